@@ -0,0 +1,24 @@
+# Write the header with the git hash of the source used by the benchmark runner
+#
+# SRC_DIR  directory inside the git repository
+# OUT_FILE header to generate, it is rewritten only when the hash change
+
+execute_process(COMMAND git rev-parse --short HEAD
+		WORKING_DIRECTORY ${SRC_DIR}
+		OUTPUT_VARIABLE OPENFPM_GIT_HASH
+		OUTPUT_STRIP_TRAILING_WHITESPACE
+		ERROR_QUIET)
+
+if (NOT OPENFPM_GIT_HASH)
+	set(OPENFPM_GIT_HASH "unknown")
+endif()
+
+set(GIT_HASH_HEADER "#define OPENFPM_GIT_HASH \"${OPENFPM_GIT_HASH}\"\n")
+
+if (EXISTS ${OUT_FILE})
+	file(READ ${OUT_FILE} GIT_HASH_HEADER_OLD)
+endif()
+
+if (NOT "${GIT_HASH_HEADER}" STREQUAL "${GIT_HASH_HEADER_OLD}")
+	file(WRITE ${OUT_FILE} "${GIT_HASH_HEADER}")
+endif()
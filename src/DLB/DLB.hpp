@@ -8,6 +8,9 @@
 #ifndef SRC_DECOMPOSITION_DLB_HPP_
 #define SRC_DECOMPOSITION_DLB_HPP_
 
+#include <unordered_map>
+#include "load_history.hpp"
+
 //! Time structure for statistical purposes
 typedef struct
 {
@@ -49,6 +52,11 @@ typedef struct
  *
  *  In the Un-balance Threshold heuristic the re-balance is triggered when the un-balance level exceeds a certain level.
  *  Levels can be chosen in the ThresholdLevel type.
+ *
+ *  DLB remember the last step times and the last computational costs of the sub-sub-domains. With a predictor
+ *  (setPredictor) the SAR heuristic use the predicted step time, and CartDecomposition::refine(DLB &) give to the
+ *  partitioner the costs predicted setPredictionHorizon() steps ahead instead of the last ones (moving fronts
+ *  are not chased)
  */
 class DLB
 {
@@ -66,6 +74,12 @@ public:
 		THRLD_LOW = 5, THRLD_MEDIUM = 7, THRLD_HIGH = 10
 	};
 
+	//! Predictor of the step times and of the computational costs
+	enum Predictor
+	{
+		LAST_VALUE, EXP_SMOOTHING, LINEAR_TREND
+	};
+
 private:
 
 	//! Runtime virtual cluster machine
@@ -98,6 +112,51 @@ private:
 	//! Threshold value
 	ThresholdLevel thl = THRLD_MEDIUM;
 
+	//! Predictor (the default use the last values)
+	Predictor pred = LAST_VALUE;
+
+	//! Number of values remembered
+	size_t h_len = 8;
+
+	//! Smoothing of the level for EXP_SMOOTHING
+	double alpha = 0.5;
+
+	//! Smoothing of the trend for EXP_SMOOTHING
+	double beta = 0.3;
+
+	//! Number of steps ahead of the predicted costs
+	double horizon = 1.0;
+
+	//! Last step times of this processor
+	load_history t_hist;
+
+	//! Last computational costs of the sub-sub-domains of this processor
+	std::unordered_map<size_t,load_history> c_hist;
+
+	//! Costs update counter
+	size_t c_step = 0;
+
+	//! For each sub-sub-domain in c_hist the last costs update that set it
+	std::unordered_map<size_t,size_t> c_stamp;
+
+	/*! \brief Predict the next value of a history with the selected predictor
+	 *
+	 * \param lh history
+	 * \param h number of steps after the last value
+	 *
+	 * \return the predicted value
+	 *
+	 */
+	double predict(const load_history & lh, double h) const
+	{
+		if (pred == EXP_SMOOTHING)
+		{return lh.predictExp(alpha,beta,h);}
+		else if (pred == LINEAR_TREND)
+		{return lh.predictLinear(h);}
+
+		return lh.last();
+	}
+
 	/*! \brief Function that gather times informations and decides if a rebalance is needed it uses the SAR heuristic
 	 *
 	 * \return true if re-balance is needed
@@ -105,7 +164,7 @@ private:
 	 */
 	inline bool SAR()
 	{
-		long t = timeInfo.iterationEndTime - timeInfo.iterationStartTime;
+		float t = getPredictedStepTime();
 		float t_max = t, t_avg = t;
 
 		// Exchange time informations through processors
@@ -272,6 +331,7 @@ public:
 	void endIteration()
 	{
 		timeInfo.iterationEndTime = clock();
+		t_hist.add((long)(timeInfo.iterationEndTime - timeInfo.iterationStartTime));
 	}
 
 	/*! \brief Set the end time when the previous rebalance has been performed
@@ -281,6 +341,7 @@ public:
 	void endIteration(size_t t)
 	{
 		timeInfo.iterationEndTime = t;
+		t_hist.add((long)(timeInfo.iterationEndTime - timeInfo.iterationStartTime));
 	}
 
 	/*! \brief Set delta time step for one iteration (Computation time)
@@ -329,6 +390,127 @@ public:
 		thl = t;
 	}
 
+	/*! \brief Set the predictor of the step times and of the computational costs (default LAST_VALUE)
+	 *
+	 * \param p predictor
+	 * \param len number of step times and costs to remember (the histories are cleared)
+	 *
+	 */
+	void setPredictor(Predictor p, size_t len = 8)
+	{
+		pred = p;
+		h_len = len;
+		t_hist.setCapacity(len);
+		c_hist.clear();
+		c_stamp.clear();
+	}
+
+	/*! \brief Get the predictor
+	 *
+	 * \return the predictor
+	 *
+	 */
+	Predictor getPredictor()
+	{
+		return pred;
+	}
+
+	/*! \brief Set the smoothing factors of the EXP_SMOOTHING predictor
+	 *
+	 * \param a smoothing of the level (default 0.5)
+	 * \param b smoothing of the trend (default 0.3)
+	 *
+	 */
+	void setSmoothing(double a, double b)
+	{
+		alpha = a;
+		beta = b;
+	}
+
+	/*! \brief Set how many steps ahead the computational costs are predicted
+	 *
+	 * The partition is used until the next re-balance, a good value is half of the
+	 * steps between two re-balance (default 1)
+	 *
+	 * \param h number of steps
+	 *
+	 */
+	void setPredictionHorizon(double h)
+	{
+		horizon = h;
+	}
+
+	/*! \brief Get the predicted time of the next step of this processor
+	 *
+	 * \return the step time (the last one with LAST_VALUE)
+	 *
+	 */
+	double getPredictedStepTime()
+	{
+		if (t_hist.size() == 0)
+		{return (long)(timeInfo.iterationEndTime - timeInfo.iterationStartTime);}
+
+		return predict(t_hist,1.0);
+	}
+
+	/*! \brief Start an update of the computational costs (see addSubSubDomainCost)
+	 *
+	 */
+	void beginCostUpdate()
+	{
+		c_step++;
+	}
+
+	/*! \brief Remember the computational cost of a sub-sub-domain and get the predicted one
+	 *
+	 * \param id sub-sub-domain id
+	 * \param cost current computational cost
+	 *
+	 * \return the cost predicted after the prediction horizon (cost with LAST_VALUE)
+	 *
+	 */
+	size_t addSubSubDomainCost(size_t id, size_t cost)
+	{
+		if (pred == LAST_VALUE)
+		{return cost;}
+
+		auto fnd = c_hist.find(id);
+		if (fnd == c_hist.end())
+		{fnd = c_hist.emplace(id,load_history(h_len)).first;}
+
+		fnd->second.add(cost);
+		c_stamp[id] = c_step;
+
+		return (size_t)(predict(fnd->second,horizon) + 0.5);
+	}
+
+	/*! \brief End an update of the computational costs, the sub-sub-domains not updated (moved to other processors) are forgotten
+	 *
+	 */
+	void endCostUpdate()
+	{
+		for (auto it = c_stamp.begin() ; it != c_stamp.end() ; )
+		{
+			if (it->second != c_step)
+			{
+				c_hist.erase(it->first);
+				it = c_stamp.erase(it);
+			}
+			else
+			{++it;}
+		}
+	}
+
+	/*! \brief Number of sub-sub-domains with a cost history
+	 *
+	 * \return the number of sub-sub-domains
+	 *
+	 */
+	size_t getNCostHistories()
+	{
+		return c_hist.size();
+	}
+
 };
 
 #endif /* SRC_DECOMPOSITION_DLB_HPP_ */
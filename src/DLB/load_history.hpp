@@ -0,0 +1,190 @@
+/*
+ * load_history.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_DLB_LOAD_HISTORY_HPP_
+#define SRC_DLB_LOAD_HISTORY_HPP_
+
+/*! \brief Ring buffer of the last n values of a load (step time or computational cost) with predictors
+ *
+ * The predictors extrapolate the load h steps after the last value:
+ *
+ * * predictLinear fit a line (least squares) on the values in the buffer
+ * * predictExp use the double exponential smoothing (Holt), level and trend are recomputed
+ *   from the oldest value in the buffer
+ *
+ * With less than two values both return the last value
+ *
+ * \code
+ *
+ * load_history lh(8);
+ *
+ * for (size_t i = 0 ; i < n_step ; i++)
+ * {lh.add(step_time(i));}
+ *
+ * double t_next = lh.predictExp(0.5,0.3,1.0);
+ *
+ * \endcode
+ *
+ */
+class load_history
+{
+	//! values (ring buffer)
+	openfpm::vector<double> val;
+
+	//! position of the oldest value
+	size_t first = 0;
+
+	//! number of values stored
+	size_t n = 0;
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param cap number of values to remember
+	 *
+	 */
+	load_history(size_t cap = 8)
+	{
+		val.resize((cap == 0)?1:cap);
+	}
+
+	/*! \brief Change the number of values to remember, the history is cleared
+	 *
+	 * \param cap number of values to remember
+	 *
+	 */
+	void setCapacity(size_t cap)
+	{
+		val.resize((cap == 0)?1:cap);
+		clear();
+	}
+
+	//! Forget all the values
+	void clear()
+	{
+		first = 0;
+		n = 0;
+	}
+
+	/*! \brief Add a value, if the buffer is full the oldest is overwritten
+	 *
+	 * \param v value
+	 *
+	 */
+	void add(double v)
+	{
+		if (n < val.size())
+		{
+			val.get((first + n) % val.size()) = v;
+			n++;
+		}
+		else
+		{
+			val.get(first) = v;
+			first = (first + 1) % val.size();
+		}
+	}
+
+	/*! \brief Number of values stored
+	 *
+	 * \return the number of values
+	 *
+	 */
+	size_t size() const
+	{
+		return n;
+	}
+
+	/*! \brief Get a value
+	 *
+	 * \param i index (0 is the oldest)
+	 *
+	 * \return the value
+	 *
+	 */
+	double get(size_t i) const
+	{
+		return val.get((first + i) % val.size());
+	}
+
+	/*! \brief Get the last value
+	 *
+	 * \return the last value, 0 if empty
+	 *
+	 */
+	double last() const
+	{
+		return (n == 0)?0.0:get(n-1);
+	}
+
+	/*! \brief Predict with the least squares line on the stored values
+	 *
+	 * \param h number of steps after the last value
+	 *
+	 * \return the predicted value (not negative)
+	 *
+	 */
+	double predictLinear(double h) const
+	{
+		if (n < 2)
+		{return last();}
+
+		double x_m = (n - 1) / 2.0;
+		double y_m = 0.0;
+
+		for (size_t i = 0 ; i < n ; i++)
+		{y_m += get(i);}
+
+		y_m /= n;
+
+		double sxy = 0.0;
+		double sxx = 0.0;
+
+		for (size_t i = 0 ; i < n ; i++)
+		{
+			sxy += (i - x_m) * (get(i) - y_m);
+			sxx += (i - x_m) * (i - x_m);
+		}
+
+		double p = y_m + sxy / sxx * (n - 1 + h - x_m);
+
+		return (p < 0.0)?0.0:p;
+	}
+
+	/*! \brief Predict with the double exponential smoothing (Holt)
+	 *
+	 * \param alpha smoothing of the level (1 follow the last value)
+	 * \param beta smoothing of the trend (0 no trend)
+	 * \param h number of steps after the last value
+	 *
+	 * \return the predicted value (not negative)
+	 *
+	 */
+	double predictExp(double alpha, double beta, double h) const
+	{
+		if (n < 2)
+		{return last();}
+
+		double l = get(0);
+		double b = get(1) - get(0);
+
+		for (size_t i = 1 ; i < n ; i++)
+		{
+			double l_p = l;
+
+			l = alpha * get(i) + (1.0 - alpha) * (l + b);
+			b = beta * (l - l_p) + (1.0 - beta) * b;
+		}
+
+		double p = l + h * b;
+
+		return (p < 0.0)?0.0:p;
+	}
+};
+
+#endif /* SRC_DLB_LOAD_HISTORY_HPP_ */
@@ -0,0 +1,474 @@
+/*
+ * phase_profiler.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_DEBUG_PHASE_PROFILER_HPP_
+#define SRC_DEBUG_PHASE_PROFILER_HPP_
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include "VCluster/VCluster.hpp"
+
+//! Communication phases instrumented
+enum prof_phase
+{
+	PROF_MAP,
+	PROF_GHOST_GET,
+	PROF_GHOST_PUT,
+	PROF_DECOMPOSE,
+	PROF_GRID_GHOST_GET,
+	PROF_GRID_MAP,
+	PROF_N_PHASES
+};
+
+//! Sub-phases of a communication phase
+enum prof_sub
+{
+	PROF_TOTAL,
+	PROF_LABEL,
+	PROF_PACK,
+	PROF_COMM,
+	PROF_UNPACK,
+	PROF_LOCAL,
+	PROF_BC,
+	PROF_N_SUB
+};
+
+//! Counters of a communication phase
+enum prof_counter
+{
+	PROF_CALLS,
+	PROF_BYTES_SENT,
+	PROF_BYTES_RECV,
+	PROF_MSG_SENT,
+	PROF_MSG_RECV,
+	PROF_PART_SENT,
+	PROF_PART_RECV,
+	PROF_N_COUNTERS
+};
+
+/*! \brief Statistics of one phase
+ *
+ */
+struct prof_phase_stat
+{
+	//! time spent in each sub-phase
+	double time[PROF_N_SUB];
+
+	//! counters
+	size_t cnt[PROF_N_COUNTERS];
+};
+
+/*! \brief Lightweight profiler of the communication phases (map, ghost_get, ghost_put, decompose ...)
+ *
+ * It is always compiled, the overhead is few clock reads for each call of an instrumented phase. Each phase
+ * record the time spent in labelling, packing, communication (MPI wait), unpacking, local ghost copy (periodic
+ * replicas of the local particles in ghost_get/ghost_put) and boundary conditions (periodic wrap of the positions
+ * while labelling in map), together with bytes, messages and particles sent and received.
+ *
+ * print_stats() and write_json() are collective (one gather of all the statistics on processor 0) and report
+ * min/avg/max across processors
+ *
+ */
+class phase_profiler
+{
+	//! statistics of each phase
+	prof_phase_stat st[PROF_N_PHASES];
+
+	//! true if the profiler is active
+	bool enabled;
+
+	/*! \brief Name of a phase
+	 *
+	 * \param ph phase
+	 *
+	 * \return the name
+	 *
+	 */
+	static const char * phase_name(size_t ph)
+	{
+		const char * names[PROF_N_PHASES] = {"map","ghost_get","ghost_put","decompose","grid_ghost_get","grid_map"};
+		return names[ph];
+	}
+
+	/*! \brief Name of a sub-phase
+	 *
+	 * \param sb sub-phase
+	 *
+	 * \return the name
+	 *
+	 */
+	static const char * sub_name(size_t sb)
+	{
+		const char * names[PROF_N_SUB] = {"total","label","pack","comm","unpack","local","bc"};
+		return names[sb];
+	}
+
+	/*! \brief Name of a counter
+	 *
+	 * \param c counter
+	 *
+	 * \return the name
+	 *
+	 */
+	static const char * counter_name(size_t c)
+	{
+		const char * names[PROF_N_COUNTERS] = {"calls","bytes_sent","bytes_recv","msg_sent","msg_recv","part_sent","part_recv"};
+		return names[c];
+	}
+
+	//! number of values reduced for each phase
+	static const size_t n_val = PROF_N_SUB + PROF_N_COUNTERS;
+
+	/*! \brief Reduce all the statistics across processors on processor 0
+	 *
+	 * All the values are packed in one vector and gathered with one collective
+	 *
+	 * \param mn minimum
+	 * \param avg average
+	 * \param mx maximum
+	 *
+	 */
+	void reduce(openfpm::vector<double> & mn, openfpm::vector<double> & avg, openfpm::vector<double> & mx)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		openfpm::vector<double> val(PROF_N_PHASES*n_val);
+		openfpm::vector<double> all;
+
+		for (size_t i = 0 ; i < PROF_N_PHASES ; i++)
+		{
+			for (size_t j = 0 ; j < n_val ; j++)
+			{val.get(i*n_val+j) = (j < PROF_N_SUB)?st[i].time[j]:(double)st[i].cnt[j - PROF_N_SUB];}
+		}
+
+		v_cl.SGather(val,all,0);
+
+		if (v_cl.getProcessUnitID() != 0)
+		{return;}
+
+		mn = val;
+		avg.resize(val.size());
+		mx = val;
+
+		for (size_t i = 0 ; i < val.size() ; i++)
+		{avg.get(i) = 0.0;}
+
+		size_t np = all.size() / val.size();
+
+		for (size_t k = 0 ; k < np ; k++)
+		{
+			for (size_t i = 0 ; i < val.size() ; i++)
+			{
+				double v = all.get(k*val.size()+i);
+
+				mn.get(i) = (v < mn.get(i))?v:mn.get(i);
+				avg.get(i) += v;
+				mx.get(i) = (v > mx.get(i))?v:mx.get(i);
+			}
+		}
+
+		for (size_t i = 0 ; i < avg.size() ; i++)
+		{avg.get(i) /= np;}
+	}
+
+public:
+
+	//! Constructor
+	phase_profiler()
+	:enabled(true)
+	{
+		reset();
+	}
+
+	/*! \brief Reset all the statistics
+	 *
+	 */
+	void reset()
+	{
+		for (size_t i = 0 ; i < PROF_N_PHASES ; i++)
+		{
+			for (size_t j = 0 ; j < PROF_N_SUB ; j++)
+			{st[i].time[j] = 0.0;}
+
+			for (size_t j = 0 ; j < PROF_N_COUNTERS ; j++)
+			{st[i].cnt[j] = 0;}
+		}
+	}
+
+	/*! \brief Enable or disable the profiler
+	 *
+	 * \param en true to enable
+	 *
+	 */
+	void enable(bool en)
+	{
+		enabled = en;
+	}
+
+	/*! \brief Return true if the profiler is enabled
+	 *
+	 * \return true if enabled
+	 *
+	 */
+	inline bool isEnabled() const
+	{
+		return enabled;
+	}
+
+	/*! \brief Add time to a sub-phase
+	 *
+	 * \param ph phase
+	 * \param sb sub-phase
+	 * \param t time in seconds
+	 *
+	 */
+	inline void add_time(prof_phase ph, prof_sub sb, double t)
+	{
+		st[ph].time[sb] += t;
+	}
+
+	/*! \brief Increment a counter
+	 *
+	 * \param ph phase
+	 * \param c counter
+	 * \param n increment
+	 *
+	 */
+	inline void add(prof_phase ph, prof_counter c, size_t n)
+	{
+		if (enabled == true)
+		{st[ph].cnt[c] += n;}
+	}
+
+	/*! \brief Record the communication of a phase
+	 *
+	 * \param ph phase
+	 * \param bytes_sent bytes sent
+	 * \param bytes_recv bytes received
+	 * \param msg_sent messages sent
+	 * \param msg_recv messages received
+	 * \param part_sent particles (or grid pieces) sent
+	 * \param part_recv particles (or grid pieces) received
+	 *
+	 */
+	inline void add_comm(prof_phase ph, size_t bytes_sent, size_t bytes_recv, size_t msg_sent, size_t msg_recv, size_t part_sent, size_t part_recv)
+	{
+		if (enabled == false)
+		{return;}
+
+		st[ph].cnt[PROF_BYTES_SENT] += bytes_sent;
+		st[ph].cnt[PROF_BYTES_RECV] += bytes_recv;
+		st[ph].cnt[PROF_MSG_SENT] += msg_sent;
+		st[ph].cnt[PROF_MSG_RECV] += msg_recv;
+		st[ph].cnt[PROF_PART_SENT] += part_sent;
+		st[ph].cnt[PROF_PART_RECV] += part_recv;
+	}
+
+	/*! \brief Get the statistics of a phase on this processor
+	 *
+	 * \param ph phase
+	 *
+	 * \return the statistics
+	 *
+	 */
+	inline const prof_phase_stat & get(prof_phase ph) const
+	{
+		return st[ph];
+	}
+
+	/*! \brief Print min/avg/max across processors of all the phases called at least once (collective)
+	 *
+	 * \param out stream where to print (only processor 0 print)
+	 *
+	 */
+	void print_stats(std::ostream & out = std::cout)
+	{
+		openfpm::vector<double> mn;
+		openfpm::vector<double> avg;
+		openfpm::vector<double> mx;
+
+		reduce(mn,avg,mx);
+
+		if (create_vcluster().getProcessUnitID() != 0)
+		{return;}
+
+		out << std::left << std::setw(16) << "phase" << std::setw(12) << "value" << std::right << std::setw(16) << "min" << std::setw(16) << "avg" << std::setw(16) << "max" << std::endl;
+
+		for (size_t i = 0 ; i < PROF_N_PHASES ; i++)
+		{
+			if (mx.get(i*n_val + PROF_N_SUB + PROF_CALLS) == 0)
+			{continue;}
+
+			for (size_t j = 0 ; j < n_val ; j++)
+			{
+				if (mx.get(i*n_val+j) == 0)
+				{continue;}
+
+				const char * name = (j < PROF_N_SUB)?sub_name(j):counter_name(j - PROF_N_SUB);
+
+				out << std::left << std::setw(16) << phase_name(i) << std::setw(12) << name << std::right
+				    << std::setw(16) << mn.get(i*n_val+j) << std::setw(16) << avg.get(i*n_val+j) << std::setw(16) << mx.get(i*n_val+j) << std::endl;
+			}
+		}
+	}
+
+	/*! \brief Write min/avg/max across processors of all the phases in JSON format (collective)
+	 *
+	 * \param file output file (only processor 0 write)
+	 *
+	 */
+	void write_json(const std::string & file)
+	{
+		openfpm::vector<double> mn;
+		openfpm::vector<double> avg;
+		openfpm::vector<double> mx;
+
+		reduce(mn,avg,mx);
+
+		Vcluster<> & v_cl = create_vcluster();
+
+		if (v_cl.getProcessUnitID() != 0)
+		{return;}
+
+		std::ofstream out(file);
+
+		if (out.is_open() == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error cannot open the file " << file << std::endl;
+			return;
+		}
+
+		out << "{\n  \"n_ranks\": " << v_cl.getProcessingUnits() << ",\n  \"phases\": {";
+
+		bool first_ph = true;
+		for (size_t i = 0 ; i < PROF_N_PHASES ; i++)
+		{
+			if (mx.get(i*n_val + PROF_N_SUB + PROF_CALLS) == 0)
+			{continue;}
+
+			out << ((first_ph == true)?"\n":",\n") << "    \"" << phase_name(i) << "\": {";
+			first_ph = false;
+
+			for (size_t j = 0 ; j < n_val ; j++)
+			{
+				const char * name = (j < PROF_N_SUB)?sub_name(j):counter_name(j - PROF_N_SUB);
+
+				out << ((j == 0)?"\n":",\n") << "      \"" << name << "\": {\"min\": " << mn.get(i*n_val+j)
+				    << ", \"avg\": " << avg.get(i*n_val+j) << ", \"max\": " << mx.get(i*n_val+j) << "}";
+			}
+
+			out << "\n    }";
+		}
+
+		out << "\n  }\n}\n";
+	}
+};
+
+/*! \brief Return the global phase profiler
+ *
+ * \return the profiler
+ *
+ */
+inline phase_profiler & openfpm_profiler()
+{
+	static phase_profiler prof;
+
+	return prof;
+}
+
+/*! \brief Measure the time of a sub-phase from the construction to stop() (or destruction)
+ *
+ */
+class prof_region
+{
+	//! phase
+	prof_phase ph;
+
+	//! sub-phase
+	prof_sub sb;
+
+	//! true if running
+	bool running;
+
+	//! starting time
+	std::chrono::steady_clock::time_point t0;
+
+	//! sub-phase of the operations timed with inner()
+	prof_sub sb_in;
+
+	//! time spent in the operations timed with inner()
+	double t_in;
+
+public:
+
+	/*! \brief Start measuring
+	 *
+	 * \param ph phase
+	 * \param sb sub-phase
+	 *
+	 */
+	prof_region(prof_phase ph, prof_sub sb)
+	:ph(ph),sb(sb),running(openfpm_profiler().isEnabled()),sb_in(sb),t_in(0.0)
+	{
+		if (running == true)
+		{t0 = std::chrono::steady_clock::now();}
+	}
+
+	/*! \brief Execute f and account its time to the sub-phase sb_in instead of this region
+	 *
+	 * It is used for an operation done inside the loop of another sub-phase (like the boundary
+	 * conditions applied while labelling), when the profiler is disabled f is just called
+	 *
+	 * \param sb_in sub-phase of f
+	 * \param f operation to time
+	 *
+	 */
+	template<typename F> inline void inner(prof_sub sb_in, F f)
+	{
+		if (running == false)
+		{
+			f();
+			return;
+		}
+
+		std::chrono::steady_clock::time_point ti = std::chrono::steady_clock::now();
+		f();
+		std::chrono::duration<double> dt = std::chrono::steady_clock::now() - ti;
+
+		this->sb_in = sb_in;
+		t_in += dt.count();
+	}
+
+	/*! \brief Stop measuring and add the time to the profiler
+	 *
+	 */
+	inline void stop()
+	{
+		if (running == false)
+		{return;}
+
+		std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+		openfpm_profiler().add_time(ph,sb,dt.count() - t_in);
+
+		if (t_in != 0.0)
+		{openfpm_profiler().add_time(ph,sb_in,t_in);}
+
+		if (sb == PROF_TOTAL)
+		{openfpm_profiler().add(ph,PROF_CALLS,1);}
+
+		running = false;
+	}
+
+	//! Destructor
+	~prof_region()
+	{
+		stop();
+	}
+};
+
+#endif /* SRC_DEBUG_PHASE_PROFILER_HPP_ */
@@ -22,6 +22,7 @@
 #include "Space/Shape/Point.hpp"
 #include "NN/CellList/CellDecomposer.hpp"
 #include <unordered_map>
+#include <algorithm>
 #include "NN/CellList/CellList.hpp"
 #include "Space/Ghost.hpp"
 #include "common.hpp"
@@ -39,9 +40,201 @@
 #include "data_type/aggregate.hpp"
 #include "Domain_NN_calculator_cart.hpp"
 #include "cuda/CartDecomposition_gpu.cuh"
+#include "Debug/phase_profiler.hpp"
 
 #define CARTDEC_ERROR 2000lu
 
+/*! \brief Quality of the partition produced by CartDecomposition (see getQualityReport)
+ *
+ * The first block is about this processor, the second is the aggregate over all the processors
+ *
+ */
+struct dec_quality_report
+{
+	//! computational load of this processor
+	size_t load = 0;
+
+	//! number of sub-sub-domains of this processor
+	size_t n_ssd = 0;
+
+	//! number of sub-domains of this processor
+	size_t n_sub = 0;
+
+	//! number of neighborhood processors
+	size_t n_nn = 0;
+
+	//! volume of the external ghost boxes of this processor
+	double ghost_vol = 0.0;
+
+	//! edges of the sub-sub-domain graph from this processor to the others
+	size_t edge_cut = 0;
+
+	//! sub-sub-domains of this processor moved to another processor by the last decomposition
+	size_t mig = 0;
+
+	//! maximum load
+	size_t load_max = 0;
+
+	//! minimum load
+	size_t load_min = 0;
+
+	//! average load
+	double load_avg = 0.0;
+
+	//! load imbalance max / avg (1.0 perfect balance)
+	double imbalance = 1.0;
+
+	//! total volume of the external ghost boxes
+	double ghost_vol_tot = 0.0;
+
+	//! maximum volume of the external ghost boxes of one processor
+	double ghost_vol_max = 0.0;
+
+	//! maximum number of neighborhood processors
+	size_t n_nn_max = 0;
+
+	//! total number of sub-domains
+	size_t n_sub_tot = 0;
+
+	//! maximum number of sub-domains of one processor
+	size_t n_sub_max = 0;
+
+	//! total edge cut (every cut edge counted once)
+	size_t edge_cut_tot = 0;
+
+	//! total number of sub-sub-domains moved by the last decomposition
+	size_t mig_tot = 0;
+};
+
+/*! \brief Sub-sub-domain moved by the diffusive load balancing (see CartDecomposition::diffuse)
+ *
+ */
+struct dif_move
+{
+	//! sub-sub-domain id
+	size_t id;
+
+	//! processor that receive the sub-sub-domain
+	size_t dst_proc;
+
+	//! diffuse call that moved it
+	size_t step;
+
+	//! it does not have pointers
+	static bool noPointers() {return true;}
+};
+
+/*! \brief Check if the Distribution decompose the whole graph on the processor 0 (like MetisDistribution)
+ *
+ * In that case the processor 0 must have the costs of every sub-sub-domain
+ *
+ */
+template<typename Distribution, typename Sfinae = void>
+struct is_master_decompose: std::false_type
+{};
+
+/*! \brief Check if the Distribution decompose the whole graph on the processor 0 (like MetisDistribution)
+ *
+ */
+template<typename Distribution>
+struct is_master_decompose<Distribution,typename std::enable_if<Distribution::master_decompose>::type>: std::true_type
+{};
+
+/*! \brief Get the sub-sub-domains of this processor
+ *
+ * Without the list of the owned sub-sub-domains in the Distribution the graph is scanned, O(global sub-sub-domains)
+ *
+ */
+template<typename Distribution, typename Sfinae = void>
+struct dist_owned_ssd
+{
+	/*! \brief Get the sub-sub-domains of this processor
+	 *
+	 * \param dist distribution
+	 * \param p_id processor id
+	 * \param q_owned sub-sub-domains of this processor
+	 *
+	 */
+	static void get(Distribution & dist, size_t p_id, openfpm::vector<size_t> & q_owned)
+	{
+		auto & g = dist.getGraph();
+
+		q_owned.clear();
+		for (size_t i = 0 ; i < g.getNVertex() ; i++)
+		{
+			if (g.template vertex_p<nm_v::proc_id>(i) == p_id)
+			{q_owned.add(i);}
+		}
+	}
+};
+
+/*! \brief Get the sub-sub-domains of this processor
+ *
+ * The Distribution has the list of the owned sub-sub-domains, O(local sub-sub-domains)
+ *
+ */
+template<typename Distribution>
+struct dist_owned_ssd<Distribution,typename std::conditional<true,void,decltype(std::declval<Distribution &>().getOwnerSubSubDomain(0))>::type>
+{
+	/*! \brief Get the sub-sub-domains of this processor
+	 *
+	 * \param dist distribution
+	 * \param p_id processor id
+	 * \param q_owned sub-sub-domains of this processor
+	 *
+	 */
+	static void get(Distribution & dist, size_t p_id, openfpm::vector<size_t> & q_owned)
+	{
+		q_owned.resize(dist.getNOwnerSubSubDomains());
+		for (size_t k = 0 ; k < q_owned.size() ; k++)
+		{q_owned.get(k) = dist.getOwnerSubSubDomain(k);}
+	}
+};
+
+/*! \brief Set the same communication cost on all the edges of the Distribution graph
+ *
+ * It use setCommunicationCost on every edge
+ *
+ */
+template<typename Distribution, typename Sfinae = void>
+struct dist_set_all_comm_cost
+{
+	/*! \brief Set the communication cost on all the edges
+	 *
+	 * \param dist distribution
+	 * \param cost communication cost
+	 *
+	 */
+	static void set(Distribution & dist, size_t cost)
+	{
+		for (size_t i = 0; i < dist.getNSubSubDomains(); i++)
+		{
+			for (size_t s = 0; s < dist.getNSubSubDomainNeighbors(i); s++)
+			{dist.setCommunicationCost(i, s, cost);}
+		}
+	}
+};
+
+/*! \brief Set the same communication cost on all the edges of the Distribution graph
+ *
+ * It use setAllCommunicationCosts when the Distribution has it (the implicit graph store a single weight)
+ *
+ */
+template<typename Distribution>
+struct dist_set_all_comm_cost<Distribution,typename std::conditional<true,void,decltype(std::declval<Distribution &>().setAllCommunicationCosts(0))>::type>
+{
+	/*! \brief Set the communication cost on all the edges
+	 *
+	 * \param dist distribution
+	 * \param cost communication cost
+	 *
+	 */
+	static void set(Distribution & dist, size_t cost)
+	{
+		dist.setAllCommunicationCosts(cost);
+	}
+};
+
 /*! \brief It spread the sub-sub-domain on a regular cartesian grid of size dim
  *
  * \warning this function only guarantee that the division on each direction is
@@ -146,6 +339,10 @@ public:
 	//! This class admit a class defined on an extended domain
 	typedef CartDecomposition_ext<dim,T,Memory,layout_base,Distribution> extended_type;
 
+	//! measured costs of one sub-sub-domain (id, bytes to migrate it, bytes that cross each face if
+	//! the face is cut, index 2*d + (0 for the face low, 1 for the face high))
+	typedef aggregate<size_t,size_t,size_t[2*dim]> meas_cost_type;
+
 protected:
 
 	//! bool that indicate whenever the buffer has been already transfer to device
@@ -220,6 +417,74 @@ protected:
 	//! set of Boxes produced by the decomposition optimizer
 	openfpm::vector<::Box<dim, size_t>> loc_box;
 
+	//! if true sub_domains_global contain only the local and neighborhood sub-domains, the
+	//! owner of the other cells is stored in a distributed directory (see setDistributedDirectory)
+	bool dir_mode = false;
+
+	//! distributed directory, owner processor of the cells of gr in [dir_start,dir_start + dir_owner.size())
+	openfpm::vector<size_t> dir_owner;
+
+	//! first cell of gr stored by this processor in the directory
+	size_t dir_start = 0;
+
+	//! if true the sub-domains are produced by the merge-aware optimizer (see setSubdomainMerge)
+	bool sub_merge = false;
+
+	//! maximum number of sub-domains for the merge-aware optimizer (0 no limit)
+	size_t sub_max_box = 0;
+
+	//! cost of one sub-domain for the merge-aware optimizer (in ghost sub-sub-domains)
+	size_t sub_box_cost = 0;
+
+	//! surface to volume statistics of the local sub-domains
+	dec_optimizer_stats sub_stats;
+
+	//! sub-sub-domains of this processor (from the last decomposition)
+	openfpm::vector<size_t> q_owned;
+
+	//! sub-sub-domains that left this processor in the last decomposition
+	size_t q_mig = 0;
+
+	//! sub-sub-domains moved by this processor with diffuse since the last global decomposition
+	openfpm::vector<dif_move> dif_mv;
+
+	//! number of diffuse calls
+	size_t dif_step = 0;
+
+	//! number of diffuse calls at the last synchronization of the graph (see diffuse_sync)
+	size_t dif_step_sync = 0;
+
+	/*! \brief Update the list of the sub-sub-domains of this processor and count the ones that left
+	 *
+	 * It cost O(local sub-sub-domains) when the Distribution has the list of the owned sub-sub-domains
+	 * (MetisDistribution, ParMetisDistribution), O(global sub-sub-domains) otherwise (see dist_owned_ssd)
+	 *
+	 * \param p_id processor id
+	 *
+	 */
+	void update_owned_ssd(size_t p_id)
+	{
+		auto & g = dist.getGraph();
+
+		q_mig = 0;
+		for (size_t k = 0 ; k < q_owned.size() ; k++)
+		{
+			if (g.template vertex_p<nm_v::proc_id>(q_owned.get(k)) != p_id)
+			{q_mig++;}
+		}
+
+		dist_owned_ssd<Distribution>::get(dist,p_id,q_owned);
+	}
+
+	//! number of cells of gr stored by each processor in the directory
+	size_t dir_blk = 1;
+
+	//! measured costs of the owned sub-sub-domains and of their neighborhood, of all the sub-sub-domains on processor 0 with MetisDistribution (see setMeasuredCosts)
+	openfpm::vector<meas_cost_type> meas_cost;
+
+	//! true if the measured costs has been set
+	bool meas_set = false;
+
 	/*! \brief It convert the box from the domain decomposition into sub-domain
 	 *
 	 * The decomposition box from the domain-decomposition contain the box in integer
@@ -302,6 +567,147 @@ protected:
 		v_cl.execute();
 	}
 
+	/*! \brief Collect the local sub-domains and the sub-domains of the neighborhood processors
+	 *
+	 * \param sub_domains_global output
+	 *
+	 */
+	void collect_near_sub_domains(openfpm::vector<Box_map<dim,T>,Memory,typename layout_base<Box_map<dim, T>>::type,layout_base> & sub_domains_global)
+	{
+		sub_domains_global.clear();
+
+		for (size_t i = 0 ; i < sub_domains.size() ; i++)
+		{
+			sub_domains_global.add();
+
+			sub_domains_global.template get<0>(sub_domains_global.size()-1) = ::SpaceBox<dim,T>(sub_domains.get(i));
+			sub_domains_global.template get<1>(sub_domains_global.size()-1) = v_cl.rank();
+		}
+
+		for (size_t i = 0 ; i < nn_prcs<dim,T>::getNNProcessors() ; i++)
+		{
+			size_t prc = nn_prcs<dim,T>::IDtoProc(i);
+			const openfpm::vector< ::Box<dim,T> > & nn_sub = nn_prcs<dim,T>::getNearSubdomains(prc);
+
+			for (size_t j = 0 ; j < nn_sub.size() ; j++)
+			{
+				// the periodic images are outside the domain
+				::Box<dim,T> b_int;
+				if (domain.Intersect(nn_sub.get(j),b_int) == false)
+				{continue;}
+
+				sub_domains_global.add();
+
+				sub_domains_global.template get<0>(sub_domains_global.size()-1) = ::SpaceBox<dim,T>(b_int);
+				sub_domains_global.template get<1>(sub_domains_global.size()-1) = prc;
+			}
+		}
+	}
+
+	/*! \brief Linear id of the cell of gr containing the point
+	 *
+	 * \param p point
+	 *
+	 * \return the linearized cell id
+	 *
+	 */
+	size_t dirCell(const Point<dim,T> & p) const
+	{
+		grid_key_dx<dim> key;
+
+		for (size_t i = 0 ; i < dim ; i++)
+		{
+			long int c = (long int)std::floor((p.get(i) - domain.getLow(i)) / spacing[i]);
+			c = (c < 0)?0:c;
+			c = (c >= (long int)gr.size(i))?gr.size(i)-1:c;
+			key.set_d(i,c);
+		}
+
+		return gr.LinId(key);
+	}
+
+	/*! \brief Construct the distributed directory
+	 *
+	 * The cells of gr are block-distributed across the processors. Each processor send the
+	 * cells covered by its sub-domains to the processors storing them. The memory
+	 * is O(cells / processors) on each processor
+	 *
+	 */
+	void construct_directory()
+	{
+		size_t n_cell = gr.size();
+
+		dir_blk = (n_cell + v_cl.size() - 1) / v_cl.size();
+		dir_blk = (dir_blk == 0)?1:dir_blk;
+		dir_start = v_cl.rank() * dir_blk;
+
+		size_t dir_stop = (dir_start + dir_blk < n_cell)?dir_start + dir_blk:n_cell;
+		dir_owner.resize((dir_stop > dir_start)?dir_stop - dir_start:0);
+		for (size_t i = 0 ; i < dir_owner.size() ; i++)
+		{dir_owner.get(i) = (size_t)-1;}
+
+		std::unordered_map<size_t,size_t> dst_id;
+		openfpm::vector<size_t> prc_send;
+		openfpm::vector<openfpm::vector<size_t>> c_send;
+
+		for (size_t s = 0 ; s < sub_domains.size() ; s++)
+		{
+			grid_key_dx<dim> k1;
+			grid_key_dx<dim> k2;
+
+			// sub-domains are aligned to the cells of gr
+			for (size_t i = 0 ; i < dim ; i++)
+			{
+				long int c1 = std::lround((sub_domains.get(s).getLow(i) - domain.getLow(i)) / spacing[i]);
+				long int c2 = std::lround((sub_domains.get(s).getHigh(i) - domain.getLow(i)) / spacing[i]) - 1;
+
+				k1.set_d(i,(c1 < 0)?0:c1);
+				k2.set_d(i,(c2 >= (long int)gr.size(i))?gr.size(i)-1:c2);
+			}
+
+			grid_key_dx_iterator_sub<dim> g_sub(gr,k1,k2);
+
+			while (g_sub.isNext())
+			{
+				size_t lin = gr.LinId(g_sub.get());
+				size_t dst = lin / dir_blk;
+
+				if (dst == v_cl.rank())
+				{dir_owner.get(lin - dir_start) = v_cl.rank();}
+				else
+				{
+					auto it = dst_id.find(dst);
+					if (it == dst_id.end())
+					{
+						dst_id[dst] = prc_send.size();
+						prc_send.add(dst);
+						c_send.add();
+						c_send.last().add(lin);
+					}
+					else
+					{c_send.get(it->second).add(lin);}
+				}
+
+				++g_sub;
+			}
+		}
+
+		openfpm::vector<size_t> c_recv;
+		openfpm::vector<size_t> prc_recv;
+		openfpm::vector<size_t> sz_recv;
+
+		v_cl.SSendRecv(c_send,c_recv,prc_send,prc_recv,sz_recv);
+
+		size_t off = 0;
+		for (size_t i = 0 ; i < prc_recv.size() ; i++)
+		{
+			for (size_t j = 0 ; j < sz_recv.get(i) ; j++)
+			{dir_owner.get(c_recv.get(off + j) - dir_start) = prc_recv.get(i);}
+
+			off += sz_recv.get(i);
+		}
+	}
+
 public:
 
 	void initialize_fine_s(const ::Box<dim,T> & domain)
@@ -318,7 +724,13 @@ public:
 
 	void construct_fine_s()
 	{
-		collect_all_sub_domains(sub_domains_global);
+		if (dir_mode == true)
+		{
+			collect_near_sub_domains(sub_domains_global);
+			construct_directory();
+		}
+		else
+		{collect_all_sub_domains(sub_domains_global);}
 
 		// now draw all sub-domains in fine-s
 
@@ -371,6 +783,9 @@ public:
 		// fill the structure that store the processor id for each sub-domain
 		initialize_fine_s(domain);
 
+		// sub-sub-domains moved by the decomposition (quality report)
+		update_owned_ssd(p_id);
+
 		// Optimize the decomposition creating bigger spaces
 		// And reducing Ghost over-stress
 		dec_optimizer<dim, Graph_CSR<nm_v, nm_e>> d_o(dist.getGraph(), gr_dist.getSize());
@@ -386,7 +801,12 @@ public:
 		}
 
 		// optimize the decomposition
-		d_o.template optimize<nm_v::sub_id, nm_v::proc_id>(dist.getGraph(), p_id, loc_box, box_nn_processor,ghe,bc);
+		if (sub_merge == true)
+		{d_o.template optimize_merge<nm_v::sub_id, nm_v::proc_id>(dist.getGraph(), p_id, loc_box, box_nn_processor,ghe,bc,sub_max_box,sub_box_cost);}
+		else
+		{d_o.template optimize<nm_v::sub_id, nm_v::proc_id>(dist.getGraph(), p_id, loc_box, box_nn_processor,ghe,bc);}
+
+		sub_stats = d_o.getStats();
 
 		// Initialize
 		if (loc_box.size() > 0)
@@ -465,12 +885,99 @@ public:
 		}
 	}
 
+	/*! \brief Set the communication and migration costs from the measured traffic (see setMeasuredCosts)
+	 *
+	 * The cost of the edge between two sub-sub-domains is the number of bytes that cross the shared face
+	 * in both directions, the migration cost is the number of bytes of the sub-sub-domain. The costs are
+	 * scaled by a common unit to stay in the range of the partitioner weights. Every processor set the
+	 * costs of the sub-sub-domains it own, when the graph is decomposed on processor 0 (MetisDistribution)
+	 * processor 0 set the costs of all the sub-sub-domains
+	 *
+	 * \warning it is a collective call
+	 *
+	 * \param ts number of ghost_get between two rebalancing
+	 *
+	 */
+	void computeMeasuredCosts(size_t ts)
+	{
+		// maximum weight passed to the partitioner
+		const size_t c_max = 1 << 24;
+
+		std::unordered_map<size_t,size_t> m_id;
+
+		size_t max_c = 1;
+		for (size_t i = 0 ; i < meas_cost.size() ; i++)
+		{
+			m_id[meas_cost.template get<0>(i)] = i;
+			max_c = std::max(max_c,meas_cost.template get<1>(i));
+
+			for (size_t f = 0 ; f < 2*dim ; f++)
+			{max_c = std::max(max_c,2*meas_cost.template get<2>(i)[f]*ts);}
+		}
+
+		// the unit must be the same on all processors to keep the edges symmetric
+		v_cl.max(max_c);
+		v_cl.execute();
+
+		size_t unit = 1 + max_c / c_max;
+
+		bool all = is_master_decompose<Distribution>::value && v_cl.rank() == 0;
+		size_t n_set = (all == true)?dist.getNSubSubDomains():dist.getNOwnerSubSubDomains();
+
+		for (size_t k = 0; k < n_set; k++)
+		{
+			size_t i = (all == true)?k:dist.getOwnerSubSubDomain(k);
+
+			auto it_i = m_id.find(i);
+			size_t mig = (it_i == m_id.end())?0:meas_cost.template get<1>(it_i->second);
+
+			dist.setMigrationCost(i, std::max((size_t)1,mig / unit));
+
+			grid_key_dx<dim> ki = gr_dist.InvLinId(i);
+
+			for (size_t s = 0; s < dist.getNSubSubDomainNeighbors(i); s++)
+			{
+				size_t j = dist.getSubSubDomainNeighbor(i,s);
+				grid_key_dx<dim> kj = gr_dist.InvLinId(j);
+
+				auto it_j = m_id.find(j);
+
+				// bytes crossing the face shared by i and j, face + of i is face - of j
+				size_t b = 0;
+				for (size_t d = 0 ; d < dim ; d++)
+				{
+					if (ki.get(d) == kj.get(d))
+					{continue;}
+
+					size_t f = (kj.get(d) > ki.get(d))?1:0;
+
+					if (it_i != m_id.end())
+					{b += meas_cost.template get<2>(it_i->second)[2*d + f];}
+
+					if (it_j != m_id.end())
+					{b += meas_cost.template get<2>(it_j->second)[2*d + 1 - f];}
+				}
+
+				// the graph must stay undirected, b is symmetric in i and j
+				dist.setCommunicationCost(i, s, std::max((size_t)1,b * ts / unit));
+			}
+		}
+
+		commCostSet = true;
+	}
+
 	/*! \brief Calculate communication and migration costs
 	 *
 	 * \param ts how many timesteps have passed since last calculation, used to approximate the cost
 	 */
 	void computeCommunicationAndMigrationCosts(size_t ts)
 	{
+		if (meas_set == true)
+		{
+			computeMeasuredCosts(ts);
+			return;
+		}
+
 		float migration = 0;
 
 		SpaceBox<dim, T> cellBox = cd.getCellBox();
@@ -491,20 +998,12 @@ public:
 
 		migration = pow(b_s, dim);
 
-		size_t prev = 0;
-
 		for (size_t i = 0; i < dist.getNSubSubDomains(); i++)
-		{
-			dist.setMigrationCost(i, norm * migration /* * dist.getSubSubDomainComputationCost(i)*/ );
+		{dist.setMigrationCost(i, norm * migration /* * dist.getSubSubDomainComputationCost(i)*/ );}
 
-			for (size_t s = 0; s < dist.getNSubSubDomainNeighbors(i); s++)
-			{
-				// We have to remove dist.getSubSubDomainComputationCost(i) otherwise the graph is
-				// not directed
-				dist.setCommunicationCost(i, s, 1 /** dist.getSubSubDomainComputationCost(i)*/  *  ts);
-			}
-			prev += dist.getNSubSubDomainNeighbors(i);
-		}
+		// We have to remove dist.getSubSubDomainComputationCost(i) otherwise the graph is
+		// not directed, the cost is the same on all the edges
+		dist_set_all_comm_cost<Distribution>::set(dist, 1 /** dist.getSubSubDomainComputationCost(i)*/  *  ts);
 
 		commCostSet = true;
 	}
@@ -863,6 +1362,19 @@ public:
 		cart.box_nn_processor = box_nn_processor;
 		cart.sub_domains = sub_domains;
 		cart.fine_s = fine_s;
+		cart.dir_mode = dir_mode;
+		cart.sub_merge = sub_merge;
+		cart.sub_max_box = sub_max_box;
+		cart.sub_box_cost = sub_box_cost;
+		cart.sub_stats = sub_stats;
+		cart.q_owned = q_owned;
+		cart.q_mig = q_mig;
+		cart.dif_mv = dif_mv;
+		cart.dif_step = dif_step;
+		cart.dif_step_sync = dif_step_sync;
+		cart.dir_owner = dir_owner;
+		cart.dir_start = dir_start;
+		cart.dir_blk = dir_blk;
 
 		cart.gr = gr;
 		cart.cd = cd;
@@ -910,6 +1422,21 @@ public:
 		cart.cd = cd;
 		cart.domain = domain;
 		cart.sub_domains_global = sub_domains_global;
+		cart.dir_mode = dir_mode;
+		cart.sub_merge = sub_merge;
+		cart.sub_max_box = sub_max_box;
+		cart.sub_box_cost = sub_box_cost;
+		cart.sub_stats = sub_stats;
+		cart.q_owned = q_owned;
+		cart.q_mig = q_mig;
+		cart.dif_mv = dif_mv;
+		cart.dif_step = dif_step;
+		cart.dif_step_sync = dif_step_sync;
+		cart.dir_owner = dir_owner;
+		cart.dir_start = dir_start;
+		cart.dir_blk = dir_blk;
+		cart.meas_cost = meas_cost;
+		cart.meas_set = meas_set;
 		for (size_t i = 0 ; i < dim ; i++)
 		{cart.spacing[i] = spacing[i];};
 
@@ -984,6 +1511,21 @@ public:
 		cd = cart.cd;
 		domain = cart.domain;
 		sub_domains_global = cart.sub_domains_global;
+		dir_mode = cart.dir_mode;
+		sub_merge = cart.sub_merge;
+		sub_max_box = cart.sub_max_box;
+		sub_box_cost = cart.sub_box_cost;
+		sub_stats = cart.sub_stats;
+		q_owned = cart.q_owned;
+		q_mig = cart.q_mig;
+		dif_mv = cart.dif_mv;
+		dif_step = cart.dif_step;
+		dif_step_sync = cart.dif_step_sync;
+		dir_owner = cart.dir_owner;
+		dir_start = cart.dir_start;
+		dir_blk = cart.dir_blk;
+		meas_cost = cart.meas_cost;
+		meas_set = cart.meas_set;
 
 		for (size_t i = 0 ; i < dim ; i++)
 		{
@@ -1024,6 +1566,21 @@ public:
 		cd = cart.cd;
 		domain = cart.domain;
 		sub_domains_global.swap(cart.sub_domains_global);
+		dir_mode = cart.dir_mode;
+		sub_merge = cart.sub_merge;
+		sub_max_box = cart.sub_max_box;
+		sub_box_cost = cart.sub_box_cost;
+		sub_stats = cart.sub_stats;
+		q_owned = cart.q_owned;
+		q_mig = cart.q_mig;
+		dif_mv.swap(cart.dif_mv);
+		dif_step = cart.dif_step;
+		dif_step_sync = cart.dif_step_sync;
+		dir_owner.swap(cart.dir_owner);
+		dir_start = cart.dir_start;
+		dir_blk = cart.dir_blk;
+		meas_cost.swap(cart.meas_cost);
+		meas_set = cart.meas_set;
 
 		for (size_t i = 0 ; i < dim ; i++)
 		{
@@ -1059,56 +1616,472 @@ public:
 		return openfpm::math::round_big_2(pow(n_sub, 1.0 / dim));
 	}
 
-	/*! \brief Given a point return in which processor the particle should go
+	/*! \brief Store only the local and neighborhood sub-domains
 	 *
-	 * \param p point
+	 * By default every processor store all the sub-domains (gathered and broadcasted), that
+	 * cost O(total sub-domains) memory and setup time on each processor. With the distributed
+	 * directory every processor store only its sub-domains and the ones of the neighborhood
+	 * processors, the owner of the other cells of the decomposition grid is stored in a
+	 * directory block-distributed across the processors.
 	 *
-	 * \return processorID
+	 * \warning In this mode processorID is valid only for points in local or neighborhood
+	 *          sub-domains (it signal an error and return -1 for the others), the other points must be
+	 *          resolved with processorIDRemote (collective). The map of vector_dist and grid_dist_id
+	 *          do it automatically.
+	 *          Must be set before decompose, it is not supported on device
+	 *
+	 * \param dir true to use the distributed directory
 	 *
 	 */
-	template<typename Mem> size_t inline processorID(const encapc<1, Point<dim,T>, Mem> & p) const
+	void setDistributedDirectory(bool dir)
 	{
-		return processorID_impl(p,fine_s,sub_domains_global,getDomain(),bc);
+		dir_mode = dir;
 	}
 
-	/*! \brief Given a point return in which processor the particle should go
+	/*! \brief Check if the decomposition use the distributed directory
 	 *
-	 * \param p point
+	 * \return true if the distributed directory is used
 	 *
-	 * \return processorID
+	 */
+	bool isDistributedDirectory() const
+	{
+		return dir_mode;
+	}
+
+	/*! \brief Produce the sub-domains with the merge-aware optimizer
+	 *
+	 * The sub-domains produced by the wavefront expansion are merged to minimize the total ghost
+	 * surface plus box_cost for each sub-domain, with at most max_box sub-domains for each processor
+	 * (if reachable with rectangular merges). Must be set before decompose
+	 *
+	 * \param merge true to use the merge-aware optimizer
+	 * \param max_box maximum number of sub-domains (0 no limit)
+	 * \param box_cost cost of one sub-domain in ghost sub-sub-domains
 	 *
 	 */
-	size_t inline processorID(const Point<dim,T> &p) const
+	void setSubdomainMerge(bool merge, size_t max_box = 0, size_t box_cost = 0)
 	{
-		return processorID_impl(p,fine_s,sub_domains_global,getDomain(),bc);
+		sub_merge = merge;
+		sub_max_box = max_box;
+		sub_box_cost = box_cost;
 	}
 
-	/*! \brief Given a point return in which processor the particle should go
+	/*! \brief Get the surface to volume statistics of the local sub-domains
 	 *
-	 * \param p point
+	 * The surface and the volume are in sub-sub-domains of the decomposition grid
 	 *
-	 * \return processorID
+	 * \return the statistics of the last decomposition
 	 *
 	 */
-	size_t inline processorID(const T (&p)[dim]) const
+	const dec_optimizer_stats & getSubdomainStats() const
 	{
-		return processorID_impl(p,fine_s,sub_domains_global,getDomain(),bc);
+		return sub_stats;
 	}
 
-	/*! \brief Given a point return in which processor the point/particle should go
+	/*! \brief Report the quality of the current partition
 	 *
-	 * Boundary conditions are considered
+	 * Load, sub-domains, neighborhood processors, external ghost volume, edge cut of the
+	 * sub-sub-domain graph and sub-sub-domains moved by the last decomposition, for this
+	 * processor and aggregated. It cost O(local sub-sub-domains) and one batch of reductions, so it can be
+	 * called after every decompose / refine / redecompose to reject a partition before map().
+	 * If no computation cost has been set the load is the number of sub-sub-domains
 	 *
-	 * \param p point
+	 * \warning it is a collective call
 	 *
-	 * \return processorID
+	 * \return the report
 	 *
 	 */
-	template<typename Mem> size_t inline processorIDBC(encapc<1, Point<dim,T>, Mem> p)
+	dec_quality_report getQualityReport()
+	{
+		dec_quality_report rep;
+		size_t p_id = v_cl.getProcessUnitID();
+		auto & g = dist.getGraph();
+
+		rep.load = dist.getProcessorLoad();
+		rep.n_ssd = q_owned.size();
+		rep.n_sub = sub_domains.size();
+		rep.n_nn = nn_prcs<dim,T>::getNNProcessors();
+		rep.mig = q_mig;
+
+		for (size_t p = 0 ; p < nn_prcs<dim,T>::getNNProcessors() ; p++)
+		{
+			for (size_t i = 0 ; i < ie_ghost<dim,T,Memory,layout_base>::getProcessorNEGhost(p) ; i++)
+			{rep.ghost_vol += ie_ghost<dim,T,Memory,layout_base>::getProcessorEGhostBox(p,i).getVolume();}
+		}
+
+		for (size_t k = 0 ; k < q_owned.size() ; k++)
+		{
+			size_t i = q_owned.get(k);
+
+			for (size_t e = 0 ; e < dist.getNSubSubDomainNeighbors(i) ; e++)
+			{
+				if (g.template vertex_p<nm_v::proc_id>(dist.getSubSubDomainNeighbor(i,e)) != p_id)
+				{rep.edge_cut++;}
+			}
+		}
+
+		// sums
+		double sm[6] = {(double)rep.load,(double)rep.n_ssd,rep.ghost_vol,(double)rep.n_sub,(double)rep.edge_cut,(double)rep.mig};
+
+		// maximums (the minimums as maximum of the opposite)
+		double mx[7] = {(double)rep.load,(double)rep.n_ssd,rep.ghost_vol,(double)rep.n_nn,(double)rep.n_sub,-(double)rep.load,-(double)rep.n_ssd};
+
+		for (size_t i = 0 ; i < 6 ; i++)
+		{v_cl.sum(sm[i]);}
+
+		for (size_t i = 0 ; i < 7 ; i++)
+		{v_cl.max(mx[i]);}
+
+		v_cl.execute();
+
+		size_t np = v_cl.getProcessingUnits();
+
+		// without computation costs the load is the number of sub-sub-domains
+		if (sm[0] == 0)
+		{
+			rep.load = rep.n_ssd;
+			sm[0] = sm[1];
+			mx[0] = mx[1];
+			mx[5] = mx[6];
+		}
+
+		rep.load_max = mx[0];
+		rep.load_min = -mx[5];
+		rep.load_avg = sm[0] / np;
+		rep.imbalance = (rep.load_avg == 0)?1.0:rep.load_max / rep.load_avg;
+		rep.ghost_vol_tot = sm[2];
+		rep.ghost_vol_max = mx[2];
+		rep.n_nn_max = mx[3];
+		rep.n_sub_tot = sm[3];
+		rep.n_sub_max = mx[4];
+		rep.edge_cut_tot = sm[4] / 2;
+		rep.mig_tot = sm[5];
+
+		return rep;
+	}
+
+	/*! \brief Use measured communication and migration costs in the next decomposition
+	 *
+	 * Instead of the geometric model the edge between two sub-sub-domains get the bytes that
+	 * cross the shared face (the ghost traffic if the face is cut) and every sub-sub-domain the
+	 * bytes to migrate it. Every processor pass its own contribution only for the sub-sub-domains
+	 * it measured, each contribution is sent to the processor that own the sub-sub-domain and to the
+	 * owners of its neighborhood, where the contributions are summed. When the graph is decomposed
+	 * on processor 0 (MetisDistribution) every contribution is sent also to processor 0
+	 * (see vector_dist::measureCommunicationAndMigrationCosts)
+	 *
+	 * \warning it is a collective call
+	 *
+	 * \param cost measured costs of the sub-sub-domains (one entry for each sub-sub-domain)
+	 *
+	 */
+	void setMeasuredCosts(const openfpm::vector<meas_cost_type> & cost)
+	{
+		auto & g = dist.getGraph();
+
+		std::unordered_map<size_t,size_t> prc_id;
+		openfpm::vector<size_t> prc;
+		openfpm::vector<openfpm::vector<meas_cost_type>> send;
+
+		// entries this processor need
+		openfpm::vector<meas_cost_type> recv;
+
+		// processors that need the entry
+		openfpm::vector<size_t> dst;
+
+		for (size_t i = 0 ; i < cost.size() ; i++)
+		{
+			size_t id = cost.template get<0>(i);
+
+			if (id >= gr_dist.size())
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " error the measured sub-sub-domain " << id << " does not exist, there are " << gr_dist.size() << " sub-sub-domains" << std::endl;
+				continue;
+			}
+
+			dst.clear();
+			dst.add(g.template vertex_p<nm_v::proc_id>(id));
+
+			for (size_t s = 0 ; s < dist.getNSubSubDomainNeighbors(id) ; s++)
+			{
+				size_t p = g.template vertex_p<nm_v::proc_id>(dist.getSubSubDomainNeighbor(id,s));
+
+				bool found = false;
+				for (size_t k = 0 ; k < dst.size() ; k++)
+				{found |= (dst.get(k) == p);}
+
+				if (found == false)
+				{dst.add(p);}
+			}
+
+			if (is_master_decompose<Distribution>::value == true)
+			{
+				bool found = false;
+				for (size_t k = 0 ; k < dst.size() ; k++)
+				{found |= (dst.get(k) == 0);}
+
+				if (found == false)
+				{dst.add(0);}
+			}
+
+			for (size_t k = 0 ; k < dst.size() ; k++)
+			{
+				if (dst.get(k) == v_cl.rank())
+				{
+					recv.add();
+					recv.last().set(cost.get(i));
+					continue;
+				}
+
+				auto it = prc_id.find(dst.get(k));
+				if (it == prc_id.end())
+				{
+					prc_id[dst.get(k)] = prc.size();
+					prc.add(dst.get(k));
+					send.add();
+					it = prc_id.find(dst.get(k));
+				}
+
+				send.get(it->second).add();
+				send.get(it->second).last().set(cost.get(i));
+			}
+		}
+
+		openfpm::vector<size_t> prc_recv;
+		openfpm::vector<size_t> sz_recv;
+
+		// the received entries are appended after the local ones
+		v_cl.SSendRecv(send,recv,prc,prc_recv,sz_recv);
+
+		// sum the contributions
+		std::unordered_map<size_t,size_t> m_id;
+		meas_cost.clear();
+
+		for (size_t i = 0 ; i < recv.size() ; i++)
+		{
+			size_t id = recv.template get<0>(i);
+
+			auto it = m_id.find(id);
+			if (it == m_id.end())
+			{
+				m_id[id] = meas_cost.size();
+				meas_cost.add();
+				meas_cost.last().set(recv.get(i));
+				continue;
+			}
+
+			meas_cost.template get<1>(it->second) += recv.template get<1>(i);
+
+			for (size_t f = 0 ; f < 2*dim ; f++)
+			{meas_cost.template get<2>(it->second)[f] += recv.template get<2>(i)[f];}
+		}
+
+		meas_set = true;
+
+		// recompute the costs at the next decomposition
+		commCostSet = false;
+	}
+
+	/*! \brief Go back to the geometric communication and migration costs
+	 *
+	 */
+	void clearMeasuredCosts()
+	{
+		meas_cost.clear();
+		meas_set = false;
+		commCostSet = false;
+	}
+
+	/*! \brief Given a point return in which processor the particle should go, if it can be
+	 *         resolved with the stored sub-domains
+	 *
+	 * \param p point (inside the domain)
+	 *
+	 * \return the processor id or -1 if the point is not in the stored sub-domains
+	 *
+	 */
+	long int processorIDLocal(const Point<dim,T> & p) const
+	{
+		size_t cl = fine_s.getCell(p);
+		size_t n_ele = fine_s.getNelements(cl);
+
+		for (size_t i = 0 ; i < n_ele ; i++)
+		{
+			size_t e = fine_s.get(cl,i);
+
+			if (sub_domains_global.template get<0>(e).isInsideNP_with_border(p,domain,bc) == true)
+			{return sub_domains_global.template get<1>(e);}
+		}
+
+		return -1;
+	}
+
+	/*! \brief Given a set of points return in which processor they should go, using the distributed directory
+	 *
+	 * The queries are batched, one message for each processor storing part of the directory
+	 *
+	 * \warning it is collective
+	 *
+	 * \param pts points (inside the domain)
+	 * \param prc for each point the processor id
+	 *
+	 */
+	void processorIDRemote(const openfpm::vector<Point<dim,T>> & pts, openfpm::vector<size_t> & prc)
+	{
+		prc.resize(pts.size());
+
+		std::unordered_map<size_t,size_t> dst_id;
+		openfpm::vector<size_t> prc_send;
+		openfpm::vector<openfpm::vector<size_t>> q_send;
+		openfpm::vector<openfpm::vector<size_t>> q_pts;
+
+		for (size_t i = 0 ; i < pts.size() ; i++)
+		{
+			size_t lin = dirCell(pts.get(i));
+			size_t dst = lin / dir_blk;
+
+			if (dst == v_cl.rank())
+			{
+				prc.get(i) = dir_owner.get(lin - dir_start);
+				continue;
+			}
+
+			auto it = dst_id.find(dst);
+			if (it == dst_id.end())
+			{
+				dst_id[dst] = prc_send.size();
+				prc_send.add(dst);
+				q_send.add();
+				q_pts.add();
+				it = dst_id.find(dst);
+			}
+
+			q_send.get(it->second).add(lin);
+			q_pts.get(it->second).add(i);
+		}
+
+		// send the queries
+		openfpm::vector<size_t> q_recv;
+		openfpm::vector<size_t> prc_recv;
+		openfpm::vector<size_t> sz_recv;
+
+		v_cl.SSendRecv(q_send,q_recv,prc_send,prc_recv,sz_recv);
+
+		// answer
+		openfpm::vector<openfpm::vector<size_t>> r_send(prc_recv.size());
+
+		size_t off = 0;
+		for (size_t i = 0 ; i < prc_recv.size() ; i++)
+		{
+			r_send.get(i).resize(sz_recv.get(i));
+
+			for (size_t j = 0 ; j < sz_recv.get(i) ; j++)
+			{r_send.get(i).get(j) = dir_owner.get(q_recv.get(off + j) - dir_start);}
+
+			off += sz_recv.get(i);
+		}
+
+		openfpm::vector<size_t> r_recv;
+		openfpm::vector<size_t> prc_back;
+		openfpm::vector<size_t> sz_back;
+
+		v_cl.SSendRecv(r_send,r_recv,prc_recv,prc_back,sz_back);
+
+		// the answers come in the order of the queries
+		off = 0;
+		for (size_t i = 0 ; i < prc_back.size() ; i++)
+		{
+			auto it = dst_id.find(prc_back.get(i));
+
+			if (it != dst_id.end())
+			{
+				for (size_t j = 0 ; j < sz_back.get(i) ; j++)
+				{prc.get(q_pts.get(it->second).get(j)) = r_recv.get(off + j);}
+			}
+
+			off += sz_back.get(i);
+		}
+	}
+
+	/*! \brief processorID with the distributed directory, only the points in the local and
+	 *         neighborhood sub-domains can be resolved
+	 *
+	 * \param p point
+	 *
+	 * \return the processor id, -1 (with an error) if the point cannot be resolved
+	 *
+	 */
+	size_t processorID_dir(const Point<dim,T> & p) const
+	{
+		long int id = processorIDLocal(p);
+
+		if (id == -1)
+		{std::cerr << __FILE__ << ":" << __LINE__ << " error with the distributed directory processorID can resolve only points in the local and neighborhood sub-domains, use processorIDRemote" << std::endl;}
+
+		return id;
+	}
+
+	/*! \brief Given a point return in which processor the particle should go
+	 *
+	 * \param p point
+	 *
+	 * \return processorID
+	 *
+	 */
+	template<typename Mem> size_t inline processorID(const encapc<1, Point<dim,T>, Mem> & p) const
+	{
+		if (dir_mode == true)
+		{return processorID_dir(p);}
+
+		return processorID_impl(p,fine_s,sub_domains_global,getDomain(),bc);
+	}
+
+	/*! \brief Given a point return in which processor the particle should go
+	 *
+	 * \param p point
+	 *
+	 * \return processorID
+	 *
+	 */
+	size_t inline processorID(const Point<dim,T> &p) const
+	{
+		if (dir_mode == true)
+		{return processorID_dir(p);}
+
+		return processorID_impl(p,fine_s,sub_domains_global,getDomain(),bc);
+	}
+
+	/*! \brief Given a point return in which processor the particle should go
+	 *
+	 * \param p point
+	 *
+	 * \return processorID
+	 *
+	 */
+	size_t inline processorID(const T (&p)[dim]) const
+	{
+		if (dir_mode == true)
+		{return processorID_dir(p);}
+
+		return processorID_impl(p,fine_s,sub_domains_global,getDomain(),bc);
+	}
+
+	/*! \brief Given a point return in which processor the point/particle should go
+	 *
+	 * Boundary conditions are considered
+	 *
+	 * \param p point
+	 *
+	 * \return processorID
+	 *
+	 */
+	template<typename Mem> size_t inline processorIDBC(encapc<1, Point<dim,T>, Mem> p)
 	{
 		Point<dim,T> pt = p;
 		applyPointBC(pt);
 
+		if (dir_mode == true)
+		{return processorID_dir(pt);}
 
 		return processorID_impl(pt,fine_s,sub_domains_global,getDomain(),bc);
 	}
@@ -1129,6 +2102,9 @@ public:
 
 		// Get the number of elements in the cell
 
+		if (dir_mode == true)
+		{return processorID_dir(pt);}
+
 		return processorID_impl(pt,fine_s,sub_domains_global,getDomain(),bc);
 	}
 
@@ -1146,6 +2122,9 @@ public:
 		Point<dim,T> pt = p;
 		applyPointBC(pt);
 
+		if (dir_mode == true)
+		{return processorID_dir(pt);}
+
 		return processorID_impl(pt,fine_s,sub_domains_global,getDomain(),bc);
 	}
 
@@ -1334,6 +2313,11 @@ public:
 	 */
 	void decompose()
 	{
+		prof_region prof_t(PROF_DECOMPOSE,PROF_TOTAL);
+
+		// the moves of diffuse must be known by all processors
+		diffuse_sync();
+
 		reset();
 
 		if (commCostSet == false)
@@ -1356,6 +2340,11 @@ public:
 	 */
 	void refine(size_t ts)
 	{
+		prof_region prof_t(PROF_DECOMPOSE,PROF_TOTAL);
+
+		// the moves of diffuse must be known by all processors
+		diffuse_sync();
+
 		reset();
 
 		if (commCostSet == false)
@@ -1378,6 +2367,11 @@ public:
 	 */
 	void redecompose(size_t ts)
 	{
+		prof_region prof_t(PROF_DECOMPOSE,PROF_TOTAL);
+
+		// the moves of diffuse must be known by all processors
+		diffuse_sync();
+
 		reset();
 
 		if (commCostSet == false)
@@ -1393,7 +2387,85 @@ public:
 		domain_nn_calculator_cart<dim>::setParameters(proc_box);
 	}
 
+	/*! \brief Start an asynchronous re-decomposition, available only for Metis distribution
+	 *
+	 * The computational costs are taken now, the new decomposition is computed in background
+	 * and the current one stay valid (the simulation can continue) until redecompose_commit()
+	 *
+	 * \warning it is a collective call
+	 *
+	 * \param ts number of time step from the previous load balancing
+	 *
+	 */
+	void redecompose_async(size_t ts)
+	{
+		prof_region prof_t(PROF_DECOMPOSE,PROF_TOTAL);
+
+		// the moves of diffuse must be known by all processors
+		diffuse_sync();
+
+		if (commCostSet == false)
+		{computeCommunicationAndMigrationCosts(ts);}
+
+		dist.decompose_async();
+	}
+
+	/*! \brief Switch to the decomposition started with redecompose_async()
+	 *
+	 * After the call the particles must be redistributed (map)
+	 *
+	 * \warning it is a collective call
+	 *
+	 * \return false if there was no asynchronous re-decomposition to commit (nothing change)
+	 *
+	 */
+	bool redecompose_commit()
+	{
+		prof_region prof_t(PROF_DECOMPOSE,PROF_TOTAL);
+
+		if (dist.isDecomposeAsyncRunning() == false)
+		{return false;}
+
+		reset();
+
+		dist.decompose_commit();
+
+		createSubdomains(v_cl,bc);
+
+		calculateGhostBoxes();
+
+		domain_nn_calculator_cart<dim>::reset();
+		domain_nn_calculator_cart<dim>::setParameters(proc_box);
+
+		return true;
+	}
+
+	/*! \brief Replace the computational costs of the sub-sub-domains of this processor with the ones predicted by dlb
+	 *
+	 * The costs must be set again before each call (as vector_dist::addComputationCosts does)
+	 *
+	 * \param dlb Dynamic load balancing object
+	 *
+	 */
+	void predictComputationCosts(DLB & dlb)
+	{
+		if (dlb.getPredictor() == DLB::Predictor::LAST_VALUE)
+		{return;}
+
+		dlb.beginCostUpdate();
+
+		for (size_t k = 0 ; k < q_owned.size() ; k++)
+		{
+			size_t i = q_owned.get(k);
+			dist.setComputationCost(i,dlb.addSubSubDomainCost(i,dist.getSubSubDomainComputationCost(i)));
+		}
+
+		dlb.endCostUpdate();
+	}
+
 	/*! \brief Refine the decomposition, available only for ParMetis distribution, for Metis it is a null call
+	 *
+	 * If dlb has a predictor the decision and the partition use the predicted computational costs
 	 *
 	 * \param dlb Dynamic load balancing object
 	 *
@@ -1401,6 +2473,8 @@ public:
 	 */
 	bool refine(DLB & dlb)
 	{
+		predictComputationCosts(dlb);
+
 		// if the DLB heuristic to use is the "Unbalance Threshold" get unbalance percentage
 		if (dlb.getHeurisitc() == DLB::Heuristic::UNBALANCE_THRLD)
 		{
@@ -1421,6 +2495,274 @@ public:
 		return false;
 	}
 
+	/*! \brief Incremental (diffusive) load balancing, without a global re-partition
+	 *
+	 * Every processor exchange its load only with the neighborhood processors and hand to each
+	 * lighter neighbor at most the first order diffusion flow (L_p - L_q) / (max(deg_p,deg_q) + 1), moving
+	 * the sub-sub-domains on the border with it (one layer for each call, at least one sub-sub-domain
+	 * stay). The maximum load therefore never increase. The moved sub-sub-domains are sent only to the
+	 * neighborhood processors (the other processors get them before the next global decomposition, see
+	 * diffuse_sync), then the sub-domains are optimized and the ghost boxes recomputed. It is much cheaper
+	 * than refine and can be called every few tens of time-steps, a big imbalance is removed in several calls
+	 *
+	 * \warning it is a collective call
+	 *
+	 * \return true if the decomposition changed (the particles must be redistributed with map)
+	 *
+	 */
+	bool diffuse()
+	{
+		prof_region prof_t(PROF_DECOMPOSE,PROF_TOTAL);
+
+		size_t p_id = v_cl.getProcessUnitID();
+		auto & g = dist.getGraph();
+
+		// computational cost of the sub-sub-domains of this processor (unit cost if not set)
+		openfpm::vector<size_t> w_own(q_owned.size());
+		size_t load = 0;
+
+		for (size_t k = 0 ; k < q_owned.size() ; k++)
+		{
+			w_own.get(k) = std::max((size_t)1,dist.getSubSubDomainComputationCost(q_owned.get(k)));
+			load += w_own.get(k);
+		}
+
+		// exchange load and degree with the neighborhood processors
+		openfpm::vector<size_t> prc_send;
+
+		for (size_t i = 0 ; i < nn_prcs<dim,T>::getNNProcessors() ; i++)
+		{
+			size_t prc = nn_prcs<dim,T>::IDtoProc(i);
+
+			if (prc != p_id)
+			{prc_send.add(prc);}
+		}
+
+		openfpm::vector<openfpm::vector<size_t>> l_send(prc_send.size());
+
+		for (size_t i = 0 ; i < prc_send.size() ; i++)
+		{
+			l_send.get(i).add(load);
+			l_send.get(i).add(prc_send.size());
+		}
+
+		openfpm::vector<size_t> l_recv;
+		openfpm::vector<size_t> prc_recv;
+		openfpm::vector<size_t> sz_recv;
+
+		v_cl.SSendRecv(l_send,l_recv,prc_send,prc_recv,sz_recv);
+
+		// lighter neighbors, the lightest first
+		struct dif_target
+		{
+			//! load of the neighbor
+			size_t load;
+
+			//! neighbor processor
+			size_t prc;
+
+			//! load to hand
+			size_t flow;
+
+			//! load handed
+			size_t acc;
+
+			//! lightest first
+			bool operator<(const dif_target & t) const
+			{
+				if (load != t.load)	{return load < t.load;}
+				return prc < t.prc;
+			}
+		};
+
+		std::vector<dif_target> tg;
+
+		size_t off = 0;
+		for (size_t i = 0 ; i < prc_recv.size() ; i++)
+		{
+			size_t l_q = l_recv.get(off);
+			size_t deg = std::max(prc_send.size(),l_recv.get(off + 1));
+			off += sz_recv.get(i);
+
+			if (l_q >= load)
+			{continue;}
+
+			dif_target t;
+			t.load = l_q;
+			t.prc = prc_recv.get(i);
+			t.flow = (load - l_q) / (deg + 1);
+			t.acc = 0;
+			tg.push_back(t);
+		}
+
+		std::sort(tg.begin(),tg.end());
+
+		// move the border sub-sub-domains
+		openfpm::vector<dif_move> mv;
+		std::vector<bool> moved(q_owned.size(),false);
+
+		for (size_t t = 0 ; t < tg.size() ; t++)
+		{
+			for (size_t k = 0 ; k < q_owned.size() && mv.size() + 1 < q_owned.size() ; k++)
+			{
+				size_t i = q_owned.get(k);
+				size_t w = w_own.get(k);
+
+				if (moved[k] == true)
+				{continue;}
+
+				// never hand more than the flow, so that the receiver stay lighter than the sender
+				if (tg[t].acc + w > tg[t].flow)
+				{continue;}
+
+				bool border = false;
+				for (size_t e = 0 ; e < dist.getNSubSubDomainNeighbors(i) ; e++)
+				{
+					if ((size_t)g.template vertex_p<nm_v::proc_id>(dist.getSubSubDomainNeighbor(i,e)) == tg[t].prc)
+					{border = true; break;}
+				}
+
+				if (border == false)
+				{continue;}
+
+				moved[k] = true;
+				tg[t].acc += w;
+
+				mv.add();
+				mv.last().id = i;
+				mv.last().dst_proc = tg[t].prc;
+				mv.last().step = dif_step;
+			}
+		}
+
+		dif_step++;
+
+		// the decomposition change if any processor move something
+		size_t n_mv = mv.size();
+		v_cl.sum(n_mv);
+		v_cl.execute();
+
+		if (n_mv == 0)
+		{return false;}
+
+		// the processors that own the sub-sub-domains adjacent to a moved one are neighborhood
+		// processors of the sender, the moves are sent only to them (see diffuse_sync for the others)
+		openfpm::vector<size_t> prc_mv;
+		openfpm::vector<openfpm::vector<dif_move>> mv_send;
+
+		if (mv.size() != 0)
+		{
+			for (size_t i = 0 ; i < prc_send.size() ; i++)
+			{
+				prc_mv.add(prc_send.get(i));
+				mv_send.add(mv);
+			}
+		}
+
+		openfpm::vector<dif_move> mv_all;
+		openfpm::vector<size_t> prc_mv_recv;
+		openfpm::vector<size_t> sz_mv_recv;
+
+		v_cl.SSendRecv(mv_send,mv_all,prc_mv,prc_mv_recv,sz_mv_recv);
+
+		for (size_t i = 0 ; i < mv.size() ; i++)
+		{
+			mv_all.add(mv.get(i));
+			dif_mv.add(mv.get(i));
+		}
+
+		for (size_t i = 0 ; i < mv_all.size() ; i++)
+		{g.template vertex_p<nm_v::proc_id>(mv_all.get(i).id) = mv_all.get(i).dst_proc;}
+
+		dist.updateOwners();
+
+		reset();
+
+		createSubdomains(v_cl,bc);
+
+		calculateGhostBoxes();
+
+		domain_nn_calculator_cart<dim>::reset();
+		domain_nn_calculator_cart<dim>::setParameters(proc_box);
+
+		return true;
+	}
+
+	/*! \brief Propagate to all the processors the sub-sub-domains moved by diffuse
+	 *
+	 * diffuse send the moves only to the neighborhood processors, the replicated graph of the other
+	 * processors is therefore not updated far from them. Before a global decomposition every processor
+	 * send the moves it did to all the others, and the moves are applied in the order of the diffuse calls
+	 *
+	 * \warning it is a collective call
+	 *
+	 */
+	void diffuse_sync()
+	{
+		// diffuse is collective, dif_step is the same on all processors
+		if (dif_step == dif_step_sync)
+		{return;}
+
+		auto & g = dist.getGraph();
+		size_t p_id = v_cl.getProcessUnitID();
+
+		openfpm::vector<size_t> prc;
+		openfpm::vector<openfpm::vector<dif_move>> send;
+
+		if (dif_mv.size() != 0)
+		{
+			for (size_t i = 0 ; i < v_cl.getProcessingUnits() ; i++)
+			{
+				if (i == p_id)
+				{continue;}
+
+				prc.add(i);
+				send.add(dif_mv);
+			}
+		}
+
+		openfpm::vector<dif_move> recv;
+		openfpm::vector<size_t> prc_recv;
+		openfpm::vector<size_t> sz_recv;
+
+		v_cl.SSendRecv(send,recv,prc,prc_recv,sz_recv);
+
+		for (size_t i = 0 ; i < dif_mv.size() ; i++)
+		{recv.add(dif_mv.get(i));}
+
+		// in one diffuse call a sub-sub-domain is moved only by its owner
+		std::vector<dif_move> all(recv.size());
+		for (size_t i = 0 ; i < recv.size() ; i++)
+		{all[i] = recv.get(i);}
+
+		std::stable_sort(all.begin(),all.end(),[](const dif_move & a, const dif_move & b){return a.step < b.step;});
+
+		for (size_t i = 0 ; i < all.size() ; i++)
+		{g.template vertex_p<nm_v::proc_id>(all[i].id) = all[i].dst_proc;}
+
+		dif_mv.clear();
+		dif_step_sync = dif_step;
+	}
+
+	/*! \brief Incremental (diffusive) load balancing driven by the DLB heuristic (see diffuse())
+	 *
+	 * \param dlb Dynamic load balancing object
+	 *
+	 * \return true if the decomposition changed, false otherwise
+	 */
+	bool diffuse(DLB & dlb)
+	{
+		predictComputationCosts(dlb);
+
+		if (dlb.getHeurisitc() == DLB::Heuristic::UNBALANCE_THRLD)
+		{dlb.setUnbalance(dist.getUnbalance());}
+
+		if (dlb.rebalanceNeeded())
+		{return diffuse();}
+
+		return false;
+	}
+
 //	size_t n_step = 0;
 
 	/*! \brief Get the current un-balance value
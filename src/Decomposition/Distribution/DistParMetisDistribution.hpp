@@ -331,6 +331,19 @@ public:
 		return g.getNChilds(id);
 	}
 
+	/*! \brief Returns the e-th neighbor of the sub-sub-domain id
+	 *
+	 * \param id id of the sub-sub-domain
+	 * \param e id in the neighborhood list
+	 *
+	 * \return the id of the neighborhood sub-sub-domain
+	 *
+	 */
+	size_t getSubSubDomainNeighbor(size_t id, size_t e)
+	{
+		return g.getChild(id,e);
+	}
+
 	/*! \brief Print current graph and save it to file
 	 *
 	 * \param file file
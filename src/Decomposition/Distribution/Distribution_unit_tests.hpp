@@ -123,6 +123,9 @@ BOOST_AUTO_TEST_CASE( Metis_distribution_test)
 		met_dist.setCommunicationCost(i,j,1);
 	}
 
+	// the reference data has been produced with the original metis labels
+	met_dist.setRemapLabels(false);
+
 	met_dist.decompose();
 
 	BOOST_REQUIRE_EQUAL(met_dist.get_ndec(),2ul);
@@ -178,6 +181,282 @@ BOOST_AUTO_TEST_CASE( Metis_distribution_test)
 //	BOOST_REQUIRE_EQUAL(sizeof(MetisDistribution<3,float>),720ul);
 }
 
+BOOST_AUTO_TEST_CASE( Metis_distribution_remap_test)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() != 3)
+	return;
+
+	MetisDistribution<3, float> met_dist(v_cl);
+
+	size_t sz[3] = { GS_SIZE, GS_SIZE, GS_SIZE };
+	Box<3, float> box( { 0.0, 0.0, 0.0 }, { 1.0, 1.0, 1.0 });
+	grid_sm<3, void> info(sz);
+
+	met_dist.onTest();
+	met_dist.createCartGraph(info,box);
+	met_dist.decompose();
+
+	// the first decomposition does not migrate anything
+	BOOST_REQUIRE_EQUAL(met_dist.getPredictedMigration(),0ul);
+
+	// move the load on one corner and re-decompose
+
+	for (size_t k = 0; k < met_dist.getNOwnerSubSubDomains(); k++)
+	{
+		size_t i = met_dist.getOwnerSubSubDomain(k);
+
+		if (i < GS_SIZE * GS_SIZE)
+			met_dist.setComputationCost(i,4);
+		else
+			met_dist.setComputationCost(i,1);
+	}
+
+	met_dist.decompose();
+
+	BOOST_REQUIRE(met_dist.getPredictedMigration() <= met_dist.getPredictedMigrationNoRemap());
+
+	// the labels must be still a permutation
+
+	openfpm::vector<size_t> cnt(v_cl.getProcessingUnits());
+	for (size_t i = 0 ; i < cnt.size() ; i++)
+	{cnt.get(i) = 0;}
+
+	for (size_t i = 0 ; i < met_dist.getNSubSubDomains() ; i++)
+	{cnt.get(met_dist.getGraph().vertex_p<nm_v::proc_id>(i)) += 1;}
+
+	for (size_t i = 0 ; i < cnt.size() ; i++)
+	{BOOST_REQUIRE(cnt.get(i) != 0);}
+}
+
+BOOST_AUTO_TEST_CASE( Metis_distribution_async_test)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() != 3)
+	return;
+
+	MetisDistribution<3, float> met_dist(v_cl);
+	MetisDistribution<3, float> met_async(v_cl);
+
+	size_t sz[3] = { GS_SIZE, GS_SIZE, GS_SIZE };
+	Box<3, float> box( { 0.0, 0.0, 0.0 }, { 1.0, 1.0, 1.0 });
+	grid_sm<3, void> info(sz);
+
+	met_dist.onTest();
+	met_dist.createCartGraph(info,box);
+	met_dist.decompose();
+
+	met_async.onTest();
+	met_async.createCartGraph(info,box);
+	met_async.decompose();
+
+	for (size_t k = 0; k < met_dist.getNOwnerSubSubDomains(); k++)
+	{
+		size_t i = met_dist.getOwnerSubSubDomain(k);
+		met_dist.setComputationCost(i,(i < GS_SIZE * GS_SIZE)?4:1);
+	}
+
+	for (size_t k = 0; k < met_async.getNOwnerSubSubDomains(); k++)
+	{
+		size_t i = met_async.getOwnerSubSubDomain(k);
+		met_async.setComputationCost(i,(i < GS_SIZE * GS_SIZE)?4:1);
+	}
+
+	met_dist.decompose();
+	met_async.decompose_async();
+
+	BOOST_REQUIRE_EQUAL(met_async.isDecomposeAsyncRunning(),true);
+
+	// the weights set after the snapshot does not change the result
+	for (size_t k = 0; k < met_async.getNOwnerSubSubDomains(); k++)
+	{met_async.setComputationCost(met_async.getOwnerSubSubDomain(k),100);}
+
+	bool ret = met_async.decompose_commit();
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+	BOOST_REQUIRE_EQUAL(met_async.isDecomposeAsyncRunning(),false);
+	BOOST_REQUIRE_EQUAL(met_async.get_ndec(),met_dist.get_ndec());
+
+	for (size_t i = 0 ; i < met_dist.getNSubSubDomains() ; i++)
+	{BOOST_REQUIRE_EQUAL(met_async.getGraph().vertex_p<nm_v::proc_id>(i),met_dist.getGraph().vertex_p<nm_v::proc_id>(i));}
+
+	BOOST_REQUIRE_EQUAL(met_async.getNOwnerSubSubDomains(),met_dist.getNOwnerSubSubDomains());
+
+	// nothing to commit
+	ret = met_async.decompose_commit();
+	BOOST_REQUIRE_EQUAL(ret,false);
+
+	// overwriting a distribution with a running decomposition wait and discard it
+	met_async.decompose_async();
+	met_async = met_dist;
+
+	BOOST_REQUIRE_EQUAL(met_async.isDecomposeAsyncRunning(),false);
+	BOOST_REQUIRE_EQUAL(met_async.decompose_commit(),false);
+}
+
+BOOST_AUTO_TEST_CASE( Metis_distribution_implicit_graph_test)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() != 3)
+	return;
+
+	MetisDistribution<3, float> met_dist(v_cl);
+	MetisDistribution<3, float> met_imp(v_cl);
+
+	size_t sz[3] = { GS_SIZE, GS_SIZE, GS_SIZE };
+	Box<3, float> box( { 0.0, 0.0, 0.0 }, { 1.0, 1.0, 1.0 });
+	grid_sm<3, void> info(sz);
+
+	met_dist.onTest();
+	met_dist.createCartGraph(info,box);
+
+	met_imp.onTest();
+	met_imp.setImplicitGraph(true);
+	met_imp.setGraphThreads(4);
+	met_imp.createCartGraph(info,box);
+
+	BOOST_REQUIRE_EQUAL(met_imp.isImplicitGraph(),true);
+	BOOST_REQUIRE_EQUAL(met_imp.getNSubSubDomains(),met_dist.getNSubSubDomains());
+
+	// the implicit graph has the same vertices and the same neighborhood
+	for (size_t i = 0 ; i < met_dist.getNSubSubDomains() ; i++)
+	{
+		float p1[3];
+		float p2[3];
+		met_dist.getSSDomainPos(i,p1);
+		met_imp.getSSDomainPos(i,p2);
+
+		for (size_t d = 0 ; d < 3 ; d++)
+		{BOOST_REQUIRE_CLOSE(p1[d],p2[d],0.0001);}
+
+		BOOST_REQUIRE_EQUAL(met_imp.getGraph().vertex_p<nm_v::global_id>(i),i);
+
+		size_t nn = met_dist.getNSubSubDomainNeighbors(i);
+		BOOST_REQUIRE_EQUAL(met_imp.getNSubSubDomainNeighbors(i),nn);
+
+		std::vector<size_t> n1;
+		std::vector<size_t> n2;
+
+		for (size_t e = 0 ; e < nn ; e++)
+		{
+			n1.push_back(met_dist.getSubSubDomainNeighbor(i,e));
+			n2.push_back(met_imp.getSubSubDomainNeighbor(i,e));
+		}
+
+		std::sort(n1.begin(),n1.end());
+		std::sort(n2.begin(),n2.end());
+
+		for (size_t e = 0 ; e < nn ; e++)
+		{BOOST_REQUIRE_EQUAL(n1[e],n2[e]);}
+	}
+
+	// decompose with different communication costs on the edges
+	met_imp.decompose();
+
+	for (size_t i = 0 ; i < met_imp.getNSubSubDomains() ; i++)
+	{
+		for (size_t e = 0 ; e < met_imp.getNSubSubDomainNeighbors(i) ; e++)
+		{
+			// the weight must be the same in both directions
+			size_t j = met_imp.getSubSubDomainNeighbor(i,e);
+			met_imp.setCommunicationCost(i,e,(i < GS_SIZE*GS_SIZE || j < GS_SIZE*GS_SIZE)?8:1);
+		}
+	}
+
+	// metis require a symmetric adjwgt
+	for (size_t i = 0 ; i < met_imp.getNSubSubDomains() ; i++)
+	{
+		for (size_t e = 0 ; e < met_imp.getNSubSubDomainNeighbors(i) ; e++)
+		{
+			size_t j = met_imp.getSubSubDomainNeighbor(i,e);
+
+			for (size_t t = 0 ; t < met_imp.getNSubSubDomainNeighbors(j) ; t++)
+			{
+				if (met_imp.getSubSubDomainNeighbor(j,t) == i)
+				{BOOST_REQUIRE_EQUAL(met_imp.getSubSubDomainCommunicationCost(i,e),met_imp.getSubSubDomainCommunicationCost(j,t));}
+			}
+		}
+	}
+
+	met_imp.decompose();
+
+	BOOST_REQUIRE_EQUAL(met_imp.get_ndec(),2ul);
+	BOOST_REQUIRE(met_imp.getUnbalance() < 0.03);
+
+	size_t n_own = met_imp.getNOwnerSubSubDomains();
+	v_cl.sum(n_own);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(n_own,met_imp.getNSubSubDomains());
+}
+
+BOOST_AUTO_TEST_CASE( CartesianGraphImplicit_periodic_test)
+{
+	// periodic directions with one and two sub-sub-domains
+	size_t sz[3] = {1,2,5};
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+	Box<3, float> box( { 0.0, 0.0, 0.0 }, { 1.0, 1.0, 1.0 });
+	grid_sm<3, void> info(sz);
+
+	Graph_CSR<nm_v, nm_e> gp_imp;
+	Graph_CSR<nm_v, nm_e> gp_mat;
+
+	CartesianGraphImplicit<3,Graph_CSR<nm_v, nm_e>> g_imp;
+	CartesianGraphImplicit<3,Graph_CSR<nm_v, nm_e>> g_mat;
+
+	g_imp.setGraph(gp_imp);
+	g_imp.setup(info,bc,true);
+	g_imp.createVertices(box);
+
+	g_mat.setGraph(gp_mat);
+	g_mat.setup(info,bc,false);
+	g_mat.setNThreads(3);
+	g_mat.createGraph(box);
+
+	size_t ne = 0;
+
+	for (size_t i = 0 ; i < g_imp.getNVertex() ; i++)
+	{
+		// no self edges and no duplicated edges: one neighborhood in y and two in z
+		BOOST_REQUIRE_EQUAL(g_imp.getNChilds(i),3ul);
+		BOOST_REQUIRE_EQUAL(g_mat.getNChilds(i),3ul);
+
+		for (size_t e = 0 ; e < g_imp.getNChilds(i) ; e++)
+		{
+			BOOST_REQUIRE(g_imp.getChild(i,e) != i);
+			BOOST_REQUIRE_EQUAL(g_imp.getChild(i,e),g_mat.getChild(i,e));
+
+			for (size_t f = 0 ; f < e ; f++)
+			{BOOST_REQUIRE(g_imp.getChild(i,e) != g_imp.getChild(i,f));}
+		}
+
+		ne += g_imp.getNChilds(i);
+	}
+
+	BOOST_REQUIRE_EQUAL(g_imp.getNEdge(),ne);
+	BOOST_REQUIRE_EQUAL(g_mat.getNEdge(),ne);
+
+	// a weight on one edge does not change the others
+	g_imp.setAllEdges(1);
+	g_imp.setChildEdge(0,1,7);
+
+	BOOST_REQUIRE_EQUAL(g_imp.hasEdgeWeights(),true);
+
+	for (size_t i = 0 ; i < g_imp.getNVertex() ; i++)
+	{
+		for (size_t e = 0 ; e < g_imp.getNChilds(i) ; e++)
+		{BOOST_REQUIRE_EQUAL(g_imp.getChildEdge(i,e).get<nm_e::communication>(),(i == 0 && e == 1)?7ul:1ul);}
+	}
+
+	g_imp.setAllEdges(2);
+
+	BOOST_REQUIRE_EQUAL(g_imp.hasEdgeWeights(),false);
+	BOOST_REQUIRE_EQUAL(g_imp.getChildEdge(0,1).get<nm_e::communication>(),2ul);
+}
+
 BOOST_AUTO_TEST_CASE( Parmetis_distribution_test)
 {
 	Vcluster<> & v_cl = create_vcluster();
@@ -10,6 +10,10 @@
 
 #include "SubdomainGraphNodes.hpp"
 #include "metis_util.hpp"
+#include "partition_remap.hpp"
+#include "Graph/CartesianGraphImplicit.hpp"
+#include <thread>
+#include <functional>
 
 #define METIS_DISTRIBUTION_ERROR_OBJECT std::runtime_error("Metis runtime error");
 
@@ -55,11 +59,17 @@ class MetisDistribution
 	//! Global sub-sub-domain graph
 	Graph_CSR<nm_v, nm_e> gp;
 
+	//! Graph seen by metis, the edges are computed from the grid in implicit mode
+	CartesianGraphImplicit<dim,Graph_CSR<nm_v, nm_e>> gi;
+
+	//! if true the edges of the graph are not stored (see setImplicitGraph)
+	bool implicit_graph = false;
+
 	//! Flag that indicate if we are doing a test (In general it fix the seed)
 	bool testing = false;
 
 	//! Metis decomposer utility
-	Metis<Graph_CSR<nm_v, nm_e>> metis_graph;
+	Metis<CartesianGraphImplicit<dim,Graph_CSR<nm_v, nm_e>>> metis_graph;
 
 	//! unordered map that map global sub-sub-domain to owned_cost_sub id
 	std::unordered_map<size_t,size_t> owner_scs;
@@ -70,6 +80,150 @@ class MetisDistribution
 	//! received assignment
 	openfpm::vector<met_sub_w> recv_ass;
 
+	//! if true the labels of a new partition are permuted to minimize the migration
+	bool remap_labels = true;
+
+	//! predicted migration of the last decomposition (weight of the sub-sub-domains changing processor)
+	size_t mig_pred = 0;
+
+	//! predicted migration of the last decomposition without the labels permutation
+	size_t mig_pred_no_remap = 0;
+
+	/*! \brief Permute the processor labels produced by metis to maximize the overlap with the previous assignment
+	 *
+	 * \param old_p previous assignment
+	 *
+	 */
+	void remap_partition(const openfpm::vector<size_t> & old_p)
+	{
+		partition_remap rm(v_cl.getProcessingUnits());
+
+		for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+		{
+			size_t w = gp.template vertex_p<nm_v::computation>(i);
+			rm.add(old_p.get(i),gp.template vertex_p<nm_v::proc_id>(i),(w == 0)?1:w);
+		}
+
+		openfpm::vector<size_t> perm;
+		rm.compute(perm);
+
+		mig_pred_no_remap = rm.getMigrationNoRemap();
+
+		if (remap_labels == false)
+		{
+			mig_pred = mig_pred_no_remap;
+			return;
+		}
+
+		for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+		{gp.template vertex_p<nm_v::proc_id>(i) = perm.get(gp.template vertex_p<nm_v::proc_id>(i));}
+
+		mig_pred = rm.getMigration();
+	}
+
+	//! graph decomposed by the asynchronous decomposition (processor 0)
+	Graph_CSR<nm_v, nm_e> gp_async;
+
+	//! graph seen by metis in the asynchronous decomposition
+	CartesianGraphImplicit<dim,Graph_CSR<nm_v, nm_e>> gi_async;
+
+	//! weights snapshot of the asynchronous decomposition
+	openfpm::vector<met_sub_w> recv_async;
+
+	//! thread running the asynchronous decomposition (processor 0)
+	std::thread thr_async;
+
+	//! true if an asynchronous decomposition has been started and not committed
+	bool async_run = false;
+
+	/*! \brief Decompose a graph with metis
+	 *
+	 * \param g graph to decompose (the result is stored in proc_id)
+	 * \param np number of partitions
+	 * \param use_w use the computation weights
+	 * \param testing fix the seed
+	 *
+	 */
+	static void metis_decompose(CartesianGraphImplicit<dim,Graph_CSR<nm_v, nm_e>> & g, size_t np, bool use_w, bool testing)
+	{
+		Metis<CartesianGraphImplicit<dim,Graph_CSR<nm_v, nm_e>>> mt(g);
+		mt.setNThreads(g.getNThreads());
+		mt.initMetisGraph(np,use_w);
+		mt.onTest(testing);
+		mt.template decompose<nm_v::proc_id>();
+	}
+
+	/*! \brief Processor 0 has the new decomposition in gp, it fill recv_ass and remap the labels
+	 *
+	 * \param old_p previous assignment
+	 * \param has_prev true if old_p is valid
+	 *
+	 */
+	void set_assignment(const openfpm::vector<size_t> & old_p, bool has_prev)
+	{
+		if (has_prev == true)
+		{remap_partition(old_p);}
+		else
+		{mig_pred = mig_pred_no_remap = 0;}
+
+		if (recv_ass.size() != 0)
+		{
+			// we fill the assignment
+			for (size_t i = 0 ; i < recv_ass.size() ; i++)
+				recv_ass.get(i).w = gp.template vertex_p<nm_v::proc_id>(recv_ass.get(i).id);
+		}
+		else
+		{
+			recv_ass.resize(gp.getNVertex());
+
+			// we fill the assignment
+			for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+			{
+				recv_ass.get(i).id = i;
+				recv_ass.get(i).w = gp.template vertex_p<nm_v::proc_id>(i);
+			}
+		}
+	}
+
+	/*! \brief Broadcast the assignment of processor 0 and update the owned sub-sub-domains
+	 *
+	 */
+	void bcast_assignment()
+	{
+		recv_ass.resize(gp.getNVertex());
+
+		openfpm::vector<size_t> mig(2);
+		mig.get(0) = mig_pred;
+		mig.get(1) = mig_pred_no_remap;
+
+		// broad cast the result
+		v_cl.Bcast(recv_ass,0);
+		v_cl.Bcast(mig,0);
+		v_cl.execute();
+
+		mig_pred = mig.get(0);
+		mig_pred_no_remap = mig.get(1);
+		owner_scs.clear();
+		owner_cost_sub.clear();
+
+		size_t j = 0;
+
+		// Fill the metis graph
+		for (size_t i = 0 ; i < recv_ass.size() ; i++)
+		{
+			gp.template vertex_p<nm_v::proc_id>(recv_ass.get(i).id) = recv_ass.get(i).w;
+
+			if (recv_ass.get(i).w == v_cl.getProcessUnitID())
+			{
+				owner_scs[recv_ass.get(i).id] = j;
+				j++;
+				owner_cost_sub.add();
+				owner_cost_sub.last().id = recv_ass.get(i).id;
+				owner_cost_sub.last().w = 1;
+			}
+		}
+	}
+
 	/*! \brief Check that the sub-sub-domain id exist
 	 *
 	 * \param id sub-sub-domain id
@@ -94,9 +248,9 @@ class MetisDistribution
 	inline void check_overflowe(size_t id, size_t e)
 	{
 #ifdef SE_CLASS1
-		if (e >= gp.getNChilds(id))
+		if (e >= gi.getNChilds(id))
 		{
-			std::cerr << "Error " << __FILE__ ":" << __LINE__ << " for the sub-sub-domain " << id << " such neighborhood doesn't exist (e = " << e << ", " << "total size = " << gp.getNChilds(id) << ")\n";
+			std::cerr << "Error " << __FILE__ ":" << __LINE__ << " for the sub-sub-domain " << id << " such neighborhood doesn't exist (e = " << e << ", " << "total size = " << gi.getNChilds(id) << ")\n";
 			ACTION_ON_ERROR(METIS_DISTRIBUTION_ERROR_OBJECT)
 		}
 #endif
@@ -106,14 +260,18 @@ public:
 
 	static constexpr unsigned int computation = nm_v::computation;
 
+	//! the whole graph is decomposed on processor 0 (see is_master_decompose)
+	static constexpr bool master_decompose = true;
+
 	/*! \brief constructor
 	 *
 	 * \param v_cl vcluster
 	 *
 	 */
 	MetisDistribution(Vcluster<> & v_cl)
-	:v_cl(v_cl),metis_graph(gp)
+	:v_cl(v_cl),metis_graph(gi)
 	{
+		gi.setGraph(gp);
 #ifdef SE_CLASS2
 			check_new(this,8,VECTOR_EVENT,1);
 #endif
@@ -157,6 +315,8 @@ public:
 #ifdef SE_CLASS2
 		check_delete(this);
 #endif
+		if (thr_async.joinable())
+		{thr_async.join();}
 	}
 
 
@@ -181,24 +341,21 @@ public:
 		gr = grid;
 		domain = dom;
 
-		// Create a cartesian grid graph
-		CartesianGraphFactory<dim, Graph_CSR<nm_v, nm_e>> g_factory_part;
-		gp = g_factory_part.template construct<NO_EDGE, nm_v::id, T, dim - 1, 0>(gr.getSize(), domain, bc);
-
-		// Init to 0.0 axis z (to fix in graphFactory)
-		if (dim < 3)
-		{
-			for (size_t i = 0; i < gp.getNVertex(); i++)
-			{
-				gp.vertex(i).template get<nm_v::x>()[2] = 0.0;
-			}
-		}
+		gi.setGraph(gp);
+		gi.setup(gr,bc,implicit_graph);
 
-		for (size_t i = 0; i < gp.getNVertex(); i++)
-			gp.vertex(i).template get<nm_v::global_id>() = i;
+		// the vertices (and the edges) are created in parallel with setGraphThreads
+		if (implicit_graph == true)
+		{gi.createVertices(domain);}
+		else
+		{gi.createGraph(domain);}
 	}
 
 	/*! \brief Get the current graph (main)
+	 *
+	 * \warning with the implicit graph (setImplicitGraph) it store only the vertices, the neighborhood and
+	 *          the communication costs must be accessed with getNSubSubDomainNeighbors, getSubSubDomainNeighbor
+	 *          and getSubSubDomainCommunicationCost
 	 *
 	 * \return the current sub-sub domain Graph
 	 *
@@ -226,6 +383,8 @@ public:
 
 		if (v_cl.getProcessUnitID() == 0)
 		{
+			metis_graph.setNThreads(gi.getNThreads());
+
 			if (recv_ass.size() != 0)
 			{
 				// we fill the assignment
@@ -238,56 +397,146 @@ public:
 				metis_graph.initMetisGraph(v_cl.getProcessingUnits(),false);
 			metis_graph.onTest(testing);
 
-			// decompose
-			metis_graph.decompose<nm_v::proc_id>();
+			// previous assignment
+			bool has_prev = (metis_graph.get_ndec() != 0);
+			openfpm::vector<size_t> old_p;
 
-			if (recv_ass.size() != 0)
+			if (has_prev == true)
 			{
-				// we fill the assignment
-				for (size_t i = 0 ; i < recv_ass.size() ; i++)
-					recv_ass.get(i).w = gp.template vertex_p<nm_v::proc_id>(recv_ass.get(i).id);
-			}
-			else
-			{
-				recv_ass.resize(gp.getNVertex());
-
-				// we fill the assignment
+				old_p.resize(gp.getNVertex());
 				for (size_t i = 0 ; i < gp.getNVertex() ; i++)
-				{
-					recv_ass.get(i).id = i;
-					recv_ass.get(i).w = gp.template vertex_p<nm_v::proc_id>(i);
-				}
+				{old_p.get(i) = gp.template vertex_p<nm_v::proc_id>(i);}
 			}
+
+			// decompose
+			metis_graph.decompose<nm_v::proc_id>();
+
+			set_assignment(old_p,has_prev);
 		}
 		else
 		{
 			metis_graph.inc_dec();
 		}
 
-		recv_ass.resize(gp.getNVertex());
+		bcast_assignment();
+	}
 
-		// broad cast the result
-		v_cl.Bcast(recv_ass,0);
-		v_cl.execute();
-		owner_scs.clear();
-		owner_cost_sub.clear();
+	/*! \brief Start an asynchronous decomposition
+	 *
+	 * The computation costs are gathered now (snapshot), processor 0 run metis in a separate
+	 * thread on a copy of the graph, and the call return immediately on all processors. The
+	 * current decomposition stay valid until decompose_commit() is called
+	 *
+	 * \warning it is a collective call
+	 *
+	 */
+	void decompose_async()
+	{
+#ifdef SE_CLASS2
+			check_valid(this,8);
+#endif
 
-		size_t j = 0;
+		if (async_run == true)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error an asynchronous decomposition is already running, call decompose_commit() first" << std::endl;
+			return;
+		}
 
-		// Fill the metis graph
-		for (size_t i = 0 ; i < recv_ass.size() ; i++)
+		// Gather the sub-domain weight in one processor
+		recv_async.clear();
+		v_cl.SGather(owner_cost_sub,recv_async,0);
+
+		if (v_cl.getProcessUnitID() == 0)
 		{
-			gp.template vertex_p<nm_v::proc_id>(recv_ass.get(i).id) = recv_ass.get(i).w;
+			gp_async = gp;
 
-			if (recv_ass.get(i).w == v_cl.getProcessUnitID())
+			for (size_t i = 0 ; i < recv_async.size() ; i++)
+			{gp_async.template vertex_p<nm_v::computation>(recv_async.get(i).id) = recv_async.get(i).w;}
+
+			gi_async = gi;
+			gi_async.setGraph(gp_async);
+
+			thr_async = std::thread(metis_decompose,std::ref(gi_async),v_cl.getProcessingUnits(),recv_async.size() != 0,testing);
+		}
+
+		async_run = true;
+	}
+
+	/*! \brief Install the decomposition started with decompose_async()
+	 *
+	 * Processor 0 wait the end of the decomposition (if not already finished), the result is
+	 * broadcasted as in decompose(). After the call the computation costs must be set again
+	 *
+	 * \warning it is a collective call
+	 *
+	 * \return false if there is no asynchronous decomposition to commit
+	 *
+	 */
+	bool decompose_commit()
+	{
+#ifdef SE_CLASS2
+			check_valid(this,8);
+#endif
+
+		if (async_run == false)
+		{return false;}
+
+		recv_ass.clear();
+
+		if (v_cl.getProcessUnitID() == 0)
+		{
+			thr_async.join();
+
+			bool has_prev = (metis_graph.get_ndec() != 0);
+			openfpm::vector<size_t> old_p;
+
+			if (has_prev == true)
 			{
-				owner_scs[recv_ass.get(i).id] = j;
-				j++;
-				owner_cost_sub.add();
-				owner_cost_sub.last().id = recv_ass.get(i).id;
-				owner_cost_sub.last().w = 1;
+				old_p.resize(gp.getNVertex());
+				for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+				{old_p.get(i) = gp.template vertex_p<nm_v::proc_id>(i);}
 			}
+
+			// install the snapshot weights and the new decomposition
+			for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+			{
+				gp.template vertex_p<nm_v::computation>(i) = gp_async.template vertex_p<nm_v::computation>(i);
+				gp.template vertex_p<nm_v::proc_id>(i) = gp_async.template vertex_p<nm_v::proc_id>(i);
+			}
+
+			recv_ass.swap(recv_async);
+			set_assignment(old_p,has_prev);
 		}
+
+		metis_graph.inc_dec();
+		async_run = false;
+
+		bcast_assignment();
+
+		return true;
+	}
+
+	/*! \brief Wait the end of a running asynchronous decomposition and discard it
+	 *
+	 * The decomposition thread use gi_async and gp_async, it must end before the graphs are overwritten
+	 *
+	 */
+	void discard_async()
+	{
+		if (thr_async.joinable())
+		{thr_async.join();}
+
+		async_run = false;
+	}
+
+	/*! \brief Check if an asynchronous decomposition has been started and not committed
+	 *
+	 * \return true if decompose_commit() must be called
+	 *
+	 */
+	bool isDecomposeAsyncRunning() const
+	{
+		return async_run;
 	}
 
 	/*! \brief Refine current decomposition
@@ -315,6 +564,34 @@ public:
 		decompose();
 	}
 
+	/*! \brief Update the owned sub-sub-domains after the processor ids in the graph has been changed
+	 *
+	 * Used by the incremental load balancing, the sub-sub-domains that stay keep their
+	 * computational cost, the received ones get cost 1 (as after a decomposition)
+	 *
+	 */
+	void updateOwners()
+	{
+		std::unordered_map<size_t,size_t> n_owner_scs;
+		openfpm::vector<met_sub_w> n_owner_cost_sub;
+
+		for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+		{
+			if (gp.template vertex_p<nm_v::proc_id>(i) != v_cl.getProcessUnitID())
+			{continue;}
+
+			n_owner_scs[i] = n_owner_cost_sub.size();
+			n_owner_cost_sub.add();
+			n_owner_cost_sub.last().id = i;
+
+			auto fnd = owner_scs.find(i);
+			n_owner_cost_sub.last().w = (fnd == owner_scs.end())?1:owner_cost_sub.get(fnd->second).w;
+		}
+
+		owner_scs.swap(n_owner_scs);
+		owner_cost_sub.swap(n_owner_cost_sub);
+	}
+
 
 	/*! \brief Function that return the position (point P1) of the sub-sub domain box in the space
 	 *
@@ -413,7 +690,19 @@ public:
 		check_overflowe(id,e);
 #endif
 
-		gp.getChildEdge(id, e).template get<nm_e::communication>() = cost;
+		gi.setChildEdge(id, e, cost);
+	}
+
+	/*! \brief Set the same communication cost on all the edges
+	 *
+	 * With the implicit graph a single weight is stored (setCommunicationCost store a weight for each edge)
+	 *
+	 * \param cost communication cost
+	 *
+	 */
+	void setAllCommunicationCosts(size_t cost)
+	{
+		gi.setAllEdges(cost);
 	}
 
 	/*! \brief Returns total number of sub-sub-domains
@@ -442,7 +731,33 @@ public:
 		check_overflow(id);
 #endif
 
-		return gp.getNChilds(id);
+		return gi.getNChilds(id);
+	}
+
+	/*! \brief Returns the e-th neighbor of the sub-sub-domain id
+	 *
+	 * \param id id of the sub-sub-domain
+	 * \param e id in the neighborhood list
+	 *
+	 * \return the id of the neighborhood sub-sub-domain
+	 *
+	 */
+	size_t getSubSubDomainNeighbor(size_t id, size_t e)
+	{
+		return gi.getChild(id,e);
+	}
+
+	/*! \brief Returns the communication cost of the edge to the e-th neighbor of the sub-sub-domain id
+	 *
+	 * \param id id of the sub-sub-domain
+	 * \param e id in the neighborhood list
+	 *
+	 * \return the communication cost
+	 *
+	 */
+	size_t getSubSubDomainCommunicationCost(size_t id, size_t e)
+	{
+		return gi.getChildEdge(id,e).template get<nm_e::communication>();
 	}
 
 	/*! \brief Compute the unbalance of the processor compared to the optimal balance
@@ -571,11 +886,22 @@ public:
 			check_valid(&mt,8);
 			check_valid(this,8);
 #endif
+		discard_async();
+
+		if (mt.async_run == true)
+		{std::cerr << __FILE__ << ":" << __LINE__ << " warning the asynchronous decomposition of the copied distribution is not copied, call decompose_commit() on it first" << std::endl;}
+
 		this->gr = mt.gr;
 		this->domain = mt.domain;
 		this->gp = mt.gp;
+		this->gi = mt.gi;
+		this->gi.setGraph(this->gp);
+		this->implicit_graph = mt.implicit_graph;
 		this->owner_cost_sub = mt.owner_cost_sub;
 		this->owner_scs = mt.owner_scs;
+		this->remap_labels = mt.remap_labels;
+		this->mig_pred = mt.mig_pred;
+		this->mig_pred_no_remap = mt.mig_pred_no_remap;
 		return *this;
 	}
 
@@ -592,11 +918,21 @@ public:
 			check_valid(mt);
 			check_valid(this,8);
 #endif
+		// the graphs of mt are moved, its running decomposition cannot be committed any more
+		discard_async();
+		mt.discard_async();
+
 		this->gr = mt.gr;
 		this->domain = mt.domain;
 		this->gp.swap(mt.gp);
+		this->gi = mt.gi;
+		this->gi.setGraph(this->gp);
+		this->implicit_graph = mt.implicit_graph;
 		this->owner_cost_sub.swap(mt.owner_cost_sub);
 		this->owner_scs.swap(mt.owner_scs);
+		this->remap_labels = mt.remap_labels;
+		this->mig_pred = mt.mig_pred;
+		this->mig_pred_no_remap = mt.mig_pred_no_remap;
 		return *this;
 	}
 
@@ -657,6 +993,76 @@ public:
 		return owner_cost_sub.get(ids).w;
 	}
 
+	/*! \brief Permute the processor labels of a new decomposition to minimize the migration
+	 *
+	 * Metis assign arbitrary part ids, without the permutation a partition almost equal to the
+	 * previous one can move almost all the particles (default true)
+	 *
+	 * \param remap true to permute the labels
+	 *
+	 */
+	void setRemapLabels(bool remap)
+	{
+		remap_labels = remap;
+	}
+
+	/*! \brief Predicted migration of the last decomposition
+	 *
+	 * Sum of the computational weight of the sub-sub-domains that change processor
+	 *
+	 * \return the predicted migration
+	 *
+	 */
+	size_t getPredictedMigration() const
+	{
+		return mig_pred;
+	}
+
+	/*! \brief Predicted migration of the last decomposition if the labels were not permuted
+	 *
+	 * \return the predicted migration
+	 *
+	 */
+	size_t getPredictedMigrationNoRemap() const
+	{
+		return mig_pred_no_remap;
+	}
+
+	/*! \brief Do not store the edges of the sub-sub-domain graph
+	 *
+	 * The neighborhood of a sub-sub-domain is computed from its grid index, the vertices are
+	 * created in parallel and the communication weight is stored for each edge only if the
+	 * edges have different weights. The metis graph is constructed in parallel in any case.
+	 * Must be set before createCartGraph
+	 *
+	 * \param implicit true to compute the edges from the grid
+	 *
+	 */
+	void setImplicitGraph(bool implicit)
+	{
+		implicit_graph = implicit;
+	}
+
+	/*! \brief Check if the edges of the sub-sub-domain graph are computed from the grid
+	 *
+	 * \return true if the graph is implicit
+	 *
+	 */
+	bool isImplicitGraph() const
+	{
+		return implicit_graph;
+	}
+
+	/*! \brief Set the number of threads used to construct the graphs (default 1)
+	 *
+	 * \param n number of threads
+	 *
+	 */
+	void setGraphThreads(size_t n)
+	{
+		gi.setNThreads(n);
+	}
+
 	/*! \brief Get the decomposition counter
 	 *
 	 * \return the decomposition counter
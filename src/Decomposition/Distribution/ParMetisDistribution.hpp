@@ -12,8 +12,10 @@
 
 #include "SubdomainGraphNodes.hpp"
 #include "parmetis_util.hpp"
+#include "partition_remap.hpp"
 #include "Graph/ids.hpp"
 #include "Graph/CartesianGraphFactory.hpp"
+#include "Graph/CartesianGraphImplicit.hpp"
 
 #define PARMETIS_DISTRIBUTION_ERROR 100002
 
@@ -50,8 +52,14 @@ class ParMetisDistribution
 	//! Global sub-sub-domain graph
 	Graph_CSR<nm_v, nm_e> gp;
 
+	//! Graph seen by parmetis, the edges are computed from the grid in implicit mode
+	CartesianGraphImplicit<dim,Graph_CSR<nm_v, nm_e>> gi;
+
+	//! if true the edges of the graph are not stored (see setImplicitGraph)
+	bool implicit_graph = false;
+
 	//! Convert the graph to parmetis format
-	Parmetis<Graph_CSR<nm_v, nm_e>> parmetis_graph;
+	Parmetis<CartesianGraphImplicit<dim,Graph_CSR<nm_v, nm_e>>> parmetis_graph;
 
 	//! Id of the sub-sub-domain where we set the costs
 	openfpm::vector<size_t> sub_sub_owner;
@@ -85,6 +93,82 @@ class ParMetisDistribution
 	//! Flag to check if weights are used on vertices
 	bool verticesGotWeights = false;
 
+	//! if true the labels of a new partition are permuted to minimize the migration
+	bool remap_labels = true;
+
+	//! predicted migration of the last decomposition (number of sub-sub-domains changing processor)
+	size_t mig_pred = 0;
+
+	//! predicted migration of the last decomposition without the labels permutation
+	size_t mig_pred_no_remap = 0;
+
+	/*! \brief Permute the labels of the received partitions to maximize the overlap with the previous assignment
+	 *
+	 * Every processor has all the partitions and the previous assignment, so every processor compute
+	 * the same permutation. The vertices are counted with unit weight, because the computational
+	 * weights are not guaranteed to be the same on all processors
+	 *
+	 */
+	void remap_partitions()
+	{
+		size_t Np = v_cl.getProcessingUnits();
+		partition_remap rm(Np);
+
+		for (size_t i = 0; i < Np; i++)
+		{
+			size_t k = 0;
+			for (rid l = vtxdist.get(i); k < partitions.get(i).size() && l < vtxdist.get(i + 1); k++, ++l)
+			{
+				auto v_id = m2g.find(l)->second.id;
+				rm.add(gp.template vertex_p<nm_v::proc_id>(v_id),partitions.get(i).get(k),1);
+			}
+		}
+
+		openfpm::vector<size_t> perm;
+		rm.compute(perm);
+
+		mig_pred_no_remap = rm.getMigrationNoRemap();
+		mig_pred = mig_pred_no_remap;
+
+		if (remap_labels == false)
+		{return;}
+
+		for (size_t i = 0; i < Np; i++)
+		{
+			for (size_t k = 0 ; k < partitions.get(i).size() ; k++)
+			{partitions.get(i).get(k) = perm.get(partitions.get(i).get(k));}
+		}
+
+		mig_pred = rm.getMigration();
+	}
+
+	/*! \brief Re-map the vertices after the processor ids in the graph and vtxdist has been updated
+	 *
+	 * The vertices of each processor get consecutive re-mapped ids starting from vtxdist, in the
+	 * order of the global id
+	 *
+	 */
+	void renumberVertices()
+	{
+		size_t Np = v_cl.getProcessingUnits();
+
+		openfpm::vector<size_t> cnt;
+		cnt.resize(Np);
+
+		for (size_t i = 0 ; i < gp.getNVertex(); ++i)
+		{
+			size_t pid = gp.template vertex_p<nm_v::proc_id>(i);
+
+			rid j = rid(vtxdist.get(pid).id + cnt.get(pid));
+			gid gi = gid(i);
+
+			gp.template vertex_p<nm_v::id>(i) = j.id;
+			cnt.get(pid)++;
+
+			setMapId(j,gi);
+		}
+	}
+
 	/*! \brief Update main graph ad subgraph with the received data of the partitions from the other processors
 	 *
 	 */
@@ -94,6 +178,10 @@ class ParMetisDistribution
 
 		size_t Np = v_cl.getProcessingUnits();
 
+		// the first decomposition has no previous assignment
+		if (is_distributed == true)
+		{remap_partitions();}
+
 		// Init n_vtxdist to gather informations about the new decomposition
 		openfpm::vector<rid> n_vtxdist(Np + 1);
 		for (size_t i = 0; i <= Np; i++)
@@ -133,21 +221,7 @@ class ParMetisDistribution
 		for (size_t i = 0; i <= Np; i++)
 			vtxdist.get(i) = n_vtxdist.get(i);
 
-		openfpm::vector<size_t> cnt;
-		cnt.resize(Np);
-
-		for (size_t i = 0 ; i < gp.getNVertex(); ++i)
-		{
-			size_t pid = gp.template vertex_p<nm_v::proc_id>(i);
-
-			rid j = rid(vtxdist.get(pid).id + cnt.get(pid));
-			gid gi = gid(i);
-
-			gp.template vertex_p<nm_v::id>(i) = j.id;
-			cnt.get(pid)++;
-
-			setMapId(j,gi);
-		}
+		renumberVertices();
 	}
 
 	/*! \brief operator to access the vertex by mapped position
@@ -287,6 +361,7 @@ public:
 	ParMetisDistribution(Vcluster<> & v_cl)
 	:is_distributed(false),v_cl(v_cl), parmetis_graph(v_cl, v_cl.getProcessingUnits()), vtxdist(v_cl.getProcessingUnits() + 1), partitions(v_cl.getProcessingUnits()), v_per_proc(v_cl.getProcessingUnits())
 	{
+		gi.setGraph(gp);
 	}
 
 	/*! Copy constructor
@@ -327,9 +402,15 @@ public:
 		gr = grid;
 		domain = dom;
 
-		// Create a cartesian grid graph
-		CartesianGraphFactory<dim, Graph_CSR<nm_v, nm_e>> g_factory_part;
-		gp = g_factory_part.template construct<NO_EDGE, nm_v::id, T, dim - 1, 0>(gr.getSize(), domain, bc);
+		gi.setGraph(gp);
+		gi.setup(gr,bc,implicit_graph);
+
+		// the vertices (and the edges) are created in parallel with setGraphThreads
+		if (implicit_graph == true)
+		{gi.createVertices(domain);}
+		else
+		{gi.createGraph(domain);}
+
 		initLocalToGlobalMap();
 
 		//! Get the number of processing units
@@ -348,23 +429,13 @@ public:
 			else
 				vtxdist.get(i).id = (div_v) * i + mod_v;
 		}
-
-		// Init to 0.0 axis z (to fix in graphFactory)
-		if (dim < 3)
-		{
-			for (size_t i = 0; i < gp.getNVertex(); i++)
-			{
-				gp.vertex(i).template get<nm_v::x>()[2] = 0.0;
-			}
-		}
-		for (size_t i = 0; i < gp.getNVertex(); i++)
-		{
-			gp.vertex(i).template get<nm_v::global_id>() = i;
-		}
-
 	}
 
 	/*! \brief Get the current graph (main)
+	 *
+	 * \warning with the implicit graph (setImplicitGraph) it store only the vertices, the neighborhood and
+	 *          the communication costs must be accessed with getNSubSubDomainNeighbors, getSubSubDomainNeighbor
+	 *          and getSubSubDomainCommunicationCost
 	 *
 	 */
 	Graph_CSR<nm_v, nm_e> & getGraph()
@@ -378,9 +449,9 @@ public:
 	void decompose()
 	{
 		if (is_distributed == false)
-			parmetis_graph.initSubGraph(gp, vtxdist, m2g, verticesGotWeights);
+			parmetis_graph.initSubGraph(gi, vtxdist, m2g, verticesGotWeights);
 		else
-			parmetis_graph.reset(gp, vtxdist, m2g, verticesGotWeights);
+			parmetis_graph.reset(gi, vtxdist, m2g, verticesGotWeights);
 
 		//! Decompose
 		parmetis_graph.decompose(vtxdist);
@@ -400,7 +471,7 @@ public:
 	void refine()
 	{
 		// Reset parmetis graph and reconstruct it
-		parmetis_graph.reset(gp, vtxdist, m2g, verticesGotWeights);
+		parmetis_graph.reset(gi, vtxdist, m2g, verticesGotWeights);
 
 		// Refine
 		parmetis_graph.refine(vtxdist);
@@ -417,7 +488,7 @@ public:
 	void redecompose()
 	{
 		// Reset parmetis graph and reconstruct it
-		parmetis_graph.reset(gp, vtxdist, m2g, verticesGotWeights);
+		parmetis_graph.reset(gi, vtxdist, m2g, verticesGotWeights);
 
 		// Refine
 		parmetis_graph.redecompose(vtxdist);
@@ -425,6 +496,37 @@ public:
 		postDecomposition();
 	}
 
+	/*! \brief Update the owned sub-sub-domains after the processor ids in the graph has been changed
+	 *
+	 * Used by the incremental load balancing, vtxdist and the re-mapped ids are reconstructed
+	 * from the processor ids, as at the end of a decomposition. The graph must be the same on
+	 * all processors
+	 *
+	 */
+	void updateOwners()
+	{
+		size_t Np = v_cl.getProcessingUnits();
+
+		sub_sub_owner.clear();
+
+		for (size_t i = 0; i <= Np; i++)
+		{vtxdist.get(i).id = 0;}
+
+		for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+		{
+			size_t pid = gp.template vertex_p<nm_v::proc_id>(i);
+			++vtxdist.get(pid + 1);
+
+			if (pid == v_cl.getProcessUnitID())
+			{sub_sub_owner.add(i);}
+		}
+
+		for (size_t i = 2; i <= Np; i++)
+		{vtxdist.get(i) += vtxdist.get(i - 1);}
+
+		renumberVertices();
+	}
+
 	/*! \brief Compute the unbalance of the processor compared to the optimal balance
 	 *
 	 * \return the unbalance from the optimal one 0.01 mean 1%
@@ -562,11 +664,23 @@ public:
 
 		size_t e_id = v_id + e;
 
-		if (e_id >= gp.getNEdge())
-			std::cerr << "Such edge doesn't exist (id = " << e_id << ", " << "total size = " << gp.getNEdge() << ")\n";
+		if (e_id >= gi.getNEdge())
+			std::cerr << "Such edge doesn't exist (id = " << e_id << ", " << "total size = " << gi.getNEdge() << ")\n";
 #endif
 
-		gp.getChildEdge(v_id, e).template get<nm_e::communication>() = communication;
+		gi.setChildEdge(v_id, e, communication);
+	}
+
+	/*! \brief Set the same communication cost on all the edges
+	 *
+	 * With the implicit graph a single weight is stored (setCommunicationCost store a weight for each edge)
+	 *
+	 * \param cost communication cost
+	 *
+	 */
+	void setAllCommunicationCosts(size_t cost)
+	{
+		gi.setAllEdges(cost);
 	}
 
 	/*! \brief Returns total number of sub-sub-domains in the distribution graph
@@ -615,7 +729,33 @@ public:
 			std::cerr << __FILE__ << ":" << __LINE__ << "Such vertex doesn't exist (id = " << id << ", " << "total size = " << gp.getNVertex() << ")\n";
 #endif
 
-		return gp.getNChilds(id);
+		return gi.getNChilds(id);
+	}
+
+	/*! \brief Returns the e-th neighbor of the sub-sub-domain id
+	 *
+	 * \param id id of the sub-sub-domain
+	 * \param e id in the neighborhood list
+	 *
+	 * \return the id of the neighborhood sub-sub-domain
+	 *
+	 */
+	size_t getSubSubDomainNeighbor(size_t id, size_t e)
+	{
+		return gi.getChild(id,e);
+	}
+
+	/*! \brief Returns the communication cost of the edge to the e-th neighbor of the sub-sub-domain id
+	 *
+	 * \param id id of the sub-sub-domain
+	 * \param e id in the neighborhood list
+	 *
+	 * \return the communication cost
+	 *
+	 */
+	size_t getSubSubDomainCommunicationCost(size_t id, size_t e)
+	{
+		return gi.getChildEdge(id,e).template get<nm_e::communication>();
 	}
 
 	/*! \brief Print the current distribution and save it to VTK file
@@ -635,11 +775,17 @@ public:
 		gr = dist.gr;
 		domain = dist.domain;
 		gp = dist.gp;
+		gi = dist.gi;
+		gi.setGraph(gp);
+		implicit_graph = dist.implicit_graph;
 		vtxdist = dist.vtxdist;
 		partitions = dist.partitions;
 		v_per_proc = dist.v_per_proc;
 		verticesGotWeights = dist.verticesGotWeights;
 		sub_sub_owner = dist.sub_sub_owner;
+		remap_labels = dist.remap_labels;
+		mig_pred = dist.mig_pred;
+		mig_pred_no_remap = dist.mig_pred_no_remap;
 		m2g = dist.m2g;
 		parmetis_graph = dist.parmetis_graph;
 
@@ -652,17 +798,90 @@ public:
 		gr = dist.gr;
 		domain = dist.domain;
 		gp.swap(dist.gp);
+		gi = dist.gi;
+		gi.setGraph(gp);
+		implicit_graph = dist.implicit_graph;
 		vtxdist.swap(dist.vtxdist);
 		partitions.swap(dist.partitions);
 		v_per_proc.swap(dist.v_per_proc);
 		verticesGotWeights = dist.verticesGotWeights;
 		sub_sub_owner.swap(dist.sub_sub_owner);
+		remap_labels = dist.remap_labels;
+		mig_pred = dist.mig_pred;
+		mig_pred_no_remap = dist.mig_pred_no_remap;
 		m2g.swap(dist.m2g);
 		parmetis_graph = dist.parmetis_graph;
 
 		return *this;
 	}
 
+	/*! \brief Permute the processor labels of a new decomposition to minimize the migration
+	 *
+	 * ParMetis assign arbitrary part ids, without the permutation a partition almost equal to the
+	 * previous one can move almost all the particles (default true)
+	 *
+	 * \param remap true to permute the labels
+	 *
+	 */
+	void setRemapLabels(bool remap)
+	{
+		remap_labels = remap;
+	}
+
+	/*! \brief Predicted migration of the last decomposition
+	 *
+	 * \return the number of sub-sub-domains that change processor
+	 *
+	 */
+	size_t getPredictedMigration() const
+	{
+		return mig_pred;
+	}
+
+	/*! \brief Predicted migration of the last decomposition if the labels were not permuted
+	 *
+	 * \return the number of sub-sub-domains that would change processor
+	 *
+	 */
+	size_t getPredictedMigrationNoRemap() const
+	{
+		return mig_pred_no_remap;
+	}
+
+	/*! \brief Do not store the edges of the sub-sub-domain graph
+	 *
+	 * The neighborhood of a sub-sub-domain is computed from its grid index, the vertices are
+	 * created in parallel and the communication weight is stored for each edge only if the
+	 * edges have different weights. Must be set before createCartGraph
+	 *
+	 * \param implicit true to compute the edges from the grid
+	 *
+	 */
+	void setImplicitGraph(bool implicit)
+	{
+		implicit_graph = implicit;
+	}
+
+	/*! \brief Check if the edges of the sub-sub-domain graph are computed from the grid
+	 *
+	 * \return true if the graph is implicit
+	 *
+	 */
+	bool isImplicitGraph() const
+	{
+		return implicit_graph;
+	}
+
+	/*! \brief Set the number of threads used to create the graph (default 1)
+	 *
+	 * \param n number of threads
+	 *
+	 */
+	void setGraphThreads(size_t n)
+	{
+		gi.setNThreads(n);
+	}
+
 	/*! \brief Get the decomposition counter
 	 *
 	 * \return the decomposition counter
@@ -11,6 +11,7 @@
 #include "util/mathutil.hpp"
 #include "NN/CellList/CellDecomposer.hpp"
 #include "Grid/grid_key_dx_iterator_hilbert.hpp"
+#include "Graph/CartesianGraphImplicit.hpp"
 
 /*! \brief Class that distribute sub-sub-domains across processors using an hilbert curve
  *         to divide the space
@@ -35,6 +36,11 @@ class SpaceDistribution
 	//! Global sub-sub-domain graph
 	Graph_CSR<nm_v, nm_e> gp;
 
+	//! neighborhood of the sub-sub-domains, computed from the grid in implicit mode
+	CartesianGraphImplicit<dim,Graph_CSR<nm_v, nm_e>> gi;
+
+	//! if true the edges of the graph are not stored (see setImplicitGraph)
+	bool implicit_graph = false;
 
 public:
 
@@ -45,6 +51,7 @@ public:
 	SpaceDistribution(Vcluster<> & v_cl)
 	:v_cl(v_cl)
 	{
+		gi.setGraph(gp);
 	}
 
 	/*! Copy constructor
@@ -85,22 +92,21 @@ public:
 		gr = grid;
 		domain = dom;
 
-		// Create a cartesian grid graph
-		CartesianGraphFactory<dim, Graph_CSR<nm_v, nm_e>> g_factory_part;
-		gp = g_factory_part.template construct<NO_EDGE, nm_v::id, T, dim - 1, 0>(gr.getSize(), domain, bc);
-
-		// Init to 0.0 axis z (to fix in graphFactory)
-		if (dim < 3)
-		{
-			for (size_t i = 0; i < gp.getNVertex(); i++)
-				gp.vertex(i).template get<nm_v::x>()[2] = 0.0;
-		}
-		for (size_t i = 0; i < gp.getNVertex(); i++)
-			gp.vertex(i).template get<nm_v::global_id>() = i;
+		gi.setGraph(gp);
+		gi.setup(gr,bc,implicit_graph);
 
+		// the vertices (and the edges) are created in parallel with setGraphThreads
+		if (implicit_graph == true)
+		{gi.createVertices(domain);}
+		else
+		{gi.createGraph(domain);}
 	}
 
 	/*! \brief Get the current graph (main)
+	 *
+	 * \warning with the implicit graph (setImplicitGraph) it store only the vertices, the neighborhood and
+	 *          the communication costs must be accessed with getNSubSubDomainNeighbors, getSubSubDomainNeighbor
+	 *          and getSubSubDomainCommunicationCost
 	 *
 	 */
 	Graph_CSR<nm_v, nm_e> & getGraph()
@@ -230,6 +236,14 @@ public:
 		std::cout << __FILE__ << ":" << __LINE__ << " You are trying to dynamicaly balance a fixed decomposition, this operation has no effect" << std::endl;
 	}
 
+	/*! \brief Update the owned sub-sub-domains after the processor ids in the graph has been changed
+	 *
+	 * The owner is stored only in the graph, nothing to do
+	 *
+	 */
+	void updateOwners()
+	{}
+
 	/*! \brief Compute the unbalance of the processor compared to the optimal balance
 	 *
 	 * \return the unbalance from the optimal one 0.01 mean 1%
@@ -347,7 +361,33 @@ public:
 	 */
 	size_t getNSubSubDomainNeighbors(size_t id)
 	{
-		return gp.getNChilds(id);
+		return gi.getNChilds(id);
+	}
+
+	/*! \brief Returns the e-th neighbor of the sub-sub-domain id
+	 *
+	 * \param id id of the sub-sub-domain
+	 * \param e id in the neighborhood list
+	 *
+	 * \return the id of the neighborhood sub-sub-domain
+	 *
+	 */
+	size_t getSubSubDomainNeighbor(size_t id, size_t e)
+	{
+		return gi.getChild(id,e);
+	}
+
+	/*! \brief Returns the communication cost of the edge to the e-th neighbor of the sub-sub-domain id
+	 *
+	 * \param id id of the sub-sub-domain
+	 * \param e id in the neighborhood list
+	 *
+	 * \return the communication cost
+	 *
+	 */
+	size_t getSubSubDomainCommunicationCost(size_t id, size_t e)
+	{
+		return gi.getChildEdge(id,e).template get<nm_e::communication>();
 	}
 
 	/*! \brief Print the current distribution and save it to VTK file
@@ -366,6 +406,9 @@ public:
 		gr = dist.gr;
 		domain = dist.domain;
 		gp = dist.gp;
+		gi = dist.gi;
+		gi.setGraph(gp);
+		implicit_graph = dist.implicit_graph;
 
 		return *this;
 	}
@@ -376,10 +419,46 @@ public:
 		gr = dist.gr;
 		domain = dist.domain;
 		gp.swap(dist.gp);
+		gi = dist.gi;
+		gi.setGraph(gp);
+		implicit_graph = dist.implicit_graph;
 
 		return *this;
 	}
 
+	/*! \brief Do not store the edges of the sub-sub-domain graph
+	 *
+	 * The neighborhood of a sub-sub-domain is computed from its grid index and the vertices
+	 * are created in parallel. Must be set before createCartGraph
+	 *
+	 * \param implicit true to compute the edges from the grid
+	 *
+	 */
+	void setImplicitGraph(bool implicit)
+	{
+		implicit_graph = implicit;
+	}
+
+	/*! \brief Check if the edges of the sub-sub-domain graph are computed from the grid
+	 *
+	 * \return true if the graph is implicit
+	 *
+	 */
+	bool isImplicitGraph() const
+	{
+		return implicit_graph;
+	}
+
+	/*! \brief Set the number of threads used to create the graph (default 1)
+	 *
+	 * \param n number of threads
+	 *
+	 */
+	void setGraphThreads(size_t n)
+	{
+		gi.setNThreads(n);
+	}
+
 	/*! \brief It return the decomposition id
 	 *
 	 * It just return 0
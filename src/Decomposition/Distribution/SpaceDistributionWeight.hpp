@@ -350,6 +350,19 @@ public:
 		return gp.getNChilds(id);
 	}
 
+	/*! \brief Returns the e-th neighbor of the sub-sub-domain id
+	 *
+	 * \param id id of the sub-sub-domain
+	 * \param e id in the neighborhood list
+	 *
+	 * \return the id of the neighborhood sub-sub-domain
+	 *
+	 */
+	size_t getSubSubDomainNeighbor(size_t id, size_t e)
+	{
+		return gp.getChild(id,e);
+	}
+
 	/*! \brief Print the current distribution and save it to VTK file
 	 *
 	 * \param file filename
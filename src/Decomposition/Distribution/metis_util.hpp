@@ -12,6 +12,8 @@
 #include "metis.h"
 #include "SubdomainGraphNodes.hpp"
 #include "VTKWriter/VTKWriter.hpp"
+#include "Graph/CartesianGraphImplicit.hpp"
+#include "util/thread_pool.hpp"
 
 /*! \brief Metis graph structure
  *
@@ -84,6 +86,38 @@ class Metis
 	//! Distribution tolerance
 	real_t dist_tol = 1.05;
 
+	//! number of threads used to construct the metis graph
+	size_t n_thr = 1;
+
+	/*! \brief Construct the start of the adjacency list of each vertex in parallel
+	 *
+	 * \param g Graph
+	 *
+	 */
+	void constructXadj(Graph & g)
+	{
+		size_t nv = g.getNVertex();
+
+		Mg.xadj = new idx_t[nv + 1];
+		Mg.xadj[0] = 0;
+
+		idx_t * xadj = Mg.xadj;
+
+		size_t n_t = (n_thr > nv)?1:n_thr;
+		size_t chunk = (nv + n_t - 1) / n_t;
+
+		// number of children of each vertex
+		run_threads(n_t,[&](size_t t)
+		{
+			size_t stop = std::min(nv,(t+1)*chunk);
+			for (size_t i = t*chunk ; i < stop ; i++)
+			{xadj[i+1] = g.getNChilds(i);}
+		});
+
+		for (size_t i = 0 ; i < nv ; i++)
+		{Mg.xadj[i+1] += Mg.xadj[i];}
+	}
+
 	/*! \brief Construct Adjacency list
 	 *
 	 * \param g Graph
@@ -92,37 +126,28 @@ class Metis
 	void constructAdjList(Graph & g)
 	{
 		// create xadj and adjlist
-
-		// create xadj, adjlist, vwgt, adjwgt and vsize
-		Mg.xadj = new idx_t[g.getNVertex() + 1];
+		constructXadj(g);
 		Mg.adjncy = new idx_t[g.getNEdge()];
 
-		//! starting point in the adjacency list
-		size_t prev = 0;
+		idx_t * xadj = Mg.xadj;
+		idx_t * adjncy = Mg.adjncy;
 
-		// actual position
-		size_t id = 0;
+		size_t nv = g.getNVertex();
+		size_t n_t = (n_thr > nv)?1:n_thr;
+		size_t chunk = (nv + n_t - 1) / n_t;
 
-		// for each vertex calculate the position of the starting point in the adjacency list
-		for (size_t i = 0; i < g.getNVertex(); i++)
+		// each vertex write its own part of the adjacency list
+		run_threads(n_t,[&](size_t t)
 		{
-			// Calculate the starting point in the adjacency list
-			Mg.xadj[id] = prev;
-
-			// Create the adjacency list
-			for (size_t s = 0; s < g.getNChilds(i); s++)
+			size_t stop = std::min(nv,(t+1)*chunk);
+			for (size_t i = t*chunk ; i < stop ; i++)
 			{
-				Mg.adjncy[prev + s] = g.getChild(i, s);
-			}
+				size_t nc = xadj[i+1] - xadj[i];
 
-			// update the position for the next vertex
-			prev += g.getNChilds(i);
-
-			id++;
-		}
-
-		// Fill the last point
-		Mg.xadj[id] = prev;
+				for (size_t s = 0; s < nc; s++)
+				{adjncy[xadj[i] + s] = g.getChild(i, s);}
+			}
+		});
 	}
 
 	/*! \brief Construct Adjacency list
@@ -133,48 +158,44 @@ class Metis
 	void constructAdjListWithWeights(Graph & g)
 	{
 		// create xadj, adjlist, vwgt, adjwgt and vsize
-		Mg.xadj = new idx_t[g.getNVertex() + 1];
+		constructXadj(g);
 		Mg.adjncy = new idx_t[g.getNEdge()];
 		Mg.vwgt = new idx_t[g.getNVertex()];
 		Mg.adjwgt = new idx_t[g.getNEdge()];
 		Mg.vsize = new idx_t[g.getNVertex()];
 
-		//! starting point in the adjacency list
-		size_t prev = 0;
+		Metis_graph & mg = Mg;
 
-		// actual position
-		size_t id = 0;
+		size_t nv = g.getNVertex();
+		size_t n_t = (n_thr > nv)?1:n_thr;
+		size_t chunk = (nv + n_t - 1) / n_t;
 
-		// for each vertex calculate the position of the starting point in the adjacency list
-		for (size_t i = 0; i < g.getNVertex(); i++)
+		// each vertex write its own part of the adjacency list
+		run_threads(n_t,[&](size_t t)
 		{
-			// Add weight to vertex and migration cost
-			Mg.vwgt[i] = g.vertex(i).template get<nm_v::computation>();
-			Mg.vwgt[i] = (Mg.vwgt[i] == 0)?1:Mg.vwgt[i];
-			Mg.vsize[i] = g.vertex(i).template get<nm_v::migration>();
-			Mg.vsize[i] = (Mg.vsize[i] == 0)?1:Mg.vsize[i];
-
-			// Calculate the starting point in the adjacency list
-			Mg.xadj[id] = prev;
-
-			// Create the adjacency list
-			for (size_t s = 0; s < g.getNChilds(i); s++)
+			size_t stop = std::min(nv,(t+1)*chunk);
+			for (size_t i = t*chunk ; i < stop ; i++)
 			{
-				Mg.adjncy[prev + s] = g.getChild(i, s);
-
-				// zero values on Metis are dangerous
-				Mg.adjwgt[prev + s] = g.getChildEdge(i, s).template get<nm_e::communication>();
-				Mg.adjwgt[prev + s] = (Mg.adjwgt[prev + s] == 0)?1:Mg.adjwgt[prev + s];
+				// Add weight to vertex and migration cost
+				mg.vwgt[i] = g.vertex(i).template get<nm_v::computation>();
+				mg.vwgt[i] = (mg.vwgt[i] == 0)?1:mg.vwgt[i];
+				mg.vsize[i] = g.vertex(i).template get<nm_v::migration>();
+				mg.vsize[i] = (mg.vsize[i] == 0)?1:mg.vsize[i];
+
+				size_t prev = mg.xadj[i];
+				size_t nc = mg.xadj[i+1] - prev;
+
+				// Create the adjacency list
+				for (size_t s = 0; s < nc; s++)
+				{
+					mg.adjncy[prev + s] = g.getChild(i, s);
+
+					// zero values on Metis are dangerous
+					mg.adjwgt[prev + s] = g.getChildEdge(i, s).template get<nm_e::communication>();
+					mg.adjwgt[prev + s] = (mg.adjwgt[prev + s] == 0)?1:mg.adjwgt[prev + s];
+				}
 			}
-
-			// update the position for the next vertex
-			prev += g.getNChilds(i);
-
-			id++;
-		}
-
-		// Fill the last point
-		Mg.xadj[id] = prev;
+		});
 	}
 
 public:
@@ -438,6 +459,16 @@ public:
 		n_dec++;
 	}
 
+	/*! \brief Set the number of threads used to construct the metis graph
+	 *
+	 * \param n number of threads
+	 *
+	 */
+	void setNThreads(size_t n)
+	{
+		n_thr = (n == 0)?1:n;
+	}
+
 	/*! \brief It set Metis on test
 	 *
 	 * \param testing set to true to disable the testing
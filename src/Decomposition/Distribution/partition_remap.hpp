@@ -0,0 +1,189 @@
+/*
+ * partition_remap.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_DECOMPOSITION_DISTRIBUTION_PARTITION_REMAP_HPP_
+#define SRC_DECOMPOSITION_DISTRIBUTION_PARTITION_REMAP_HPP_
+
+#include <unordered_map>
+#include <algorithm>
+#include <vector>
+
+/*! \brief Permute the part labels of a new partition to maximize the overlap with the previous one
+ *
+ * Graph partitioners assign arbitrary part ids, a partition almost identical to the previous
+ * one can have all the labels changed, moving all the data in the following map. The overlap
+ * matrix (weight of the vertices in old part i and new part j) is accumulated with add, compute
+ * produce the permutation of the new labels with a greedy matching (heaviest overlaps first).
+ * The result is deterministic, so every processor with the same input produce the same permutation
+ *
+ * \code
+ *
+ * partition_remap rm(n_parts);
+ *
+ * for (size_t i = 0 ; i < n_vertex ; i++)
+ * {rm.add(old_part.get(i),new_part.get(i),weight.get(i));}
+ *
+ * openfpm::vector<size_t> perm;
+ * rm.compute(perm);
+ *
+ * // new_part.get(i) = perm.get(new_part.get(i))
+ *
+ * \endcode
+ *
+ */
+class partition_remap
+{
+	//! number of parts
+	size_t n_parts;
+
+	//! overlap matrix (sparse) key = new_part * n_parts + old_part
+	std::unordered_map<size_t,size_t> overlap;
+
+	//! total weight
+	size_t tot = 0;
+
+	//! weight that does not move with the original labels
+	size_t stay_id = 0;
+
+	//! weight that does not move with the permuted labels
+	size_t stay_perm = 0;
+
+	//! overlap entry
+	struct ov_entry
+	{
+		//! overlap weight
+		size_t w;
+
+		//! new part
+		size_t n;
+
+		//! old part
+		size_t o;
+
+		//! heaviest first, ties broken by labels (deterministic)
+		bool operator<(const ov_entry & e) const
+		{
+			if (w != e.w)	{return w > e.w;}
+			if (n != e.n)	{return n < e.n;}
+			return o < e.o;
+		}
+	};
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param n_parts number of parts
+	 *
+	 */
+	partition_remap(size_t n_parts)
+	:n_parts(n_parts)
+	{}
+
+	/*! \brief Add a vertex
+	 *
+	 * \param old_p part in the previous partition
+	 * \param new_p part in the new partition
+	 * \param w weight of the vertex (data that move if the part change)
+	 *
+	 */
+	void add(size_t old_p, size_t new_p, size_t w)
+	{
+		tot += w;
+
+		if (old_p >= n_parts || new_p >= n_parts)
+		{return;}
+
+		overlap[new_p * n_parts + old_p] += w;
+
+		if (old_p == new_p)
+		{stay_id += w;}
+	}
+
+	/*! \brief Compute the permutation of the new labels
+	 *
+	 * \param perm for each new part the label to use
+	 *
+	 */
+	void compute(openfpm::vector<size_t> & perm)
+	{
+		std::vector<ov_entry> ent;
+		ent.reserve(overlap.size());
+
+		for (auto it = overlap.begin() ; it != overlap.end() ; ++it)
+		{
+			ov_entry e;
+			e.w = it->second;
+			e.n = it->first / n_parts;
+			e.o = it->first % n_parts;
+			ent.push_back(e);
+		}
+
+		std::sort(ent.begin(),ent.end());
+
+		perm.resize(n_parts);
+		std::vector<bool> n_set(n_parts,false);
+		std::vector<bool> o_used(n_parts,false);
+
+		stay_perm = 0;
+
+		for (size_t i = 0 ; i < ent.size() ; i++)
+		{
+			if (n_set[ent[i].n] == true || o_used[ent[i].o] == true)
+			{continue;}
+
+			perm.get(ent[i].n) = ent[i].o;
+			n_set[ent[i].n] = true;
+			o_used[ent[i].o] = true;
+			stay_perm += ent[i].w;
+		}
+
+		// parts without overlap get the free labels in order
+		size_t o = 0;
+		for (size_t n = 0 ; n < n_parts ; n++)
+		{
+			if (n_set[n] == true)
+			{continue;}
+
+			while (o_used[o] == true)	{o++;}
+
+			perm.get(n) = o;
+			o_used[o] = true;
+		}
+
+		// the greedy matching can be worst than the identity only in degenerate cases
+		if (stay_perm < stay_id)
+		{
+			for (size_t n = 0 ; n < n_parts ; n++)
+			{perm.get(n) = n;}
+
+			stay_perm = stay_id;
+		}
+	}
+
+	/*! \brief Predicted weight that migrate with the original labels
+	 *
+	 * \return the weight
+	 *
+	 */
+	size_t getMigrationNoRemap() const
+	{
+		return tot - stay_id;
+	}
+
+	/*! \brief Predicted weight that migrate with the permuted labels (after compute)
+	 *
+	 * \return the weight
+	 *
+	 */
+	size_t getMigration() const
+	{
+		return tot - stay_perm;
+	}
+};
+
+#endif /* SRC_DECOMPOSITION_DISTRIBUTION_PARTITION_REMAP_HPP_ */
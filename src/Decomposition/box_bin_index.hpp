@@ -0,0 +1,261 @@
+/*
+ * box_bin_index.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_DECOMPOSITION_BOX_BIN_INDEX_HPP_
+#define SRC_DECOMPOSITION_BOX_BIN_INDEX_HPP_
+
+#include <cmath>
+#include <algorithm>
+
+/*! \brief Spatial index over a set of boxes (cell binning)
+ *
+ * The bounding box of the set is divided into about one cell for each box, every box is
+ * registered in all the cells it span. A query return the boxes registered in the cells
+ * spanned by the query box, in increasing order and without repetitions. It is a
+ * candidate list: the caller must still check the intersection. It is used to avoid the
+ * all-to-all intersections in the construction of the ghost boxes
+ *
+ * \code
+ *
+ * box_bin_index<dim,T> idx;
+ * idx.build(boxes);
+ *
+ * openfpm::vector<size_t> cand;
+ * idx.query(q,cand);
+ *
+ * for (size_t k = 0 ; k < cand.size() ; k++)
+ * {
+ *    size_t b = cand.get(k);
+ *    ... boxes.get(b).Intersect(q,bi) ...
+ * }
+ *
+ * \endcode
+ *
+ */
+template<unsigned int dim, typename T>
+class box_bin_index
+{
+	//! bounding box of the indexed boxes
+	Box<dim,T> bbox;
+
+	//! cells grid
+	grid_sm<dim,void> gr;
+
+	//! size of one cell
+	T cs[dim];
+
+	//! for each cell the start of its list in ids (CSR), size number of cells + 1
+	openfpm::vector<size_t> start;
+
+	//! boxes id of each cell
+	openfpm::vector<size_t> ids;
+
+	//! for each box the last query that returned it (avoid repetitions)
+	openfpm::vector<size_t> stamp;
+
+	//! query counter
+	size_t n_query = 0;
+
+	//! number of indexed boxes
+	size_t n_box = 0;
+
+	/*! \brief Get the cell range spanned by a box (clamped to the grid)
+	 *
+	 * \param b box
+	 * \param k1 first cell
+	 * \param k2 last cell
+	 *
+	 */
+	void cell_range(const Box<dim,T> & b, grid_key_dx<dim> & k1, grid_key_dx<dim> & k2) const
+	{
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			long int c1 = 0;
+			long int c2 = 0;
+
+			if (cs[d] > 0)
+			{
+				c1 = (long int)std::floor((b.getLow(d) - bbox.getLow(d)) / cs[d]);
+				c2 = (long int)std::floor((b.getHigh(d) - bbox.getLow(d)) / cs[d]);
+			}
+
+			long int mx = gr.size(d) - 1;
+			k1.set_d(d,std::max(0l,std::min(c1,mx)));
+			k2.set_d(d,std::max(0l,std::min(c2,mx)));
+		}
+	}
+
+public:
+
+	/*! \brief Index the boxes
+	 *
+	 * \param bx boxes to index, the id returned by query is the index in this vector
+	 *
+	 */
+	void build(const openfpm::vector<Box<dim,T>> & bx)
+	{
+		n_box = bx.size();
+		n_query = 0;
+		stamp.resize(n_box);
+
+		for (size_t i = 0 ; i < n_box ; i++)
+		{stamp.get(i) = 0;}
+
+		ids.clear();
+
+		size_t div[dim];
+
+		if (n_box == 0)
+		{
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				div[d] = 1;
+				cs[d] = 0;
+			}
+
+			gr.setDimensions(div);
+			start.resize(2);
+			start.get(0) = 0;
+			start.get(1) = 0;
+			return;
+		}
+
+		bbox = bx.get(0);
+		for (size_t i = 1 ; i < n_box ; i++)
+		{bbox.enclose(bx.get(i));}
+
+		// about one cell for each box
+		size_t n_div = std::max((size_t)1,(size_t)std::ceil(std::pow((double)n_box,1.0/dim)));
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			T ext = bbox.getHigh(d) - bbox.getLow(d);
+			div[d] = (ext > 0)?n_div:1;
+			cs[d] = (ext > 0)?ext / div[d]:0;
+		}
+
+		gr.setDimensions(div);
+
+		// count the boxes in each cell (CSR)
+
+		start.resize(gr.size() + 1);
+		for (size_t i = 0 ; i < start.size() ; i++)
+		{start.get(i) = 0;}
+
+		grid_key_dx<dim> k1;
+		grid_key_dx<dim> k2;
+
+		for (size_t i = 0 ; i < n_box ; i++)
+		{
+			cell_range(bx.get(i),k1,k2);
+
+			grid_key_dx_iterator_sub<dim> it(gr,k1,k2);
+
+			while (it.isNext())
+			{
+				start.get(gr.LinId(it.get()) + 1) += 1;
+				++it;
+			}
+		}
+
+		for (size_t i = 1 ; i < start.size() ; i++)
+		{start.get(i) += start.get(i-1);}
+
+		ids.resize(start.last());
+
+		openfpm::vector<size_t> fill(gr.size());
+		for (size_t i = 0 ; i < fill.size() ; i++)
+		{fill.get(i) = start.get(i);}
+
+		// boxes are inserted in increasing order, so each cell list is sorted
+		for (size_t i = 0 ; i < n_box ; i++)
+		{
+			cell_range(bx.get(i),k1,k2);
+
+			grid_key_dx_iterator_sub<dim> it(gr,k1,k2);
+
+			while (it.isNext())
+			{
+				size_t c = gr.LinId(it.get());
+				ids.get(fill.get(c)) = i;
+				fill.get(c)++;
+				++it;
+			}
+		}
+	}
+
+	/*! \brief Get the boxes that can intersect q
+	 *
+	 * \param q query box
+	 * \param cand candidate boxes id, sorted and without repetitions (the content is replaced)
+	 *
+	 */
+	void query(const Box<dim,T> & q, openfpm::vector<size_t> & cand)
+	{
+		cand.clear();
+
+		if (n_box == 0)
+		{return;}
+
+		// The query is enlarged by a fraction of cell, so that rounding in the construction
+		// of q never exclude a box that touch it
+		Box<dim,T> qe = q;
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			T eps = (cs[d] > 0)?cs[d]*1e-3:std::fabs(bbox.getLow(d))*1e-6 + 1e-12;
+
+			if (qe.getHigh(d) + eps < bbox.getLow(d) || qe.getLow(d) - eps > bbox.getHigh(d))
+			{return;}
+
+			qe.setLow(d,qe.getLow(d) - eps);
+			qe.setHigh(d,qe.getHigh(d) + eps);
+		}
+
+		n_query++;
+
+		grid_key_dx<dim> k1;
+		grid_key_dx<dim> k2;
+		cell_range(qe,k1,k2);
+
+		grid_key_dx_iterator_sub<dim> it(gr,k1,k2);
+
+		while (it.isNext())
+		{
+			size_t c = gr.LinId(it.get());
+
+			for (size_t j = start.get(c) ; j < start.get(c+1) ; j++)
+			{
+				size_t b = ids.get(j);
+
+				if (stamp.get(b) != n_query)
+				{
+					stamp.get(b) = n_query;
+					cand.add(b);
+				}
+			}
+
+			++it;
+		}
+
+		// keep the order of the linear scan
+		if (cand.size() > 1)
+		{std::sort(&cand.get(0),&cand.get(0) + cand.size());}
+	}
+
+	/*! \brief Number of indexed boxes
+	 *
+	 * \return the number of boxes
+	 *
+	 */
+	size_t size() const
+	{
+		return n_box;
+	}
+};
+
+#endif /* SRC_DECOMPOSITION_BOX_BIN_INDEX_HPP_ */
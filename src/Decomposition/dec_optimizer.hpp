@@ -3,6 +3,8 @@
 
 #include "Grid/iterators/grid_key_dx_iterator_sub.hpp"
 #include "Grid/iterators/grid_skin_iterator.hpp"
+#include <queue>
+#include <vector>
 
 /*! \brief this class represent a wavefront of dimension dim
  *
@@ -37,6 +39,33 @@ struct is_typedef_and_data_same<true,wavefront<dim>>
 	};
 };
 
+/*! \brief Surface to volume statistics of the sub-domains produced by dec_optimizer
+ *
+ * The surface of a sub-domain is the number of sub-sub-domains in its ghost (the sub-domain
+ * enlarged by the ghost minus the sub-domain), the volume the number of sub-sub-domains inside
+ *
+ */
+struct dec_optimizer_stats
+{
+	//! number of sub-domains
+	size_t n_box = 0;
+
+	//! total volume
+	size_t volume = 0;
+
+	//! total ghost surface
+	size_t surface = 0;
+
+	//! minimum surface / volume ratio
+	double sv_min = 0.0;
+
+	//! maximum surface / volume ratio
+	double sv_max = 0.0;
+
+	//! average surface / volume ratio
+	double sv_avg = 0.0;
+};
+
 /*! \brief This class take a graph representing the space decomposition and produce a
  *         simplified version
  *
@@ -52,8 +81,240 @@ class dec_optimizer
 	//! Contain information about the grid size
 	grid_sm<dim,void> gh;
 
+	//! statistics of the last optimization
+	dec_optimizer_stats stats;
+
+	//! candidate merge of two sub-domains
+	struct merge_cand
+	{
+		//! reduction of the cost
+		long int gain;
+
+		//! first sub-domain
+		size_t a;
+
+		//! second sub-domain
+		size_t b;
+
+		//! version of a when the candidate has been created
+		size_t va;
+
+		//! version of b when the candidate has been created
+		size_t vb;
+
+		//! the best gain first, ties broken by the ids (deterministic)
+		bool operator<(const merge_cand & m) const
+		{
+			if (gain != m.gain)	{return gain < m.gain;}
+			if (a != m.a)	{return a > m.a;}
+			return b > m.b;
+		}
+	};
+
 private:
 
+	/*! \brief Number of sub-sub-domains in the ghost of a sub-domain
+	 *
+	 * \param box sub-domain (high included)
+	 * \param ghe ghost extension
+	 *
+	 * \return the ghost surface
+	 *
+	 */
+	static size_t ghost_surface(const Box<dim,size_t> & box, const Ghost<dim,long int> & ghe)
+	{
+		size_t v = 1;
+		size_t ve = 1;
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			size_t l = box.getHigh(d) - box.getLow(d) + 1;
+			v *= l;
+			ve *= l + std::labs(ghe.getLow(d)) + std::labs(ghe.getHigh(d));
+		}
+
+		return ve - v;
+	}
+
+	/*! \brief Number of sub-sub-domains in a sub-domain
+	 *
+	 * \param box sub-domain (high included)
+	 *
+	 * \return the volume
+	 *
+	 */
+	static size_t box_volume(const Box<dim,size_t> & box)
+	{
+		size_t v = 1;
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{v *= box.getHigh(d) - box.getLow(d) + 1;}
+
+		return v;
+	}
+
+	/*! \brief Check if two sub-domains share part of a face
+	 *
+	 * \param a first sub-domain
+	 * \param b second sub-domain
+	 *
+	 * \return true if they touch
+	 *
+	 */
+	static bool touch(const Box<dim,size_t> & a, const Box<dim,size_t> & b)
+	{
+		size_t n_adj = 0;
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			if (a.getHigh(d) + 1 == b.getLow(d) || b.getHigh(d) + 1 == a.getLow(d))
+			{n_adj++;}
+			else if (a.getHigh(d) < b.getLow(d) || b.getHigh(d) < a.getLow(d))
+			{return false;}
+		}
+
+		return n_adj == 1;
+	}
+
+	/*! \brief Evaluate the merge of two sub-domains into their bounding box
+	 *
+	 * The merge is valid if the bounding box is exactly tiled by sub-domains of the same processor,
+	 * all of them are absorbed
+	 *
+	 * \param bx sub-domains
+	 * \param alive alive sub-domains
+	 * \param prc processor of each sub-domain
+	 * \param a first sub-domain
+	 * \param b second sub-domain
+	 * \param ghe ghost extension
+	 * \param box_cost cost of one sub-domain
+	 * \param mb merged box
+	 * \param abs absorbed sub-domains
+	 * \param gain reduction of the cost
+	 *
+	 * \return true if the merge is valid
+	 *
+	 */
+	static bool eval_merge(const openfpm::vector<Box<dim,size_t>> & bx,
+						   const std::vector<bool> & alive,
+						   const openfpm::vector<size_t> & prc,
+						   size_t a, size_t b,
+						   const Ghost<dim,long int> & ghe,
+						   size_t box_cost,
+						   Box<dim,size_t> & mb,
+						   openfpm::vector<size_t> & abs,
+						   long int & gain)
+	{
+		mb = bx.get(a);
+		mb.enclose(bx.get(b));
+
+		abs.clear();
+		size_t vol = 0;
+		long int c_abs = 0;
+
+		for (size_t i = 0 ; i < bx.size() ; i++)
+		{
+			if (alive[i] == false)
+			{continue;}
+
+			const Box<dim,size_t> & bi = bx.get(i);
+
+			bool inside = true;
+			bool out = false;
+
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				if (bi.getHigh(d) < mb.getLow(d) || bi.getLow(d) > mb.getHigh(d))
+				{out = true;break;}
+
+				if (bi.getLow(d) < mb.getLow(d) || bi.getHigh(d) > mb.getHigh(d))
+				{inside = false;}
+			}
+
+			if (out == true)
+			{continue;}
+
+			// partially overlapping or of another processor
+			if (inside == false || prc.get(i) != prc.get(a))
+			{return false;}
+
+			abs.add(i);
+			vol += box_volume(bi);
+			c_abs += ghost_surface(bi,ghe) + box_cost;
+		}
+
+		// holes
+		if (vol != box_volume(mb))
+		{return false;}
+
+		gain = c_abs - (long int)(ghost_surface(mb,ghe) + box_cost);
+
+		return true;
+	}
+
+	/*! \brief Push the merge candidates of the sub-domain a
+	 *
+	 */
+	static void push_candidates(std::priority_queue<merge_cand> & pq,
+								const openfpm::vector<Box<dim,size_t>> & bx,
+								const std::vector<bool> & alive,
+								const std::vector<size_t> & ver,
+								const openfpm::vector<size_t> & prc,
+								size_t a,
+								const Ghost<dim,long int> & ghe,
+								size_t box_cost,
+								openfpm::vector<size_t> & abs)
+	{
+		Box<dim,size_t> mb;
+
+		for (size_t b = 0 ; b < bx.size() ; b++)
+		{
+			if (b == a || alive[b] == false || prc.get(b) != prc.get(a) || touch(bx.get(a),bx.get(b)) == false)
+			{continue;}
+
+			merge_cand mc;
+			if (eval_merge(bx,alive,prc,a,b,ghe,box_cost,mb,abs,mc.gain) == false)
+			{continue;}
+
+			mc.a = std::min(a,b);
+			mc.b = std::max(a,b);
+			mc.va = ver[mc.a];
+			mc.vb = ver[mc.b];
+
+			pq.push(mc);
+		}
+	}
+
+	/*! \brief Compute the surface to volume statistics
+	 *
+	 * \param lb sub-domains
+	 * \param ghe ghost extension
+	 *
+	 */
+	void compute_stats(const openfpm::vector<Box<dim,size_t>> & lb, const Ghost<dim,long int> & ghe)
+	{
+		stats = dec_optimizer_stats();
+		stats.n_box = lb.size();
+
+		for (size_t i = 0 ; i < lb.size() ; i++)
+		{
+			size_t v = box_volume(lb.get(i));
+			size_t s = ghost_surface(lb.get(i),ghe);
+
+			double sv = (double)s / v;
+
+			stats.volume += v;
+			stats.surface += s;
+			stats.sv_avg += sv;
+			stats.sv_min = (i == 0)?sv:std::min(stats.sv_min,sv);
+			stats.sv_max = std::max(stats.sv_max,sv);
+		}
+
+		if (lb.size() != 0)
+		{stats.sv_avg /= lb.size();}
+	}
+
+
 	/*! \brief Expand one wavefront
 	 *
 	 * \param v_w wavefronts
@@ -555,6 +816,48 @@ private:
 		return sub_id;
 	}
 
+	/*! \brief Cover the sub-sub-domains of a processor with sub-domains (wavefront expansion from seeds)
+	 *
+	 * \tparam p_id property containing the decomposition
+	 * \tparam p_sub property to fill with the sub-domain decomposition
+	 *
+	 * \param graph we are processing
+	 * \param pr_id Processor id (if p_id == -1 the optimization is done for all the processors)
+	 * \param lb list of sub-domain boxes
+	 * \param box_nn_processor for each sub-domain it list all the neighborhood processors
+	 * \param ghe ghost size
+	 * \param bc boundary conditions
+	 *
+	 */
+	template <unsigned int p_sub, unsigned int p_id> void optimize_wf(Graph & graph, long int pr_id, openfpm::vector<Box<dim,size_t>> & lb, openfpm::vector< openfpm::vector<size_t> > & box_nn_processor, const Ghost<dim,long int> & ghe, const size_t (& bc)[dim])
+	{
+		grid_key_dx<dim> key_seed;
+		key_seed.zero();
+
+		// if processor is -1 call optimize with -1 to do on all processors and exit
+		if (pr_id == -1)
+		{
+			optimize<p_sub,p_id>(key_seed,graph,pr_id,lb,box_nn_processor,ghe,bc);
+			return;
+		}
+
+		size_t sub_id = 0;
+
+		// fill the sub decomposition with negative number
+		fill_domain<p_sub>(graph,gh.getBox(),-1);
+
+		key_seed = search_seed<p_id,p_sub>(graph,pr_id);
+
+		while (key_seed.isValid())
+		{
+			// optimize
+			sub_id = optimize<p_sub,p_id>(key_seed,graph,pr_id,lb,box_nn_processor,ghe,bc,false,sub_id);
+
+			// new seed
+			key_seed = search_seed<p_id,p_sub>(graph,pr_id);
+		}
+	}
+
 	/*! \brief Construct the sub-domain processor list
 	 *
 	 * \tparam p_id property that contain the decomposition
@@ -663,38 +966,133 @@ public:
 	 */
 	template <unsigned int p_sub, unsigned int p_id> void optimize(Graph & graph, long int pr_id, openfpm::vector<Box<dim,size_t>> & lb, openfpm::vector< openfpm::vector<size_t> > & box_nn_processor, const Ghost<dim,long int> & ghe, const size_t (& bc)[dim])
 	{
-		grid_key_dx<dim> key_seed;
-		key_seed.zero();
+		size_t lb_start = lb.size();
 
-		// if processor is -1 call optimize with -1 to do on all processors and exit
-		if (pr_id == -1)
+		optimize_wf<p_sub,p_id>(graph,pr_id,lb,box_nn_processor,ghe,bc);
+
+		// Construct box box_nn_processor from the constructed domain
+		construct_box_nn_processor<p_id>(graph,box_nn_processor,lb,ghe,bc,pr_id);
+
+		openfpm::vector<Box<dim,size_t>> nb;
+		for (size_t i = lb_start ; i < lb.size() ; i++)
+		{nb.add(lb.get(i));}
+
+		compute_stats(nb,ghe);
+	}
+
+	/*! \brief optimize the graph merging the sub-domains to minimize the ghost surface
+	 *
+	 * The sub-domains produced by the wavefront expansion are merged greedily: two touching
+	 * sub-domains are merged into their bounding box when the bounding box is exactly tiled by
+	 * sub-domains of the same processor (all of them are absorbed). The merge with the biggest
+	 * reduction of the cost (ghost surface + box_cost for each sub-domain) is done first. The merges
+	 * stop when no merge reduce the cost and the number of sub-domains is not bigger than max_box
+	 * (if the budget cannot be reached the result can have more than max_box sub-domains)
+	 *
+	 * \tparam p_id property containing the decomposition
+	 * \tparam p_sub property to fill with the sub-domain decomposition
+	 *
+	 * \param graph we are processing
+	 * \param pr_id Processor id (if p_id == -1 the optimization is done for all the processors)
+	 * \param lb list of sub-domain boxes
+	 * \param box_nn_processor for each sub-domain it list all the neighborhood processors
+	 * \param ghe ghost size
+	 * \param bc boundary conditions
+	 * \param max_box maximum number of sub-domains (0 no limit)
+	 * \param box_cost cost of one sub-domain in ghost sub-sub-domains
+	 *
+	 */
+	template <unsigned int p_sub, unsigned int p_id> void optimize_merge(Graph & graph, long int pr_id, openfpm::vector<Box<dim,size_t>> & lb, openfpm::vector< openfpm::vector<size_t> > & box_nn_processor, const Ghost<dim,long int> & ghe, const size_t (& bc)[dim], size_t max_box = 0, size_t box_cost = 0)
+	{
+		openfpm::vector<Box<dim,size_t>> bx;
+		openfpm::vector< openfpm::vector<size_t> > tmp;
+
+		optimize_wf<p_sub,p_id>(graph,pr_id,bx,tmp,ghe,bc);
+
+		openfpm::vector<size_t> prc(bx.size());
+		std::vector<bool> alive(bx.size(),true);
+		std::vector<size_t> ver(bx.size(),0);
+
+		for (size_t i = 0 ; i < bx.size() ; i++)
+		{prc.get(i) = graph.vertex(gh.LinId(bx.get(i).getKP1())).template get<p_id>();}
+
+		std::priority_queue<merge_cand> pq;
+		openfpm::vector<size_t> abs;
+
+		for (size_t a = 0 ; a < bx.size() ; a++)
+		{push_candidates(pq,bx,alive,ver,prc,a,ghe,box_cost,abs);}
+
+		size_t n_alive = bx.size();
+		Box<dim,size_t> mb;
+
+		while (pq.size() != 0)
 		{
-			optimize<p_sub,p_id>(key_seed,graph,pr_id,lb,box_nn_processor,ghe,bc);
+			merge_cand mc = pq.top();
+			pq.pop();
 
-			// Construct box box_nn_processor from the constructed domain
-			construct_box_nn_processor<p_id>(graph,box_nn_processor,lb,ghe,bc,pr_id);
+			if (alive[mc.a] == false || alive[mc.b] == false || ver[mc.a] != mc.va || ver[mc.b] != mc.vb)
+			{continue;}
 
-			return;
-		}
+			if (mc.gain <= 0 && (max_box == 0 || n_alive <= max_box))
+			{break;}
 
-		size_t sub_id = 0;
+			// the other sub-domains can be changed in the meanwhile
+			long int gain;
+			if (eval_merge(bx,alive,prc,mc.a,mc.b,ghe,box_cost,mb,abs,gain) == false)
+			{continue;}
 
-		// fill the sub decomposition with negative number
-		fill_domain<p_sub>(graph,gh.getBox(),-1);
+			if (gain != mc.gain)
+			{
+				mc.gain = gain;
+				pq.push(mc);
+				continue;
+			}
 
-		key_seed = search_seed<p_id,p_sub>(graph,pr_id);
+			for (size_t i = 0 ; i < abs.size() ; i++)
+			{
+				alive[abs.get(i)] = false;
+				ver[abs.get(i)]++;
+			}
 
-		while (key_seed.isValid())
+			alive[mc.a] = true;
+			bx.get(mc.a) = mb;
+			n_alive -= abs.size() - 1;
+
+			push_candidates(pq,bx,alive,ver,prc,mc.a,ghe,box_cost,abs);
+		}
+
+		// relabel the sub-domains
+
+		size_t lb_start = lb.size();
+		size_t sub_id = 0;
+
+		for (size_t i = 0 ; i < bx.size() ; i++)
 		{
-			// optimize
-			sub_id = optimize<p_sub,p_id>(key_seed,graph,pr_id,lb,box_nn_processor,ghe,bc,false,sub_id);
+			if (alive[i] == false)
+			{continue;}
 
-			// new seed
-			key_seed = search_seed<p_id,p_sub>(graph,pr_id);
+			lb.add(bx.get(i));
+			fill_domain<p_sub>(graph,bx.get(i),sub_id);
+			sub_id++;
 		}
 
-		// Construct box box_nn_processor from the constructed domain
-		construct_box_nn_processor<p_id>(graph,box_nn_processor,lb,ghe,bc,pr_id);
+		openfpm::vector<Box<dim,size_t>> nb;
+		for (size_t i = lb_start ; i < lb.size() ; i++)
+		{nb.add(lb.get(i));}
+
+		construct_box_nn_processor<p_id>(graph,box_nn_processor,nb,ghe,bc,pr_id);
+
+		compute_stats(nb,ghe);
+	}
+
+	/*! \brief Get the statistics of the sub-domains produced by the last optimization
+	 *
+	 * \return the surface to volume statistics
+	 *
+	 */
+	const dec_optimizer_stats & getStats() const
+	{
+		return stats;
 	}
 };
 
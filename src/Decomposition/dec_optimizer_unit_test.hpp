@@ -205,6 +205,95 @@ BOOST_AUTO_TEST_CASE( dec_optimizer_disconnected_subdomains_np)
 	BOOST_REQUIRE_EQUAL(true,test);
 }
 
+BOOST_AUTO_TEST_CASE( dec_optimizer_merge_test)
+{
+	CartesianGraphFactory<3,Graph_CSR<nm_v,nm_e>> g_factory;
+
+	// Cartesian grid
+	size_t sz[3] = {GS_SIZE,GS_SIZE,GS_SIZE};
+
+	//! Grid info
+	grid_sm<3,void> gs(sz);
+
+	// Box
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	// Boundary conditions, non periodic
+	size_t bc[] = {NON_PERIODIC,NON_PERIODIC,NON_PERIODIC};
+
+	// Graph to decompose
+	Graph_CSR<nm_v,nm_e> g = g_factory.construct<nm_e::communication,NO_VERTEX_ID,float,2,0>(sz,box,bc);
+
+	// Irregular partition in 2 parts (staircase)
+	size_t n_p0 = 0;
+	for (size_t i = 0 ; i < gs.size() ; i++)
+	{
+		grid_key_dx<3> key = gs.InvLinId(i);
+		size_t id = ((size_t)key.get(0) < 2 + (key.get(1) + key.get(2)) % 4)?0:1;
+		g.vertex(i).get<nm_v::id>() = id;
+
+		n_p0 += (id == 0);
+	}
+
+	Ghost<3,size_t> ghe(1);
+
+	dec_optimizer<3,Graph_CSR<nm_v,nm_e>> d_o(g,sz);
+
+	// wavefront sub-domains
+	openfpm::vector<Box<3,size_t>> dec_wf;
+	openfpm::vector< openfpm::vector<size_t> > box_nn_wf;
+	d_o.optimize<nm_v::sub_id,nm_v::id>(g,0,dec_wf,box_nn_wf,ghe,bc);
+	dec_optimizer_stats st_wf = d_o.getStats();
+
+	BOOST_REQUIRE_EQUAL(st_wf.n_box,dec_wf.size());
+	BOOST_REQUIRE_EQUAL(st_wf.volume,n_p0);
+
+	// merged sub-domains
+	openfpm::vector<Box<3,size_t>> dec_m;
+	openfpm::vector< openfpm::vector<size_t> > box_nn_m;
+	d_o.optimize_merge<nm_v::sub_id,nm_v::id>(g,0,dec_m,box_nn_m,ghe,bc);
+	dec_optimizer_stats st_m = d_o.getStats();
+
+	BOOST_REQUIRE_EQUAL(st_m.n_box,dec_m.size());
+	BOOST_REQUIRE_EQUAL(box_nn_m.size(),dec_m.size());
+	BOOST_REQUIRE_EQUAL(st_m.volume,n_p0);
+	BOOST_REQUIRE(st_m.n_box <= st_wf.n_box);
+	BOOST_REQUIRE(st_m.surface <= st_wf.surface);
+
+	// The merged sub-domains cover exactly the cells of processor 0 and the sub_id is consistent
+	openfpm::vector<size_t> cnt(gs.size());
+	for (size_t i = 0 ; i < cnt.size() ; i++)
+	{cnt.get(i) = 0;}
+
+	for (size_t b = 0 ; b < dec_m.size() ; b++)
+	{
+		grid_key_dx_iterator_sub<3> it(gs,dec_m.get(b).getKP1(),dec_m.get(b).getKP2());
+
+		while (it.isNext())
+		{
+			size_t lin = gs.LinId(it.get());
+			cnt.get(lin)++;
+
+			BOOST_REQUIRE_EQUAL(g.vertex(lin).get<nm_v::id>(),0ul);
+			BOOST_REQUIRE_EQUAL(g.vertex(lin).get<nm_v::sub_id>(),(long int)b);
+
+			++it;
+		}
+	}
+
+	for (size_t i = 0 ; i < cnt.size() ; i++)
+	{BOOST_REQUIRE_EQUAL(cnt.get(i),(g.vertex(i).get<nm_v::id>() == 0)?1ul:0ul);}
+
+	// An high cost for each sub-domain never produce more sub-domains
+	openfpm::vector<Box<3,size_t>> dec_c;
+	openfpm::vector< openfpm::vector<size_t> > box_nn_c;
+	d_o.optimize_merge<nm_v::sub_id,nm_v::id>(g,0,dec_c,box_nn_c,ghe,bc,1,1000);
+
+	BOOST_REQUIRE(dec_c.size() <= dec_m.size());
+	BOOST_REQUIRE(d_o.getStats().sv_min <= d_o.getStats().sv_avg);
+	BOOST_REQUIRE(d_o.getStats().sv_avg <= d_o.getStats().sv_max);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -10,6 +10,7 @@
 
 #include "common.hpp"
 #include "nn_processor.hpp"
+#include "Decomposition/box_bin_index.hpp"
 #include "Decomposition/shift_vect_converter.hpp"
 #include "Decomposition/cuda/ie_ghost_gpu.cuh"
 
@@ -207,6 +208,20 @@ protected:
 		geo_cell.Initialize(domain,div,0);
 	}
 
+	/*! \brief Build a spatial index of the sub-domains of each near processor
+	 *
+	 * \param nn_p contain the sub-domains of the near processors
+	 * \param nn_idx one index for each near processor (in ProctoID order)
+	 *
+	 */
+	void index_near_subdomains(const nn_prcs<dim,T> & nn_p, openfpm::vector<box_bin_index<dim,T>> & nn_idx)
+	{
+		nn_idx.resize(nn_p.getNNProcessors());
+
+		for (size_t p = 0 ; p < nn_p.getNNProcessors() ; p++)
+		{nn_idx.get(p).build(nn_p.getNearSubdomains(nn_p.IDtoProc(p)));}
+	}
+
 	/*! \brief Create the box_nn_processor_int (bx part)  structure
 	 *
 	 * For each sub-domain of the local processor it store the intersection between the enlarged
@@ -231,6 +246,12 @@ protected:
 		box_nn_processor_int.resize(sub_domains.size());
 		proc_int_box.resize(nn_p.getNNProcessors());
 
+		// spatial index of the sub-domains of each near processor
+		openfpm::vector<box_bin_index<dim,T>> nn_idx;
+		index_near_subdomains(nn_p,nn_idx);
+
+		openfpm::vector<size_t> cand;
+
 		// For each sub-domain
 		for (size_t i = 0 ; i < sub_domains.size() ; i++)
 		{
@@ -263,8 +284,12 @@ protected:
 				openfpm::vector< ::Box<dim,T> > & box_nn_processor_int_gg = box_nn_processor_int.get(i).get(j).bx;
 
 				// for each near processor sub-domain intersect with the enlarged local sub-domain and store it
-				for (size_t b = 0 ; b < nn_processor_subdomains_g.size() ; b++)
+				nn_idx.get(nn_p.ProctoID(p_id)).query(sub_with_ghost,cand);
+
+				for (size_t c = 0 ; c < cand.size() ; c++)
 				{
+					size_t b = cand.get(c);
+
 					::Box<dim,T> bi;
 					::Box<dim,T> sub_bb(nn_processor_subdomains_g.get(b));
 
@@ -333,9 +358,25 @@ protected:
 		box_nn_processor_int.resize(sub_domains.size());
 		proc_int_box.resize(nn_p.getNNProcessors());
 
+		// spatial index of the sub-domains of each near processor
+		openfpm::vector<box_bin_index<dim,T>> nn_idx;
+		index_near_subdomains(nn_p,nn_idx);
+
+		openfpm::vector<size_t> cand;
+
 		// For each sub-domain
 		for (size_t i = 0 ; i < sub_domains.size() ; i++)
 		{
+			// the near sub-domains enlarged by the ghost intersect the local sub-domain
+			// if they intersect the local sub-domain enlarged by the opposite ghost
+			::Box<dim,T> l_sub_q = sub_domains.get(i);
+
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				l_sub_q.setLow(d,l_sub_q.getLow(d) - ghost.getHigh(d));
+				l_sub_q.setHigh(d,l_sub_q.getHigh(d) - ghost.getLow(d));
+			}
+
 			// For each processor contiguous to this sub-domain
 			for (size_t j = 0 ; j < box_nn_processor.get(i).size() ; j++)
 			{
@@ -355,8 +396,12 @@ protected:
 				size_t lc_proc = nn_p.getNearProcessor(p_id);
 
 				// For each near processor sub-domains enlarge and intersect with the local sub-domain and store the result
-				for (size_t k = 0 ; k < nn_p_box.size() ; k++)
+				nn_idx.get(nn_p.ProctoID(p_id)).query(l_sub_q,cand);
+
+				for (size_t c = 0 ; c < cand.size() ; c++)
 				{
+					size_t k = cand.get(c);
+
 					// enlarge the near-processor sub-domain
 					::Box<dim,T> n_sub = nn_p_box.get(k);
 
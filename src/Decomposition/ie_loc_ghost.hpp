@@ -14,6 +14,7 @@
 #include "common.hpp"
 #include "VTKWriter/VTKWriter.hpp"
 #include "nn_processor.hpp"
+#include "Decomposition/box_bin_index.hpp"
 
 /*! \brief structure that store and compute the internal and external local ghost box
  *
@@ -32,6 +33,22 @@ class ie_loc_ghost
 	//! temporal added sub-domains
 	openfpm::vector<Box_loc_sub<dim,T>> sub_domains_tmp;
 
+	/*! \brief Build a spatial index of the local sub-domains (and their periodic images)
+	 *
+	 * \param sub_domains_prc local sub-domains + borders
+	 * \param idx index
+	 *
+	 */
+	void index_subdomains(const openfpm::vector<Box_loc_sub<dim,T>> & sub_domains_prc, box_bin_index<dim,T> & idx)
+	{
+		openfpm::vector<::Box<dim,T>> bx(sub_domains_prc.size());
+
+		for (size_t j = 0 ; j < sub_domains_prc.size() ; j++)
+		{bx.get(j) = sub_domains_prc.get(j).bx;}
+
+		idx.build(bx);
+	}
+
 	/*! \brief Create the external local ghost boxes
 	 *
 	 * \param ghost part
@@ -48,6 +65,11 @@ class ie_loc_ghost
 
 		loc_ghost_box.resize(sub_domains.size());
 
+		box_bin_index<dim,T> idx;
+		index_subdomains(sub_domains_prc,idx);
+
+		openfpm::vector<size_t> cand;
+
 		// For each sub-domain
 		for (size_t i = 0 ; i < sub_domains.size() ; i++)
 		{
@@ -57,8 +79,11 @@ class ie_loc_ghost
 			sub_with_ghost.enlarge(ghost);
 
 			// intersect with the other local sub-domains
-			for (size_t j = 0 ; j < sub_domains_prc.size() ; j++)
+			idx.query(sub_with_ghost,cand);
+
+			for (size_t c = 0 ; c < cand.size() ; c++)
 			{
+				size_t j = cand.get(c);
 				size_t rj = sub_domains_prc.get(j).sub;
 
 				if (rj == i && sub_domains_prc.get(j).cmb == zero)
@@ -109,12 +134,30 @@ class ie_loc_ghost
 
 		loc_ghost_box.resize(sub_domains.size());
 
+		box_bin_index<dim,T> idx;
+		index_subdomains(sub_domains_prc,idx);
+
+		openfpm::vector<size_t> cand;
+
 		// For each sub-domain
 		for (size_t i = 0 ; i < sub_domains.size() ; i++)
 		{
+			// the others sub-domains enlarged by the ghost intersect the sub-domain i
+			// if they intersect the sub-domain i enlarged by the opposite ghost
+			::Box<dim,T> sub_q = sub_domains.get(i);
+
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				sub_q.setLow(d,sub_q.getLow(d) - ghost.getHigh(d));
+				sub_q.setHigh(d,sub_q.getHigh(d) - ghost.getLow(d));
+			}
+
+			idx.query(sub_q,cand);
+
 			// intersect with the others local sub-domains
-			for (size_t j = 0 ; j < sub_domains_prc.size() ; j++)
+			for (size_t c = 0 ; c < cand.size() ; c++)
 			{
+				size_t j = cand.get(c);
 				SpaceBox<dim,T> sub_with_ghost = sub_domains_prc.get(j).bx;
 				size_t rj = sub_domains_prc.get(j).sub;
 
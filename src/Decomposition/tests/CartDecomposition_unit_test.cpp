@@ -688,5 +688,377 @@ BOOST_AUTO_TEST_CASE( CartDecomposition_nsub_algo_functions_test)
 	}
 }
 
+BOOST_AUTO_TEST_CASE( CartDecomposition_distributed_directory_test )
+{
+	// Vcluster
+	Vcluster<> & vcl = create_vcluster();
+
+	// Physical domain
+	Box<3, float> box( { 0.0, 0.0, 0.0 }, { 1.0, 1.0, 1.0 });
+	size_t div[3];
+
+	size_t n_sub = vcl.getProcessingUnits() * SUB_UNIT_FACTOR;
+	for (int i = 0; i < 3; i++)
+	{div[i] = openfpm::math::round_big_2(pow(n_sub,1.0/3));}
+
+	Ghost<3, float> g(0.01);
+	size_t bc[] = { PERIODIC, PERIODIC, PERIODIC };
+
+	CartDecomposition<3, float> dec(vcl);
+	dec.setParameters(div,box,bc,g);
+	dec.decompose();
+
+	CartDecomposition<3, float> dec_dir(vcl);
+	dec_dir.setDistributedDirectory(true);
+	dec_dir.setParameters(div,box,bc,g);
+	dec_dir.decompose();
+
+	BOOST_REQUIRE_EQUAL(dec_dir.isDistributedDirectory(),true);
+
+	// only local and neighborhood sub-domains are stored
+	BOOST_REQUIRE(dec_dir.private_get_sub_domains_global().size() <= dec.private_get_sub_domains_global().size());
+
+	openfpm::vector<Point<3,float>> pts;
+
+	for (size_t i = 0 ; i < 1000 ; i++)
+	{
+		Point<3,float> p({(float)rand() / RAND_MAX,(float)rand() / RAND_MAX,(float)rand() / RAND_MAX});
+		pts.add(p);
+
+		// resolved locally must be the same processor
+		long int lp = dec_dir.processorIDLocal(p);
+		if (lp != -1)
+		{BOOST_REQUIRE_EQUAL((size_t)lp,dec.processorID(p));}
+	}
+
+	// the directory resolve every point
+	openfpm::vector<size_t> prc;
+	dec_dir.processorIDRemote(pts,prc);
+
+	for (size_t i = 0 ; i < pts.size() ; i++)
+	{BOOST_REQUIRE_EQUAL(prc.get(i),dec.processorID(pts.get(i)));}
+}
+
+BOOST_AUTO_TEST_CASE( CartDecomposition_quality_report_test )
+{
+	// Vcluster
+	Vcluster<> & vcl = create_vcluster();
+
+	// Physical domain
+	Box<3, float> box( { 0.0, 0.0, 0.0 }, { 1.0, 1.0, 1.0 });
+	size_t div[3];
+
+	size_t n_sub = vcl.getProcessingUnits() * SUB_UNIT_FACTOR;
+	for (int i = 0; i < 3; i++)
+	{div[i] = openfpm::math::round_big_2(pow(n_sub,1.0/3));}
+
+	Ghost<3, float> g(0.01);
+	size_t bc[] = { NON_PERIODIC, NON_PERIODIC, NON_PERIODIC };
+
+	CartDecomposition<3, float> dec(vcl);
+	dec.setParameters(div,box,bc,g);
+	dec.decompose();
+
+	dec_quality_report rep = dec.getQualityReport();
+
+	BOOST_REQUIRE_EQUAL(rep.n_sub,dec.getNSubDomain());
+	BOOST_REQUIRE_EQUAL(rep.n_nn,dec.getNNProcessors());
+
+	size_t n_ssd = rep.n_ssd;
+	size_t n_sub_tot = rep.n_sub;
+	vcl.sum(n_ssd);
+	vcl.sum(n_sub_tot);
+	vcl.execute();
+
+	BOOST_REQUIRE_EQUAL(n_ssd,div[0]*div[1]*div[2]);
+	BOOST_REQUIRE_EQUAL(rep.n_sub_tot,n_sub_tot);
+
+	// first decomposition nothing move
+	BOOST_REQUIRE_EQUAL(rep.mig,0ul);
+	BOOST_REQUIRE_EQUAL(rep.mig_tot,0ul);
+
+	BOOST_REQUIRE(rep.load_min <= rep.load_avg);
+	BOOST_REQUIRE(rep.load_avg <= rep.load_max);
+	BOOST_REQUIRE(rep.imbalance >= 1.0);
+	BOOST_REQUIRE(rep.ghost_vol <= rep.ghost_vol_max);
+	BOOST_REQUIRE(rep.n_nn <= rep.n_nn_max);
+
+	if (vcl.getProcessingUnits() == 1)
+	{
+		BOOST_REQUIRE_EQUAL(rep.edge_cut_tot,0ul);
+		BOOST_REQUIRE_EQUAL(rep.ghost_vol_tot,0.0);
+	}
+	else
+	{
+		// a cut edge imply a neighborhood processor
+		BOOST_REQUIRE(rep.edge_cut_tot > 0);
+		if (rep.edge_cut != 0)
+		{BOOST_REQUIRE(rep.n_nn > 0);}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( CartDecomposition_diffuse_test )
+{
+	// Vcluster
+	Vcluster<> & vcl = create_vcluster();
+
+	// Physical domain
+	Box<3, float> box( { 0.0, 0.0, 0.0 }, { 1.0, 1.0, 1.0 });
+	size_t div[3];
+
+	size_t n_sub = vcl.getProcessingUnits() * SUB_UNIT_FACTOR;
+	for (int i = 0; i < 3; i++)
+	{div[i] = openfpm::math::round_big_2(pow(n_sub,1.0/3));}
+
+	Ghost<3, float> g(0.01);
+	size_t bc[] = { NON_PERIODIC, NON_PERIODIC, NON_PERIODIC };
+
+	CartDecomposition<3, float> dec(vcl);
+	dec.setParameters(div,box,bc,g);
+	dec.decompose();
+
+	// the sub-sub-domains of the processor 0 are 4 times heavier, so that the processor 0 is the
+	// only one with the maximum load (the graph is replicated, every processor know the owners)
+	auto & gp = dec.getDistribution().getGraph();
+	std::vector<bool> heavy(gp.getNVertex());
+
+	for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+	{heavy[i] = (gp.vertex_p<nm_v::proc_id>(i) == 0);}
+
+	auto set_costs = [&]()
+	{
+		auto & dist = dec.getDistribution();
+
+		for (size_t k = 0 ; k < dist.getNOwnerSubSubDomains() ; k++)
+		{
+			size_t i = dist.getOwnerSubSubDomain(k);
+			dec.setSubSubDomainComputationCost(i,(heavy[i] == true)?4:1);
+		}
+	};
+
+	set_costs();
+	dec_quality_report r0 = dec.getQualityReport();
+
+	bool changed = false;
+	for (size_t s = 0 ; s < 4 ; s++)
+	{
+		changed |= dec.diffuse();
+		set_costs();
+	}
+
+	dec_quality_report r1 = dec.getQualityReport();
+
+	// one processor has nothing to balance
+	if (vcl.getProcessingUnits() == 1)
+	{BOOST_REQUIRE_EQUAL(changed,false);}
+
+	// every sub-sub-domain has an owner and every processor keep some
+	size_t n_ssd = r1.n_ssd;
+	vcl.sum(n_ssd);
+	vcl.execute();
+
+	BOOST_REQUIRE_EQUAL(n_ssd,div[0]*div[1]*div[2]);
+	BOOST_REQUIRE(r1.n_ssd > 0);
+	BOOST_REQUIRE(r1.n_sub > 0);
+
+	// the sub-domains cover the sub-sub-domains of the processor
+	size_t n_cell = 0;
+	for (size_t i = 0 ; i < dec.getNSubDomain() ; i++)
+	{
+		SpaceBox<3,float> sub = dec.getSubDomain(i);
+
+		size_t n = 1;
+		for (size_t d = 0 ; d < 3 ; d++)
+		{n *= (size_t)std::round((sub.getHigh(d) - sub.getLow(d)) * div[d]);}
+
+		n_cell += n;
+	}
+
+	BOOST_REQUIRE_EQUAL(n_cell,r1.n_ssd);
+
+	// the imbalance never grow, with more than one processor the heaviest processor hand load
+	// to its neighborhood and the imbalance decrease
+	BOOST_REQUIRE(r1.imbalance <= r0.imbalance);
+	BOOST_REQUIRE(r1.load_max <= r0.load_max);
+
+	if (vcl.getProcessingUnits() > 1)
+	{
+		BOOST_REQUIRE_EQUAL(changed,true);
+		BOOST_REQUIRE(r1.imbalance < r0.imbalance);
+	}
+
+	// the moves are sent only to the neighborhood processors, after the synchronization every
+	// processor has the same graph
+	dec.diffuse_sync();
+
+	size_t chk = 0;
+	for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+	{chk += (i + 1) * gp.vertex_p<nm_v::proc_id>(i);}
+
+	size_t chk_max = chk;
+	size_t chk_min = -chk;
+	vcl.max(chk_max);
+	vcl.max(chk_min);
+	vcl.execute();
+
+	BOOST_REQUIRE_EQUAL(chk_max,chk);
+	BOOST_REQUIRE_EQUAL(-chk_min,chk);
+}
+
+BOOST_AUTO_TEST_CASE( CartDecomposition_dlb_predictor_test )
+{
+	// Vcluster
+	Vcluster<> & vcl = create_vcluster();
+
+	// the ring buffer keep the last 4 values
+	load_history lh(4);
+
+	for (size_t i = 1 ; i <= 5 ; i++)
+	{lh.add(i);}
+
+	BOOST_REQUIRE_EQUAL(lh.size(),4ul);
+	BOOST_REQUIRE_EQUAL(lh.get(0),2.0);
+	BOOST_REQUIRE_EQUAL(lh.last(),5.0);
+
+	// a linear load is predicted exactly
+	BOOST_REQUIRE_CLOSE(lh.predictLinear(1.0),6.0,0.001);
+	BOOST_REQUIRE_CLOSE(lh.predictLinear(3.0),8.0,0.001);
+	BOOST_REQUIRE_CLOSE(lh.predictExp(1.0,1.0,2.0),7.0,0.001);
+
+	// a constant load stay constant
+	load_history lc(4);
+	for (size_t i = 0 ; i < 6 ; i++)
+	{lc.add(3.0);}
+
+	BOOST_REQUIRE_CLOSE(lc.predictLinear(5.0),3.0,0.001);
+	BOOST_REQUIRE_CLOSE(lc.predictExp(0.5,0.3,5.0),3.0,0.001);
+
+	// predicted costs of a growing sub-sub-domain
+	DLB dlb(vcl);
+
+	BOOST_REQUIRE_EQUAL(dlb.addSubSubDomainCost(7,10),10ul);
+
+	dlb.setPredictor(DLB::Predictor::LINEAR_TREND,4);
+	dlb.setPredictionHorizon(2);
+
+	size_t c = 0;
+	for (size_t s = 0 ; s < 4 ; s++)
+	{
+		dlb.beginCostUpdate();
+		c = dlb.addSubSubDomainCost(7,10 + 2*s);
+
+		// the sub-sub-domain 8 leave the processor after the first update
+		if (s == 0)
+		{dlb.addSubSubDomainCost(8,1);}
+
+		dlb.endCostUpdate();
+	}
+
+	BOOST_REQUIRE_EQUAL(c,20ul);
+	BOOST_REQUIRE_EQUAL(dlb.getNCostHistories(),1ul);
+
+	// predicted step time
+	for (size_t s = 0 ; s < 4 ; s++)
+	{
+		dlb.startIteration(0);
+		dlb.endIteration(10 + 10*s);
+	}
+
+	BOOST_REQUIRE_CLOSE(dlb.getPredictedStepTime(),50.0,0.001);
+
+	// the decomposition use the predicted costs
+	Box<3, float> box( { 0.0, 0.0, 0.0 }, { 1.0, 1.0, 1.0 });
+	size_t div[3];
+
+	size_t n_sub = vcl.getProcessingUnits() * SUB_UNIT_FACTOR;
+	for (int i = 0; i < 3; i++)
+	{div[i] = openfpm::math::round_big_2(pow(n_sub,1.0/3));}
+
+	Ghost<3, float> g(0.01);
+	size_t bc[] = { NON_PERIODIC, NON_PERIODIC, NON_PERIODIC };
+
+	CartDecomposition<3, float> dec(vcl);
+	dec.setParameters(div,box,bc,g);
+	dec.decompose();
+
+	DLB dlb_d(vcl);
+	dlb_d.setPredictor(DLB::Predictor::LINEAR_TREND,4);
+
+	auto & dist = dec.getDistribution();
+
+	for (size_t s = 0 ; s < 3 ; s++)
+	{
+		for (size_t k = 0 ; k < dist.getNOwnerSubSubDomains() ; k++)
+		{dec.setSubSubDomainComputationCost(dist.getOwnerSubSubDomain(k),1 + s);}
+
+		dec.predictComputationCosts(dlb_d);
+	}
+
+	for (size_t k = 0 ; k < dist.getNOwnerSubSubDomains() ; k++)
+	{BOOST_REQUIRE_EQUAL(dec.getSubSubDomainComputationCost(dist.getOwnerSubSubDomain(k)),4ul);}
+}
+
+BOOST_AUTO_TEST_CASE( CartDecomposition_box_bin_index_test )
+{
+	openfpm::vector<Box<3,float>> bx;
+
+	for (size_t i = 0 ; i < 1000 ; i++)
+	{
+		Box<3,float> b;
+
+		for (size_t d = 0 ; d < 3 ; d++)
+		{
+			float l = (float)rand() / RAND_MAX;
+			b.setLow(d,l);
+			b.setHigh(d,l + 0.1 * (float)rand() / RAND_MAX);
+		}
+
+		bx.add(b);
+	}
+
+	// a box touching exactly another one
+	Box<3,float> bt = bx.get(0);
+	bt.setLow(0,bx.get(0).getHigh(0));
+	bt.setHigh(0,bx.get(0).getHigh(0) + 0.05);
+	bx.add(bt);
+
+	box_bin_index<3,float> idx;
+	idx.build(bx);
+
+	BOOST_REQUIRE_EQUAL(idx.size(),bx.size());
+
+	openfpm::vector<size_t> cand;
+
+	for (size_t q = 0 ; q < 200 ; q++)
+	{
+		Box<3,float> qb = (q == 0)?bx.get(0):bx.get(rand() % bx.size());
+		qb.enlarge(Ghost<3,float>(0.02));
+
+		idx.query(qb,cand);
+
+		// sorted without repetitions
+		for (size_t k = 1 ; k < cand.size() ; k++)
+		{BOOST_REQUIRE(cand.get(k-1) < cand.get(k));}
+
+		// every intersecting box is a candidate
+		size_t k = 0;
+		for (size_t j = 0 ; j < bx.size() ; j++)
+		{
+			Box<3,float> bi;
+			if (qb.Intersect(bx.get(j),bi) == false)
+			{continue;}
+
+			while (k < cand.size() && cand.get(k) < j)	{k++;}
+
+			BOOST_REQUIRE(k < cand.size());
+			BOOST_REQUIRE_EQUAL(cand.get(k),j);
+		}
+	}
+
+	// query outside
+	idx.query(Box<3,float>({5.0,5.0,5.0},{6.0,6.0,6.0}),cand);
+	BOOST_REQUIRE_EQUAL(cand.size(),0ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,542 @@
+/*
+ * CartesianGraphImplicit.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_GRAPH_CARTESIANGRAPHIMPLICIT_HPP_
+#define SRC_GRAPH_CARTESIANGRAPHIMPLICIT_HPP_
+
+#include <vector>
+#include <algorithm>
+#include "Grid/grid_sm.hpp"
+#include "Space/Shape/Box.hpp"
+#include "Space/Shape/HyperCube.hpp"
+#include "SubdomainGraphNodes.hpp"
+#include "util/thread_pool.hpp"
+
+/*! \brief Cartesian sub-sub-domain graph with neighborhood computed from the grid index
+ *
+ * It expose the same interface of Graph_CSR used by the decomposition (vertex, getNChilds,
+ * getChild, getChildEdge, getNVertex, getNEdge), so that Metis and Parmetis can use it in
+ * place of the graph. The vertices (properties) are stored in a Graph_CSR without edges.
+ * In implicit mode the children of a vertex are the face neighborhood in the order produced
+ * by CartesianGraphFactory, computed on the fly (without self and duplicated edges in periodic
+ * directions with one or two sub-sub-domains), and the communication weight of the edges is a
+ * single value (setAllEdges) until a weight is set on one edge (then a weight for each edge is
+ * stored, n_vertex * 2*dim). Otherwise every call is forwarded to the graph.
+ *
+ * \tparam dim dimensionality
+ * \tparam Graph graph storing the vertices
+ *
+ */
+template<unsigned int dim, typename Graph>
+class CartesianGraphImplicit
+{
+	//! graph storing the vertices (and the edges if not implicit)
+	Graph * g = NULL;
+
+	//! true if the edges are computed from the grid
+	bool implicit = false;
+
+	//! grid of the sub-sub-domains
+	grid_sm<dim,void> gr;
+
+	//! boundary conditions
+	size_t bc[dim];
+
+	//! face neighborhood (same order of CartesianGraphFactory)
+	std::vector<comb<dim>> cmb;
+
+	//! communication weight of all the edges
+	size_t e_uni = 1;
+
+	//! communication weight of each edge (n_vertex * cmb.size()), empty if all are e_uni
+	openfpm::vector<size_t> e_w;
+
+	//! number of threads used to create the graph
+	size_t n_thr = 1;
+
+	/*! \brief Get the neighborhood of a vertex in direction j
+	 *
+	 * \param key vertex position
+	 * \param j direction
+	 * \param child neighborhood vertex
+	 *
+	 * \return false if the neighborhood does not exist
+	 *
+	 */
+	inline bool child_dir(const grid_key_dx<dim> & key, size_t j, size_t & child) const
+	{
+		grid_key_dx<dim> kc;
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			long int k = key.get(d) + cmb[j][d];
+			long int sz = gr.size(d);
+
+			if (k < 0 || k >= sz)
+			{
+				if (bc[d] == NON_PERIODIC)
+				{return false;}
+
+				k = (k + sz) % sz;
+			}
+
+			kc.set_d(d,k);
+		}
+
+		child = gr.LinId(kc);
+		return true;
+	}
+
+	/*! \brief Get the children of a vertex
+	 *
+	 * In a periodic direction with one sub-sub-domain the neighborhood is the vertex itself and with two
+	 * sub-sub-domains the two faces have the same neighborhood, self and duplicated edges are skipped
+	 *
+	 * \param v vertex
+	 * \param child children
+	 * \param slot direction of each child
+	 *
+	 * \return the number of children
+	 *
+	 */
+	inline size_t children(size_t v, size_t (& child)[2*dim], size_t (& slot)[2*dim]) const
+	{
+		grid_key_dx<dim> key = gr.InvLinId(v);
+		size_t n = 0;
+
+		for (size_t j = 0 ; j < cmb.size() ; j++)
+		{
+			size_t c;
+
+			if (child_dir(key,j,c) == false || c == v)
+			{continue;}
+
+			bool dup = false;
+			for (size_t k = 0 ; k < n ; k++)
+			{dup |= (child[k] == c);}
+
+			if (dup == true)
+			{continue;}
+
+			child[n] = c;
+			slot[n] = j;
+			n++;
+		}
+
+		return n;
+	}
+
+	/*! \brief Get the direction of the i-th child of a vertex
+	 *
+	 * \param v vertex
+	 * \param i child (it must exist, i < getNChilds(v))
+	 *
+	 * \return the direction
+	 *
+	 */
+	inline size_t child_slot(size_t v, size_t i) const
+	{
+		size_t child[2*dim];
+		size_t slot[2*dim];
+
+		children(v,child,slot);
+
+		return slot[i];
+	}
+
+public:
+
+	/*! \brief Communication weight of an edge (read only), same usage of the Graph_CSR edge
+	 *
+	 */
+	struct edge_w
+	{
+		//! weight
+		size_t w;
+
+		//! the only edge property available is the communication
+		template<unsigned int p> size_t get() const
+		{
+			return w;
+		}
+	};
+
+	//! Constructor
+	CartesianGraphImplicit()
+	{
+		for (size_t d = 0 ; d < dim ; d++)
+		{bc[d] = NON_PERIODIC;}
+	}
+
+	/*! \brief Set the graph storing the vertices
+	 *
+	 * \param g_ graph
+	 *
+	 */
+	void setGraph(Graph & g_)
+	{
+		g = &g_;
+	}
+
+	/*! \brief Set the grid and the boundary conditions
+	 *
+	 * \param gr_ grid of the sub-sub-domains
+	 * \param bc_ boundary conditions
+	 * \param implicit_ true to compute the edges from the grid
+	 *
+	 */
+	void setup(const grid_sm<dim,void> & gr_, const size_t (& bc_)[dim], bool implicit_)
+	{
+		gr = gr_;
+		implicit = implicit_;
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{bc[d] = bc_[d];}
+
+		HyperCube<dim> hc;
+		cmb = hc.getCombinations_R(dim-1);
+
+		e_uni = 1;
+		e_w.clear();
+	}
+
+	/*! \brief Create the vertices of the Cartesian graph (without edges) in parallel
+	 *
+	 * The vertex properties are the ones of CartesianGraphFactory with nm_v vertices: position
+	 * (x), id and global_id equal to the vertex index, the others are zero (sub_id -1)
+	 *
+	 * \param dom domain
+	 * \param n_slot edges reserved for each vertex
+	 *
+	 */
+	template<typename T> void createVertices(const Box<dim,T> & dom, size_t n_slot = 1)
+	{
+		Graph gn(gr.size(),n_slot);
+		g->swap(gn);
+
+		T szd[dim];
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{szd[d] = (dom.getHigh(d) - dom.getLow(d)) / gr.size(d);}
+
+		Graph & gv = *g;
+		const grid_sm<dim,void> & grv = gr;
+
+		size_t nv = gr.size();
+		size_t n_t = (n_thr > nv)?1:n_thr;
+		size_t chunk = (nv + n_t - 1) / n_t;
+
+		run_threads(n_t,[&](size_t t)
+		{
+			size_t stop = std::min(nv,(t+1)*chunk);
+			for (size_t i = t*chunk ; i < stop ; i++)
+			{
+				grid_key_dx<dim> key = grv.InvLinId(i);
+				auto v = gv.vertex(i);
+
+				for (size_t d = 0 ; d < 3 ; d++)
+				{v.template get<nm_v::x>()[d] = (d < dim)?key.get(d) * szd[d]:0.0;}
+
+				v.template get<nm_v::migration>() = 0;
+				v.template get<nm_v::computation>() = 0;
+				v.template get<nm_v::global_id>() = i;
+				v.template get<nm_v::id>() = i;
+				v.template get<nm_v::sub_id>() = -1;
+				v.template get<nm_v::proc_id>() = 0;
+			}
+		});
+	}
+
+	/*! \brief Create the Cartesian graph with vertices and edges (materialised, not implicit)
+	 *
+	 * The vertices and the neighborhood of every vertex are computed in parallel, the edges are then
+	 * appended in the vertex order (Graph_CSR does not support concurrent insertion). The graph is
+	 * the one of CartesianGraphFactory without self and duplicated edges (see children)
+	 *
+	 * \param dom domain
+	 *
+	 */
+	template<typename T> void createGraph(const Box<dim,T> & dom)
+	{
+		createVertices(dom,2*dim);
+
+		size_t nv = gr.size();
+		size_t n_t = (n_thr > nv)?1:n_thr;
+		size_t chunk = (nv + n_t - 1) / n_t;
+
+		std::vector<size_t> nc(nv);
+		std::vector<size_t> ch(nv*2*dim);
+
+		run_threads(n_t,[&](size_t t)
+		{
+			size_t stop = std::min(nv,(t+1)*chunk);
+			for (size_t i = t*chunk ; i < stop ; i++)
+			{
+				size_t child[2*dim];
+				size_t slot[2*dim];
+
+				nc[i] = children(i,child,slot);
+
+				for (size_t k = 0 ; k < nc[i] ; k++)
+				{ch[i*2*dim + k] = child[k];}
+			}
+		});
+
+		for (size_t i = 0 ; i < nv ; i++)
+		{
+			for (size_t k = 0 ; k < nc[i] ; k++)
+			{g->addEdge(i,ch[i*2*dim + k]);}
+		}
+	}
+
+	/*! \brief Set the number of threads used to create the graph
+	 *
+	 * \param n number of threads
+	 *
+	 */
+	void setNThreads(size_t n)
+	{
+		n_thr = (n == 0)?1:n;
+	}
+
+	/*! \brief Get the number of threads used to create the graph
+	 *
+	 * \return the number of threads
+	 *
+	 */
+	size_t getNThreads() const
+	{
+		return n_thr;
+	}
+
+	/*! \brief Check if the edges are computed from the grid
+	 *
+	 * \return true if implicit
+	 *
+	 */
+	bool isImplicit() const
+	{
+		return implicit;
+	}
+
+	/*! \brief Get the number of vertices
+	 *
+	 * \return the number of vertices
+	 *
+	 */
+	size_t getNVertex() const
+	{
+		return g->getNVertex();
+	}
+
+	/*! \brief Get the number of edges
+	 *
+	 * \return the number of edges
+	 *
+	 */
+	size_t getNEdge() const
+	{
+		if (implicit == false)
+		{return g->getNEdge();}
+
+		size_t ne = 0;
+
+		// the first direction met for each dimension
+		bool seen[dim];
+		for (size_t d = 0 ; d < dim ; d++)
+		{seen[d] = false;}
+
+		for (size_t j = 0 ; j < cmb.size() ; j++)
+		{
+			size_t n = 1;
+
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				if (cmb[j][d] == 0)
+				{
+					n *= gr.size(d);
+					continue;
+				}
+
+				// no self edges (one sub-sub-domain), the two faces have the same neighborhood with two
+				if (bc[d] == NON_PERIODIC || gr.size(d) == 1)
+				{n *= gr.size(d)-1;}
+				else if (gr.size(d) == 2)
+				{n *= (seen[d] == false)?2:0;}
+				else
+				{n *= gr.size(d);}
+
+				seen[d] = true;
+			}
+
+			ne += n;
+		}
+
+		return ne;
+	}
+
+	/*! \brief Get the number of children of a vertex
+	 *
+	 * \param v vertex
+	 *
+	 * \return the number of children
+	 *
+	 */
+	size_t getNChilds(size_t v) const
+	{
+		if (implicit == false)
+		{return g->getNChilds(v);}
+
+		size_t child[2*dim];
+		size_t slot[2*dim];
+
+		return children(v,child,slot);
+	}
+
+	/*! \brief Get the i-th child of a vertex
+	 *
+	 * \param v vertex
+	 * \param i child
+	 *
+	 * \return the child vertex
+	 *
+	 */
+	size_t getChild(size_t v, size_t i) const
+	{
+		if (implicit == false)
+		{return g->getChild(v,i);}
+
+		size_t child[2*dim];
+		size_t slot[2*dim];
+
+		children(v,child,slot);
+
+		return child[i];
+	}
+
+	/*! \brief Get the edge to the i-th child of a vertex
+	 *
+	 * \param v vertex
+	 * \param i child
+	 *
+	 * \return the edge weight
+	 *
+	 */
+	edge_w getChildEdge(size_t v, size_t i) const
+	{
+		edge_w e;
+
+		if (implicit == false)
+		{e.w = g->getChildEdge(v,i).template get<nm_e::communication>();}
+		else if (e_w.size() == 0)
+		{e.w = e_uni;}
+		else
+		{e.w = e_w.get(v*cmb.size() + child_slot(v,i));}
+
+		return e;
+	}
+
+	/*! \brief Set the communication weight of the edge to the i-th child of a vertex
+	 *
+	 * \param v vertex
+	 * \param i child
+	 * \param w weight
+	 *
+	 */
+	void setChildEdge(size_t v, size_t i, size_t w)
+	{
+		if (implicit == false)
+		{
+			g->getChildEdge(v,i).template get<nm_e::communication>() = w;
+			return;
+		}
+
+		if (e_w.size() == 0)
+		{
+			// a weight on one edge does not change the others, from now a weight for each edge is stored
+			if (w == e_uni)
+			{return;}
+
+			e_w.resize(g->getNVertex() * cmb.size());
+
+			for (size_t k = 0 ; k < e_w.size() ; k++)
+			{e_w.get(k) = e_uni;}
+		}
+
+		e_w.get(v*cmb.size() + child_slot(v,i)) = w;
+	}
+
+	/*! \brief Set the same communication weight on all the edges
+	 *
+	 * In implicit mode it release the weights stored for each edge
+	 *
+	 * \param w weight
+	 *
+	 */
+	void setAllEdges(size_t w)
+	{
+		if (implicit == false)
+		{
+			for (size_t v = 0 ; v < g->getNVertex() ; v++)
+			{
+				for (size_t i = 0 ; i < g->getNChilds(v) ; i++)
+				{g->getChildEdge(v,i).template get<nm_e::communication>() = w;}
+			}
+
+			return;
+		}
+
+		e_uni = w;
+		e_w.clear();
+	}
+
+	/*! \brief Check if a weight is stored for each edge
+	 *
+	 * \return true if the edge weights are stored
+	 *
+	 */
+	bool hasEdgeWeights() const
+	{
+		return e_w.size() != 0;
+	}
+
+	/*! \brief Get a vertex
+	 *
+	 * \param k vertex id or iterator
+	 *
+	 * \return the vertex
+	 *
+	 */
+	template<typename K> auto vertex(const K & k) -> decltype(g->vertex(k))
+	{
+		return g->vertex(k);
+	}
+
+	/*! \brief Get a vertex property
+	 *
+	 * \param id vertex
+	 *
+	 * \return the property
+	 *
+	 */
+	template<unsigned int p> auto vertex_p(size_t id) -> decltype(g->template vertex_p<p>(id))
+	{
+		return g->template vertex_p<p>(id);
+	}
+
+	/*! \brief Get the vertex iterator
+	 *
+	 * \return the iterator
+	 *
+	 */
+	auto getVertexIterator() const -> decltype(g->getVertexIterator())
+	{
+		return g->getVertexIterator();
+	}
+};
+
+#endif /* SRC_GRAPH_CARTESIANGRAPHIMPLICIT_HPP_ */
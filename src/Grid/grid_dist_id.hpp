@@ -1786,6 +1786,40 @@ public:
 
 		gdb_ext_old.clear();
 	}
+
+	/*! \brief Move the grid on a new decomposition
+	 *
+	 * The local grids of the new decomposition are created and filled with map() from the current ones
+	 *
+	 * \param dec_new new decomposition (same domain and boundary conditions of this grid)
+	 *
+	 */
+	void redistribute(const Decomposition & dec_new)
+	{
+		loc_grid_old.swap(loc_grid);
+		gdb_ext_old.swap(gdb_ext);
+
+		dec = dec_new.duplicate(ghost);
+
+		// the ghost boxes depend on the decomposition
+		ig_box.clear();
+		eg_box.clear();
+		loc_ig_box.clear();
+		loc_eg_box.clear();
+		g_id_to_internal_ghost_box.clear();
+		g_id_to_external_ghost_box.clear();
+
+		init_i_g_box = false;
+		init_e_g_box = false;
+		init_local_i_g_box = false;
+		init_local_e_g_box = false;
+		init_fix_ie_g_box = false;
+
+		Create();
+
+		map();
+	}
+
 	inline void save(const std::string & filename) const
 	{
 		HDF5_writer<GRID_DIST> h5s;
@@ -10,6 +10,7 @@
 
 #include "Vector/vector_dist_ofb.hpp"
 #include "Grid/copy_grid_fast.hpp"
+#include "Debug/phase_profiler.hpp"
 
 /*! \brief Unpack selector
  *
@@ -616,6 +617,91 @@ public:
 		}
 	}
 
+	/*! \brief Get the processor that store each intersection between the old local grids and the new grids
+	 *
+	 * The intersections are visited in the same order of labelIntersectionGridsProcessor. With the
+	 * distributed directory the intersections outside the local and neighborhood sub-domains are
+	 * resolved with processorIDRemote
+	 *
+	 * \warning it is collective
+	 *
+	 * \param dec Decomposition
+	 * \param cd_sm Cell-decomposer
+	 * \param gdb_ext_old information of the old local grids
+	 * \param gdb_ext_global information of the grids globaly
+	 * \param owner for each intersection the processor id
+	 *
+	 */
+	inline void intersectionGridsOwner(Decomposition & dec,
+									   CellDecomposer_sm<dim,St,shift<dim,St>> & cd_sm,
+									   openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext_old,
+									   openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext_global,
+									   openfpm::vector<size_t> & owner)
+	{
+		bool dir_mode = dec.isDistributedDirectory();
+
+		openfpm::vector<size_t> far_id;
+		openfpm::vector<Point<dim,St>> far_pos;
+
+		owner.clear();
+
+		for (size_t i = 0; i < gdb_ext_old.size(); i++)
+		{
+			// Local old sub-domain in global coordinates
+			SpaceBox<dim,long int> sub_dom = gdb_ext_old.get(i).Dbox;
+			sub_dom += gdb_ext_old.get(i).origin;
+
+			for (size_t j = 0; j < gdb_ext_global.size(); j++)
+			{
+				// Intersection box
+				SpaceBox<dim,long int> inte_box;
+
+				// Global new sub-domain in global coordinates
+				SpaceBox<dim,long int> sub_dom_new = gdb_ext_global.get(j).Dbox;
+				sub_dom_new += gdb_ext_global.get(j).origin;
+
+				bool intersect = false;
+
+				if (sub_dom.isValid() == true && sub_dom_new.isValid() == true)
+					intersect = sub_dom.Intersect(sub_dom_new, inte_box);
+
+				if (intersect == false)
+				{continue;}
+
+				auto inte_box_cont = cd_sm.convertCellUnitsIntoDomainSpace(inte_box);
+
+				// Get processor ID that store intersection box
+				Point<dim,St> p;
+				for (size_t n = 0; n < dim; n++)
+					p.get(n) = (inte_box_cont.getHigh(n) + inte_box_cont.getLow(n))/2;
+
+				if (dir_mode == true)
+				{
+					long int lp = dec.processorIDLocal(p);
+
+					if (lp == -1)
+					{
+						far_id.add(owner.size());
+						far_pos.add(p);
+					}
+
+					owner.add(lp);
+				}
+				else
+				{owner.add(dec.processorID(p));}
+			}
+		}
+
+		if (dir_mode == true)
+		{
+			openfpm::vector<size_t> far_prc;
+			dec.processorIDRemote(far_pos,far_prc);
+
+			for (size_t i = 0 ; i < far_id.size() ; i++)
+			{owner.get(far_id.get(i)) = far_prc.get(i);}
+		}
+	}
+
 	/*! \brief Label intersection grids for mappings
 	 *
 	 * \param dec Decomposition
@@ -640,6 +726,10 @@ public:
 		// resize the label buffer
 		lbl_b.resize(v_cl.getProcessingUnits());
 
+		// processor that store each intersection
+		openfpm::vector<size_t> owner;
+		intersectionGridsOwner(dec,cd_sm,gdb_ext_old,gdb_ext_global,owner);
+
 		size_t count2 = 0;
 
 		// Label all the intersection grids with the processor id where they should go
@@ -668,15 +758,10 @@ public:
 
 				if (intersect == true)
 				{
-					count2++;
-					auto inte_box_cont = cd_sm.convertCellUnitsIntoDomainSpace(inte_box);
-
 					// Get processor ID that store intersection box
-					Point<dim,St> p;
-					for (size_t n = 0; n < dim; n++)
-						p.get(n) = (inte_box_cont.getHigh(n) + inte_box_cont.getLow(n))/2;
+					p_id = owner.get(count2);
+					count2++;
 
-					p_id = dec.processorID(p);
 					prc_sz.get(p_id)++;
 
 					// Transform coordinates to local
@@ -760,11 +845,15 @@ public:
 			  openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext_old,
 			  openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext_global)
 	{
+		prof_region prof_t(PROF_GRID_MAP,PROF_TOTAL);
+
 		// Processor communication size
 		openfpm::vector<size_t> prc_sz(v_cl.getProcessingUnits());
 
 		// Contains the processor id of each box (basically where they have to go)
+		prof_region prof_l(PROF_GRID_MAP,PROF_LABEL);
 		labelIntersectionGridsProcessor(dec,cd_sm,loc_grid_old,gdb_ext,gdb_ext_old,gdb_ext_global,m_oGrid,prc_sz);
+		prof_l.stop();
 
 		// Calculate the sending buffer size for each processor, put this information in
 		// a contiguous buffer
@@ -796,9 +885,33 @@ public:
 		openfpm::vector<openfpm::vector<aggregate<device_grid,SpaceBox<dim,long int>>>> m_oGrid_recv;
 
 		// Send and recieve intersection grids
+		prof_region prof_c(PROF_GRID_MAP,PROF_COMM);
 		v_cl.SSendRecv(m_oGrid_new,m_oGrid_recv,prc_r,prc_recv_map,recv_sz_map);
+		prof_c.stop();
+
+		typedef openfpm::vector<aggregate<device_grid,SpaceBox<dim,long int>>> grid_msg;
+
+		// grid pieces and bytes (serialized) sent and received
+		size_t n_sent = 0;
+		size_t b_sent = 0;
+		for (size_t i = 0 ; i < m_oGrid_new.size() ; i++)
+		{
+			n_sent += m_oGrid_new.get(i).size();
+			Packer<grid_msg,HeapMemory>::packRequest(m_oGrid_new.get(i),b_sent);
+		}
+
+		size_t n_recv = 0;
+		size_t b_recv = 0;
+		for (size_t i = 0 ; i < m_oGrid_recv.size() ; i++)
+		{
+			n_recv += m_oGrid_recv.get(i).size();
+			Packer<grid_msg,HeapMemory>::packRequest(m_oGrid_recv.get(i),b_recv);
+		}
+
+		openfpm_profiler().add_comm(PROF_GRID_MAP,b_sent,b_recv,prc_r.size(),prc_recv_map.size(),n_sent,n_recv);
 
 		// Reconstruct the new local grids
+		prof_region prof_u(PROF_GRID_MAP,PROF_UNPACK);
 		grids_reconstruct(m_oGrid_recv,loc_grid,gdb_ext,cd_sm);
 	}
 
@@ -825,21 +938,36 @@ public:
 		SCOREP_USER_REGION("ghost_get",SCOREP_USER_REGION_TYPE_FUNCTION)
 #endif
 
+		prof_region prof_t(PROF_GRID_GHOST_GET,PROF_TOTAL);
+
 		size_t req = 0;
 
 		ExtPreAlloc<Memory> * prRecv_prp = NULL;
 		ExtPreAlloc<Memory> * prAlloc_prp = NULL;
 
+		prof_region prof_p(PROF_GRID_GHOST_GET,PROF_PACK);
+
 		if (v_cl.getProcessingUnits() != 1)
-		{send_and_receive_ghost<prp...>(&prAlloc_prp,&prRecv_prp, ig_box,eg_box,gdb_ext,loc_grid,req);}
+		{
+			send_and_receive_ghost<prp...>(&prAlloc_prp,&prRecv_prp, ig_box,eg_box,gdb_ext,loc_grid,req);
+			openfpm_profiler().add_comm(PROF_GRID_GHOST_GET,req,g_recv_prp_mem.size(),ig_box.size(),eg_box.size(),0,0);
+		}
+
+		prof_p.stop();
 
 		// Before wait for the communication to complete we sync the local ghost
 		// in order to overlap with communication
 
+		prof_region prof_lc(PROF_GRID_GHOST_GET,PROF_LOCAL);
 		ghost_get_local<prp...>(loc_ig_box,loc_eg_box,gdb_ext,loc_grid,g_id_to_external_ghost_box);
+		prof_lc.stop();
 
 		// wait to receive communication
+		prof_region prof_c(PROF_GRID_GHOST_GET,PROF_COMM);
 		v_cl.execute();
+		prof_c.stop();
+
+		prof_region prof_u(PROF_GRID_GHOST_GET,PROF_UNPACK);
 
 		if (v_cl.getProcessingUnits() != 1)
 		{process_received<prp...>(prRecv_prp,eg_box,loc_grid,g_id_to_external_ghost_box);}
@@ -1965,6 +1965,69 @@ BOOST_AUTO_TEST_CASE ( grid_overflow_round_off_error )
     BOOST_REQUIRE_EQUAL(match,true);
 }
 
+BOOST_AUTO_TEST_CASE ( grid_dist_id_redistribute )
+{
+	size_t sz[3] = {32,32,32};
+	periodicity<3> bc = {{PERIODIC,PERIODIC,PERIODIC}};
+
+	Ghost<3,long int> g(1);
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	grid_dist_id<3, float, aggregate<size_t>> grid(sz,domain,g,bc);
+
+	auto & gs = grid.getGridInfo();
+
+	auto it = grid.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto p = it.get();
+		grid.get<0>(p) = gs.LinId(it.getGKey(p));
+
+		++it;
+	}
+
+	// decomposition with the cost concentrated in the lower half
+	auto dec = grid.getDecomposition().duplicate();
+
+	for (size_t i = 0 ; i < dec.getNSubSubDomains() ; i++)
+	{
+		float pos[3];
+		dec.getSubSubDomainPosition(i,pos);
+
+		dec.setSubSubDomainComputationCost(i,(pos[0] < 0.5)?8:1);
+	}
+
+	dec.decompose();
+
+	grid.redistribute(dec);
+
+	size_t cnt = 0;
+	bool match = true;
+
+	auto it2 = grid.getDomainIterator();
+
+	while (it2.isNext())
+	{
+		auto p = it2.get();
+
+		match &= grid.get<0>(p) == gs.LinId(it2.getGKey(p));
+		cnt++;
+
+		++it2;
+	}
+
+	auto & v_cl = create_vcluster();
+	v_cl.sum(cnt);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(match,true);
+	BOOST_REQUIRE_EQUAL(cnt,(size_t)32*32*32);
+
+	// the ghost follow the new decomposition
+	grid.ghost_get<0>();
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
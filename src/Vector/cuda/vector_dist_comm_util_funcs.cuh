@@ -18,6 +18,9 @@
 
 #define RUN_ON_DEVICE 1024
 #define MAP_LOCAL 2
+#define MAP_SFC_ORDER 4096
+#define GHOST_DELTA 8192
+#define MAP_NBX 16384
 
 #define SKIP_LABELLING 512
 #define KEEP_PROPERTIES 512
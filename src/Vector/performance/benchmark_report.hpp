@@ -0,0 +1,450 @@
+/*
+ * benchmark_report.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_VECTOR_PERFORMANCE_BENCHMARK_REPORT_HPP_
+#define SRC_VECTOR_PERFORMANCE_BENCHMARK_REPORT_HPP_
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include "Vector/map_vector.hpp"
+
+// generated at build time by the benchmark runner build
+#ifdef HAVE_BENCHMARK_GIT_HASH
+#include "benchmark_git_hash.h"
+#endif
+
+#ifndef OPENFPM_GIT_HASH
+#define OPENFPM_GIT_HASH "unknown"
+#endif
+
+/*! \brief One measurement of a benchmark (a test at a given problem size)
+ *
+ */
+struct benchmark_record
+{
+	//! name of the test
+	std::string test;
+
+	//! name of the measured quantity inside the test
+	std::string name;
+
+	//! problem size
+	size_t size;
+
+	//! number of processors
+	size_t n_ranks;
+
+	//! number of samples
+	size_t n_samples;
+
+	//! mean
+	double mean;
+
+	//! standard deviation
+	double dev;
+
+	//! git hash of the source
+	std::string git_hash;
+};
+
+/*! \brief Result of the comparison of a record with the baseline
+ *
+ */
+struct benchmark_compare_result
+{
+	//! record compared
+	benchmark_record rec;
+
+	//! baseline mean
+	double base_mean;
+
+	//! baseline standard deviation
+	double base_dev;
+
+	//! Welch t statistic (positive means slower)
+	double t;
+
+	//! relative change of the mean (positive means slower)
+	double rel;
+
+	//! true if it is a statistically significant regression
+	bool regression;
+
+	//! true if the record or the baseline has less than two samples (no t statistic)
+	bool insufficient;
+};
+
+/*! \brief Collect the benchmark results and write them in a machine readable format (JSON/CSV)
+ *
+ * A report can be loaded back from CSV and used as baseline. compare() flag a regression when the mean is
+ * slower than the baseline by more than min_rel and the Welch t statistic exceed t_crit. Records (or baselines)
+ * with less than two samples have no deviation and are reported as insufficient samples, never as regression
+ *
+ * \snippet pdata_benchmark.cpp benchmark report usage
+ *
+ */
+class benchmark_report
+{
+	//! all the records
+	openfpm::vector<benchmark_record> recs;
+
+	/*! \brief Escape a string for JSON
+	 *
+	 * \param str string
+	 *
+	 * \return the escaped string
+	 *
+	 */
+	static std::string json_escape(const std::string & str)
+	{
+		std::string out;
+
+		for (size_t i = 0 ; i < str.size() ; i++)
+		{
+			if (str[i] == '"' || str[i] == '\\')
+			{out += '\\';}
+			out += str[i];
+		}
+
+		return out;
+	}
+
+	/*! \brief Quote a string for CSV
+	 *
+	 * \param str string
+	 *
+	 * \return the quoted string
+	 *
+	 */
+	static std::string csv_quote(const std::string & str)
+	{
+		std::string out("\"");
+
+		for (size_t i = 0 ; i < str.size() ; i++)
+		{
+			if (str[i] == '"')
+			{out += '"';}
+			out += str[i];
+		}
+
+		return out + "\"";
+	}
+
+	/*! \brief Split a CSV line into fields
+	 *
+	 * \param line line
+	 * \param fields output fields
+	 *
+	 */
+	static void csv_split(const std::string & line, openfpm::vector<std::string> & fields)
+	{
+		fields.clear();
+		std::string cur;
+		bool quoted = false;
+
+		for (size_t i = 0 ; i < line.size() ; i++)
+		{
+			char c = line[i];
+
+			if (quoted == true)
+			{
+				if (c == '"' && i+1 < line.size() && line[i+1] == '"')
+				{cur += '"'; i++;}
+				else if (c == '"')
+				{quoted = false;}
+				else
+				{cur += c;}
+			}
+			else if (c == '"')
+			{quoted = true;}
+			else if (c == ',')
+			{fields.add(cur); cur.clear();}
+			else if (c != '\r')
+			{cur += c;}
+		}
+
+		fields.add(cur);
+	}
+
+	/*! \brief Find a record with the same test, name, size and number of processors
+	 *
+	 * \param r record to search
+	 *
+	 * \return the index of the record or -1 if not found
+	 *
+	 */
+	long int find(const benchmark_record & r) const
+	{
+		for (size_t i = 0 ; i < recs.size() ; i++)
+		{
+			const benchmark_record & b = recs.get(i);
+
+			if (b.test == r.test && b.name == r.name && b.size == r.size && b.n_ranks == r.n_ranks)
+			{return i;}
+		}
+
+		return -1;
+	}
+
+public:
+
+	/*! \brief Add a record from the samples
+	 *
+	 * \param test name of the test
+	 * \param name name of the measured quantity
+	 * \param size problem size
+	 * \param n_ranks number of processors
+	 * \param measures samples
+	 *
+	 */
+	void add(const std::string & test, const std::string & name, size_t size, size_t n_ranks, const openfpm::vector<double> & measures)
+	{
+		double mean = 0.0;
+		double dev = 0.0;
+
+		for (size_t i = 0 ; i < measures.size() ; i++)
+		{mean += measures.get(i);}
+
+		if (measures.size() != 0)
+		{mean /= measures.size();}
+
+		for (size_t i = 0 ; i < measures.size() ; i++)
+		{dev += (measures.get(i) - mean)*(measures.get(i) - mean);}
+
+		if (measures.size() > 1)
+		{dev = sqrt(dev / (measures.size() - 1));}
+
+		add(test,name,size,n_ranks,measures.size(),mean,dev);
+	}
+
+	/*! \brief Add a record from already computed statistics
+	 *
+	 * \param test name of the test
+	 * \param name name of the measured quantity
+	 * \param size problem size
+	 * \param n_ranks number of processors
+	 * \param n_samples number of samples
+	 * \param mean mean
+	 * \param dev standard deviation
+	 *
+	 */
+	void add(const std::string & test, const std::string & name, size_t size, size_t n_ranks, size_t n_samples, double mean, double dev)
+	{
+		recs.add();
+		benchmark_record & r = recs.last();
+
+		r.test = test;
+		r.name = name;
+		r.size = size;
+		r.n_ranks = n_ranks;
+		r.n_samples = n_samples;
+		r.mean = mean;
+		r.dev = dev;
+		r.git_hash = OPENFPM_GIT_HASH;
+	}
+
+	/*! \brief Return the number of records
+	 *
+	 * \return the number of records
+	 *
+	 */
+	size_t size() const
+	{
+		return recs.size();
+	}
+
+	/*! \brief Get a record
+	 *
+	 * \param i record
+	 *
+	 * \return the record
+	 *
+	 */
+	const benchmark_record & get(size_t i) const
+	{
+		return recs.get(i);
+	}
+
+	//! Remove all the records
+	void clear()
+	{
+		recs.clear();
+	}
+
+	/*! \brief Write the report in JSON format
+	 *
+	 * \param out stream
+	 *
+	 */
+	void write_json(std::ostream & out) const
+	{
+		out << "{\n  \"git_hash\": \"" << json_escape(OPENFPM_GIT_HASH) << "\",\n  \"results\": [";
+
+		for (size_t i = 0 ; i < recs.size() ; i++)
+		{
+			const benchmark_record & r = recs.get(i);
+
+			out << ((i == 0)?"\n":",\n") << "    {\"test\": \"" << json_escape(r.test) << "\", \"name\": \"" << json_escape(r.name)
+			    << "\", \"size\": " << r.size << ", \"n_ranks\": " << r.n_ranks << ", \"n_samples\": " << r.n_samples
+			    << ", \"mean\": " << r.mean << ", \"stddev\": " << r.dev << ", \"git_hash\": \"" << json_escape(r.git_hash) << "\"}";
+		}
+
+		out << "\n  ]\n}\n";
+	}
+
+	/*! \brief Write the report in CSV format
+	 *
+	 * \param out stream
+	 *
+	 */
+	void write_csv(std::ostream & out) const
+	{
+		out << "test,name,size,n_ranks,n_samples,mean,stddev,git_hash\n";
+
+		for (size_t i = 0 ; i < recs.size() ; i++)
+		{
+			const benchmark_record & r = recs.get(i);
+
+			out << csv_quote(r.test) << "," << csv_quote(r.name) << "," << r.size << "," << r.n_ranks << "," << r.n_samples
+			    << "," << r.mean << "," << r.dev << "," << csv_quote(r.git_hash) << "\n";
+		}
+	}
+
+	/*! \brief Write the report on file, the format is selected from the extension (.json or .csv)
+	 *
+	 * \param file output file
+	 *
+	 * \return true if succeed
+	 *
+	 */
+	bool write(const std::string & file) const
+	{
+		std::ofstream out(file);
+
+		if (out.is_open() == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error cannot open the file " << file << std::endl;
+			return false;
+		}
+
+		out.precision(10);
+
+		if (file.size() >= 4 && file.compare(file.size() - 4,4,".csv") == 0)
+		{write_csv(out);}
+		else
+		{write_json(out);}
+
+		return true;
+	}
+
+	/*! \brief Load a report from a CSV file written with write_csv
+	 *
+	 * \param file input file
+	 *
+	 * \return true if succeed
+	 *
+	 */
+	bool load_csv(const std::string & file)
+	{
+		std::ifstream in(file);
+
+		if (in.is_open() == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error cannot open the file " << file << std::endl;
+			return false;
+		}
+
+		std::string line;
+		openfpm::vector<std::string> fields;
+
+		// skip the header
+		std::getline(in,line);
+
+		while (std::getline(in,line))
+		{
+			if (line.size() == 0)
+			{continue;}
+
+			csv_split(line,fields);
+
+			if (fields.size() != 8)
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " error malformed line in " << file << ": " << line << std::endl;
+				return false;
+			}
+
+			add(fields.get(0),fields.get(1),std::stoul(fields.get(2)),std::stoul(fields.get(3)),std::stoul(fields.get(4)),std::stod(fields.get(5)),std::stod(fields.get(6)));
+			recs.last().git_hash = fields.get(7);
+		}
+
+		return true;
+	}
+
+	/*! \brief Compare this report with a baseline
+	 *
+	 * Records not present in the baseline are skipped
+	 *
+	 * \param base baseline
+	 * \param res result of the comparison for each record found in the baseline
+	 * \param t_crit critical value of the Welch t statistic
+	 * \param min_rel minimum relative slow-down to consider a regression
+	 *
+	 * \return the number of regressions
+	 *
+	 */
+	size_t compare(const benchmark_report & base, openfpm::vector<benchmark_compare_result> & res, double t_crit = 3.0, double min_rel = 0.05) const
+	{
+		size_t n_reg = 0;
+		res.clear();
+
+		for (size_t i = 0 ; i < recs.size() ; i++)
+		{
+			const benchmark_record & r = recs.get(i);
+			long int j = base.find(r);
+
+			if (j == -1)
+			{continue;}
+
+			const benchmark_record & b = base.recs.get(j);
+
+			res.add();
+			benchmark_compare_result & c = res.last();
+
+			c.rec = r;
+			c.base_mean = b.mean;
+			c.base_dev = b.dev;
+			c.rel = (b.mean != 0.0)?(r.mean - b.mean) / b.mean:0.0;
+			c.insufficient = (r.n_samples < 2 || b.n_samples < 2);
+
+			if (c.insufficient == true)
+			{
+				c.t = 0.0;
+				c.regression = false;
+				continue;
+			}
+
+			double var = r.dev*r.dev / r.n_samples + b.dev*b.dev / b.n_samples;
+
+			// with a deviation of zero (identical samples) any slow-down is significant
+			if (var != 0.0)
+			{c.t = (r.mean - b.mean) / sqrt(var);}
+			else
+			{c.t = (r.mean > b.mean)?INFINITY:0.0;}
+
+			c.regression = (c.t > t_crit && c.rel > min_rel);
+
+			if (c.regression == true)
+			{n_reg++;}
+		}
+
+		return n_reg;
+	}
+};
+
+#endif /* SRC_VECTOR_PERFORMANCE_BENCHMARK_REPORT_HPP_ */
@@ -0,0 +1,434 @@
+/*
+ * comm_scaling_benchmarks.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ *
+ * Weak and strong scaling benchmarks of the communication layer (vector_dist map/ghost_get/ghost_put
+ * and grid_dist_id ghost_get/map). They are driven by pdata_bench: running the same command line
+ * with mpirun -np N for different N give weak scaling (--weak, sizes per processor) or strong scaling
+ * (fixed total sizes)
+ *
+ */
+
+#ifndef SRC_VECTOR_PERFORMANCE_COMM_SCALING_BENCHMARKS_HPP_
+#define SRC_VECTOR_PERFORMANCE_COMM_SCALING_BENCHMARKS_HPP_
+
+#include "Vector/vector_dist.hpp"
+#include "Grid/grid_dist_id.hpp"
+#include "Debug/phase_profiler.hpp"
+#include "Vector/performance/vector_dist_performance_util.hpp"
+#include "Vector/performance/benchmark_report.hpp"
+
+/*! \brief Parameters of a communication benchmark
+ *
+ */
+struct comm_bench_param
+{
+	//! total number of particles (or grid points)
+	size_t np;
+
+	//! number of samples
+	size_t n_samples;
+
+	//! average number of neighborhood particles (it define the cut-off radius)
+	double n_nn;
+
+	//! ghost widths as multiple of the cut-off radius
+	openfpm::vector<double> ghost;
+
+	//! movement amplitudes as multiple of the cut-off radius
+	openfpm::vector<double> move;
+
+	/*! \brief Cut-off radius such that on average every particle has n_nn neighborhood particles
+	 *
+	 * \return the cut-off radius
+	 *
+	 */
+	float r_cut() const
+	{
+		return pow(3.0 * n_nn / (4.0 * M_PI * np),1.0/3.0);
+	}
+};
+
+/*! \brief Collect, for every sample, the time breakdown and the communication volume of a phase
+ *
+ * Times are the maximum across processors, bytes/messages/particles are reported per processor
+ * (average and maximum)
+ *
+ */
+class comm_sample_stats
+{
+	//! name of the quantities
+	openfpm::vector<std::string> names;
+
+	//! samples of each quantity
+	openfpm::vector<openfpm::vector<double>> val;
+
+	/*! \brief Add a sample to a quantity
+	 *
+	 * \param name quantity
+	 * \param v value
+	 *
+	 */
+	void add(const std::string & name, double v)
+	{
+		for (size_t i = 0 ; i < names.size() ; i++)
+		{
+			if (names.get(i) == name)
+			{
+				val.get(i).add(v);
+				return;
+			}
+		}
+
+		names.add(name);
+		val.add();
+		val.last().add(v);
+	}
+
+public:
+
+	/*! \brief Add a sample from the current content of the profiler (collective)
+	 *
+	 * \param ph phase
+	 * \param wct wall-clock time of the call on this processor
+	 *
+	 */
+	void sample(prof_phase ph, double wct)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+		const prof_phase_stat & st = openfpm_profiler().get(ph);
+
+		double t[PROF_N_SUB];
+		for (size_t i = 0 ; i < PROF_N_SUB ; i++)
+		{
+			t[i] = st.time[i];
+			v_cl.max(t[i]);
+		}
+
+		v_cl.max(wct);
+
+		size_t bs = st.cnt[PROF_BYTES_SENT];
+		size_t bs_max = bs;
+		size_t ms = st.cnt[PROF_MSG_SENT];
+		size_t ms_max = ms;
+		size_t ps = st.cnt[PROF_PART_SENT];
+
+		v_cl.sum(bs);
+		v_cl.max(bs_max);
+		v_cl.sum(ms);
+		v_cl.max(ms_max);
+		v_cl.sum(ps);
+		v_cl.execute();
+
+		double n_ranks = v_cl.getProcessingUnits();
+
+		add("time",wct);
+		add("label",t[PROF_LABEL]);
+		add("pack",t[PROF_PACK]);
+		add("comm",t[PROF_COMM]);
+		add("unpack",t[PROF_UNPACK]);
+		add("local",t[PROF_LOCAL]);
+		add("bc",t[PROF_BC]);
+		add("bytes_per_rank",bs / n_ranks);
+		add("bytes_max_rank",bs_max);
+		add("msg_per_rank",ms / n_ranks);
+		add("msg_max_rank",ms_max);
+		add("part_per_rank",ps / n_ranks);
+	}
+
+	/*! \brief Move all the collected samples in a report
+	 *
+	 * \param rep report
+	 * \param test name of the test
+	 * \param prefix prefix of the quantity name (variant of the test)
+	 * \param size problem size
+	 *
+	 */
+	void flush(benchmark_report & rep, const std::string & test, const std::string & prefix, size_t size)
+	{
+		for (size_t i = 0 ; i < names.size() ; i++)
+		{rep.add(test,prefix + "/" + names.get(i),size,create_vcluster().getProcessingUnits(),val.get(i));}
+
+		names.clear();
+		val.clear();
+	}
+};
+
+/*! \brief Create a variant name like g1.5_m0.1
+ *
+ * \param tag tag
+ * \param v value
+ *
+ * \return the name
+ *
+ */
+static inline std::string comm_bench_tag(const char * tag, double v)
+{
+	std::stringstream str;
+	str << tag << v;
+	return str.str();
+}
+
+//! distributed vector used by the communication benchmarks
+typedef vector_dist<3,float, aggregate<float> > comm_bench_vector;
+
+/*! \brief Create and fill a distributed vector for the communication benchmarks
+ *
+ * \param vd vector to fill
+ * \param np total number of particles
+ *
+ */
+static inline void comm_bench_fill(comm_bench_vector & vd, size_t np)
+{
+	vd_initialize<3>(vd,create_vcluster(),np);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		vd.getProp<0>(it.get()) = 1.0;
+		++it;
+	}
+}
+
+/*! \brief Benchmark vector_dist::map varying the movement amplitude
+ *
+ * \param p parameters
+ * \param rep report
+ *
+ */
+static inline void comm_bench_vector_map(const comm_bench_param & p, benchmark_report & rep)
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+	float r_cut = p.r_cut();
+
+	for (size_t m = 0 ; m < p.move.size() ; m++)
+	{
+		comm_bench_vector vd(p.np,box,bc,Ghost<3,float>(r_cut));
+		comm_bench_fill(vd,p.np);
+
+		comm_sample_stats stats;
+
+		for (size_t i = 0 ; i < p.n_samples ; i++)
+		{
+			move_particles<3>(vd,p.move.get(m)*r_cut);
+
+			openfpm_profiler().reset();
+
+			timer t;
+			t.start();
+			vd.map();
+			t.stop();
+
+			stats.sample(PROF_MAP,t.getwct());
+		}
+
+		stats.flush(rep,"vector_map",comm_bench_tag("m",p.move.get(m)),p.np);
+	}
+}
+
+/*! \brief Benchmark vector_dist::ghost_get varying the ghost width, with and without SKIP_LABELLING / NO_POSITION
+ *
+ * \param p parameters
+ * \param rep report
+ *
+ */
+static inline void comm_bench_vector_ghost_get(const comm_bench_param & p, benchmark_report & rep)
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+	float r_cut = p.r_cut();
+
+	size_t opts[] = {0,SKIP_LABELLING,SKIP_LABELLING | NO_POSITION};
+	const char * opt_names[] = {"","_skip_labelling","_skip_labelling_no_position"};
+
+	for (size_t g = 0 ; g < p.ghost.size() ; g++)
+	{
+		comm_bench_vector vd(p.np,box,bc,Ghost<3,float>(p.ghost.get(g)*r_cut));
+		comm_bench_fill(vd,p.np);
+
+		for (size_t o = 0 ; o < sizeof(opts)/sizeof(size_t) ; o++)
+		{
+			comm_sample_stats stats;
+
+			// SKIP_LABELLING reuse the labelling of the previous ghost_get
+			vd.ghost_get<0>();
+
+			for (size_t i = 0 ; i < p.n_samples ; i++)
+			{
+				openfpm_profiler().reset();
+
+				timer t;
+				t.start();
+				vd.ghost_get<0>(opts[o]);
+				t.stop();
+
+				stats.sample(PROF_GHOST_GET,t.getwct());
+			}
+
+			stats.flush(rep,"vector_ghost_get",comm_bench_tag("g",p.ghost.get(g)) + opt_names[o],p.np);
+		}
+	}
+}
+
+/*! \brief Benchmark vector_dist::ghost_put varying the ghost width
+ *
+ * \param p parameters
+ * \param rep report
+ *
+ */
+static inline void comm_bench_vector_ghost_put(const comm_bench_param & p, benchmark_report & rep)
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+	float r_cut = p.r_cut();
+
+	for (size_t g = 0 ; g < p.ghost.size() ; g++)
+	{
+		comm_bench_vector vd(p.np,box,bc,Ghost<3,float>(p.ghost.get(g)*r_cut));
+		comm_bench_fill(vd,p.np);
+		vd.ghost_get<0>();
+
+		comm_sample_stats stats;
+
+		for (size_t i = 0 ; i < p.n_samples ; i++)
+		{
+			openfpm_profiler().reset();
+
+			timer t;
+			t.start();
+			vd.ghost_put<add_,0>();
+			t.stop();
+
+			stats.sample(PROF_GHOST_PUT,t.getwct());
+		}
+
+		stats.flush(rep,"vector_ghost_put",comm_bench_tag("g",p.ghost.get(g)),p.np);
+	}
+}
+
+/*! \brief Number of grid points on each direction, and ghost width in grid points, for the grid benchmarks
+ *
+ * \param p parameters
+ * \param g ghost width (multiple of the cut-off radius)
+ * \param sz number of points on each direction
+ *
+ * \return the ghost width in grid points
+ *
+ */
+static inline long int comm_bench_grid_size(const comm_bench_param & p, double g, size_t (& sz)[3])
+{
+	size_t n = std::max((size_t)2,(size_t)cbrt((double)p.np));
+
+	for (size_t i = 0 ; i < 3 ; i++)
+	{sz[i] = n;}
+
+	return std::max(1l,(long int)round(g * p.r_cut() * n));
+}
+
+/*! \brief Benchmark grid_dist_id::ghost_get varying the ghost width
+ *
+ * \param p parameters
+ * \param rep report
+ *
+ */
+static inline void comm_bench_grid_ghost_get(const comm_bench_param & p, benchmark_report & rep)
+{
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+	periodicity<3> bc = {{PERIODIC,PERIODIC,PERIODIC}};
+
+	for (size_t g = 0 ; g < p.ghost.size() ; g++)
+	{
+		size_t sz[3];
+		Ghost<3,long int> gg(comm_bench_grid_size(p,p.ghost.get(g),sz));
+
+		grid_dist_id<3,float,aggregate<float>> gd(sz,domain,gg,bc);
+
+		auto it = gd.getDomainIterator();
+
+		while (it.isNext())
+		{
+			gd.get<0>(it.get()) = 1.0;
+			++it;
+		}
+
+		comm_sample_stats stats;
+
+		for (size_t i = 0 ; i < p.n_samples ; i++)
+		{
+			openfpm_profiler().reset();
+
+			timer t;
+			t.start();
+			gd.ghost_get<0>();
+			t.stop();
+
+			stats.sample(PROF_GRID_GHOST_GET,t.getwct());
+		}
+
+		stats.flush(rep,"grid_ghost_get",comm_bench_tag("g",p.ghost.get(g)),sz[0]*sz[1]*sz[2]);
+	}
+}
+
+/*! \brief Benchmark grid_dist_id::map
+ *
+ * Two decompositions are created, the one of the grid (uniform cost) and one with the cost concentrated
+ * in the lower half of the domain. At each sample the grid is redistributed on the other decomposition
+ *
+ * \param p parameters
+ * \param rep report
+ *
+ */
+static inline void comm_bench_grid_map(const comm_bench_param & p, benchmark_report & rep)
+{
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t sz[3];
+	Ghost<3,long int> gg(comm_bench_grid_size(p,1.0,sz));
+
+	grid_dist_id<3,float,aggregate<float>> gd(sz,domain,gg);
+
+	auto it = gd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		gd.get<0>(it.get()) = 1.0;
+		++it;
+	}
+
+	typedef typename std::remove_reference<decltype(gd.getDecomposition())>::type dec_type;
+
+	dec_type dec_u = gd.getDecomposition().duplicate();
+	dec_type dec_w = gd.getDecomposition().duplicate();
+
+	for (size_t i = 0 ; i < dec_w.getNSubSubDomains() ; i++)
+	{
+		float pos[3];
+		dec_w.getSubSubDomainPosition(i,pos);
+
+		dec_w.setSubSubDomainComputationCost(i,(pos[0] < 0.5)?8:1);
+	}
+
+	dec_w.decompose();
+
+	comm_sample_stats stats;
+
+	for (size_t i = 0 ; i < p.n_samples ; i++)
+	{
+		openfpm_profiler().reset();
+
+		timer t;
+		t.start();
+		gd.redistribute((i % 2 == 0)?dec_w:dec_u);
+		t.stop();
+
+		stats.sample(PROF_GRID_MAP,t.getwct());
+	}
+
+	stats.flush(rep,"grid_map","redistribute",sz[0]*sz[1]*sz[2]);
+}
+
+#endif /* SRC_VECTOR_PERFORMANCE_COMM_SCALING_BENCHMARKS_HPP_ */
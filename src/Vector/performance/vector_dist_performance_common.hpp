@@ -268,4 +268,67 @@ template<unsigned int dim, size_t prp = 0, typename T, typename V> void calc_for
 	}
 }
 
+/*! \brief Calculate and put particles' forces using a Verlet-list
+ *
+ * \param NN Verlet list
+ * \param vd Distributed vector
+ * \param r_cut Cut-off radius
+ */
+template<unsigned int dim, size_t prp = 0, typename T, typename V> void calc_forces_verlet(T & NN, V & vd, float r_cut)
+{
+	auto it_v = vd.getDomainIterator();
+
+	float sum[dim];
+
+	while (it_v.isNext())
+	{
+		//key
+		vect_dist_key_dx key = it_v.get();
+
+    	// Get the position of the particles
+		Point<dim,float> p = vd.getPos(key);
+
+		for (size_t i = 0; i < dim; i++)
+			sum[i] = 0;
+
+    	// Get the neighborhood of the particle
+    	auto nn_it = NN.template getNNIterator<NO_CHECK>(key.getKey());
+
+    	while(nn_it.isNext())
+    	{
+    		auto nnp = nn_it.get();
+
+    		// p != q
+    		if (nnp == key.getKey())
+    		{
+    			++nn_it;
+    			continue;
+    		}
+
+    		Point<dim,float> q = vd.getPos(nnp);
+
+			//Calculate the forces
+			float num[dim];
+			for (size_t i = 0; i < dim; i++)
+				num[i] = p[i] - q[i];
+
+			float denom = 0;
+			for (size_t i = 0; i < dim; i++)
+				denom += num[i] * num[i];
+
+			for (size_t i = 0; i < dim; i++)
+				sum[i] += num[i] / denom;
+
+			//Next neighborhood particle
+			++nn_it;
+		}
+
+		//Put the forces
+		for (size_t i = 0; i < dim; i++)
+			vd.template getProp<prp>(key)[i] += sum[i];
+
+		++it_v;
+	}
+}
+
 #endif /* SRC_VECTOR_PERFORMANCE_VECTOR_DIST_PERFORMANCE_COMMON_HPP_ */
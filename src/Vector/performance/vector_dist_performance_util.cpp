@@ -9,6 +9,7 @@
 
 #include "vector_dist_performance_util.hpp"
 #include "Plot/GoogleChart.hpp"
+#include "benchmark_report.hpp"
 
 void addUpdtateTime(GoogleChart & cg)
 {
@@ -69,6 +70,28 @@ void StandardPerformanceGraph(std::string file_mean,
 	yp_mean.save(file_mean_save);
 	yp_dev.save(file_var_save);
 
+	// machine readable copy of the results
+	if (create_vcluster().getProcessUnitID() == 0)
+	{
+		benchmark_report rep;
+
+		for (size_t r = 0 ; r < yp_mean.size() ; r++)
+		{
+			for (size_t k = 0 ; k < yp_mean.get(r).size() && k < xp.size() ; k++)
+			{
+				for (size_t g = 0 ; g < yp_mean.get(r).get(k).size() ; g++)
+				{
+					std::string gname = (r < gnames.size())?gnames.get(r):std::to_string(r);
+					std::string sname = (g < names.size())?names.get(g):std::to_string(g);
+
+					rep.add(gname,sname,xp.get(k),create_vcluster().getProcessingUnits(),0,yp_mean.get(r).get(k).get(g),yp_dev.get(r).get(k).get(g));
+				}
+			}
+		}
+
+		rep.write(file_mean_save + ".json");
+	}
+
 	if (y_ref_mean.size() != 0 && yp_mean.size() != 0 && yp_mean.get(0).size() != 0)
 	{
 		// We reconstruct y and yn
@@ -182,6 +182,48 @@ template<typename V> double benchmark_get_verlet(V & vd, float r_cut)
 	return t.getwct();
 }
 
+/*! \brief Benchmark verlet getting time for a given Verlet-list type
+ *
+ * \param NN Verlet list
+ * \param vd Distributed vector
+ * \param r_cut Cut-off radius
+ *
+ * \return real time
+ */
+template<typename VerletL, typename V> double benchmark_get_verlet_type(VerletL & NN, V & vd, float r_cut)
+{
+	//Timer
+	timer t;
+	t.start();
+
+	//get verlet
+	NN = vd.template getVerlet<VerletL>(r_cut);
+
+	t.stop();
+
+	return t.getwct();
+}
+
+/*! \brief Benchmark particles' forces time using a Verlet-list
+ *
+ * \param NN Verlet list
+ * \param vd Distributed vector
+ * \param r_cut Cut-off radius
+ *
+ * \return real time
+ */
+template<unsigned int dim, size_t prp = 0, typename T, typename V> double benchmark_calc_forces_verlet(T & NN, V & vd, float r_cut)
+{
+	//Timer
+	timer t;
+	t.start();
+
+	calc_forces_verlet<dim,prp>(NN,vd,r_cut);
+
+	t.stop();
+
+	return t.getwct();
+}
 
 
 /*! \brief Benchmark particles' forces time
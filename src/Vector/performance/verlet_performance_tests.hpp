@@ -249,6 +249,140 @@ template<unsigned int dim> void vd_verlet_hilbert_benchmark(size_t k_start, size
 }
 
 
+/*! \brief Memory used by a Verlet-list (0 if unknown)
+ *
+ * \param NN Verlet-list
+ * \param n_part number of particles in the Verlet-list
+ *
+ * \return the memory in byte
+ *
+ */
+template<typename VerletL> size_t verlet_memory(VerletL & NN, size_t n_part)
+{
+	return 0;
+}
+
+/*! \brief Memory used by a Verlet-list with Mem_fast storage
+ *
+ * Mem_fast store one counter for each particle and the same number of slots
+ * (at least the size of the biggest neighborhood) for each particle
+ *
+ * \param NN Verlet-list
+ * \param n_part number of particles in the Verlet-list
+ *
+ * \return the memory in byte
+ *
+ */
+template<unsigned int dim, typename St, typename Memory, typename local_index, typename transform>
+size_t verlet_memory(VerletList<dim,St,Mem_fast<Memory,local_index>,transform> & NN, size_t n_part)
+{
+	size_t slot = 0;
+
+	for (size_t p = 0 ; p < n_part ; p++)
+	{
+		size_t nn = NN.getNNPart(p);
+		slot = (nn > slot)?nn:slot;
+	}
+
+	return n_part * (slot + 1) * sizeof(local_index);
+}
+
+/*! \brief Memory used by a Verlet-list in CSR format
+ *
+ * \param NN Verlet-list
+ * \param n_part number of particles in the Verlet-list
+ *
+ * \return the memory in byte
+ *
+ */
+template<unsigned int dim, typename St, typename vp, typename CellL, typename nn_store>
+size_t verlet_memory(VerletListCSR<dim,St,vp,CellL,nn_store> & NN, size_t n_part)
+{
+	return NN.getNNMemory();
+}
+
+/*! \brief Run the Verlet-list storage benchmark for one Verlet-list type
+ *
+ * \param vd Distributed vector
+ * \param r_cut Cut-off radius
+ * \param name name of the Verlet-list type
+ *
+ */
+template<unsigned int dim, typename VerletL, typename V> void vd_verlet_storage_benchmark_type(V & vd, float r_cut, const std::string & name)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	VerletL NN;
+
+	double sum_verlet = 0;
+	for (size_t n = 0 ; n < N_VERLET_TEST; n++)
+		sum_verlet += benchmark_get_verlet_type(NN,vd,r_cut);
+	sum_verlet /= N_VERLET_TEST;
+
+	double sum_forces = 0;
+	for (size_t l = 0 ; l < N_VERLET_TEST; l++)
+		sum_forces += benchmark_calc_forces_verlet<dim>(NN,vd,r_cut);
+	sum_forces /= N_VERLET_TEST;
+
+	size_t mem = verlet_memory(NN,vd.size_local());
+	v_cl.sum(mem);
+	v_cl.execute();
+
+	if (v_cl.getProcessUnitID() == 0)
+		std::cout << name << ", Cut-off = " << r_cut << ", Particles = " << vd.size_local() << " time to get the verlet-list: " << sum_verlet << " time to calculate forces: " << sum_forces << " neighborhood memory (byte): " << mem << std::endl;
+}
+
+/*! \brief Function for verlet test comparing the neighborhood storage (full index and 16-bit delta)
+ *         after an Hilbert curve reordering
+ *
+ */
+template<unsigned int dim> void vd_verlet_storage_benchmark(size_t k_start, openfpm::vector<float> & r_cutoff, size_t m)
+{
+	std::string str("Testing " + std::to_string(dim) + "D vector, Verlet-list neighborhood storage");
+	print_test_v(str,0);
+
+	for (size_t r = 0; r < r_cutoff.size(); r++ )
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		//Cut-off radius
+		float r_cut = r_cutoff.get(r);
+
+		// Number of particles
+		size_t k = k_start * v_cl.getProcessingUnits();
+
+		BOOST_TEST_CHECKPOINT( "Testing " << dim << "D vector Verlet-list storage k=" << k );
+
+		Box<dim,float> box;
+
+		for (size_t i = 0; i < dim; i++)
+		{
+			box.setLow(i,0.0);
+			box.setHigh(i,1.0);
+		}
+
+		// Boundary conditions
+		size_t bc[dim];
+
+		for (size_t i = 0; i < dim; i++)
+			bc[i] = PERIODIC;
+
+		vector_dist<dim,float, aggregate<float[dim]> > vd(k,box,bc,Ghost<dim,float>(r_cut));
+
+		// Initialize a dist vector
+		vd_initialize<dim>(vd, v_cl, k);
+
+		// neighbors are index-local only after a space filling curve reordering
+		vd.reorder(m);
+		vd.template ghost_get<0>();
+
+		vd_verlet_storage_benchmark_type<dim,VERLET_MEMFAST(dim,float)>(vd,r_cut,"VerletList Mem_fast");
+		vd_verlet_storage_benchmark_type<dim,VERLET_MEMFAST_INT(dim,float)>(vd,r_cut,"VerletList Mem_fast int");
+		vd_verlet_storage_benchmark_type<dim,VERLET_CSR(dim,float)>(vd,r_cut,"VerletListCSR full");
+		vd_verlet_storage_benchmark_type<dim,VERLET_CSR_DELTA16(dim,float)>(vd,r_cut,"VerletListCSR delta16");
+	}
+}
+
 /*! \brief Function for verlet performance report
  *
  */
@@ -389,6 +523,13 @@ BOOST_AUTO_TEST_CASE( vector_dist_verlet_test )
 	vd_verlet_random_benchmark<2>(k_start,k_min,r_cutoff,n_particles,time_force_mean_2,time_create_mean_2,time_force_dev_2,time_create_dev_2);
 }
 
+BOOST_AUTO_TEST_CASE( vector_dist_verlet_storage_test )
+{
+	//Benchmark the neighborhood storage for 2D and 3D
+	vd_verlet_storage_benchmark<3>(k_start,r_cutoff,5);
+	vd_verlet_storage_benchmark<2>(k_start,r_cutoff,7);
+}
+
 BOOST_AUTO_TEST_CASE(vector_dist_verlet_performance_write_report)
 {
 	GoogleChart cg;
@@ -426,5 +426,133 @@ BOOST_AUTO_TEST_CASE( vector_dist_multiphase_cell_list_sym_test )
 	BOOST_REQUIRE_EQUAL(ret,true);
 }
 
+BOOST_AUTO_TEST_CASE( vector_dist_multiphase_fused_verlet_test )
+{
+	if (create_vcluster().getProcessingUnits() > 24)
+		return;
+
+	size_t sz[3] = {60,60,40};
+
+	// The domain
+	Box<3,float> box({-1000.0,-1000.0,-1000.0},{2000.0,2000.0,1000.0});
+
+	// Boundary conditions
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+
+	float r_cut = 51.0;
+
+	// ghost, big enough to contain the interaction radius
+	Ghost<3,float> ghost(r_cut);
+
+	openfpm::vector< vector_dist<3,float, aggregate<double,double>> > phases;
+
+	// first phase
+	phases.add( vector_dist<3,float, aggregate<double,double>>(0,box,bc,ghost) );
+
+	// The other 3 phases
+	phases.add( vector_dist<3,float, aggregate<double,double>>(phases.get(0).getDecomposition(),0) );
+	phases.add( vector_dist<3,float, aggregate<double,double>>(phases.get(0).getDecomposition(),0) );
+	phases.add( vector_dist<3,float, aggregate<double,double>>(phases.get(0).getDecomposition(),0) );
+
+	// Fill the phases with particles
+
+	auto g_it = phases.get(0).getGridIterator(sz);
+
+	while (g_it.isNext())
+	{
+		auto key = g_it.get();
+
+		for (size_t i = 0 ; i < phases.size() ; i++)
+		{
+			phases.get(i).add();
+
+			phases.get(i).getLastPos()[0] = key.get(0) * g_it.getSpacing(0) + box.getLow(0);
+			phases.get(i).getLastPos()[1] = key.get(1) * g_it.getSpacing(1) + box.getLow(1);
+			phases.get(i).getLastPos()[2] = key.get(2) * g_it.getSpacing(2) + box.getLow(2);
+		}
+
+		++g_it;
+	}
+
+	// Sync all phases
+	for (size_t i = 0 ; i < phases.size() ; i++)
+	{
+		phases.get(i).map();
+		phases.get(i).ghost_get<>();
+	}
+
+	// Phase-pair Verlet-lists with one traversal
+	auto NN = createVerletMultiPhase<2>(phases,r_cut);
+
+	bool ret = true;
+
+	for (size_t i = 0 ; i < phases.size() ; i++)
+	{
+		for (size_t p = 0 ; p < phases.get(i).size_local() ; p++)
+		{
+			for (size_t j = 0 ; j < phases.size() ; j++)
+			{ret &= NN.getNNPart(i,j,p) == 7ul;}
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	// Symmetric, every interaction is stored once across all the processors
+
+	auto NN_sym = createVerletMultiPhase<2>(phases,r_cut,VL_SYMMETRIC,2);
+
+	for (size_t i = 0 ; i < phases.size() ; i++)
+	{
+		auto it = phases.get(i).getDomainAndGhostIterator();
+
+		while (it.isNext())
+		{
+			phases.get(i).getPropWrite<0>(it.get()) = 0;
+
+			++it;
+		}
+	}
+
+	for (size_t i = 0 ; i < phases.size() ; i++)
+	{
+		for (size_t p = 0 ; p < phases.get(i).size_local() ; p++)
+		{
+			for (size_t j = 0 ; j < phases.size() ; j++)
+			{
+				auto Np = NN_sym.getNNIterator(i,j,p);
+
+				while (Np.isNext())
+				{
+					auto q = Np.get();
+
+					phases.get(i).getProp<0>(p)++;
+					phases.get(j).getProp<0>(q)++;
+
+					++Np;
+				}
+			}
+		}
+	}
+
+	for (size_t i = 0 ; i < phases.size() ; i++)
+	{phases.get(i).ghost_put<add_,0>();}
+
+#ifdef SE_CLASS3
+
+	for (size_t i = 0 ; i < phases.size() ; i++)
+	{phases.get(i).getDomainIterator();}
+
+#endif
+
+	// 7 neighborhood for each phase, the particle itself excluded
+	for (size_t i = 0 ; i < phases.size() ; i++)
+	{
+		for (size_t p = 0 ; p < phases.get(i).size_local() ; p++)
+		{ret &= phases.get(i).getProp<0>(p) == 4*7 - 1;}
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -236,6 +236,93 @@ BOOST_AUTO_TEST_CASE( vector_dist_full_NN )
 	test_full_nn<VERLET_MEMBAL(3,float)>(k);
 	k /= 2;
 	test_full_nn<VERLET_MEMMW(3,float)>(k);
+	test_full_nn<VERLET_CSR(3,float)>(k);
+	test_full_nn<VERLET_CSR_DELTA16(3,float)>(k);
+}
+
+template<typename VerletList>
+void test_verlet_csr_threads()
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 12)
+		return;
+
+	std::default_random_engine eg;
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+	float r_cut = 0.1;
+
+	vector_dist<3,float, aggregate<float> > vd(2000 * v_cl.getProcessingUnits(),box,bc,Ghost<3,float>(r_cut*1.001));
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		for (size_t i = 0 ; i < 3 ; i++)
+		{vd.getPos(key)[i] = ud(eg);}
+
+		++it;
+	}
+
+	vd.map();
+	vd.ghost_get<0>();
+
+	auto NN1 = vd.template getVerlet<VerletList>(r_cut);
+	auto NN4 = vd.template getVerlet<VerletList>(r_cut);
+	auto NN3 = vd.template getVerlet<VerletList>(r_cut,3);
+
+	// the default is one thread, the threads of the pool are reused by the updates
+	BOOST_REQUIRE_EQUAL(NN1.getNThreads(),1ul);
+	BOOST_REQUIRE_EQUAL(NN3.getNThreads(),3ul);
+	NN4.setNThreads(4);
+
+	bool ret = true;
+
+	// constructed directly with multiple threads
+	for (size_t p = 0 ; p < vd.size_local() ; p++)
+	{
+		ret &= NN1.getNNPart(p) == NN3.getNNPart(p);
+
+		for (size_t j = 0 ; j < NN3.getNNPart(p) ; j++)
+		{ret &= NN1.get(p,j) == NN3.get(p,j);}
+	}
+
+	for (size_t s = 0 ; s < 3 ; s++)
+	{
+		vd.updateVerlet(NN4,r_cut);
+
+		for (size_t p = 0 ; p < vd.size_local() ; p++)
+		{
+			ret &= NN1.getNNPart(p) == NN4.getNNPart(p);
+
+			size_t j = 0;
+			auto NNp = NN4.getNNIterator(p);
+
+			while (NNp.isNext())
+			{
+				ret &= NNp.get() == NN4.get(p,j);
+				ret &= NN1.get(p,j) == NN4.get(p,j);
+
+				j++;
+				++NNp;
+			}
+
+			ret &= j == NN4.getNNPart(p);
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_verlet_csr_threads )
+{
+	test_verlet_csr_threads<VERLET_CSR(3,float)>();
+	test_verlet_csr_threads<VERLET_CSR_DELTA16(3,float)>();
 }
 
 BOOST_AUTO_TEST_CASE( vector_dist_particle_iteration )
@@ -390,6 +477,134 @@ BOOST_AUTO_TEST_CASE( vector_dist_particle_NN_update_with_limit )
 	BOOST_REQUIRE_EQUAL(cell1.getHigh(2),cell2.getHigh(2));
 }
 
+BOOST_AUTO_TEST_CASE( vector_dist_particle_NN_incremental_update )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 12)
+		return;
+
+    // set the seed
+	// create the random generator engine
+	std::srand(v_cl.getProcessUnitID());
+    std::default_random_engine eg;
+    std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+    long int k = 4096 * v_cl.getProcessingUnits();
+
+	print_test_v("Testing 3D particle cell-list incremental update k=",k);
+	BOOST_TEST_CHECKPOINT( "Testing 3D particle cell-list incremental update k=" << k );
+
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	// Boundary conditions
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+
+	float r_cut = 0.1;
+
+	// ghost
+	Ghost<3,float> ghost(r_cut);
+
+	typedef  aggregate<float> part_prop;
+
+	// Distributed vector
+	vector_dist<3,float, part_prop > vd(k,box,bc,ghost);
+
+	auto it = vd.getIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		++it;
+	}
+
+	vd.map();
+	vd.ghost_get<0>();
+
+	auto NN_inc = vd.getCellList(r_cut);
+	vd.updateCellListIncremental(NN_inc);
+
+	BOOST_REQUIRE_EQUAL(vd.getCellListIncrementalNFull(),1ul);
+	BOOST_REQUIRE_EQUAL(vd.getCellListIncrementalNUpdate(),0ul);
+
+	for (size_t s = 0 ; s < 6 ; s++)
+	{
+		size_t n_full = vd.getCellListIncrementalNFull();
+		size_t n_upd = vd.getCellListIncrementalNUpdate();
+
+		// the cell-list is reassigned or constructed with the full update in between
+		if (s == 2)
+		{NN_inc = vd.getCellList(r_cut);}
+		else if (s == 4)
+		{vd.updateCellList(NN_inc);}
+
+		// small displacement, only few particles change cell
+		auto it2 = vd.getDomainIterator();
+
+		while (it2.isNext())
+		{
+			auto p = it2.get();
+
+			for (size_t i = 0 ; i < 3 ; i++)
+			{
+				vd.getPos(p)[i] += 0.01f*(ud(eg) - 0.5f);
+
+				if (vd.getPos(p)[i] < 0.0f)	{vd.getPos(p)[i] = 0.0f;}
+				if (vd.getPos(p)[i] >= 1.0f)	{vd.getPos(p)[i] = 0.999f;}
+			}
+
+			++it2;
+		}
+
+		vd.ghost_get<0>();
+
+		vd.updateCellListIncremental(NN_inc);
+
+		// after getCellList / updateCellList a full construction is expected, otherwise only
+		// the particles that changed cell must be moved
+		bool exp_full = (s == 2 || s == 4);
+
+		BOOST_REQUIRE_EQUAL(vd.getCellListIncrementalNFull(),n_full + exp_full);
+		BOOST_REQUIRE_EQUAL(vd.getCellListIncrementalNUpdate(),n_upd + !exp_full);
+
+		// every particle is stored once in its cell, no stale entries
+		bool ret = true;
+		size_t tot = 0;
+		openfpm::vector<unsigned char> seen(vd.size_local_with_ghost());
+
+		for (size_t i = 0 ; i < seen.size() ; i++)
+		{seen.get(i) = 0;}
+
+		for (size_t c = 0 ; c < NN_inc.getGrid().size() ; c++)
+		{
+			for (size_t j = 0 ; j < NN_inc.getNelements(c) ; j++)
+			{
+				size_t e = NN_inc.get(c,j);
+
+				ret &= e < seen.size();
+				if (ret == false)
+				{break;}
+
+				Point<3,float> xp = vd.getPos(e);
+				ret &= NN_inc.getCell(xp) == c;
+				ret &= seen.get(e) == 0;
+
+				seen.get(e) = 1;
+				tot++;
+			}
+		}
+
+		ret &= tot == vd.size_local_with_ghost();
+
+		BOOST_REQUIRE_EQUAL(ret,true);
+	}
+}
+
 BOOST_AUTO_TEST_CASE( vector_dist_particle_getCellListSym_with_div )
 {
 	Vcluster<> & v_cl = create_vcluster();
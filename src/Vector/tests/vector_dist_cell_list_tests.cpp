@@ -168,8 +168,107 @@ void test_reorder_cl()
 	}
 }
 
+///////////////////////// test map with sfc order ///////////////////////////////
+
+void test_map_sfc_order(reorder_opt opt)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 48)
+		return;
+
+    // set the seed
+	// create the random generator engine
+	std::srand(v_cl.getProcessUnitID());
+    std::default_random_engine eg;
+    std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+    std::uniform_real_distribution<float> ud_mv(-0.02f, 0.02f);
+
+	long int k = 24288 * v_cl.getProcessingUnits();
+
+	print_test_v( "Testing 2D vector map with sfc order k=",k);
+	BOOST_TEST_CHECKPOINT( "Testing 2D vector map with sfc order k=" << k );
+
+	Box<2,float> box({0.0,0.0},{1.0,1.0});
+
+	// Boundary conditions
+	size_t bc[2]={PERIODIC,PERIODIC};
+
+	vector_dist<2,float, Point_test<float> > vd(k,box,bc,Ghost<2,float>(0.01));
+	vd.setMapSFC(6,opt);
+
+	auto it = vd.getIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+
+		++it;
+	}
+
+	vd.map(MAP_SFC_ORDER);
+
+	for (size_t s = 0 ; s < 5 ; s++)
+	{
+		// move the particles
+		auto it2 = vd.getDomainIterator();
+
+		while (it2.isNext())
+		{
+			auto key = it2.get();
+
+			vd.getPos(key)[0] += ud_mv(eg);
+			vd.getPos(key)[1] += ud_mv(eg);
+
+			// the properties remember the position
+			vd.template getProp<0>(key) = vd.getPos(key)[0];
+			vd.template getProp<1>(key) = vd.getPos(key)[1];
+
+			++it2;
+		}
+
+		vd.map(MAP_SFC_ORDER);
+
+		// Check the particles are sorted
+		bool ret = true;
+		for (size_t i = 1 ; i < vd.size_local() ; i++)
+		{ret &= vd.getSFCKey(i-1) <= vd.getSFCKey(i);}
+
+		BOOST_REQUIRE_EQUAL(ret,true);
+
+		// Check the properties moved with the positions (periodic images are shifted by one)
+		for (size_t i = 0 ; i < vd.size_local() ; i++)
+		{
+			for (size_t j = 0 ; j < 2 ; j++)
+			{
+				float prp = (j == 0)?vd.template getProp<0>(i):vd.template getProp<1>(i);
+				float d = fabs(prp - vd.getPos(i)[j]);
+
+				ret &= (d < 1e-5) || (fabs(d - 1.0f) < 1e-5);
+			}
+		}
+
+		BOOST_REQUIRE_EQUAL(ret,true);
+
+		size_t cnt = vd.size_local();
+		v_cl.sum(cnt);
+		v_cl.execute();
+
+		BOOST_REQUIRE_EQUAL((long int)cnt,k);
+	}
+}
+
 BOOST_AUTO_TEST_SUITE( vector_dist_cell_list_test_suite )
 
+BOOST_AUTO_TEST_CASE( vector_dist_map_sfc_order_test )
+{
+	test_map_sfc_order(reorder_opt::HILBERT);
+	test_map_sfc_order(reorder_opt::LINEAR);
+}
+
 BOOST_AUTO_TEST_CASE( vector_dist_reorder_2d_test )
 {
 	test_reorder_sfc(reorder_opt::HILBERT);
@@ -1072,6 +1171,8 @@ BOOST_AUTO_TEST_CASE( vector_dist_symmetric_verlet_list )
 	test_vd_symmetric_verlet_list<VERLET_MEMFAST(3,float)>();
 	test_vd_symmetric_verlet_list<VERLET_MEMBAL(3,float)>();
 	test_vd_symmetric_verlet_list<VERLET_MEMMW(3,float)>();
+	test_vd_symmetric_verlet_list<VERLET_CSR(3,float)>();
+	test_vd_symmetric_verlet_list<VERLET_CSR_DELTA16(3,float)>();
 }
 
 template<typename VerletList>
@@ -1625,6 +1726,8 @@ BOOST_AUTO_TEST_CASE( vector_dist_symmetric_crs_verlet_list )
 	test_csr_verlet_list<VERLET_MEMFAST(3,float)>();
 	test_csr_verlet_list<VERLET_MEMBAL(3,float)>();
 	test_csr_verlet_list<VERLET_MEMMW(3,float)>();
+	test_csr_verlet_list<VERLET_CSR(3,float)>();
+	test_csr_verlet_list<VERLET_CSR_DELTA16(3,float)>();
 }
 
 BOOST_AUTO_TEST_CASE( vector_dist_symmetric_crs_verlet_list_dec_override )
@@ -1732,6 +1835,8 @@ BOOST_AUTO_TEST_CASE( vector_dist_symmetric_crs_verlet_list_partit )
 	test_vd_symmetric_crs_verlet<VERLET_MEMFAST(3,float)>();
 	test_vd_symmetric_crs_verlet<VERLET_MEMBAL(3,float)>();
 	test_vd_symmetric_crs_verlet<VERLET_MEMMW(3,float)>();
+	test_vd_symmetric_crs_verlet<VERLET_CSR(3,float)>();
+	test_vd_symmetric_crs_verlet<VERLET_CSR_DELTA16(3,float)>();
 }
 
 BOOST_AUTO_TEST_CASE( vector_dist_checking_unloaded_processors )
@@ -11,6 +11,7 @@
 #include "config.h"
 
 #include <random>
+#include <unistd.h>
 #include "Vector/vector_dist.hpp"
 #include "data_type/aggregate.hpp"
 #include "vector_dist_util_unit_tests.hpp"
@@ -1881,6 +1882,876 @@ BOOST_AUTO_TEST_CASE( vector_fixing_noposition_and_keep_prop )
 	BOOST_REQUIRE_EQUAL(vd.getPropVector().size(),local);
 }
 
+BOOST_AUTO_TEST_CASE( vector_dist_phase_profiler_test )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+	Ghost<3,float> ghost(0.1);
+
+	vector_dist<3,float, aggregate<float> > vd(4096,box,bc,ghost);
+
+	openfpm_profiler().reset();
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[1] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[2] = (float)rand() / RAND_MAX;
+		vd.getProp<0>(key) = 1.0;
+
+		++it;
+	}
+
+	vd.map();
+	vd.ghost_get<0>();
+	vd.ghost_put<add_,0>();
+
+	BOOST_REQUIRE_EQUAL(openfpm_profiler().get(PROF_MAP).cnt[PROF_CALLS],1ul);
+	BOOST_REQUIRE_EQUAL(openfpm_profiler().get(PROF_GHOST_GET).cnt[PROF_CALLS],1ul);
+	BOOST_REQUIRE_EQUAL(openfpm_profiler().get(PROF_GHOST_PUT).cnt[PROF_CALLS],1ul);
+
+	// the ghost contain at least the particles received from other processors
+	BOOST_REQUIRE(vd.size_local_with_ghost() - vd.size_local() >= openfpm_profiler().get(PROF_GHOST_GET).cnt[PROF_PART_RECV]);
+
+	// sub-phases cannot take more than the total
+	const prof_phase_stat & gg = openfpm_profiler().get(PROF_GHOST_GET);
+	BOOST_REQUIRE(gg.time[PROF_LABEL] + gg.time[PROF_PACK] + gg.time[PROF_COMM] + gg.time[PROF_LOCAL] + gg.time[PROF_BC] <= gg.time[PROF_TOTAL]);
+
+	const prof_phase_stat & mp = openfpm_profiler().get(PROF_MAP);
+	BOOST_REQUIRE(mp.time[PROF_BC] + mp.time[PROF_LABEL] + mp.time[PROF_PACK] + mp.time[PROF_COMM] + mp.time[PROF_UNPACK] <= mp.time[PROF_TOTAL]);
+
+	// the local ghost copy and the boundary conditions are recorded
+	BOOST_REQUIRE(gg.time[PROF_LOCAL] > 0.0);
+	BOOST_REQUIRE(mp.time[PROF_BC] > 0.0);
+
+	// disabled profiler does not count
+	openfpm_profiler().enable(false);
+	vd.ghost_get<0>();
+	openfpm_profiler().enable(true);
+
+	BOOST_REQUIRE_EQUAL(openfpm_profiler().get(PROF_GHOST_GET).cnt[PROF_CALLS],1ul);
+
+	std::ostringstream out;
+	openfpm_profiler().print_stats(out);
+
+	// write the report in a temporary file
+	char file[] = "/tmp/phase_profiler_XXXXXX";
+	int fd = mkstemp(file);
+	BOOST_REQUIRE(fd != -1);
+	close(fd);
+
+	openfpm_profiler().write_json(file);
+
+	if (create_vcluster().getProcessUnitID() == 0)
+	{
+		BOOST_REQUIRE(out.str().find("ghost_get") != std::string::npos);
+
+		std::ifstream in(file);
+		std::string json((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+
+		BOOST_REQUIRE(json.find("\"map\"") != std::string::npos);
+		BOOST_REQUIRE(json.find("\"bc\"") != std::string::npos);
+	}
+
+	std::remove(file);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_remove_unordered_and_marked )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+	Ghost<3,float> ghost(0.1);
+
+	vector_dist<3,float, aggregate<size_t,float> > vd(0,box,bc,ghost);
+
+	// the local particles are tagged with their initial index
+	for (size_t i = 0 ; i < 10000 ; i++)
+	{
+		vd.add();
+
+		vd.getLastPos()[0] = (float)rand() / RAND_MAX;
+		vd.getLastPos()[1] = (float)rand() / RAND_MAX;
+		vd.getLastPos()[2] = (float)rand() / RAND_MAX;
+
+		vd.getLastProp<0>() = i;
+		vd.getLastProp<1>() = vd.getLastPos()[0];
+	}
+
+	// remove unordered all the multiple of 3
+	openfpm::vector<size_t> keys;
+
+	for (size_t i = 0 ; i < vd.size_local() ; i += 3)
+	{keys.add(i);}
+
+	vd.removeUnordered(keys);
+
+	BOOST_REQUIRE_EQUAL(vd.size_local(),10000ul - keys.size());
+
+	openfpm::vector<unsigned char> found;
+	found.resize(10000);
+	for (size_t i = 0 ; i < found.size() ; i++)
+	{found.get(i) = 0;}
+
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		size_t id = vd.getProp<0>(i);
+
+		BOOST_REQUIRE(id % 3 != 0);
+		BOOST_REQUIRE_EQUAL(vd.getProp<1>(i),vd.getPos(i)[0]);
+		BOOST_REQUIRE_EQUAL(found.get(id),0);
+		found.get(id) = 1;
+	}
+
+	// mark all the even ids, they are removed by map keeping the order
+	size_t n_even = 0;
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		if (vd.getProp<0>(i) % 2 == 0)
+		{
+			vd.markRemove(i);
+			n_even++;
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(vd.getNMarkedRemove(),n_even);
+
+	vd.setRemoveThreads(4);
+	size_t n_before = vd.size_local();
+	openfpm::vector<size_t> order;
+
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		if (vd.isMarkedRemove(i) == false)
+		{order.add(vd.getProp<0>(i));}
+	}
+
+	vd.removeMarked();
+
+	BOOST_REQUIRE_EQUAL(vd.size_local(),n_before - n_even);
+	BOOST_REQUIRE_EQUAL(vd.getNMarkedRemove(),0ul);
+
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		BOOST_REQUIRE_EQUAL(vd.getProp<0>(i),order.get(i));
+		BOOST_REQUIRE_EQUAL(vd.getProp<1>(i),vd.getPos(i)[0]);
+	}
+
+	// marked particles are removed by map
+	size_t tot = vd.size_local();
+	for (size_t i = 0 ; i < vd.size_local() ; i += 5)
+	{vd.markRemove(i);tot--;}
+
+	auto & v_cl = create_vcluster();
+	v_cl.sum(tot);
+	v_cl.execute();
+
+	vd.map();
+
+	size_t tot_after = vd.size_local();
+	v_cl.sum(tot_after);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(tot,tot_after);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_add_bulk )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+	Ghost<3,float> ghost(0.1);
+
+	vector_dist<3,float, aggregate<size_t> > vd(0,box,bc,ghost);
+
+	auto & v_cl = create_vcluster();
+
+	// every processor create a lattice of 32^3 particles, the lattice cover the full domain
+	size_t sz = 32;
+
+	vd.reserve(sz*sz*sz);
+	size_t start = vd.addBulk(sz*sz*sz,[&](size_t i, vect_dist_key_dx key)
+	{
+		vd.getPos(key)[0] = ((i % sz) + 0.5) / sz;
+		vd.getPos(key)[1] = (((i / sz) % sz) + 0.5) / sz;
+		vd.getPos(key)[2] = ((i / sz / sz) + 0.5) / sz;
+
+		vd.getProp<0>(key) = i;
+	},4);
+
+	BOOST_REQUIRE_EQUAL(start,0ul);
+	BOOST_REQUIRE_EQUAL(vd.size_local(),sz*sz*sz);
+
+	auto it = vd.getIteratorFrom(start);
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+		size_t i = vd.getProp<0>(key);
+
+		BOOST_REQUIRE_EQUAL(i,key.getKey() - start);
+		BOOST_REQUIRE_EQUAL(vd.getPos(key)[1],(float)((((i / sz) % sz) + 0.5) / sz));
+
+		++it;
+	}
+
+	// add other particles and send them to the owner in the same call
+	vd.addBulk(sz*sz*sz,[&](size_t i, vect_dist_key_dx key)
+	{
+		vd.getPos(key)[0] = ((i % sz) + 0.25) / sz;
+		vd.getPos(key)[1] = (((i / sz) % sz) + 0.25) / sz;
+		vd.getPos(key)[2] = ((i / sz / sz) + 0.25) / sz;
+
+		vd.getProp<0>(key) = i;
+	},1,true);
+
+	size_t tot = vd.size_local();
+	v_cl.sum(tot);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(tot,2*sz*sz*sz*v_cl.getProcessingUnits());
+
+	// after map all the particles are local
+	auto it2 = vd.getDomainIterator();
+
+	while (it2.isNext())
+	{
+		auto key = it2.get();
+
+		BOOST_REQUIRE(vd.getDecomposition().isLocal(vd.getPos(key)) == true);
+
+		++it2;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_map_property_subset )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t bc[3]={NON_PERIODIC,NON_PERIODIC,NON_PERIODIC};
+	Ghost<3,float> ghost(0.1);
+
+	vector_dist<3,float, aggregate<float,float[3],double> > vd(4096,box,bc,ghost);
+
+	auto & v_cl = create_vcluster();
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		// particles are created randomly, so they are on the wrong processor
+		vd.getPos(key)[0] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[1] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[2] = (float)rand() / RAND_MAX;
+
+		vd.getProp<0>(key) = vd.getPos(key)[0] + vd.getPos(key)[1];
+		vd.getProp<1>(key)[0] = 1.0;
+		vd.getProp<1>(key)[1] = 2.0;
+		vd.getProp<1>(key)[2] = 3.0;
+		vd.getProp<2>(key) = 4.0;
+
+		++it;
+	}
+
+	openfpm_profiler().reset();
+
+	vd.map_prp<0>();
+
+	size_t tot = vd.size_local();
+	v_cl.sum(tot);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(tot,4096ul);
+
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		BOOST_REQUIRE(vd.getDecomposition().isLocal(vd.getPos(i)) == true);
+		BOOST_REQUIRE_EQUAL(vd.getProp<0>(i),vd.getPos(i)[0] + vd.getPos(i)[1]);
+
+		if (i < vd.getMapNStay())
+		{
+			// particles that did not move keep all the properties
+			BOOST_REQUIRE_EQUAL(vd.getProp<1>(i)[2],3.0f);
+			BOOST_REQUIRE_EQUAL(vd.getProp<2>(i),4.0);
+		}
+		else
+		{
+			// received particles have the properties not sent value-initialized
+			BOOST_REQUIRE_EQUAL(vd.getProp<1>(i)[0],0.0f);
+			BOOST_REQUIRE_EQUAL(vd.getProp<1>(i)[1],0.0f);
+			BOOST_REQUIRE_EQUAL(vd.getProp<1>(i)[2],0.0f);
+			BOOST_REQUIRE_EQUAL(vd.getProp<2>(i),0.0);
+		}
+	}
+
+	// only one float is sent for each particle together with the position
+	const prof_phase_stat & st = openfpm_profiler().get(PROF_MAP);
+	BOOST_REQUIRE(st.cnt[PROF_BYTES_SENT] <= st.cnt[PROF_PART_SENT]*(sizeof(Point<3,float>) + sizeof(double)));
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_ghost_get_delta )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t bc[3]={NON_PERIODIC,NON_PERIODIC,NON_PERIODIC};
+	Ghost<3,float> ghost(0.1);
+
+	vector_dist<3,float, aggregate<float> > vd(4096,box,bc,ghost);
+
+	auto & v_cl = create_vcluster();
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[1] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[2] = (float)rand() / RAND_MAX;
+
+		++it;
+	}
+
+	vd.map();
+
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{vd.getProp<0>(i) = vd.getPos(i)[0] + vd.getPos(i)[1];}
+
+	vd.ghost_get<0>();
+
+	// the first delta exchange send everything
+	openfpm_profiler().reset();
+	vd.ghost_get<0>(SKIP_LABELLING | NO_POSITION | GHOST_DELTA);
+	size_t b_full = openfpm_profiler().get(PROF_GHOST_GET).cnt[PROF_BYTES_SENT];
+
+	// change only few particles
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		if (vd.getPos(i)[2] < 0.02)
+		{vd.getProp<0>(i) = vd.getPos(i)[0] + vd.getPos(i)[1] + 1.0;}
+	}
+
+	openfpm_profiler().reset();
+	vd.ghost_get<0>(SKIP_LABELLING | NO_POSITION | GHOST_DELTA);
+	size_t b_delta = openfpm_profiler().get(PROF_GHOST_GET).cnt[PROF_BYTES_SENT];
+
+	for (size_t i = vd.size_local() ; i < vd.size_local_with_ghost() ; i++)
+	{
+		float exp = vd.getPos(i)[0] + vd.getPos(i)[1];
+		if (vd.getPos(i)[2] < 0.02)
+		{exp += 1.0;}
+
+		BOOST_REQUIRE_EQUAL(vd.getProp<0>(i),exp);
+	}
+
+	v_cl.sum(b_full);
+	v_cl.sum(b_delta);
+	v_cl.execute();
+
+	BOOST_REQUIRE(b_delta <= b_full);
+	if (b_full != 0)
+	{BOOST_REQUIRE(b_delta < b_full);}
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_ghost_get_delta_two_properties )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t bc[3]={NON_PERIODIC,NON_PERIODIC,NON_PERIODIC};
+	Ghost<3,float> ghost(0.1);
+
+	vector_dist<3,float, aggregate<float,float> > vd(4096,box,bc,ghost);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[1] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[2] = (float)rand() / RAND_MAX;
+
+		++it;
+	}
+
+	vd.map();
+
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		vd.getProp<0>(i) = vd.getPos(i)[0] + vd.getPos(i)[1];
+		vd.getProp<1>(i) = 0.0;
+	}
+
+	vd.ghost_get<0,1>();
+	vd.ghost_get<0>(SKIP_LABELLING | NO_POSITION | GHOST_DELTA);
+
+	// property 1 become equal to what has been sent for property 0, the history of
+	// property 0 must not be used for property 1
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{vd.getProp<1>(i) = vd.getPos(i)[0] + vd.getPos(i)[1];}
+
+	vd.ghost_get<1>(SKIP_LABELLING | NO_POSITION | GHOST_DELTA);
+
+	for (size_t i = vd.size_local() ; i < vd.size_local_with_ghost() ; i++)
+	{
+		float exp = vd.getPos(i)[0] + vd.getPos(i)[1];
+
+		BOOST_REQUIRE_EQUAL(vd.getProp<0>(i),exp);
+		BOOST_REQUIRE_EQUAL(vd.getProp<1>(i),exp);
+	}
+
+	// now the delta of property 1 is against its own history
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		if (vd.getPos(i)[2] < 0.02)
+		{vd.getProp<1>(i) += 1.0;}
+	}
+
+	vd.ghost_get<1>(SKIP_LABELLING | NO_POSITION | GHOST_DELTA);
+
+	for (size_t i = vd.size_local() ; i < vd.size_local_with_ghost() ; i++)
+	{
+		float exp = vd.getPos(i)[0] + vd.getPos(i)[1];
+
+		BOOST_REQUIRE_EQUAL(vd.getProp<0>(i),exp);
+
+		if (vd.getPos(i)[2] < 0.02)
+		{exp += 1.0;}
+
+		BOOST_REQUIRE_EQUAL(vd.getProp<1>(i),exp);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_ghost_get_wire_codec )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t bc[3]={NON_PERIODIC,NON_PERIODIC,NON_PERIODIC};
+	Ghost<3,float> ghost(0.1);
+
+	vector_dist<3,float, aggregate<double,float[3]> > vd(4096,box,bc,ghost);
+
+	auto & v_cl = create_vcluster();
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[1] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[2] = (float)rand() / RAND_MAX;
+
+		++it;
+	}
+
+	vd.map();
+
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		vd.getProp<0>(i) = vd.getPos(i)[0] + vd.getPos(i)[1];
+		vd.getProp<1>(i)[0] = 1.0;
+		vd.getProp<1>(i)[1] = 2.0;
+		vd.getProp<1>(i)[2] = vd.getPos(i)[2];
+	}
+
+	openfpm_profiler().reset();
+	vd.ghost_get<0,1>();
+	size_t n_ghost = vd.size_local_with_ghost() - vd.size_local();
+	size_t b_raw = openfpm_profiler().get(PROF_GHOST_GET).cnt[PROF_BYTES_SENT];
+
+	openfpm_profiler().reset();
+	vd.ghost_get_wire<wire_pos_quant<unsigned short>,wire_f32,0,1>();
+	size_t b_wire = openfpm_profiler().get(PROF_GHOST_GET).cnt[PROF_BYTES_SENT];
+
+	BOOST_REQUIRE_EQUAL(vd.size_local_with_ghost() - vd.size_local(),n_ghost);
+
+	for (size_t i = vd.size_local() ; i < vd.size_local_with_ghost() ; i++)
+	{
+		// positions are quantised with 16 bit on a box of side at most ~1.2
+		BOOST_REQUIRE_CLOSE(vd.getProp<0>(i) + 1.0,vd.getPos(i)[0] + vd.getPos(i)[1] + 1.0,0.01);
+		BOOST_REQUIRE_EQUAL(vd.getProp<1>(i)[0],1.0f);
+		BOOST_REQUIRE_EQUAL(vd.getProp<1>(i)[1],2.0f);
+		BOOST_REQUIRE_CLOSE(vd.getProp<1>(i)[2] + 1.0f,vd.getPos(i)[2] + 1.0f,0.01);
+	}
+
+	// the same with the lossless codecs reproduce the normal ghost_get
+	vd.ghost_get_wire<wire_pos_raw,wire_raw,0,1>(SKIP_LABELLING);
+
+	for (size_t i = vd.size_local() ; i < vd.size_local_with_ghost() ; i++)
+	{
+		BOOST_REQUIRE_EQUAL(vd.getProp<0>(i),(double)(vd.getPos(i)[0] + vd.getPos(i)[1]));
+		BOOST_REQUIRE_EQUAL(vd.getProp<1>(i)[2],vd.getPos(i)[2]);
+	}
+
+	v_cl.sum(b_raw);
+	v_cl.sum(b_wire);
+	v_cl.execute();
+
+	BOOST_REQUIRE(b_wire <= b_raw);
+	if (b_raw != 0)
+	{BOOST_REQUIRE(b_wire < b_raw);}
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_ghost_get_persistent_plan )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+	Ghost<3,float> ghost(0.1);
+
+	vector_dist<3,float, aggregate<float,size_t> > vd(4096,box,bc,ghost);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[1] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[2] = (float)rand() / RAND_MAX;
+
+		++it;
+	}
+
+	vd.map();
+
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		vd.getProp<0>(i) = 0.0;
+		vd.getProp<1>(i) = i;
+	}
+
+	vd.ghost_get<0,1>();
+
+	openfpm::vector<size_t> gid;
+	for (size_t i = vd.size_local() ; i < vd.size_local_with_ghost() ; i++)
+	{gid.add(vd.getProp<1>(i));}
+
+	// steady state, the layout does not change
+	for (size_t k = 1 ; k < 4 ; k++)
+	{
+		for (size_t i = 0 ; i < vd.size_local() ; i++)
+		{vd.getProp<0>(i) = k;}
+
+		vd.ghost_get<0>(SKIP_LABELLING | NO_CHANGE_ELEMENTS);
+
+		BOOST_REQUIRE_EQUAL(vd.size_local_with_ghost() - vd.size_local(),gid.size());
+
+		for (size_t i = vd.size_local() ; i < vd.size_local_with_ghost() ; i++)
+		{
+			BOOST_REQUIRE_EQUAL(vd.getProp<0>(i),(float)k);
+			BOOST_REQUIRE_EQUAL(vd.getProp<1>(i),gid.get(i - vd.size_local()));
+		}
+	}
+
+	// the plans for properties and positions has been created only once
+	BOOST_REQUIRE(vd.getGhostPlanNBuild() <= 2);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_map_auto_local )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+	Ghost<3,float> ghost(0.1);
+
+	vector_dist<3,float, aggregate<float> > vd(4096,box,bc,ghost);
+
+	auto & v_cl = create_vcluster();
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[1] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[2] = (float)rand() / RAND_MAX;
+
+		++it;
+	}
+
+	vd.map();
+
+	size_t n_local = vd.getMapNLocal();
+
+	// small displacement, every particle go at most to a neighborhood processor
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		vd.getPos(i)[0] += 0.01;
+		vd.getPos(i)[1] -= 0.01;
+	}
+
+	vd.map();
+
+	if (v_cl.size() > 1)
+	{BOOST_REQUIRE_EQUAL(vd.getMapNLocal(),n_local + 1);}
+
+	size_t tot = vd.size_local();
+	v_cl.sum(tot);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(tot,4096ul);
+
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{BOOST_REQUIRE(vd.getDecomposition().isLocal(vd.getPos(i)) == true);}
+
+	// forcing the dynamic discovery
+	vd.map(MAP_NBX);
+
+	if (v_cl.size() > 1)
+	{BOOST_REQUIRE_EQUAL(vd.getMapNLocal(),n_local + 1);}
+
+	// only the processor 0 has particles going far, the others still send only to the neighborhood
+	if (v_cl.rank() == 0)
+	{
+		for (size_t i = 0 ; i < vd.size_local() ; i += 2)
+		{
+			vd.getPos(i)[0] = fmod(vd.getPos(i)[0] + 0.5,1.0);
+			vd.getPos(i)[2] = fmod(vd.getPos(i)[2] + 0.5,1.0);
+		}
+	}
+
+	vd.map();
+
+	tot = vd.size_local();
+	v_cl.sum(tot);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(tot,4096ul);
+
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{BOOST_REQUIRE(vd.getDecomposition().isLocal(vd.getPos(i)) == true);}
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_map_distributed_directory )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+	Ghost<3,float> ghost(0.1);
+
+	auto & v_cl = create_vcluster();
+
+	size_t div[3];
+	size_t n_sub = v_cl.getProcessingUnits() * 64;
+	for (size_t i = 0 ; i < 3 ; i++)
+	{div[i] = openfpm::math::round_big_2(pow(n_sub,1.0/3));}
+
+	CartDecomposition<3,float> dec(v_cl);
+	dec.setDistributedDirectory(true);
+	dec.setParameters(div,box,bc,ghost);
+	dec.decompose();
+
+	vector_dist<3,float, aggregate<float> > vd(dec,4096);
+
+	// random positions, many particles go to far processors
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[1] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[2] = (float)rand() / RAND_MAX;
+
+		++it;
+	}
+
+	vd.map();
+
+	size_t tot = vd.size_local();
+	v_cl.sum(tot);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(tot,4096ul);
+
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		Point<3,float> p = vd.getPos(i);
+		BOOST_REQUIRE_EQUAL(vd.getDecomposition().processorIDLocal(p),(long int)v_cl.rank());
+	}
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_measured_comm_costs )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+	Ghost<3,float> ghost(0.05);
+
+	auto & v_cl = create_vcluster();
+
+	vector_dist<3,float, aggregate<float,float[3]> > vd(4096,box,bc,ghost);
+
+	// all the particles in the lower half
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[1] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[2] = 0.5 * (float)rand() / RAND_MAX;
+
+		++it;
+	}
+
+	vd.map();
+	vd.ghost_get<0>();
+
+	BOOST_REQUIRE_EQUAL(vd.getGhostObjectSize(),sizeof(float) + sizeof(Point<3,float>));
+
+	vd.measureCommunicationAndMigrationCosts();
+
+	auto & dec = vd.getDecomposition();
+	auto & dist = dec.getDistribution();
+
+	dec.computeCommunicationAndMigrationCosts(1);
+
+	// every processor set the costs of the sub-sub-domains it own, the edges must stay
+	// symmetric and the empty half must be cheaper than the full one
+	auto & gp = dist.getGraph();
+
+	size_t c_low = 0;
+	size_t c_high = 0;
+
+	for (size_t k = 0 ; k < dist.getNOwnerSubSubDomains() ; k++)
+	{
+		size_t i = dist.getOwnerSubSubDomain(k);
+
+		for (size_t s = 0 ; s < dist.getNSubSubDomainNeighbors(i) ; s++)
+		{
+			size_t j = dist.getSubSubDomainNeighbor(i,s);
+
+			if ((size_t)gp.template vertex_p<nm_v::proc_id>(j) != v_cl.rank())
+			{continue;}
+
+			for (size_t t = 0 ; t < dist.getNSubSubDomainNeighbors(j) ; t++)
+			{
+				if (dist.getSubSubDomainNeighbor(j,t) == i)
+				{BOOST_REQUIRE_EQUAL(dist.getSubSubDomainCommunicationCost(i,s),dist.getSubSubDomainCommunicationCost(j,t));}
+			}
+		}
+
+		float pos[3];
+		dist.getSubSubDomainPosition(i,pos);
+
+		if (pos[2] < 0.5)
+		{c_low += gp.vertex(i).template get<nm_v::migration>();}
+		else
+		{c_high += gp.vertex(i).template get<nm_v::migration>();}
+	}
+
+	v_cl.sum(c_low);
+	v_cl.sum(c_high);
+	v_cl.execute();
+
+	BOOST_REQUIRE(c_low > c_high);
+
+	// decompose with the measured costs
+	dec.redecompose(1);
+	vd.map();
+
+	size_t tot = vd.size_local();
+	v_cl.sum(tot);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(tot,4096ul);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_measured_comm_costs_metis )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+	Ghost<3,float> ghost(0.05);
+
+	auto & v_cl = create_vcluster();
+
+	typedef CartDecomposition<3,float,HeapMemory,memory_traits_lin,MetisDistribution<3,float>> dec_metis;
+
+	vector_dist<3,float, aggregate<float,float[3]>, dec_metis > vd(4096,box,bc,ghost);
+
+	// all the particles in the lower half
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[1] = (float)rand() / RAND_MAX;
+		vd.getPos(key)[2] = 0.5 * (float)rand() / RAND_MAX;
+
+		++it;
+	}
+
+	vd.map();
+	vd.ghost_get<0>();
+
+	vd.measureCommunicationAndMigrationCosts();
+
+	auto & dec = vd.getDecomposition();
+	auto & dist = dec.getDistribution();
+
+	dec.computeCommunicationAndMigrationCosts(1);
+
+	// Metis decompose on processor 0, it must have the costs of all the sub-sub-domains
+	if (v_cl.rank() == 0)
+	{
+		auto & gp = dist.getGraph();
+
+		size_t c_low = 0;
+		size_t c_high = 0;
+
+		for (size_t i = 0 ; i < dist.getNSubSubDomains() ; i++)
+		{
+			for (size_t s = 0 ; s < dist.getNSubSubDomainNeighbors(i) ; s++)
+			{
+				size_t j = dist.getSubSubDomainNeighbor(i,s);
+
+				for (size_t t = 0 ; t < dist.getNSubSubDomainNeighbors(j) ; t++)
+				{
+					if (dist.getSubSubDomainNeighbor(j,t) == i)
+					{BOOST_REQUIRE_EQUAL(dist.getSubSubDomainCommunicationCost(i,s),dist.getSubSubDomainCommunicationCost(j,t));}
+				}
+			}
+
+			if (gp.vertex(i).template get<nm_v::x>()[2] < 0.5)
+			{c_low += gp.vertex(i).template get<nm_v::migration>();}
+			else
+			{c_high += gp.vertex(i).template get<nm_v::migration>();}
+		}
+
+		BOOST_REQUIRE(c_low > c_high);
+	}
+
+	// decompose with the measured costs
+	dec.redecompose(1);
+	vd.map();
+
+	size_t tot = vd.size_local();
+	v_cl.sum(tot);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(tot,4096ul);
+}
 
 BOOST_AUTO_TEST_CASE( vector_of_vector_dist )
 {
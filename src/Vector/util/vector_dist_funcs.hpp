@@ -106,6 +106,57 @@ inline void process_map_particle(size_t i, long int & end, long int & id_end, To
 }
 
 
+/*! \brief Fill the sending buffers and remove the migrating particles preserving the order of the remaining
+ *
+ * In contrast to process_map_particle the holes are not filled with particles from the tail, the remaining
+ * particles are compacted in a single pass. This keep the relative order of the particles that stay
+ * (needed to keep the vector sorted along a space filling curve)
+ *
+ *  \param m_opart for each particle the property 0 contain the particle id (ordered), 2 contain to which processor has to go
+ *  \param p_map_req it map processor id to request id
+ *  \param m_pos sending buffer to fill for position
+ *  \param m_prp sending buffer to fill for properties
+ *  \param v_pos particle position
+ *  \param v_prp particle properties
+ *  \param cnt counter for each sending buffer
+ *
+ */
+template<typename proc_class, typename Top,typename Pmr, typename T1, typename T2, typename T3, typename T4>
+inline void process_map_particles_stable(Top & m_opart, Pmr p_map_req, T1 & m_pos, T2 & m_prp, T3 & v_pos, T4 & v_prp, openfpm::vector<size_t> & cnt)
+{
+	size_t k = 0;
+	size_t w = 0;
+
+	for (size_t i = 0 ; i < v_pos.size() ; i++)
+	{
+		if (k < m_opart.size() && (size_t)m_opart.template get<0>(k) == i)
+		{
+			long int prc_id = m_opart.template get<2>(k);
+
+			if (prc_id >= 0)
+			{
+				size_t lbl = p_map_req.get(prc_id);
+
+				m_pos.get(lbl).set(cnt.get(lbl), v_pos.get(i));
+				proc_class::proc(lbl,cnt.get(lbl),i,v_prp,m_prp);
+
+				cnt.get(lbl)++;
+			}
+
+			k++;
+			continue;
+		}
+
+		if (w != i)
+		{
+			v_pos.set(w,v_pos.get(i));
+			v_prp.set(w,v_prp.get(i));
+		}
+
+		w++;
+	}
+}
+
 //! It process one particle
 template<typename proc_class, typename Top, typename T1, typename T2, typename T3, typename T4>
 __device__ inline void process_map_device_particle(unsigned int i, unsigned int offset, Top & m_opart, T1 & m_pos, T2 & m_prp, T3 & v_pos, T4 & v_prp)
@@ -407,4 +458,74 @@ struct compare_host_device<base_type[N1][N2],prp>
 	}
 };
 
+/*! \brief Check if the property id is in the list prp...
+ *
+ * \tparam id property to check
+ * \tparam prp list of properties
+ *
+ */
+template<int id, int ... prp>
+struct prp_is_listed
+{
+	//! false, the list is empty
+	enum {value = false};
+};
+
+//! Check if the property id is in the list prp...
+template<int id, int p, int ... prp>
+struct prp_is_listed<id,p,prp...>
+{
+	//! true if id is p or it is in the rest of the list
+	enum {value = (id == p) || prp_is_listed<id,prp...>::value};
+};
+
+/*! \brief Value-initialize, for the particles [start,stop), all the properties not in prp...
+ *
+ * It is used after a map that communicate only a subset of the properties, so the received particles
+ * do not contain garbage in the properties not sent
+ *
+ * \tparam vector_prp property vector
+ * \tparam prop property type
+ * \tparam prp properties sent
+ *
+ */
+template<typename vector_prp, typename prop, int ... prp>
+struct init_unlisted_prp
+{
+	//! property vector
+	vector_prp & v_prp;
+
+	//! first particle
+	size_t start;
+
+	//! end particle
+	size_t stop;
+
+	/*! \brief Constructor
+	 *
+	 * \param v_prp property vector
+	 * \param start first particle
+	 * \param stop end particle
+	 *
+	 */
+	init_unlisted_prp(vector_prp & v_prp, size_t start, size_t stop)
+	:v_prp(v_prp),start(start),stop(stop)
+	{};
+
+	//! It call the copy function for each property
+	template<typename T>
+	inline void operator()(T& t)
+	{
+		typedef typename boost::mpl::at<typename prop::type,boost::mpl::int_<T::value>>::type prp_type;
+
+		if (prp_is_listed<T::value,prp...>::value == true)
+		{return;}
+
+		prp_type zero{};
+
+		for (size_t i = start ; i < stop ; i++)
+		{meta_copy<prp_type>::meta_copy_(zero,v_prp.template get<T::value>(i));}
+	}
+};
+
 #endif /* VECTOR_DIST_FUNCS_HPP_ */
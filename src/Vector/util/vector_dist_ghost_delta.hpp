@@ -0,0 +1,367 @@
+/*
+ * vector_dist_ghost_delta.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef VECTOR_DIST_GHOST_DELTA_HPP_
+#define VECTOR_DIST_GHOST_DELTA_HPP_
+
+#include <cstring>
+#include <climits>
+#include <type_traits>
+#include "Vector/util/vector_dist_ghost_plan.hpp"
+
+/*! \brief State of the delta ghost_get (GHOST_DELTA)
+ *
+ * For each processor we send ghost properties it store the packed properties
+ * sent in the last exchange. It is valid only as long as the ghost layout does
+ * not change (no labelling in between)
+ *
+ */
+struct ghost_delta_state
+{
+	//! for each processor (in prc_g_opart order) the raw bytes of the properties sent last time
+	openfpm::vector<openfpm::vector<unsigned char>> last;
+
+	//! properties sent in the last exchange (the history is valid only for the same properties)
+	openfpm::vector<int> prp_key;
+
+	//! true if there is a valid history
+	bool valid = false;
+
+	/*! \brief Invalidate the history, the next exchange send everything
+	 *
+	 */
+	void invalidate()
+	{
+		valid = false;
+		prp_key.clear();
+		last.clear();
+	}
+
+	/*! \brief Check if the history has been produced by the exchange of the properties prp...
+	 *
+	 * \tparam prp properties
+	 *
+	 * \return true if the history refer to prp...
+	 *
+	 */
+	template<int ... prp> bool match() const
+	{
+		const int key[] = {prp...};
+
+		if (valid == false || prp_key.size() != sizeof...(prp))
+		{return false;}
+
+		for (size_t i = 0 ; i < sizeof...(prp) ; i++)
+		{
+			if (prp_key.get(i) != key[i])
+			{return false;}
+		}
+
+		return true;
+	}
+
+	/*! \brief Set the properties the history refer to
+	 *
+	 * \tparam prp properties
+	 *
+	 */
+	template<int ... prp> void set()
+	{
+		const int key[] = {prp...};
+
+		prp_key.resize(sizeof...(prp));
+		for (size_t i = 0 ; i < sizeof...(prp) ; i++)
+		{prp_key.get(i) = key[i];}
+
+		valid = true;
+	}
+};
+
+/*! \brief Check that all the properties prp... of prop are trivially copyable
+ *
+ * The delta ghost_get compare and copy the packed properties as raw bytes
+ *
+ * \tparam prop property object
+ * \tparam prp properties
+ *
+ */
+template<typename prop, int ... prp>
+struct ghost_delta_trivial
+{
+	//! true if all the properties are trivially copyable
+	static const bool value = true;
+};
+
+template<typename prop, int prp1, int ... prp>
+struct ghost_delta_trivial<prop,prp1,prp...>
+{
+	//! type of the property prp1
+	typedef typename boost::mpl::at<typename prop::type,boost::mpl::int_<prp1>>::type T;
+
+	//! true if all the properties are trivially copyable
+	static const bool value = std::is_trivially_copyable<T>::value && ghost_delta_trivial<prop,prp...>::value;
+};
+
+//! message header of the delta ghost_get
+struct ghost_delta_header
+{
+	//! number of elements in the message
+	size_t n;
+
+	//! 1 if the message contain a bitmap of the changed elements, 0 if it contain all elements
+	size_t delta;
+};
+
+/*! \brief Delta ghost_get implementation, for not linear layouts or not trivially copyable
+ *         properties it is not supported and the caller send everything
+ *
+ * \tparam is_lin true if the properties are stored with a linear layout and are trivially copyable
+ *
+ */
+template<bool is_lin>
+struct ghost_delta_impl
+{
+	template<typename prp_object, int ... prp, typename send_vector, typename vector_prp>
+	static bool run(Vcluster<> & v_cl,
+					ghost_comm_plan & plan,
+					size_t max_n,
+					ghost_delta_state & gds,
+					openfpm::vector<send_vector> & g_send_prp,
+					vector_prp & v_prp,
+					size_t g_m,
+					openfpm::vector<size_t> & prc_g_opart,
+					openfpm::vector<size_t> & prc_recv_get,
+					openfpm::vector<size_t> & recv_sz_get,
+					size_t & b_sent,
+					size_t & b_recv)
+	{
+		return false;
+	}
+};
+
+/*! \brief Delta ghost_get implementation for linear layouts
+ *
+ * Each packed ghost property object is compared (byte by byte) with the one sent
+ * in the previous exchange. For each processor we send either a bitmap of the
+ * changed elements followed by the changed elements, or all the elements, whichever
+ * is smaller. The receiver overwrite only the ghost elements marked in the bitmap,
+ * the others keep the value of the previous exchange
+ *
+ * The ghost layout is fixed, so the messages go through a communication plan with
+ * fixed buffers sized for the full message of each processor (ghost_comm_plan::exchange_var)
+ * and no dynamic discovery of the receivers is needed
+ *
+ */
+template<>
+struct ghost_delta_impl<true>
+{
+	/*! \brief Pack the delta message for one processor
+	 *
+	 * \param cur packed properties to send
+	 * \param n number of elements
+	 * \param obj_sz size of one element
+	 * \param last properties sent in the previous exchange (updated)
+	 * \param valid true if last can be used as reference
+	 * \param buf output message (at least sizeof(ghost_delta_header) + n*obj_sz bytes)
+	 *
+	 * \return the size of the message
+	 *
+	 */
+	static size_t pack(const unsigned char * cur,
+					   size_t n,
+					   size_t obj_sz,
+					   openfpm::vector<unsigned char> & last,
+					   bool valid,
+					   unsigned char * buf)
+	{
+		valid &= (last.size() == n*obj_sz);
+
+		size_t n_ch = n;
+		if (valid == true)
+		{
+			n_ch = 0;
+			for (size_t j = 0 ; j < n ; j++)
+			{n_ch += (memcmp(cur + j*obj_sz,&last.get(j*obj_sz),obj_sz) != 0);}
+		}
+
+		size_t sz_bm = (n + 7) / 8;
+		size_t sz_delta = sizeof(ghost_delta_header) + sz_bm + n_ch*obj_sz;
+		size_t sz_full = sizeof(ghost_delta_header) + n*obj_sz;
+
+		ghost_delta_header hdr;
+		hdr.n = n;
+		hdr.delta = (valid == true && sz_delta < sz_full);
+
+		memcpy(buf,&hdr,sizeof(ghost_delta_header));
+		unsigned char * out = buf + sizeof(ghost_delta_header);
+
+		if (hdr.delta)
+		{
+			unsigned char * bm = out;
+			memset(bm,0,sz_bm);
+			out += sz_bm;
+
+			for (size_t j = 0 ; j < n ; j++)
+			{
+				if (memcmp(cur + j*obj_sz,&last.get(j*obj_sz),obj_sz) != 0)
+				{
+					bm[j / 8] |= (unsigned char)(1 << (j % 8));
+					memcpy(out,cur + j*obj_sz,obj_sz);
+					out += obj_sz;
+				}
+			}
+		}
+		else if (n != 0)
+		{memcpy(out,cur,n*obj_sz);}
+
+		// remember what we sent
+		last.resize(n*obj_sz);
+		if (n != 0)
+		{memcpy(&last.get(0),cur,n*obj_sz);}
+
+		return (hdr.delta)?sz_delta:sz_full;
+	}
+
+	/*! \brief Capacity of the message of n elements (no message when there are no elements)
+	 *
+	 * \param n number of elements
+	 * \param obj_sz size of one element
+	 *
+	 * \return the capacity in byte
+	 *
+	 */
+	static size_t capacity(size_t n, size_t obj_sz)
+	{
+		return (n == 0)?0:sizeof(ghost_delta_header) + n*obj_sz;
+	}
+
+	/*! \brief Exchange the ghost properties sending only the changes
+	 *
+	 * \param v_cl Vcluster
+	 * \param plan communication plan of the delta messages
+	 * \param max_n maximum number of ghost particles in one message across all processors
+	 * \param gds history of the sent properties
+	 * \param g_send_prp packed properties to send for each processor
+	 * \param v_prp property vector
+	 * \param g_m ghost marker
+	 * \param prc_g_opart processors we send to
+	 * \param prc_recv_get ghost layout (processors)
+	 * \param recv_sz_get ghost layout (number of particles)
+	 * \param b_sent bytes sent
+	 * \param b_recv bytes received
+	 *
+	 * \return false if the messages are too big for MPI (the same on all the processors), the caller send everything
+	 *
+	 */
+	template<typename prp_object, int ... prp, typename send_vector, typename vector_prp>
+	static bool run(Vcluster<> & v_cl,
+					ghost_comm_plan & plan,
+					size_t max_n,
+					ghost_delta_state & gds,
+					openfpm::vector<send_vector> & g_send_prp,
+					vector_prp & v_prp,
+					size_t g_m,
+					openfpm::vector<size_t> & prc_g_opart,
+					openfpm::vector<size_t> & prc_recv_get,
+					openfpm::vector<size_t> & recv_sz_get,
+					size_t & b_sent,
+					size_t & b_recv)
+	{
+		static_assert(ghost_delta_trivial<typename vector_prp::value_type,prp...>::value,"delta ghost_get support only trivially copyable properties");
+
+		size_t obj_sz = sizeof(prp_object);
+
+		// everything is sent, the history is not valid anymore
+		if (capacity(max_n,obj_sz) > INT_MAX)
+		{
+			gds.invalidate();
+			return false;
+		}
+
+		plan.prepare(v_cl.getMPIComm(),
+				     prc_g_opart,[&](size_t i){return capacity(g_send_prp.get(i).size(),obj_sz);},
+				     prc_recv_get,[&](size_t i){return capacity(recv_sz_get.get(i),obj_sz);},
+				     false);
+
+		bool valid = (gds.template match<prp...>() && gds.last.size() == g_send_prp.size());
+		gds.last.resize(g_send_prp.size());
+
+		for (size_t i = 0 ; i < g_send_prp.size() ; i++)
+		{
+			size_t n = g_send_prp.get(i).size();
+
+			if (n == 0)
+			{
+				gds.last.get(i).clear();
+				plan.setSendSize(i,0);
+				continue;
+			}
+
+			const unsigned char * cur = (const unsigned char *)g_send_prp.get(i).getPointer();
+
+			size_t sz = pack(cur,n,obj_sz,gds.last.get(i),valid,&plan.getSendBuffers().get(i).get(0));
+			plan.setSendSize(i,sz);
+			b_sent += sz;
+		}
+
+		gds.template set<prp...>();
+
+		plan.exchange_var();
+
+		typedef encapc<1,prp_object,typename memory_traits_lin<prp_object>::type> encap_src;
+		typedef decltype(v_prp.get(0)) encap_dst;
+
+		openfpm::vector<prp_object> tmp(1);
+		openfpm::vector<unsigned char> & d_recv = plan.getRecvBuffer();
+		openfpm::vector<size_t> & sz_recv = plan.getRecvSizes();
+
+		// The ghost are placed after g_m in the order of prc_recv_get, the message of each processor is at a
+		// fixed offset of the receive buffer
+		size_t start = g_m;
+		size_t off = 0;
+		for (size_t i = 0 ; i < prc_recv_get.size() ; i++)
+		{
+			if (recv_sz_get.get(i) == 0)
+			{continue;}
+
+			const unsigned char * msg0 = &d_recv.get(off);
+			const unsigned char * msg = msg0;
+			off += sz_recv.get(i);
+
+			ghost_delta_header hdr;
+			memcpy(&hdr,msg,sizeof(ghost_delta_header));
+			msg += sizeof(ghost_delta_header);
+
+			if (hdr.n != recv_sz_get.get(i))
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " error delta ghost_get, the ghost layout changed, use ghost_get without SKIP_LABELLING" << std::endl;
+				return true;
+			}
+
+			const unsigned char * bm = msg;
+			const unsigned char * val = (hdr.delta)?msg + (hdr.n + 7) / 8:msg;
+
+			for (size_t j = 0 ; j < hdr.n ; j++)
+			{
+				if (hdr.delta && (bm[j / 8] & (1 << (j % 8))) == 0)
+				{continue;}
+
+				memcpy(tmp.getPointer(),val,obj_sz);
+				val += obj_sz;
+
+				object_s_di<encap_src,encap_dst,OBJ_ENCAP,prp...>(tmp.get(0),v_prp.get(start + j));
+			}
+
+			b_recv += val - msg0;
+			start += hdr.n;
+		}
+
+		return true;
+	}
+};
+
+#endif /* VECTOR_DIST_GHOST_DELTA_HPP_ */
@@ -0,0 +1,372 @@
+/*
+ * vector_dist_ghost_plan.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef VECTOR_DIST_GHOST_PLAN_HPP_
+#define VECTOR_DIST_GHOST_PLAN_HPP_
+
+#include <climits>
+#include <vector>
+
+/*! \brief Persistent communication plan for ghost_get
+ *
+ * When the ghost layout does not change (SKIP_LABELLING | NO_CHANGE_ELEMENTS)
+ * senders, receivers and message sizes are known. The plan create one persistent
+ * request (MPI_Send_init / MPI_Recv_init) for each message on fixed buffers, so
+ * that every exchange is only MPI_Startall + MPI_Waitall, without handshake and
+ * without allocations (the message sizes and the buffers are kept in the plan). The
+ * requests are created again only if the layout change.
+ *
+ * A plan can also be prepared without persistent requests for messages of variable size
+ * (like the delta ghost_get): the sizes given are then the capacity of each message and
+ * exchange_var() send only the part set with setSendSize(), still without handshake
+ * because the senders and the receivers are known
+ *
+ * The plan use its own communicator (duplicated at the first use, collective),
+ * so its messages never match the ones of Vcluster
+ *
+ */
+class ghost_comm_plan
+{
+	//! communicator of the plan
+	MPI_Comm comm = MPI_COMM_NULL;
+
+	//! processors we send to
+	openfpm::vector<size_t> prc_send;
+
+	//! size in byte of the messages we send
+	openfpm::vector<size_t> sz_send;
+
+	//! processors we receive from
+	openfpm::vector<size_t> prc_recv;
+
+	//! size in byte of the messages we receive
+	openfpm::vector<size_t> sz_recv;
+
+	//! send buffers (one for each processor in prc_send)
+	openfpm::vector<openfpm::vector<unsigned char>> send;
+
+	//! receive buffer (messages are consecutive in prc_recv order)
+	openfpm::vector<unsigned char> recv;
+
+	//! persistent requests (receive first)
+	std::vector<MPI_Request> req;
+
+	//! requests of exchange_var
+	std::vector<MPI_Request> req_v;
+
+	//! bytes to send of each message in exchange_var
+	openfpm::vector<size_t> sz_used;
+
+	//! true if the plan has persistent requests
+	bool persistent = true;
+
+	//! number of times the requests has been created
+	size_t n_build = 0;
+
+	//! true if the requests has been created for the current layout
+	bool built = false;
+
+	//! free the persistent requests
+	void free_req()
+	{
+		for (size_t i = 0 ; i < req.size() ; i++)
+		{MPI_Request_free(&req[i]);}
+
+		req.clear();
+	}
+
+	//! check if the list are equal
+	static bool equal(const openfpm::vector<size_t> & a, const openfpm::vector<size_t> & b)
+	{
+		if (a.size() != b.size())
+		{return false;}
+
+		for (size_t i = 0 ; i < a.size() ; i++)
+		{
+			if (a.get(i) != b.get(i))
+			{return false;}
+		}
+
+		return true;
+	}
+
+	//! check if the sizes stored are equal to f(i) for i in [0,n)
+	template<typename F> static bool equal_sz(const openfpm::vector<size_t> & sz, size_t n, F & f)
+	{
+		if (sz.size() != n)
+		{return false;}
+
+		for (size_t i = 0 ; i < n ; i++)
+		{
+			if (sz.get(i) != f(i))
+			{return false;}
+		}
+
+		return true;
+	}
+
+public:
+
+	//! Constructor
+	ghost_comm_plan()
+	{}
+
+	//! the requests refer to the buffers of this object, it cannot be copied
+	ghost_comm_plan(const ghost_comm_plan & p) = delete;
+
+	//! the requests refer to the buffers of this object, it cannot be copied
+	ghost_comm_plan & operator=(const ghost_comm_plan & p) = delete;
+
+	//! Destructor
+	~ghost_comm_plan()
+	{
+		int finalized = 0;
+		MPI_Finalized(&finalized);
+
+		if (finalized == true)
+		{return;}
+
+		free_req();
+
+		if (comm != MPI_COMM_NULL)
+		{MPI_Comm_free(&comm);}
+	}
+
+	/*! \brief Prepare the plan for the given layout, if the layout is the same of the previous call nothing is done
+	 *
+	 * The sizes are given as functions of the message index, they are compared with the stored ones
+	 * without allocating, so an unchanged layout cost only the comparison
+	 *
+	 * \warning the first call is collective on base
+	 *
+	 * \param base communicator
+	 * \param prc_send_ processors we send to
+	 * \param sz_send_ size in byte of the message i to send (sz_send_(i))
+	 * \param prc_recv_ processors we receive from
+	 * \param sz_recv_ size in byte of the message i to receive (sz_recv_(i))
+	 * \param persistent_ false to use the plan with exchange_var (the sizes are the capacity of the messages)
+	 *
+	 * \return false if the plan cannot be created (messages too big for MPI)
+	 *
+	 */
+	template<typename F_send, typename F_recv>
+	bool prepare(MPI_Comm base,
+				 const openfpm::vector<size_t> & prc_send_,
+				 F_send sz_send_,
+				 const openfpm::vector<size_t> & prc_recv_,
+				 F_recv sz_recv_,
+				 bool persistent_ = true)
+	{
+		if (comm == MPI_COMM_NULL)
+		{MPI_Comm_dup(base,&comm);}
+
+		if (built == true && persistent == persistent_ && equal(prc_send,prc_send_) && equal(prc_recv,prc_recv_) &&
+			equal_sz(sz_send,prc_send_.size(),sz_send_) && equal_sz(sz_recv,prc_recv_.size(),sz_recv_))
+		{return true;}
+
+		free_req();
+		built = false;
+
+		for (size_t i = 0 ; i < prc_send_.size() ; i++)
+		{
+			if (sz_send_(i) > INT_MAX)
+			{return false;}
+		}
+
+		for (size_t i = 0 ; i < prc_recv_.size() ; i++)
+		{
+			if (sz_recv_(i) > INT_MAX)
+			{return false;}
+		}
+
+		persistent = persistent_;
+		prc_send = prc_send_;
+		prc_recv = prc_recv_;
+
+		sz_send.resize(prc_send.size());
+		for (size_t i = 0 ; i < prc_send.size() ; i++)
+		{sz_send.get(i) = sz_send_(i);}
+
+		sz_recv.resize(prc_recv.size());
+		for (size_t i = 0 ; i < prc_recv.size() ; i++)
+		{sz_recv.get(i) = sz_recv_(i);}
+
+		size_t tot_recv = 0;
+		for (size_t i = 0 ; i < sz_recv.size() ; i++)
+		{tot_recv += sz_recv.get(i);}
+
+		recv.resize(tot_recv);
+		send.resize(prc_send.size());
+
+		sz_used.resize(prc_send.size());
+		for (size_t i = 0 ; i < prc_send.size() ; i++)
+		{
+			send.get(i).resize(sz_send.get(i));
+			sz_used.get(i) = sz_send.get(i);
+		}
+
+		if (persistent == false)
+		{
+			built = true;
+			n_build++;
+
+			return true;
+		}
+
+		size_t off = 0;
+		for (size_t i = 0 ; i < prc_recv.size() ; i++)
+		{
+			if (sz_recv.get(i) != 0)
+			{
+				req.push_back(MPI_REQUEST_NULL);
+				MPI_Recv_init(&recv.get(off),sz_recv.get(i),MPI_BYTE,prc_recv.get(i),0,comm,&req.back());
+			}
+
+			off += sz_recv.get(i);
+		}
+
+		for (size_t i = 0 ; i < prc_send.size() ; i++)
+		{
+			if (sz_send.get(i) != 0)
+			{
+				req.push_back(MPI_REQUEST_NULL);
+				MPI_Send_init(&send.get(i).get(0),sz_send.get(i),MPI_BYTE,prc_send.get(i),0,comm,&req.back());
+			}
+		}
+
+		built = true;
+		n_build++;
+
+		return true;
+	}
+
+	/*! \brief Execute the exchange (the send buffers must be filled)
+	 *
+	 */
+	void exchange()
+	{
+		if (req.size() == 0)
+		{return;}
+
+		MPI_Startall(req.size(),&req[0]);
+		MPI_Waitall(req.size(),&req[0],MPI_STATUSES_IGNORE);
+	}
+
+	/*! \brief Set the number of bytes to send of the message i in exchange_var
+	 *
+	 * \param i message
+	 * \param sz number of bytes (at most the capacity given in prepare)
+	 *
+	 */
+	void setSendSize(size_t i, size_t sz)
+	{
+		sz_used.get(i) = sz;
+	}
+
+	/*! \brief Execute the exchange of a plan prepared without persistent requests
+	 *
+	 * The message of each processor is received at its fixed offset of the receive buffer
+	 * (the offsets are given by the capacities), the message carry its actual size
+	 *
+	 */
+	void exchange_var()
+	{
+		req_v.clear();
+
+		size_t off = 0;
+		for (size_t i = 0 ; i < prc_recv.size() ; i++)
+		{
+			if (sz_recv.get(i) != 0)
+			{
+				req_v.push_back(MPI_REQUEST_NULL);
+				MPI_Irecv(&recv.get(off),sz_recv.get(i),MPI_BYTE,prc_recv.get(i),0,comm,&req_v.back());
+			}
+
+			off += sz_recv.get(i);
+		}
+
+		for (size_t i = 0 ; i < prc_send.size() ; i++)
+		{
+			if (sz_used.get(i) != 0)
+			{
+				req_v.push_back(MPI_REQUEST_NULL);
+				MPI_Isend(&send.get(i).get(0),sz_used.get(i),MPI_BYTE,prc_send.get(i),0,comm,&req_v.back());
+			}
+		}
+
+		if (req_v.size() != 0)
+		{MPI_Waitall(req_v.size(),&req_v[0],MPI_STATUSES_IGNORE);}
+	}
+
+	/*! \brief Get the send buffers, one for each processor we send to
+	 *
+	 * \warning the buffers must be filled in place without changing their size
+	 *
+	 * \return the send buffers
+	 *
+	 */
+	openfpm::vector<openfpm::vector<unsigned char>> & getSendBuffers()
+	{
+		return send;
+	}
+
+	/*! \brief Get the receive buffer
+	 *
+	 * \return the receive buffer
+	 *
+	 */
+	openfpm::vector<unsigned char> & getRecvBuffer()
+	{
+		return recv;
+	}
+
+	/*! \brief Get the processors we receive from
+	 *
+	 * \return the list of processors
+	 *
+	 */
+	openfpm::vector<size_t> & getRecvProcessors()
+	{
+		return prc_recv;
+	}
+
+	/*! \brief Get the size of the messages we receive
+	 *
+	 * \return the size in byte of each message
+	 *
+	 */
+	openfpm::vector<size_t> & getRecvSizes()
+	{
+		return sz_recv;
+	}
+
+	/*! \brief Total number of bytes sent for each exchange
+	 *
+	 * \return the number of bytes
+	 *
+	 */
+	size_t getSentBytes() const
+	{
+		size_t tot = 0;
+		for (size_t i = 0 ; i < sz_used.size() ; i++)
+		{tot += sz_used.get(i);}
+
+		return tot;
+	}
+
+	/*! \brief Number of times the persistent requests has been created
+	 *
+	 * \return the counter
+	 *
+	 */
+	size_t getNBuild() const
+	{
+		return n_build;
+	}
+};
+
+#endif /* VECTOR_DIST_GHOST_PLAN_HPP_ */
@@ -0,0 +1,769 @@
+/*
+ * vector_dist_wire_codec.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef VECTOR_DIST_WIRE_CODEC_HPP_
+#define VECTOR_DIST_WIRE_CODEC_HPP_
+
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+
+/*! \brief Property wire codec, the properties are sent as they are
+ *
+ */
+struct wire_raw
+{
+	//! type used on the wire for the scalar T
+	template<typename T> struct wire {typedef T type;};
+};
+
+/*! \brief Property wire codec, double components are sent as float
+ *
+ * The other scalar types are sent as they are
+ *
+ */
+struct wire_f32
+{
+	//! type used on the wire for the scalar T
+	template<typename T> struct wire {typedef T type;};
+};
+
+//! double are sent as float
+template<> struct wire_f32::wire<double> {typedef float type;};
+
+/*! \brief Encode/decode one property with the codec
+ *
+ * Arithmetic properties (and arrays of them) are converted component by component
+ * in the wire type of the codec
+ *
+ * \tparam codec property wire codec
+ * \tparam T property type
+ *
+ */
+template<typename codec, typename T, bool is_arith = std::is_arithmetic<typename std::remove_all_extents<T>::type>::value>
+struct wire_prp_codec
+{
+	//! scalar type of the property
+	typedef typename std::remove_all_extents<T>::type scalar;
+
+	//! scalar type on the wire
+	typedef typename codec::template wire<scalar>::type wscalar;
+
+	//! number of components
+	static const size_t n = sizeof(T) / sizeof(scalar);
+
+	//! size of the property on the wire
+	static const size_t size = n * sizeof(wscalar);
+
+	//! encode the property in out and move out forward
+	static inline void encode(const T & v, unsigned char * & out)
+	{
+		const scalar * s = reinterpret_cast<const scalar *>(&v);
+
+		for (size_t i = 0 ; i < n ; i++)
+		{
+			wscalar w = static_cast<wscalar>(s[i]);
+			memcpy(out,&w,sizeof(wscalar));
+			out += sizeof(wscalar);
+		}
+	}
+
+	//! decode the property from in and move in forward
+	static inline void decode(T & v, const unsigned char * & in)
+	{
+		scalar * s = reinterpret_cast<scalar *>(&v);
+
+		for (size_t i = 0 ; i < n ; i++)
+		{
+			wscalar w;
+			memcpy(&w,in,sizeof(wscalar));
+			s[i] = static_cast<scalar>(w);
+			in += sizeof(wscalar);
+		}
+	}
+};
+
+/*! \brief Encode/decode one property with the codec
+ *
+ * Not arithmetic properties are sent as raw bytes
+ *
+ * \tparam codec property wire codec
+ * \tparam T property type
+ *
+ */
+template<typename codec, typename T>
+struct wire_prp_codec<codec,T,false>
+{
+	static_assert(std::is_trivially_copyable<T>::value,"wire codecs support only trivially copyable properties");
+
+	//! size of the property on the wire
+	static const size_t size = sizeof(T);
+
+	//! encode the property in out and move out forward
+	static inline void encode(const T & v, unsigned char * & out)
+	{
+		memcpy(out,&v,sizeof(T));
+		out += sizeof(T);
+	}
+
+	//! decode the property from in and move in forward
+	static inline void decode(T & v, const unsigned char * & in)
+	{
+		memcpy(&v,in,sizeof(T));
+		in += sizeof(T);
+	}
+};
+
+/*! \brief Position wire codec, the positions are sent as they are
+ *
+ */
+struct wire_pos_raw
+{
+	/*! \brief size of a message of n positions
+	 *
+	 * \param n number of positions
+	 *
+	 * \return the size in byte
+	 *
+	 */
+	template<unsigned int dim, typename St> static size_t size(size_t n)
+	{
+		return n*dim*sizeof(St);
+	}
+
+	/*! \brief number of positions in a message
+	 *
+	 * \param sz size of the message in byte
+	 *
+	 * \return the number of positions
+	 *
+	 */
+	template<unsigned int dim, typename St> static size_t count(size_t sz)
+	{
+		return sz / (dim*sizeof(St));
+	}
+
+	/*! \brief encode n positions
+	 *
+	 * \param pos positions (any vector like object with size() and get<0>(j))
+	 * \param out output (at least size(n) bytes)
+	 *
+	 */
+	template<unsigned int dim, typename St, typename vector_pos> static void encode(const vector_pos & pos, unsigned char * out)
+	{
+		for (size_t j = 0 ; j < pos.size() ; j++)
+		{
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				St x = pos.template get<0>(j)[d];
+				memcpy(out,&x,sizeof(St));
+				out += sizeof(St);
+			}
+		}
+	}
+
+	/*! \brief decode n positions
+	 *
+	 * \param in message
+	 * \param pos decoded positions (already sized, any vector like object with size() and get<0>(j))
+	 *
+	 */
+	template<unsigned int dim, typename St, typename vector_pos> static void decode(const unsigned char * in, vector_pos & pos)
+	{
+		for (size_t j = 0 ; j < pos.size() ; j++)
+		{
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				St x;
+				memcpy(&x,in,sizeof(St));
+				pos.template get<0>(j)[d] = x;
+				in += sizeof(St);
+			}
+		}
+	}
+};
+
+/*! \brief Position wire codec, the positions are quantised relative to the bounding box of the message
+ *
+ * Each message start with the bounding box of its positions, every coordinate is
+ * then sent as an unsigned integer of type qint. The error on the received positions
+ * is at most the side of the box divided by 2 * max(qint)
+ *
+ * \tparam qint unsigned integer type used for one coordinate
+ *
+ */
+template<typename qint>
+struct wire_pos_quant
+{
+	static_assert(std::is_unsigned<qint>::value,"wire_pos_quant require an unsigned integer type");
+
+	//! see wire_pos_raw::size
+	template<unsigned int dim, typename St> static size_t size(size_t n)
+	{
+		return (n == 0)?0:2*dim*sizeof(St) + n*dim*sizeof(qint);
+	}
+
+	//! see wire_pos_raw::count
+	template<unsigned int dim, typename St> static size_t count(size_t sz)
+	{
+		return (sz == 0)?0:(sz - 2*dim*sizeof(St)) / (dim*sizeof(qint));
+	}
+
+	//! see wire_pos_raw::encode
+	template<unsigned int dim, typename St, typename vector_pos> static void encode(const vector_pos & pos, unsigned char * out)
+	{
+		if (pos.size() == 0)
+		{return;}
+
+		St lo[dim];
+		St hi[dim];
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{lo[d] = hi[d] = pos.template get<0>(0)[d];}
+
+		for (size_t j = 1 ; j < pos.size() ; j++)
+		{
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				St x = pos.template get<0>(j)[d];
+				lo[d] = (x < lo[d])?x:lo[d];
+				hi[d] = (x > hi[d])?x:hi[d];
+			}
+		}
+
+		memcpy(out,lo,dim*sizeof(St));
+		out += dim*sizeof(St);
+		memcpy(out,hi,dim*sizeof(St));
+		out += dim*sizeof(St);
+
+		const double q_max = (double)std::numeric_limits<qint>::max();
+
+		for (size_t j = 0 ; j < pos.size() ; j++)
+		{
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				double ext = (double)hi[d] - (double)lo[d];
+				double x = (double)pos.template get<0>(j)[d] - (double)lo[d];
+				qint q = (ext == 0.0)?0:(qint)std::round(x / ext * q_max);
+
+				memcpy(out,&q,sizeof(qint));
+				out += sizeof(qint);
+			}
+		}
+	}
+
+	//! see wire_pos_raw::decode
+	template<unsigned int dim, typename St, typename vector_pos> static void decode(const unsigned char * in, vector_pos & pos)
+	{
+		if (pos.size() == 0)
+		{return;}
+
+		St lo[dim];
+		St hi[dim];
+
+		memcpy(lo,in,dim*sizeof(St));
+		in += dim*sizeof(St);
+		memcpy(hi,in,dim*sizeof(St));
+		in += dim*sizeof(St);
+
+		const double q_max = (double)std::numeric_limits<qint>::max();
+
+		for (size_t j = 0 ; j < pos.size() ; j++)
+		{
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				qint q;
+				memcpy(&q,in,sizeof(qint));
+				in += sizeof(qint);
+
+				double ext = (double)hi[d] - (double)lo[d];
+				pos.template get<0>(j)[d] = (St)((double)lo[d] + (double)q / q_max * ext);
+			}
+		}
+	}
+};
+
+/*! \brief Positions of the particles sent to one processor (shifted for periodic boundary conditions) seen
+ *         as a vector, so that they are encoded without a temporary copy
+ *
+ */
+template<unsigned int dim, typename St, typename vector_pos, typename vector_opart, typename vector_shift>
+struct wire_pos_send_view
+{
+	//! position vector
+	vector_pos & v_pos;
+
+	//! particles to send (id, shift)
+	vector_opart & opart;
+
+	//! shift vectors
+	const vector_shift & shifts;
+
+	//! Constructor
+	wire_pos_send_view(vector_pos & v_pos, vector_opart & opart, const vector_shift & shifts)
+	:v_pos(v_pos),opart(opart),shifts(shifts)
+	{}
+
+	//! number of positions
+	inline size_t size() const
+	{
+		return opart.size();
+	}
+
+	//! shifted position of the particle j
+	template<unsigned int p> inline Point<dim,St> get(size_t j) const
+	{
+		Point<dim,St> s = v_pos.get(opart.template get<0>(j));
+		s -= shifts.get(opart.template get<1>(j));
+		return s;
+	}
+};
+
+/*! \brief n positions starting from start in a position vector seen as a vector, so that they are decoded in place
+ *
+ */
+template<typename vector_pos>
+struct wire_pos_recv_view
+{
+	//! position vector
+	vector_pos & v_pos;
+
+	//! first position
+	size_t start;
+
+	//! number of positions
+	size_t n;
+
+	//! Constructor
+	wire_pos_recv_view(vector_pos & v_pos, size_t start, size_t n)
+	:v_pos(v_pos),start(start),n(n)
+	{}
+
+	//! number of positions
+	inline size_t size() const
+	{
+		return n;
+	}
+
+	//! position j
+	template<unsigned int p> inline auto get(size_t j) const -> decltype(v_pos.template get<0>(start + j))
+	{
+		return v_pos.template get<0>(start + j);
+	}
+};
+
+//! It compute the size on the wire of one particle properties
+template<typename codec, typename prop>
+struct wire_size_prp
+{
+	//! size in byte
+	size_t & sz;
+
+	/*! \brief Constructor
+	 *
+	 * \param sz size to accumulate
+	 *
+	 */
+	wire_size_prp(size_t & sz)
+	:sz(sz)
+	{};
+
+	//! It add the size of each property
+	template<typename T>
+	inline void operator()(T& t)
+	{
+		typedef typename boost::mpl::at<typename prop::type,boost::mpl::int_<T::value>>::type prp_type;
+
+		sz += wire_prp_codec<codec,prp_type>::size;
+	}
+};
+
+//! It encode the properties of one particle
+template<typename codec, typename prop, typename vector_prp>
+struct wire_encode_prp
+{
+	//! property vector
+	vector_prp & v_prp;
+
+	//! particle
+	size_t id;
+
+	//! output pointer
+	unsigned char * & out;
+
+	/*! \brief Constructor
+	 *
+	 * \param v_prp property vector
+	 * \param id particle
+	 * \param out output pointer
+	 *
+	 */
+	wire_encode_prp(vector_prp & v_prp, size_t id, unsigned char * & out)
+	:v_prp(v_prp),id(id),out(out)
+	{};
+
+	//! It encode each property
+	template<typename T>
+	inline void operator()(T& t)
+	{
+		typedef typename boost::mpl::at<typename prop::type,boost::mpl::int_<T::value>>::type prp_type;
+
+		wire_prp_codec<codec,prp_type>::encode(v_prp.template get<T::value>(id),out);
+	}
+};
+
+//! It decode the properties of one particle
+template<typename codec, typename prop, typename vector_prp>
+struct wire_decode_prp
+{
+	//! property vector
+	vector_prp & v_prp;
+
+	//! particle
+	size_t id;
+
+	//! input pointer
+	const unsigned char * & in;
+
+	/*! \brief Constructor
+	 *
+	 * \param v_prp property vector
+	 * \param id particle
+	 * \param in input pointer
+	 *
+	 */
+	wire_decode_prp(vector_prp & v_prp, size_t id, const unsigned char * & in)
+	:v_prp(v_prp),id(id),in(in)
+	{};
+
+	//! It decode each property
+	template<typename T>
+	inline void operator()(T& t)
+	{
+		typedef typename boost::mpl::at<typename prop::type,boost::mpl::int_<T::value>>::type prp_type;
+
+		wire_prp_codec<codec,prp_type>::decode(v_prp.template get<T::value>(id),in);
+	}
+};
+
+/*! \brief Locate in the receive buffer the message of each processor of the ghost layout
+ *
+ * When the messages are received in the order of the ghost layout (like with the persistent plans) the
+ * offsets are consecutive and no map is constructed
+ *
+ */
+class wire_msg_locator
+{
+	//! size of each received message
+	openfpm::vector<size_t> & sz_recv;
+
+	//! true if the messages are in the order of the ghost layout
+	bool same;
+
+	//! offset of the next message (same == true)
+	size_t off;
+
+	//! processor -> offset, size (same == false)
+	std::unordered_map<size_t,std::pair<size_t,size_t>> msg_off;
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param prc_recv processors from where we received
+	 * \param sz_recv size of each message
+	 * \param prc_recv_get ghost layout (processors)
+	 *
+	 */
+	wire_msg_locator(openfpm::vector<size_t> & prc_recv, openfpm::vector<size_t> & sz_recv, openfpm::vector<size_t> & prc_recv_get)
+	:sz_recv(sz_recv),same(prc_recv.size() == prc_recv_get.size()),off(0)
+	{
+		for (size_t j = 0 ; j < prc_recv.size() && same == true ; j++)
+		{same = prc_recv.get(j) == prc_recv_get.get(j);}
+
+		if (same == true)
+		{return;}
+
+		size_t o = 0;
+		for (size_t j = 0 ; j < prc_recv.size() ; j++)
+		{
+			msg_off[prc_recv.get(j)] = std::pair<size_t,size_t>(o,sz_recv.get(j));
+			o += sz_recv.get(j);
+		}
+	}
+
+	/*! \brief Offset and size of the message of the i-th processor of the ghost layout (to call in order)
+	 *
+	 * \param i index in the ghost layout
+	 * \param prc processor
+	 * \param o offset of the message
+	 * \param sz size of the message
+	 *
+	 * \return false if the message has not been received
+	 *
+	 */
+	inline bool next(size_t i, size_t prc, size_t & o, size_t & sz)
+	{
+		if (same == true)
+		{
+			o = off;
+			sz = sz_recv.get(i);
+			off += sz;
+			return true;
+		}
+
+		auto it = msg_off.find(prc);
+
+		if (it == msg_off.end())
+		{return false;}
+
+		o = it->second.first;
+		sz = it->second.second;
+		return true;
+	}
+};
+
+/*! \brief ghost_get with wire codecs, for not linear layouts it is not supported
+ *
+ * \tparam is_lin true if the particles are stored with a linear layout
+ *
+ */
+template<bool is_lin>
+struct wire_codec_impl
+{
+	//! the codecs cannot be used
+	static const bool supported = false;
+
+	template<typename prp_codec, typename prop, int ... prp, typename vector_prp, typename vector_opart>
+	static void encode_prp(vector_prp & v_prp, vector_opart & g_opart, openfpm::vector<openfpm::vector<unsigned char>> & w_send)
+	{}
+
+	template<typename prp_codec, typename prop, int ... prp, typename vector_prp>
+	static size_t decode_prp(openfpm::vector<unsigned char> & w_recv, openfpm::vector<size_t> & prc_recv, openfpm::vector<size_t> & sz_recv,
+							 vector_prp & v_prp, size_t g_m, openfpm::vector<size_t> & prc_recv_get, openfpm::vector<size_t> & recv_sz_get, bool known)
+	{return 0;}
+
+	template<typename pos_codec, unsigned int dim, typename St, typename vector_pos, typename vector_opart, typename vector_shift>
+	static void encode_pos(vector_pos & v_pos, vector_opart & g_opart, const vector_shift & shifts, openfpm::vector<openfpm::vector<unsigned char>> & w_send)
+	{}
+
+	template<typename pos_codec, unsigned int dim, typename St, typename vector_pos>
+	static size_t decode_pos(openfpm::vector<unsigned char> & w_recv, openfpm::vector<size_t> & prc_recv, openfpm::vector<size_t> & sz_recv,
+							 vector_pos & v_pos, size_t g_m, openfpm::vector<size_t> & prc_recv_get, openfpm::vector<size_t> & recv_sz_get, bool known)
+	{return 0;}
+};
+
+/*! \brief ghost_get with wire codecs for linear layouts
+ *
+ * The messages are encoded directly from the particles to send (g_opart) and
+ * decoded directly in the ghost part of the vectors. When the ghost layout is known
+ * (known == true) the messages are placed following prc_recv_get and recv_sz_get,
+ * otherwise the layout is taken from the received messages
+ *
+ */
+template<>
+struct wire_codec_impl<true>
+{
+	//! the codecs can be used
+	static const bool supported = true;
+
+	/*! \brief encode the properties to send
+	 *
+	 * \param v_prp property vector
+	 * \param g_opart for each processor the particles to send
+	 * \param w_send one message for each processor
+	 *
+	 */
+	template<typename prp_codec, typename prop, int ... prp, typename vector_prp, typename vector_opart>
+	static void encode_prp(vector_prp & v_prp, vector_opart & g_opart, openfpm::vector<openfpm::vector<unsigned char>> & w_send)
+	{
+		size_t el_sz = 0;
+		wire_size_prp<prp_codec,prop> ws(el_sz);
+		boost::mpl::for_each_ref<boost::mpl::vector_c<int,prp...>>(ws);
+
+		w_send.resize(g_opart.size());
+
+		for (size_t i = 0 ; i < g_opart.size() ; i++)
+		{
+			w_send.get(i).resize(g_opart.get(i).size()*el_sz);
+
+			if (w_send.get(i).size() == 0)
+			{continue;}
+
+			unsigned char * out = &w_send.get(i).get(0);
+
+			for (size_t j = 0 ; j < g_opart.get(i).size() ; j++)
+			{
+				wire_encode_prp<prp_codec,prop,vector_prp> we(v_prp,g_opart.get(i).template get<0>(j),out);
+				boost::mpl::for_each_ref<boost::mpl::vector_c<int,prp...>>(we);
+			}
+		}
+	}
+
+	/*! \brief decode the received properties in the ghost part
+	 *
+	 * \param w_recv received messages
+	 * \param prc_recv processors from where we received
+	 * \param sz_recv size of each message
+	 * \param v_prp property vector
+	 * \param g_m ghost marker
+	 * \param prc_recv_get ghost layout (processors)
+	 * \param recv_sz_get ghost layout (number of particles)
+	 * \param known true if the ghost layout is known, otherwise it is set from the messages
+	 *
+	 * \return the number of particles received
+	 *
+	 */
+	template<typename prp_codec, typename prop, int ... prp, typename vector_prp>
+	static size_t decode_prp(openfpm::vector<unsigned char> & w_recv, openfpm::vector<size_t> & prc_recv, openfpm::vector<size_t> & sz_recv,
+							 vector_prp & v_prp, size_t g_m, openfpm::vector<size_t> & prc_recv_get, openfpm::vector<size_t> & recv_sz_get, bool known)
+	{
+		size_t el_sz = 0;
+		wire_size_prp<prp_codec,prop> ws(el_sz);
+		boost::mpl::for_each_ref<boost::mpl::vector_c<int,prp...>>(ws);
+
+		if (known == false)
+		{
+			prc_recv_get.clear();
+			recv_sz_get.clear();
+
+			for (size_t j = 0 ; j < prc_recv.size() ; j++)
+			{
+				prc_recv_get.add(prc_recv.get(j));
+				recv_sz_get.add(sz_recv.get(j) / el_sz);
+			}
+		}
+
+		size_t tot = 0;
+		for (size_t i = 0 ; i < recv_sz_get.size() ; i++)
+		{tot += recv_sz_get.get(i);}
+
+		if (v_prp.size() < g_m + tot)
+		{v_prp.resize(g_m + tot);}
+
+		wire_msg_locator loc(prc_recv,sz_recv,prc_recv_get);
+
+		size_t start = g_m;
+		for (size_t i = 0 ; i < prc_recv_get.size() ; i++)
+		{
+			size_t n = recv_sz_get.get(i);
+			size_t off = 0;
+			size_t sz = 0;
+			bool found = loc.next(i,prc_recv_get.get(i),off,sz);
+
+			if (n == 0)
+			{continue;}
+
+			if (found == false || sz != n*el_sz)
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " error the ghost layout does not match the received messages, use ghost_get without SKIP_LABELLING" << std::endl;
+				return start - g_m;
+			}
+
+			const unsigned char * in = &w_recv.get(off);
+
+			for (size_t j = 0 ; j < n ; j++)
+			{
+				wire_decode_prp<prp_codec,prop,vector_prp> wd(v_prp,start + j,in);
+				boost::mpl::for_each_ref<boost::mpl::vector_c<int,prp...>>(wd);
+			}
+
+			start += n;
+		}
+
+		return start - g_m;
+	}
+
+	/*! \brief encode the positions to send (shifted for periodic boundary conditions)
+	 *
+	 * \param v_pos position vector
+	 * \param g_opart for each processor the particles to send
+	 * \param shifts shift vectors
+	 * \param w_send one message for each processor
+	 *
+	 */
+	template<typename pos_codec, unsigned int dim, typename St, typename vector_pos, typename vector_opart, typename vector_shift>
+	static void encode_pos(vector_pos & v_pos, vector_opart & g_opart, const vector_shift & shifts, openfpm::vector<openfpm::vector<unsigned char>> & w_send)
+	{
+		typedef typename std::remove_reference<decltype(g_opart.get(0))>::type opart_type;
+
+		w_send.resize(g_opart.size());
+
+		for (size_t i = 0 ; i < g_opart.size() ; i++)
+		{
+			wire_pos_send_view<dim,St,vector_pos,opart_type,vector_shift> pos(v_pos,g_opart.get(i),shifts);
+
+			w_send.get(i).resize(pos_codec::template size<dim,St>(pos.size()));
+
+			if (w_send.get(i).size() != 0)
+			{pos_codec::template encode<dim,St>(pos,&w_send.get(i).get(0));}
+		}
+	}
+
+	/*! \brief decode the received positions in the ghost part
+	 *
+	 * see decode_prp for the parameters
+	 *
+	 * \return the number of particles received
+	 *
+	 */
+	template<typename pos_codec, unsigned int dim, typename St, typename vector_pos>
+	static size_t decode_pos(openfpm::vector<unsigned char> & w_recv, openfpm::vector<size_t> & prc_recv, openfpm::vector<size_t> & sz_recv,
+							 vector_pos & v_pos, size_t g_m, openfpm::vector<size_t> & prc_recv_get, openfpm::vector<size_t> & recv_sz_get, bool known)
+	{
+		if (known == false)
+		{
+			prc_recv_get.clear();
+			recv_sz_get.clear();
+
+			for (size_t j = 0 ; j < prc_recv.size() ; j++)
+			{
+				prc_recv_get.add(prc_recv.get(j));
+				recv_sz_get.add(pos_codec::template count<dim,St>(sz_recv.get(j)));
+			}
+		}
+
+		size_t tot = 0;
+		for (size_t i = 0 ; i < recv_sz_get.size() ; i++)
+		{tot += recv_sz_get.get(i);}
+
+		v_pos.resize(g_m + tot);
+
+		wire_msg_locator loc(prc_recv,sz_recv,prc_recv_get);
+
+		size_t start = g_m;
+		for (size_t i = 0 ; i < prc_recv_get.size() ; i++)
+		{
+			size_t n = recv_sz_get.get(i);
+			size_t off = 0;
+			size_t sz = 0;
+			bool found = loc.next(i,prc_recv_get.get(i),off,sz);
+
+			if (n == 0)
+			{continue;}
+
+			if (found == false || sz != pos_codec::template size<dim,St>(n))
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " error the ghost layout does not match the received messages, use ghost_get without SKIP_LABELLING" << std::endl;
+				v_pos.resize(start);
+				return start - g_m;
+			}
+
+			// decoded in place in the ghost part
+			wire_pos_recv_view<vector_pos> pos(v_pos,start,n);
+			pos_codec::template decode<dim,St>(&w_recv.get(off),pos);
+
+			start += n;
+		}
+
+		return start - g_m;
+	}
+};
+
+#endif /* VECTOR_DIST_WIRE_CODEC_HPP_ */
@@ -0,0 +1,911 @@
+/*
+ * verlet_list_csr.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_VECTOR_UTIL_VERLET_LIST_CSR_HPP_
+#define SRC_VECTOR_UTIL_VERLET_LIST_CSR_HPP_
+
+#include <cstring>
+#include <limits>
+#include "util/thread_pool.hpp"
+#include "NN/CellList/CellList.hpp"
+#include "NN/CellList/ParticleIt_Cells.hpp"
+#include "NN/VerletList/VerletList.hpp"
+
+/*! \brief Neighborhood storage of VerletListCSR with the full particle index
+ *
+ */
+struct vl_csr_full
+{
+	//! type of one slot of the neighborhood array
+	typedef size_t slot_type;
+
+	/*! \brief Number of slots required to store the neighbor q of p
+	 *
+	 * \param p particle
+	 * \param q neighbor
+	 *
+	 * \return the number of slots
+	 *
+	 */
+	static inline size_t n_slot(size_t p, size_t q)
+	{
+		return 1;
+	}
+
+	/*! \brief Write the neighbor q of p
+	 *
+	 * \param out where to write
+	 * \param p particle
+	 * \param q neighbor
+	 *
+	 * \return the number of slots written
+	 *
+	 */
+	static inline size_t write(slot_type * out, size_t p, size_t q)
+	{
+		out[0] = q;
+		return 1;
+	}
+
+	/*! \brief Number of neighbors stored in [start,stop)
+	 *
+	 * \param start first slot
+	 * \param stop end of the neighborhood
+	 *
+	 * \return the number of neighbors
+	 *
+	 */
+	static inline size_t count(const slot_type * start, const slot_type * stop)
+	{
+		return stop - start;
+	}
+
+	/*! \brief Get the j-th neighbor of p
+	 *
+	 * \param p particle
+	 * \param start first slot of the neighborhood
+	 * \param j neighbor
+	 *
+	 * \return the neighbor
+	 *
+	 */
+	static inline size_t nth(size_t p, const slot_type * start, size_t j)
+	{
+		return start[j];
+	}
+
+	/*! \brief Iterator across the neighborhood of a particle
+	 *
+	 */
+	class NNIterator
+	{
+		//! Current neighbor
+		const slot_type * cur;
+
+		//! End of the neighborhood
+		const slot_type * stop;
+
+	public:
+
+		/*! \brief Constructor
+		 *
+		 * \param p particle (not used)
+		 * \param start first neighbor
+		 * \param stop end of the neighborhood
+		 *
+		 */
+		NNIterator(size_t p, const slot_type * start, const slot_type * stop)
+		:cur(start),stop(stop)
+		{}
+
+		/*! \brief Check if there is the next element
+		 *
+		 * \return true if there is the next element
+		 *
+		 */
+		inline bool isNext() const
+		{
+			return cur < stop;
+		}
+
+		/*! \brief Get the neighborhood particle id
+		 *
+		 * \return the neighborhood particle id
+		 *
+		 */
+		inline size_t get() const
+		{
+			return *cur;
+		}
+
+		/*! \brief Go to the next element
+		 *
+		 * \return itself
+		 *
+		 */
+		inline NNIterator & operator++()
+		{
+			cur++;
+			return *this;
+		}
+	};
+};
+
+/*! \brief Neighborhood storage of VerletListCSR with 16-bit deltas
+ *
+ * Each neighbor is stored as the difference with the particle index in 16 bit. When the difference does not fit
+ * (outlier) the escape code is written followed by the full index split in 16-bit words. After a space filling curve
+ * reordering the neighbors are index-local, so most of the neighbors take 2 byte instead of 8
+ *
+ */
+struct vl_csr_delta16
+{
+	//! type of one slot of the neighborhood array
+	typedef short int slot_type;
+
+	//! escape code for the outliers
+	static const slot_type escape = -32768;
+
+	//! number of slots to store a full index
+	static const size_t n_full = sizeof(size_t) / sizeof(slot_type);
+
+	/*! \brief Number of slots required to store the neighbor q of p
+	 *
+	 * \param p particle
+	 * \param q neighbor
+	 *
+	 * \return the number of slots
+	 *
+	 */
+	static inline size_t n_slot(size_t p, size_t q)
+	{
+		long int d = (long int)q - (long int)p;
+
+		return (d > escape && d <= 32767)?1:1+n_full;
+	}
+
+	/*! \brief Write the neighbor q of p
+	 *
+	 * \param out where to write
+	 * \param p particle
+	 * \param q neighbor
+	 *
+	 * \return the number of slots written
+	 *
+	 */
+	static inline size_t write(slot_type * out, size_t p, size_t q)
+	{
+		long int d = (long int)q - (long int)p;
+
+		if (d > escape && d <= 32767)
+		{
+			out[0] = (slot_type)d;
+			return 1;
+		}
+
+		out[0] = escape;
+		memcpy(&out[1],&q,sizeof(size_t));
+
+		return 1+n_full;
+	}
+
+	/*! \brief Number of neighbors stored in [start,stop) (the neighborhood is decoded)
+	 *
+	 * \param start first slot
+	 * \param stop end of the neighborhood
+	 *
+	 * \return the number of neighbors
+	 *
+	 */
+	static inline size_t count(const slot_type * start, const slot_type * stop)
+	{
+		size_t n = 0;
+
+		for (const slot_type * cur = start ; cur < stop ; cur += (*cur != escape)?1:1+n_full)
+		{n++;}
+
+		return n;
+	}
+
+	/*! \brief Get the j-th neighbor of p (the neighborhood is decoded up to j)
+	 *
+	 * \param p particle
+	 * \param start first slot of the neighborhood
+	 * \param j neighbor
+	 *
+	 * \return the neighbor
+	 *
+	 */
+	static inline size_t nth(size_t p, const slot_type * start, size_t j)
+	{
+		const slot_type * cur = start;
+
+		for (size_t i = 0 ; i < j ; i++)
+		{cur += (*cur != escape)?1:1+n_full;}
+
+		if (*cur != escape)
+		{return p + (long int)*cur;}
+
+		size_t q;
+		memcpy(&q,&cur[1],sizeof(size_t));
+
+		return q;
+	}
+
+	/*! \brief Iterator across the neighborhood of a particle, it decode the neighbors on the fly
+	 *
+	 */
+	class NNIterator
+	{
+		//! particle
+		size_t p;
+
+		//! Current neighbor
+		const slot_type * cur;
+
+		//! End of the neighborhood
+		const slot_type * stop;
+
+	public:
+
+		/*! \brief Constructor
+		 *
+		 * \param p particle
+		 * \param start first neighbor
+		 * \param stop end of the neighborhood
+		 *
+		 */
+		NNIterator(size_t p, const slot_type * start, const slot_type * stop)
+		:p(p),cur(start),stop(stop)
+		{}
+
+		/*! \brief Check if there is the next element
+		 *
+		 * \return true if there is the next element
+		 *
+		 */
+		inline bool isNext() const
+		{
+			return cur < stop;
+		}
+
+		/*! \brief Get the neighborhood particle id
+		 *
+		 * \return the neighborhood particle id
+		 *
+		 */
+		inline size_t get() const
+		{
+			if (*cur != escape)
+			{return p + (long int)*cur;}
+
+			size_t q;
+			memcpy(&q,&cur[1],sizeof(size_t));
+
+			return q;
+		}
+
+		/*! \brief Go to the next element
+		 *
+		 * \return itself
+		 *
+		 */
+		inline NNIterator & operator++()
+		{
+			cur += (*cur != escape)?1:1+n_full;
+			return *this;
+		}
+	};
+};
+
+/*! \brief Verlet list stored in CSR format and constructed with multiple threads
+ *
+ * The neighborhood of all the particles is stored in one contiguous array (nn). The offset of the neighborhood of
+ * each particle is stored in 32 bit relative to an absolute offset stored every anchor_int particles. The construction partition the particles across threads, each thread
+ * count the neighborhood of its particles, the offsets are calculated with a prefix sum, and in a second
+ * pass each thread fill its part of the neighborhood array without any locking.
+ *
+ * It expose the same construction interface of VerletList so it can be used with vector_dist::getVerlet,
+ * getVerletSym and getVerletCrs (VL_NON_SYMMETRIC, VL_SYMMETRIC, VL_CRS_SYMMETRIC)
+ *
+ * \tparam dim dimensionality
+ * \tparam St space type
+ * \tparam vector_pos_type vector of positions
+ * \tparam CellListImpl Cell-list used to construct the Verlet-list
+ * \tparam nn_store how the neighbors are stored (vl_csr_full or vl_csr_delta16)
+ *
+ */
+template<unsigned int dim,
+         typename St,
+         typename vector_pos_type = openfpm::vector<Point<dim,St>>,
+         typename CellListImpl = CellList<dim,St,Mem_fast<>,shift<dim,St>>,
+         typename nn_store = vl_csr_full>
+class VerletListCSR
+{
+public:
+
+	//! Memory type used by the CRS particle sequence
+	typedef Mem_fast<> Mem_type_type;
+
+	//! Cell-list type
+	typedef CellListImpl CellList_type;
+
+	//! type of one slot of the neighborhood array
+	typedef typename nn_store::slot_type slot_type;
+
+private:
+
+	//! Internal cell-list
+	CellListImpl cli;
+
+	//! every how many particles an absolute offset is stored
+	static const size_t anchor_int = 256;
+
+	//! absolute offset (in slots) in nn of the particle i*anchor_int
+	openfpm::vector<size_t> offs_a;
+
+	//! offset (in slots) of the neighborhood of each particle relative to its anchor (size number of particles + 1),
+	//! during the construction it store the number of slots of each particle
+	openfpm::vector<unsigned int> offs_r;
+
+	//! neighborhood of all the particles
+	openfpm::vector<slot_type> nn;
+
+	//! particles processed in the CRS scheme
+	openfpm::vector<typename Mem_type_type::local_index_type> p_seq;
+
+	//! cut-off radius
+	St r_cut;
+
+	//! option VL_NON_SYMMETRIC VL_SYMMETRIC VL_CRS_SYMMETRIC
+	size_t opt;
+
+	//! Number of threads used for the construction (default 1, MPI usually already use all the cores)
+	size_t n_thr;
+
+	/*! \brief Count or fill the neighborhood of the particle p
+	 *
+	 * \param NN cell-list neighborhood iterator
+	 * \param p particle
+	 * \param xp position of the particle p
+	 * \param pos vector of positions
+	 * \param out where to write the neighborhood (NULL only count)
+	 *
+	 * \return the number of slots used by the neighborhood
+	 *
+	 */
+	template<typename NN_it> inline size_t nn_part(NN_it & NN, size_t p, const Point<dim,St> & xp, const vector_pos_type & pos, slot_type * out)
+	{
+		St r_cut2 = r_cut*r_cut;
+		size_t n = 0;
+
+		while (NN.isNext())
+		{
+			auto q = NN.get();
+
+			Point<dim,St> xq = pos.template get<0>(q);
+
+			if (xp.distance2(xq) < r_cut2)
+			{
+				if (out != NULL)
+				{n += nn_store::write(&out[n],p,q);}
+				else
+				{n += nn_store::n_slot(p,q);}
+			}
+
+			++NN;
+		}
+
+		return n;
+	}
+
+	/*! \brief Neighborhood of the particle p (full or symmetric)
+	 *
+	 * \param p particle
+	 * \param pos vector of positions
+	 * \param out where to write the neighborhood (NULL only count)
+	 *
+	 * \return the number of slots used by the neighborhood
+	 *
+	 */
+	inline size_t nn_part(size_t p, vector_pos_type & pos, slot_type * out)
+	{
+		Point<dim,St> xp = pos.template get<0>(p);
+
+		if (opt == VL_SYMMETRIC)
+		{
+			auto NN = cli.template getNNIteratorSym<NO_CHECK>(cli.getCell(xp),p,pos);
+			return nn_part(NN,p,xp,pos,out);
+		}
+
+		auto NN = cli.template getNNIterator<NO_CHECK>(cli.getCell(xp));
+		return nn_part(NN,p,xp,pos,out);
+	}
+
+	/*! \brief Fill the internal cell-list with all the particles
+	 *
+	 * \param pos vector of positions
+	 *
+	 */
+	void fill_cell_list(const vector_pos_type & pos)
+	{
+		cli.clear();
+
+		for (size_t i = 0 ; i < pos.size() ; i++)
+		{
+			Point<dim,St> xp = pos.template get<0>(i);
+			cli.add(xp,i);
+		}
+	}
+
+	/*! \brief Offset (in slots) of the neighborhood of the particle p in nn
+	 *
+	 * \param p particle
+	 *
+	 * \return the offset
+	 *
+	 */
+	inline size_t off(size_t p) const
+	{
+		return offs_a.get(p / anchor_int) + offs_r.get(p);
+	}
+
+	/*! \brief Reset the counters of n particles
+	 *
+	 * \param n number of particles
+	 *
+	 */
+	void reset_offs(size_t n)
+	{
+		offs_r.resize(n + 1);
+		offs_a.resize(n / anchor_int + 1);
+
+		for (size_t i = 0 ; i < offs_r.size() ; i++)
+		{offs_r.get(i) = 0;}
+	}
+
+	/*! \brief Calculate the anchors and the relative offsets from the counters stored in offs_r and resize nn
+	 *
+	 */
+	void prefix_sum()
+	{
+		size_t tot = 0;
+
+		for (size_t i = 0 ; i < offs_r.size() ; i++)
+		{
+			if (i % anchor_int == 0)
+			{offs_a.get(i / anchor_int) = tot;}
+
+			size_t c = offs_r.get(i);
+			size_t rel = tot - offs_a.get(i / anchor_int);
+
+			if (rel > std::numeric_limits<unsigned int>::max())
+			{std::cerr << __FILE__ << ":" << __LINE__ << " Error the neighborhoods of " << anchor_int << " particles exceed " << std::numeric_limits<unsigned int>::max() << " slots" << std::endl;}
+
+			offs_r.get(i) = rel;
+			tot += c;
+		}
+
+		nn.resize(tot);
+	}
+
+	/*! \brief Create the Verlet-list for the domain particles (VL_NON_SYMMETRIC and VL_SYMMETRIC)
+	 *
+	 * \param pos vector of positions
+	 * \param g_m ghost marker
+	 *
+	 */
+	void create(vector_pos_type & pos, size_t g_m)
+	{
+		reset_offs(pos.size());
+		p_seq.clear();
+
+		size_t n_t = (n_thr > g_m)?1:n_thr;
+		size_t chunk = (g_m + n_t - 1) / n_t;
+
+		// count
+		run_threads(n_t,[&](size_t t)
+		{
+			size_t stop = std::min(g_m,(t+1)*chunk);
+			for (size_t p = t*chunk ; p < stop ; p++)
+			{offs_r.get(p) = nn_part(p,pos,NULL);}
+		});
+
+		prefix_sum();
+
+		// fill
+		run_threads(n_t,[&](size_t t)
+		{
+			size_t stop = std::min(g_m,(t+1)*chunk);
+			for (size_t p = t*chunk ; p < stop ; p++)
+			{
+				if (off(p+1) != off(p))
+				{nn_part(p,pos,&nn.get(off(p)));}
+			}
+		});
+	}
+
+public:
+
+	/*! \brief Default constructor
+	 *
+	 */
+	VerletListCSR()
+	:r_cut(0),opt(VL_NON_SYMMETRIC),n_thr(1)
+	{}
+
+	/*! \brief Set the number of threads used to construct the Verlet-list (default 1)
+	 *
+	 * Use it when there are less MPI processes than cores on the node, the threads are
+	 * taken from a pool and are not created at every construction
+	 *
+	 * \param n_thr number of threads
+	 *
+	 */
+	void setNThreads(size_t n_thr)
+	{
+		this->n_thr = (n_thr == 0)?1:n_thr;
+	}
+
+	/*! \brief Get the number of threads used to construct the Verlet-list
+	 *
+	 * \return the number of threads
+	 *
+	 */
+	size_t getNThreads() const
+	{
+		return n_thr;
+	}
+
+	/*! \brief Initialize the Verlet-list
+	 *
+	 * \param box Domain where the Verlet-list is defined
+	 * \param dom Processor domain
+	 * \param r_cut cut-off radius
+	 * \param pos vector of positions
+	 * \param g_m ghost marker
+	 * \param opt VL_NON_SYMMETRIC or VL_SYMMETRIC
+	 *
+	 */
+	void Initialize(const Box<dim,St> & box, const Box<dim,St> & dom, St r_cut, vector_pos_type & pos, size_t g_m, size_t opt = VL_NON_SYMMETRIC)
+	{
+		size_t div[dim];
+
+		this->r_cut = r_cut;
+		this->opt = opt;
+
+		cl_param_calculate(box,div,r_cut,Ghost<dim,St>(0.0));
+		cli.Initialize(box,div);
+
+		fill_cell_list(pos);
+		create(pos,g_m);
+	}
+
+	/*! \brief Initialize the symmetric Verlet-list
+	 *
+	 * \param dom Simulation domain
+	 * \param pbox Processor bounding box
+	 * \param g ghost
+	 * \param r_cut cut-off radius
+	 * \param pos vector of positions
+	 * \param g_m ghost marker
+	 *
+	 */
+	void InitializeSym(const Box<dim,St> & dom, const Box<dim,St> & pbox, const Ghost<dim,St> & g, St r_cut, vector_pos_type & pos, size_t g_m)
+	{
+		InitializeCrs(dom,pbox,g,r_cut,pos,g_m);
+
+		opt = VL_SYMMETRIC;
+		create(pos,g_m);
+	}
+
+	/*! \brief Initialize the internal cell-list for the CRS scheme (the list is created with createVerletCrs)
+	 *
+	 * \param dom Simulation domain
+	 * \param pbox Processor bounding box
+	 * \param g ghost
+	 * \param r_cut cut-off radius
+	 * \param pos vector of positions
+	 * \param g_m ghost marker
+	 *
+	 */
+	void InitializeCrs(const Box<dim,St> & dom, const Box<dim,St> & pbox, const Ghost<dim,St> & g, St r_cut, vector_pos_type & pos, size_t g_m)
+	{
+		CellDecomposer_sm<dim,St,shift<dim,St>> cd_sm;
+
+		size_t pad = 0;
+		cl_param_calculateSym(dom,cd_sm,g,r_cut,pad);
+
+		this->r_cut = r_cut;
+		this->opt = VL_CRS_SYMMETRIC;
+
+		cli.Initialize(cd_sm,pbox,pad);
+
+		fill_cell_list(pos);
+	}
+
+	/*! \brief Create the Verlet-list with the CRS scheme
+	 *
+	 * The domain cells and the anomalous cells are partitioned across threads
+	 *
+	 * \param r_cut cut-off radius
+	 * \param g_m ghost marker
+	 * \param pos vector of positions
+	 * \param dom_c domain cells
+	 * \param anom_c anomalous cells
+	 *
+	 */
+	void createVerletCrs(St r_cut, size_t g_m, vector_pos_type & pos, openfpm::vector<size_t> & dom_c, openfpm::vector<subsub_lin<dim>> & anom_c)
+	{
+		this->r_cut = r_cut;
+		this->opt = VL_CRS_SYMMETRIC;
+
+		reset_offs(pos.size());
+
+		size_t n_t = (n_thr > dom_c.size() + anom_c.size())?1:n_thr;
+
+		// partition the cells across threads
+		openfpm::vector<openfpm::vector<size_t>> dom_t(n_t);
+		openfpm::vector<openfpm::vector<subsub_lin<dim>>> anom_t(n_t);
+
+		size_t chunk_d = (dom_c.size() + n_t - 1) / n_t;
+		size_t chunk_a = (anom_c.size() + n_t - 1) / n_t;
+
+		for (size_t i = 0 ; i < dom_c.size() ; i++)
+		{dom_t.get(i / chunk_d).add(dom_c.get(i));}
+
+		for (size_t i = 0 ; i < anom_c.size() ; i++)
+		{anom_t.get(i / chunk_a).add(anom_c.get(i));}
+
+		openfpm::vector<openfpm::vector<typename Mem_type_type::local_index_type>> seq_t(n_t);
+
+		// count
+		run_threads(n_t,[&](size_t t)
+		{
+			ParticleItCRS_Cells<dim,CellListImpl,vector_pos_type> it(cli,dom_t.get(t),anom_t.get(t),cli.getNNc_sym());
+
+			while (it.isNext())
+			{
+				size_t p = it.get();
+				Point<dim,St> xp = pos.template get<0>(p);
+
+				auto NN = it.getNNIteratorCSR(pos);
+				offs_r.get(p) = nn_part(NN,p,xp,pos,NULL);
+				seq_t.get(t).add(p);
+
+				++it;
+			}
+		});
+
+		prefix_sum();
+
+		// fill
+		run_threads(n_t,[&](size_t t)
+		{
+			ParticleItCRS_Cells<dim,CellListImpl,vector_pos_type> it(cli,dom_t.get(t),anom_t.get(t),cli.getNNc_sym());
+
+			while (it.isNext())
+			{
+				size_t p = it.get();
+				Point<dim,St> xp = pos.template get<0>(p);
+
+				if (off(p+1) != off(p))
+				{
+					auto NN = it.getNNIteratorCSR(pos);
+					nn_part(NN,p,xp,pos,&nn.get(off(p)));
+				}
+
+				++it;
+			}
+		});
+
+		p_seq.clear();
+		for (size_t t = 0 ; t < seq_t.size() ; t++)
+		{
+			for (size_t i = 0 ; i < seq_t.get(t).size() ; i++)
+			{p_seq.add(seq_t.get(t).get(i));}
+		}
+	}
+
+	/*! \brief Update the Verlet-list (VL_NON_SYMMETRIC and VL_SYMMETRIC)
+	 *
+	 * \param dom Processor domain
+	 * \param r_cut cut-off radius
+	 * \param pos vector of positions
+	 * \param g_m ghost marker
+	 * \param opt VL_NON_SYMMETRIC or VL_SYMMETRIC
+	 *
+	 */
+	void update(const Box<dim,St> & dom, St r_cut, vector_pos_type & pos, size_t & g_m, size_t opt)
+	{
+		this->r_cut = r_cut;
+		this->opt = opt;
+
+		fill_cell_list(pos);
+		create(pos,g_m);
+	}
+
+	/*! \brief Update the Verlet-list with the CRS scheme
+	 *
+	 * \param dom Processor domain
+	 * \param r_cut cut-off radius
+	 * \param pos vector of positions
+	 * \param g_m ghost marker
+	 * \param dom_c domain cells
+	 * \param anom_c anomalous cells
+	 *
+	 */
+	void updateCrs(const Box<dim,St> & dom, St r_cut, vector_pos_type & pos, size_t & g_m,
+			       openfpm::vector<size_t> & dom_c, openfpm::vector<subsub_lin<dim>> & anom_c)
+	{
+		fill_cell_list(pos);
+		createVerletCrs(r_cut,g_m,pos,dom_c,anom_c);
+	}
+
+	/*! \brief Clear the Verlet-list
+	 *
+	 */
+	void clear()
+	{
+		offs_a.clear();
+		offs_r.clear();
+		nn.clear();
+		p_seq.clear();
+	}
+
+	/*! \brief Get the neighborhood iterator of the particle p
+	 *
+	 * It is the way to traverse a neighborhood, with vl_csr_delta16 the neighbors are decoded sequentially
+	 *
+	 * \tparam impl not used (for compatibility with VerletList)
+	 *
+	 * \param p particle
+	 *
+	 * \return the neighborhood iterator
+	 *
+	 */
+	template<unsigned int impl = NO_CHECK> inline typename nn_store::NNIterator getNNIterator(size_t p) const
+	{
+		const slot_type * base = (nn.size() == 0)?NULL:&nn.get(0);
+
+		return typename nn_store::NNIterator(p,base + off(p),base + off(p+1));
+	}
+
+	/*! \brief Get the number of neighbors of the particle p
+	 *
+	 * \warning with vl_csr_delta16 the neighborhood is decoded, so it cost O(number of neighbors)
+	 *
+	 * \param p particle
+	 *
+	 * \return the number of neighbors
+	 *
+	 */
+	inline size_t getNNPart(size_t p) const
+	{
+		if (nn.size() == 0)
+		{return 0;}
+
+		return nn_store::count(&nn.get(0) + off(p),&nn.get(0) + off(p+1));
+	}
+
+	/*! \brief Get the j-th neighbor of the particle p
+	 *
+	 * \warning with vl_csr_delta16 the neighborhood is decoded up to j, so it cost O(j) and a loop over
+	 *          j is quadratic, use getNNIterator to traverse the neighborhood
+	 *
+	 * \param p particle
+	 * \param j neighbor
+	 *
+	 * \return the neighbor particle id
+	 *
+	 */
+	inline size_t get(size_t p, size_t j) const
+	{
+		return nn_store::nth(p,&nn.get(0) + off(p),j);
+	}
+
+	/*! \brief Return the memory used to store the neighborhoods in byte
+	 *
+	 * \return the memory in byte
+	 *
+	 */
+	inline size_t getNNMemory() const
+	{
+		return nn.size()*sizeof(slot_type) + offs_r.size()*sizeof(unsigned int) + offs_a.size()*sizeof(size_t);
+	}
+
+	/*! \brief Number of particles with a neighborhood list
+	 *
+	 * \return the number of particles
+	 *
+	 */
+	inline size_t size() const
+	{
+		return (offs_r.size() == 0)?0:offs_r.size() - 1;
+	}
+
+	/*! \brief Return the particles processed in the CRS scheme
+	 *
+	 * \return the particle sequence
+	 *
+	 */
+	openfpm::vector<typename Mem_type_type::local_index_type> & getParticleSeq()
+	{
+		return p_seq;
+	}
+
+	/*! \brief Return the internal cell-list
+	 *
+	 * \return the internal cell-list
+	 *
+	 */
+	CellListImpl & getInternalCellList()
+	{
+		return cli;
+	}
+
+	/*! \brief Set the decomposition counter
+	 *
+	 * \param n_dec decomposition counter
+	 *
+	 */
+	void set_ndec(size_t n_dec)
+	{
+		cli.set_ndec(n_dec);
+	}
+
+	/*! \brief Get the decomposition counter
+	 *
+	 * \return the decomposition counter
+	 *
+	 */
+	size_t get_ndec()
+	{
+		return cli.get_ndec();
+	}
+
+	/*! \brief Swap the Verlet-list
+	 *
+	 * \param vl Verlet-list to swap with
+	 *
+	 */
+	void swap(VerletListCSR<dim,St,vector_pos_type,CellListImpl,nn_store> & vl)
+	{
+		cli.swap(vl.cli);
+		offs_a.swap(vl.offs_a);
+		offs_r.swap(vl.offs_r);
+		nn.swap(vl.nn);
+		p_seq.swap(vl.p_seq);
+
+		std::swap(r_cut,vl.r_cut);
+		std::swap(opt,vl.opt);
+		std::swap(n_thr,vl.n_thr);
+	}
+};
+
+/*! \brief Set the number of threads used to construct a Verlet-list (no-op for the Verlet-lists constructed serially)
+ *
+ * \param ver Verlet-list
+ * \param n_thr number of threads
+ *
+ */
+template<typename VerletL> inline void verlet_set_n_threads(VerletL & ver, size_t n_thr)
+{}
+
+/*! \brief Set the number of threads used to construct a VerletListCSR
+ *
+ * \param ver Verlet-list
+ * \param n_thr number of threads
+ *
+ */
+template<unsigned int dim, typename St, typename vector_pos_type, typename CellListImpl, typename nn_store>
+inline void verlet_set_n_threads(VerletListCSR<dim,St,vector_pos_type,CellListImpl,nn_store> & ver, size_t n_thr)
+{
+	ver.setNThreads(n_thr);
+}
+
+#endif /* SRC_VECTOR_UTIL_VERLET_LIST_CSR_HPP_ */
@@ -30,6 +30,8 @@
 #include "Decomposition/CartDecomposition.hpp"
 #include "data_type/aggregate.hpp"
 #include "NN/VerletList/VerletList.hpp"
+#include "Vector/util/verlet_list_csr.hpp"
+#include "util/thread_pool.hpp"
 #include "vector_dist_comm.hpp"
 #include "DLB/LB_Model.hpp"
 #include "Vector/vector_map_iterator.hpp"
@@ -182,6 +184,9 @@ struct gcl_An
 #define VERLET_MEMBAL_INT(dim,St)  VerletList<dim,St,Mem_bal<unsigned int>,shift<dim,St> >
 #define VERLET_MEMMW_INT(dim,St)   VerletList<dim,St,Mem_mw<unsigned int>,shift<dim,St> >
 
+#define VERLET_CSR(dim,St) VerletListCSR<dim,St>
+#define VERLET_CSR_DELTA16(dim,St) VerletListCSR<dim,St,openfpm::vector<Point<dim,St>>,CellList<dim,St,Mem_fast<>,shift<dim,St>>,vl_csr_delta16>
+
 enum reorder_opt
 {
 	NO_REORDER = 0,
@@ -267,6 +272,142 @@ private:
 	//! Name of the properties
 	openfpm::vector<std::string> prp_names;
 
+	//! order of the space filling curve used by map with MAP_SFC_ORDER (0 = choose automatically)
+	int32_t sfc_m = 0;
+
+	//! type of space filling curve used by map with MAP_SFC_ORDER
+	reorder_opt sfc_opt = reorder_opt::HILBERT;
+
+	//! space filling curve key and particle id, used to merge the particles in map with MAP_SFC_ORDER
+	openfpm::vector<std::pair<size_t,size_t>> sfc_mv;
+
+	//! cell of the particles extracted from the sorted sequence (in curve order)
+	openfpm::vector<size_t> sfc_mv_cell;
+
+	//! particles extracted from the sorted sequence (in index order)
+	openfpm::vector<size_t> sfc_out;
+
+	//! space filling curve key of each local particle (cached between two map)
+	openfpm::vector<size_t> sfc_keys;
+
+	//! cell on the curve grid of each local particle (cached between two map)
+	openfpm::vector<size_t> sfc_cell;
+
+	//! processor box of the cached keys
+	Box<dim,St> sfc_box;
+
+	//! value of n_reindex when the cached keys were aligned with the particles (-1 no cache)
+	long int sfc_reindex = -1;
+
+	//! Counter incremented every time the particle indexes change (map, reorder, add, remove ...)
+	size_t n_reindex = 0;
+
+	//! Information of the last incremental cell-list construction
+	struct cl_inc_info
+	{
+		//! cell-list constructed
+		const void * cl = NULL;
+
+		//! decomposition counter at construction
+		size_t ndec = 0;
+
+		//! particle index counter at construction
+		size_t n_reindex = 0;
+
+		//! ghost marker at construction
+		size_t g_m = 0;
+
+		//! for each particle (domain + ghost) the cell where it is stored
+		openfpm::vector<size_t> p_cell;
+
+		//! for each particle (domain + ghost) the slot inside its cell
+		openfpm::vector<size_t> p_slot;
+
+		//! number of full constructions
+		size_t n_full = 0;
+
+		//! number of incremental updates
+		size_t n_inc = 0;
+	};
+
+	//! Information of the last incremental cell-list construction
+	cl_inc_info cl_inc;
+
+	//! for each local particle 1 if marked for removal with markRemove (it can be shorter than g_m)
+	openfpm::vector<unsigned char> rm_mark;
+
+	//! number of particles marked for removal
+	size_t n_marked = 0;
+
+	//! number of threads used to compact the particles marked for removal (one by default, the processors
+	//! of a node already share its cores)
+	size_t n_thr_compact = 1;
+
+	/*! \brief Return true if the particle is marked for removal
+	 *
+	 * \param i particle
+	 *
+	 * \return true if marked
+	 *
+	 */
+	inline bool rm_marked(size_t i) const
+	{
+		return i < rm_mark.size() && rm_mark.get(i) != 0;
+	}
+
+	/*! \brief Grow the removal marks to sz elements (the new elements are not marked)
+	 *
+	 * \param sz size
+	 *
+	 */
+	void rm_mark_fit(size_t sz)
+	{
+		size_t old = rm_mark.size();
+
+		if (old >= sz)
+		{return;}
+
+		rm_mark.resize(sz);
+
+		for (size_t i = old ; i < sz ; i++)
+		{rm_mark.get(i) = 0;}
+	}
+
+	/*! \brief Remove the particle p from the cell c of the cell-list
+	 *
+	 * The last element of the cell is moved in the slot of p (stored in cl_inc.p_slot) and
+	 * the last element removed, so the removal is O(1)
+	 *
+	 * \param cell_list Cell-list
+	 * \param c cell
+	 * \param p particle
+	 *
+	 */
+	template<typename CellL> void cl_inc_remove(CellL & cell_list, size_t c, size_t p)
+	{
+		size_t n = cell_list.getNelements(c);
+		size_t s = cl_inc.p_slot.get(p);
+		size_t last = cell_list.get(c,n-1);
+
+		cell_list.get(c,s) = last;
+		cl_inc.p_slot.get(last) = s;
+		cell_list.remove(c,n-1);
+	}
+
+	/*! \brief Add the particle p in the cell c of the cell-list recording its cell and slot
+	 *
+	 * \param cell_list Cell-list
+	 * \param c cell
+	 * \param p particle
+	 *
+	 */
+	template<typename CellL> void cl_inc_add(CellL & cell_list, size_t c, size_t p)
+	{
+		cell_list.addCell(c,p);
+		cl_inc.p_cell.get(p) = c;
+		cl_inc.p_slot.get(p) = cell_list.getNelements(c) - 1;
+	}
+
 #ifdef SE_CLASS3
 
 	se_class3_vector<prop::max_prop,dim,St,Decomposition,self> se3;
@@ -378,6 +519,238 @@ private:
 		}
 	}
 
+	/*! \brief Choose the order of the space filling curve used by map with MAP_SFC_ORDER
+	 *
+	 * The curve is chosen to have roughly one particle for each cell
+	 *
+	 * \return the order of the curve
+	 *
+	 */
+	int32_t sfc_order()
+	{
+		if (sfc_m != 0)
+		{return sfc_m;}
+
+		int32_t m = 1;
+		double n_side = pow((double)g_m,1.0 / dim);
+
+		// the hilbert key must fit 64 bit
+		while ((double)(1ul << m) < n_side && (m + 1)*dim < 64)
+		{m++;}
+
+		// the curve must not change between two map, otherwise the order is lost
+		sfc_m = m;
+
+		return m;
+	}
+
+	/*! \brief Cell of the particle on the grid of the space filling curve
+	 *
+	 * \param p particle
+	 * \param m order of the curve
+	 * \param pbox processor box
+	 * \param coord integer coordinates of the cell
+	 *
+	 * \return the linearized cell
+	 *
+	 */
+	size_t sfc_cell_of(size_t p, int32_t m, const Box<dim,St> & pbox, uint64_t (& coord)[dim])
+	{
+		size_t lin = 0;
+
+		for (long int i = dim - 1 ; i >= 0 ; i--)
+		{
+			size_t div = 1ul << m;
+			St len = pbox.getHigh(i) - pbox.getLow(i);
+			long int c = (len > 0)?(long int)((v_pos.template get<0>(p)[i] - pbox.getLow(i)) / len * div):0;
+
+			c = (c < 0)?0:c;
+			c = (c >= (long int)div)?div-1:c;
+
+			coord[i] = c;
+			lin = lin * div + c;
+		}
+
+		return lin;
+	}
+
+	/*! \brief Key on the space filling curve of a cell
+	 *
+	 * \param m order of the curve
+	 * \param coord integer coordinates of the cell
+	 * \param lin linearized cell
+	 *
+	 * \return the key
+	 *
+	 */
+	size_t sfc_key_of(int32_t m, uint64_t (& coord)[dim], size_t lin)
+	{
+		if (sfc_opt == reorder_opt::HILBERT)
+		{
+			int err;
+			return getHKeyFromIntCoord(m,dim,coord,&err);
+		}
+
+		return lin;
+	}
+
+	/*! \brief Sort the local particles along the space filling curve after map
+	 *
+	 * The particles [0,n_stay) are the particles that did not migrate, they are already sorted
+	 * with the exception of the few particles that moved to a different cell. The particles
+	 * [n_stay,g_m) are the particles received. Only the particles out of order and the received
+	 * particles are sorted and merged in place with the sorted sequence, the particles before
+	 * the first one out of order are not touched. The keys are cached between two map, the key
+	 * of a particle is recomputed only if it changed cell
+	 *
+	 * \param n_stay number of particles that did not migrate
+	 *
+	 */
+	void sfc_merge_after_map(size_t n_stay)
+	{
+		int32_t m = sfc_order();
+		const Box<dim,St> & pbox = getDecomposition().getProcessorBounds();
+
+		// the cache is aligned with the particles if only this map changed the indexes
+		auto & op = this->getMapOutParticles();
+		bool cache = sfc_reindex >= 0 && (size_t)sfc_reindex + 1 == n_reindex && sfc_box == pbox &&
+		             sfc_keys.size() == n_stay + op.size();
+
+		size_t n_cached = 0;
+
+		if (cache == true)
+		{
+			// remove the particles that left (m_opart is ordered)
+			size_t k = 0;
+			for (size_t i = 0 ; i < sfc_keys.size() ; i++)
+			{
+				if (k < op.size() && (size_t)op.template get<0>(k) == i)
+				{
+					k++;
+					continue;
+				}
+
+				sfc_keys.get(n_cached) = sfc_keys.get(i);
+				sfc_cell.get(n_cached) = sfc_cell.get(i);
+				n_cached++;
+			}
+		}
+
+		sfc_keys.resize(g_m);
+		sfc_cell.resize(g_m);
+
+		for (size_t i = 0 ; i < g_m ; i++)
+		{
+			uint64_t coord[dim];
+			size_t c = sfc_cell_of(i,m,pbox,coord);
+
+			if (i < n_cached && sfc_cell.get(i) == c)
+			{continue;}
+
+			sfc_cell.get(i) = c;
+			sfc_keys.get(i) = sfc_key_of(m,coord,c);
+		}
+
+		sfc_box = pbox;
+		sfc_reindex = n_reindex;
+
+		// Extract the particles that does not respect the order, the others form a sorted sequence
+		sfc_mv.clear();
+		sfc_out.clear();
+
+		size_t n_sorted = 0;
+		size_t last = 0;
+
+		for (size_t i = 0 ; i < n_stay ; i++)
+		{
+			size_t k = sfc_keys.get(i);
+			bool next_ok = (i + 1 == n_stay) || k <= sfc_keys.get(i+1);
+
+			if ((n_sorted == 0 || k >= last) && next_ok == true)
+			{
+				n_sorted++;
+				last = k;
+			}
+			else
+			{
+				sfc_mv.add(std::pair<size_t,size_t>(k,i));
+				sfc_out.add(i);
+			}
+		}
+
+		// We have nothing to do
+		if (sfc_mv.size() == 0 && n_stay == g_m)
+		{return;}
+
+		// add the received particles
+		for (size_t i = n_stay ; i < g_m ; i++)
+		{sfc_mv.add(std::pair<size_t,size_t>(sfc_keys.get(i),i));}
+
+		sfc_mv.sort();
+
+		// copy out the particles to merge
+		size_t n_mv = sfc_mv.size();
+
+		v_pos_out.resize(n_mv);
+		v_prp_out.resize(n_mv);
+		sfc_mv_cell.resize(n_mv);
+
+		for (size_t j = 0 ; j < n_mv ; j++)
+		{
+			size_t p = sfc_mv.get(j).second;
+
+			v_pos_out.set(j,v_pos.get(p));
+			v_prp_out.set(j,v_prp.get(p));
+			sfc_mv_cell.get(j) = sfc_cell.get(p);
+		}
+
+		// compact the sorted sequence, the particles before the first extracted does not move
+		size_t w = (sfc_out.size() == 0)?n_stay:sfc_out.get(0);
+		size_t q = 0;
+
+		for (size_t i = w ; i < n_stay ; i++)
+		{
+			if (q < sfc_out.size() && sfc_out.get(q) == i)
+			{
+				q++;
+				continue;
+			}
+
+			v_pos.set(w,v_pos.get(i));
+			v_prp.set(w,v_prp.get(i));
+			sfc_keys.get(w) = sfc_keys.get(i);
+			sfc_cell.get(w) = sfc_cell.get(i);
+			w++;
+		}
+
+		// merge the two sorted sequences in place (from the back), it stop at the
+		// first position of the sorted sequence that does not move
+		long int i1 = n_sorted - 1;
+		long int i2 = n_mv - 1;
+		long int o = g_m - 1;
+
+		while (i2 >= 0)
+		{
+			if (i1 >= 0 && sfc_keys.get(i1) > sfc_mv.get(i2).first)
+			{
+				v_pos.set(o,v_pos.get(i1));
+				v_prp.set(o,v_prp.get(i1));
+				sfc_keys.get(o) = sfc_keys.get(i1);
+				sfc_cell.get(o) = sfc_cell.get(i1);
+				i1--;
+			}
+			else
+			{
+				v_pos.set(o,v_pos_out.get(i2));
+				v_prp.set(o,v_prp_out.get(i2));
+				sfc_keys.get(o) = sfc_mv.get(i2).first;
+				sfc_cell.get(o) = sfc_mv_cell.get(i2);
+				i2--;
+			}
+			o--;
+		}
+	}
+
 public:
 
 	//! property object
@@ -411,6 +784,9 @@ public:
 		static_cast<vector_dist_comm<dim,St,prop,Decomposition,Memory,layout_base> *>(this)->operator=(static_cast<vector_dist_comm<dim,St,prop,Decomposition,Memory,layout_base>>(v));
 
 		g_m = v.g_m;
+		n_reindex++;
+		rm_mark = v.rm_mark;
+		n_marked = v.n_marked;
 		v_pos = v.v_pos;
 		v_prp = v.v_prp;
 
@@ -436,6 +812,9 @@ public:
 		static_cast<vector_dist_comm<dim,St,prop,Decomposition,Memory,layout_base> *>(this)->operator=(static_cast<vector_dist_comm<dim,St,prop,Decomposition,Memory,layout_base> >(v));
 
 		g_m = v.g_m;
+		n_reindex++;
+		rm_mark = v.rm_mark;
+		n_marked = v.n_marked;
 		v_pos.swap(v.v_pos);
 		v_prp.swap(v.v_prp);
 
@@ -933,6 +1312,7 @@ public:
 		v_pos.insert(g_m);
 
 		g_m++;
+		n_reindex++;
 
 #ifdef SE_CLASS3
 		for (size_t i = 0 ; i < prop::max_prop_real+1 ; i++)
@@ -940,6 +1320,114 @@ public:
 #endif
 	}
 
+	/*! \brief Reserve space for n local particles more, so the next add/addBulk do not reallocate
+	 *
+	 * \param n number of particles that will be added
+	 *
+	 */
+	void reserve(size_t n)
+	{
+		v_pos.reserve(g_m + n);
+		v_prp.reserve(g_m + n);
+	}
+
+	/*! \brief Add n local particles at the end in one step
+	 *
+	 * Positions and properties of the new particles are not initialized, they can be written using the
+	 * indexes [returned value, size_local()) or with the iterator returned by getIteratorFrom
+	 *
+	 * \warning it kill the ghost
+	 *
+	 * \param n number of particles to add
+	 *
+	 * \return the index of the first added particle
+	 *
+	 */
+	size_t addBulk(size_t n)
+	{
+		size_t start = g_m;
+
+		// the ghost is at the end, positions and properties are resized once
+		v_pos.resize(g_m + n);
+		v_prp.resize(g_m + n);
+
+		g_m += n;
+		n_reindex++;
+
+#ifdef SE_CLASS3
+		for (size_t j = start ; j < g_m ; j++)
+		{
+			for (size_t i = 0 ; i < prop::max_prop_real+1 ; i++)
+				v_prp.template get<prop::max_prop_real>(j)[i] = UNINITIALIZED;
+		}
+#endif
+
+		return start;
+	}
+
+	/*! \brief Add n local particles at the end and fill them with a functor in parallel
+	 *
+	 * The functor is called as f(i,key) for i in [0,n), where key is the particle created. It is called
+	 * concurrently from n_thr threads, so it must only write the particle key
+	 *
+	 * \code
+	 *
+	 * vd.addBulk(n_new,[&](size_t i, vect_dist_key_dx key)
+	 * {
+	 *     vd.getPos(key)[0] = ...;
+	 *     vd.template getProp<0>(key) = ...;
+	 * });
+	 *
+	 * \endcode
+	 *
+	 * \warning it kill the ghost
+	 *
+	 * \param n number of particles to add
+	 * \param f functor filling the particles
+	 * \param n_thr number of threads (one by default, the processors of a node already share its cores)
+	 * \param map_after if true call map() after filling, so the non-local particles are sent to the
+	 *        owner processor immediately
+	 *
+	 * \return the index of the first added particle (before map)
+	 *
+	 */
+	template<typename F> size_t addBulk(size_t n, F f, size_t n_thr = 1, bool map_after = false)
+	{
+		size_t start = addBulk(n);
+
+		n_thr = std::max((size_t)1,std::min(n_thr,n / 1024));
+
+		run_threads(n_thr,[&](size_t t)
+		{
+			size_t stop = start + (t+1) * n / n_thr;
+
+			for (size_t i = start + t * n / n_thr ; i < stop ; i++)
+			{
+				vect_dist_key_dx key;
+				key.setKey(i);
+
+				f(i - start,key);
+			}
+		});
+
+		if (map_after == true)
+		{map();}
+
+		return start;
+	}
+
+	/*! \brief Get an iterator over the local particles starting from start (for example the particles added by addBulk)
+	 *
+	 * \param start first particle
+	 *
+	 * \return the iterator
+	 *
+	 */
+	vector_dist_iterator getIteratorFrom(size_t start) const
+	{
+		return vector_dist_iterator(start, g_m);
+	}
+
 #ifndef ONLY_READWRITE_GETTER
 
 	/*! \brief Get the position of the last element
@@ -1298,6 +1786,9 @@ public:
 		{se3.getNN();}
 #endif
 
+		// a cell-list constructed outside updateCellListIncremental invalidate its state
+		cl_inc.cl = NULL;
+
 		// This function assume equal spacing in all directions
 		// but in the worst case we take the maximum
 		St r_cut = 0;
@@ -1322,6 +1813,117 @@ public:
 		}
 	}
 
+	/*! \brief Update a cell list moving only the particles that changed cell
+	 *
+	 * The cell of each particle from the last construction is stored. At the next call only the domain
+	 * particles that changed cell are moved, while the ghost particles are removed and
+	 * added again (ghost_get can change them completely). The cells already have slack (Mem_fast allocate
+	 * the same number of slots for every cell) so moving few particles does not produce reallocation.
+	 * If the particles has been re-indexed from the last construction (map, reorder, add, remove ...),
+	 * the decomposition changed, the cell-list is not the one constructed last time, or any cell-list
+	 * has been constructed with getCellList / updateCellList in between, a full construction is done
+	 *
+	 * \warning only CPU cell-lists (non symmetric) are supported
+	 *
+	 * \tparam CellL CellList type to update
+	 *
+	 * \param cell_list Cell list to update
+	 * \param no_se3 avoid se class 3 checking
+	 *
+	 */
+	template<typename CellL> void updateCellListIncremental(CellL & cell_list, bool no_se3 = false)
+	{
+#ifdef SE_CLASS3
+		if (no_se3 == false)
+		{se3.getNN();}
+#endif
+
+		if (cell_list.get_ndec() != getDecomposition().get_ndec())
+		{
+			updateCellList(cell_list,no_se3);
+			cl_inc.cl = NULL;
+			cl_inc.n_full++;
+			return;
+		}
+
+		bool full = cl_inc.cl != &cell_list ||
+				    cl_inc.ndec != getDecomposition().get_ndec() ||
+				    cl_inc.n_reindex != n_reindex ||
+				    cl_inc.g_m != g_m;
+
+		if (full == true)
+		{
+			cell_list.clear();
+			cl_inc.p_cell.resize(v_pos.size());
+			cl_inc.p_slot.resize(v_pos.size());
+
+			for (size_t i = 0 ; i < v_pos.size() ; i++)
+			{
+				Point<dim,St> xp = v_pos.template get<0>(i);
+				cl_inc_add(cell_list,cell_list.getCell(xp),i);
+			}
+
+			cl_inc.n_full++;
+			cl_inc.cl = &cell_list;
+			cl_inc.ndec = getDecomposition().get_ndec();
+			cl_inc.n_reindex = n_reindex;
+			cl_inc.g_m = g_m;
+		}
+		else
+		{
+			// Remove the old ghost particles
+			for (size_t i = g_m ; i < cl_inc.p_cell.size() ; i++)
+			{cl_inc_remove(cell_list,cl_inc.p_cell.get(i),i);}
+
+			// Move the domain particles that changed cell
+			for (size_t i = 0 ; i < g_m ; i++)
+			{
+				Point<dim,St> xp = v_pos.template get<0>(i);
+				size_t c = cell_list.getCell(xp);
+
+				if (c != cl_inc.p_cell.get(i))
+				{
+					cl_inc_remove(cell_list,cl_inc.p_cell.get(i),i);
+					cl_inc_add(cell_list,c,i);
+				}
+			}
+
+			// Add the new ghost particles
+			cl_inc.p_cell.resize(v_pos.size());
+			cl_inc.p_slot.resize(v_pos.size());
+
+			for (size_t i = g_m ; i < v_pos.size() ; i++)
+			{
+				Point<dim,St> xp = v_pos.template get<0>(i);
+				cl_inc_add(cell_list,cell_list.getCell(xp),i);
+			}
+
+			cl_inc.n_inc++;
+		}
+
+		cell_list.set_gm(g_m);
+	}
+
+	/*! \brief Return the number of full constructions done by updateCellListIncremental
+	 *
+	 * \return the number of full constructions
+	 *
+	 */
+	size_t getCellListIncrementalNFull() const
+	{
+		return cl_inc.n_full;
+	}
+
+	/*! \brief Return the number of incremental updates done by updateCellListIncremental
+	 *
+	 * \return the number of updates where only the particles that changed cell has been moved
+	 *
+	 */
+	size_t getCellListIncrementalNUpdate() const
+	{
+		return cl_inc.n_inc;
+	}
+
 	/*! \brief Update a cell list using the stored particles
 	 *
 	 * \tparam CellL CellList type to construct
@@ -1336,6 +1938,9 @@ public:
 		se3.getNN();
 #endif
 
+		// a cell-list constructed outside updateCellListIncremental invalidate its state
+		cl_inc.cl = NULL;
+
 		// Here we have to check that the Cell-list has been constructed
 		// from the same decomposition
 		bool to_reconstruct = cell_list.get_ndec() != getDecomposition().get_ndec();
@@ -1445,18 +2050,22 @@ public:
 	/*! \brief for each particle get the symmetric verlet list
 	 *
 	 * \param r_cut cut-off radius
+	 * \param n_thr number of threads used for the construction, it is used only by the Verlet-lists
+	 *        constructed with multiple threads (VERLET_CSR), default 1 because the MPI processes of a node
+	 *        usually already use all its cores
 	 *
 	 * \return the verlet list
 	 *
 	 */
 	template <typename VerletL = VerletList<dim,St,Mem_fast<>,shift<dim,St> >>
-	VerletL getVerletSym(St r_cut)
+	VerletL getVerletSym(St r_cut, size_t n_thr = 1)
 	{
 #ifdef SE_CLASS3
 		se3.getNN();
 #endif
 
 		VerletL ver;
+		verlet_set_n_threads(ver,n_thr);
 
 		// Processor bounding box
 		Box<dim, St> pbox = getDecomposition().getProcessorBounds();
@@ -1471,12 +2080,15 @@ public:
 	/*! \brief for each particle get the symmetric verlet list
 	 *
 	 * \param r_cut cut-off radius
+	 * \param n_thr number of threads used for the construction, it is used only by the Verlet-lists
+	 *        constructed with multiple threads (VERLET_CSR), default 1 because the MPI processes of a node
+	 *        usually already use all its cores
 	 *
 	 * \return the verlet list
 	 *
 	 */
 	template <typename VerletL = VerletList<dim,St,Mem_fast<>,shift<dim,St> >>
-	VerletL getVerletCrs(St r_cut)
+	VerletL getVerletCrs(St r_cut, size_t n_thr = 1)
 	{
 #ifdef SE_CLASS1
 		if (!(opt & BIND_DEC_TO_GHOST))
@@ -1491,6 +2103,7 @@ public:
 #endif
 
 		VerletL ver;
+		verlet_set_n_threads(ver,n_thr);
 
 		// Processor bounding box
 		Box<dim, St> pbox = getDecomposition().getProcessorBounds();
@@ -1524,18 +2137,22 @@ public:
 	/*! \brief for each particle get the verlet list
 	 *
 	 * \param r_cut cut-off radius
+	 * \param n_thr number of threads used for the construction, it is used only by the Verlet-lists
+	 *        constructed with multiple threads (VERLET_CSR), default 1 because the MPI processes of a node
+	 *        usually already use all its cores
 	 *
 	 * \return a VerletList object
 	 *
 	 */
 	template <typename VerletL = VerletList<dim,St,Mem_fast<>,shift<dim,St>,decltype(v_pos) >>
-	VerletL getVerlet(St r_cut)
+	VerletL getVerlet(St r_cut, size_t n_thr = 1)
 	{
 #ifdef SE_CLASS3
 		se3.getNN();
 #endif
 
 		VerletL ver;
+		verlet_set_n_threads(ver,n_thr);
 
 		// get the processor bounding box
 		Box<dim, St> bt = getDecomposition().getProcessorBounds();
@@ -1648,6 +2265,61 @@ public:
 	}
 
 
+	/*! \brief Update a Verlet-list constructed with multiple threads in CSR format
+	 *
+	 * \param ver Verlet to update
+	 * \param r_cut cutoff radius
+	 * \param opt option like VL_SYMMETRIC and VL_NON_SYMMETRIC or VL_CRS_SYMMETRIC
+	 *
+	 */
+	template<typename CellL, typename nn_store> void updateVerlet(VerletListCSR<dim,St,decltype(v_pos),CellL,nn_store> & ver, St r_cut, size_t opt = VL_NON_SYMMETRIC)
+	{
+#ifdef SE_CLASS3
+		se3.getNN();
+#endif
+
+		typedef VerletListCSR<dim,St,decltype(v_pos),CellL,nn_store> VerletL;
+
+		auto & NN = ver.getInternalCellList();
+
+		// Here we have to check that the Box defined by the Cell-list is the same as the domain box of this
+		// processor. if it is not like that we have to completely reconstruct from stratch
+		bool to_reconstruct = NN.get_ndec() != getDecomposition().get_ndec();
+
+		if (to_reconstruct == true)
+		{
+			VerletL ver_tmp;
+
+			if (opt == VL_SYMMETRIC)
+			{ver_tmp = getVerletSym<VerletL>(r_cut,ver.getNThreads());}
+			else if (opt == VL_CRS_SYMMETRIC)
+			{ver_tmp = getVerletCrs<VerletL>(r_cut,ver.getNThreads());}
+			else
+			{ver_tmp = getVerlet<VerletL>(r_cut,ver.getNThreads());}
+
+			ver.swap(ver_tmp);
+		}
+		else if (opt == VL_CRS_SYMMETRIC)
+		{
+			// Shift
+			grid_key_dx<dim> shift;
+
+			// Add padding
+			for (size_t i = 0 ; i < dim ; i++)
+				shift.set_d(i,NN.getPadding(i));
+
+			grid_sm<dim,void> gs = NN.getInternalGrid();
+
+			getDecomposition().setNNParameters(shift,gs);
+
+			ver.updateCrs(getDecomposition().getDomain(),r_cut,v_pos,g_m,
+					      getDecomposition().getCRSDomainCells(),
+						  getDecomposition().getCRSAnomDomainCells());
+		}
+		else
+		{ver.update(getDecomposition().getDomain(),r_cut,v_pos,g_m, opt);}
+	}
+
 	/*! \brief Construct a cell list starting from the stored particles and reorder a vector according to the Hilberts curve
 	 *
 	 * \tparam CellL CellList type to construct
@@ -1678,6 +2350,9 @@ public:
 	template<typename CellL=CellList_gen<dim,St,Process_keys_lin,Mem_bal<>,shift<dim,St> > >
 	void reorder(int32_t m, const Ghost<dim,St> & enlarge, reorder_opt opt = reorder_opt::HILBERT)
 	{
+		// the particles marked for removal are not reordered
+		removeMarked();
+
 		// reset the ghost part
 		v_pos.resize(g_m);
 		v_prp.resize(g_m);
@@ -1746,6 +2421,8 @@ public:
 
 		v_pos.swap(v_pos_dest);
 		v_prp.swap(v_prp_dest);
+
+		n_reindex++;
 	}
 
 	/*! \brief Construct a cell list starting from the stored particles and reorder a vector according to the Hilberts curve
@@ -1764,6 +2441,9 @@ public:
 	template<typename CellL=CellList_gen<dim,St,Process_keys_lin,Mem_bal<>,shift<dim,St> > >
 	void reorder_rcut(St r_cut)
 	{
+		// the particles marked for removal are not reordered
+		removeMarked();
+
 		// reset the ghost part
 		v_pos.resize(g_m);
 		v_prp.resize(g_m);
@@ -1787,6 +2467,8 @@ public:
 
 		v_pos.swap(v_pos_dest);
 		v_prp.swap(v_prp_dest);
+
+		n_reindex++;
 	}
 
 	/*! \brief It return the number of particles contained by the previous processors
@@ -2162,7 +2844,10 @@ public:
 		se3.map_pre();
 #endif
 
+		removeMarked();
+
 		this->template map_list_<prp...>(v_pos,v_prp,g_m,opt);
+		n_reindex++;
 
 #ifdef SE_CLASS3
 		se3.map_post();
@@ -2178,7 +2863,11 @@ public:
 	 * elements out the local processor. Or just after initialization if each processor
 	 * contain non local particles
 	 *
-	 * \param opt options
+	 * The particles going to a neighborhood processor are exchanged with known receivers
+	 * (like MAP_LOCAL), only the particles going to the other processors use the dynamic
+	 * discovery of the receivers. MAP_NBX force the dynamic discovery for all the particles
+	 *
+	 * \param opt options (MAP_SFC_ORDER, MAP_NBX)
 	 *
 	 */
 	template<typename obp = KillParticle> void map(size_t opt = NONE)
@@ -2187,13 +2876,106 @@ public:
 		se3.map_pre();
 #endif
 
+		if (!(opt & RUN_ON_DEVICE))
+		{removeMarked();}
+
 		this->template map_<obp>(v_pos,v_prp,g_m,opt);
+		n_reindex++;
+
+		if (opt & MAP_SFC_ORDER && !(opt & RUN_ON_DEVICE))
+		{sfc_merge_after_map(this->getMapNStay());}
 
 #ifdef SE_CLASS3
 		se3.map_post();
 #endif
 	}
 
+	/*! \brief It move all the particles that does not belong to the local processor to the respective processor,
+	 *         sending only the properties prp...
+	 *
+	 * The properties not listed are value-initialized on the particles received, use it when the other
+	 * properties are recomputed after map (forces, densities ...)
+	 *
+	 * \code
+	 *
+	 * // only position, velocity (1) and mass (2) migrate
+	 * vd.map_prp<1,2>();
+	 *
+	 * \endcode
+	 *
+	 * \tparam prp properties to communicate
+	 *
+	 * \param opt options (MAP_LOCAL, MAP_SFC_ORDER)
+	 *
+	 */
+	template<int ... prp> void map_prp(size_t opt = NONE)
+	{
+#ifdef SE_CLASS3
+		se3.map_pre();
+#endif
+
+		removeMarked();
+
+		this->template map_<KillParticle,prp...>(v_pos,v_prp,g_m,opt);
+		n_reindex++;
+
+		if (opt & MAP_SFC_ORDER)
+		{sfc_merge_after_map(this->getMapNStay());}
+
+#ifdef SE_CLASS3
+		se3.map_post();
+#endif
+	}
+
+	/*! \brief Set the space filling curve used by map when called with the option MAP_SFC_ORDER
+	 *
+	 * With MAP_SFC_ORDER map keep the local particles sorted along the curve, the particles that
+	 * leave are removed keeping the order, the particles that arrive are merged into the sorted
+	 * sequence. Compared to reorder it does not require a full sort at every call
+	 *
+	 * \param m order of the curve (0 = choose it automatically from the number of particles)
+	 * \param opt HILBERT or LINEAR
+	 *
+	 */
+	void setMapSFC(int32_t m, reorder_opt opt = reorder_opt::HILBERT)
+	{
+		sfc_m = m;
+		sfc_opt = opt;
+		sfc_reindex = -1;
+	}
+
+	/*! \brief Return the key of the particle on the space filling curve used by map with MAP_SFC_ORDER
+	 *
+	 * The curve is defined on the processor bounding box
+	 *
+	 * \param p particle
+	 * \param m order of the curve
+	 *
+	 * \return the key of the particle
+	 *
+	 */
+	size_t getSFCKey(size_t p, int32_t m)
+	{
+		const Box<dim,St> & pbox = getDecomposition().getProcessorBounds();
+
+		uint64_t coord[dim];
+		size_t lin = sfc_cell_of(p,m,pbox,coord);
+
+		return sfc_key_of(m,coord,lin);
+	}
+
+	/*! \brief Return the key of the particle on the space filling curve used by map with MAP_SFC_ORDER
+	 *
+	 * \param p particle
+	 *
+	 * \return the key of the particle
+	 *
+	 */
+	size_t getSFCKey(size_t p)
+	{
+		return getSFCKey(p,sfc_order());
+	}
+
 	/*! \brief It synchronize the properties and position of the ghost particles
 	 *
 	 * \tparam prp list of properties to get synchronize
@@ -2219,8 +3001,50 @@ public:
 
 #ifdef SE_CLASS3
 
+		// the check exchange must not change the size of the ghost particles of the user exchange
+		size_t obj_sz = this->getGhostObjectSize();
+
+		this->template ghost_get_<prop::max_prop_real>(v_pos,v_prp,g_m,opt | KEEP_PROPERTIES);
+
+		this->setGhostObjectSize(obj_sz);
+
+		se3.template ghost_get_post<prp...>(opt);
+#endif
+	}
+
+	/*! \brief It synchronize the properties and position of the ghost particles encoding the messages with wire codecs
+	 *
+	 * \code
+	 *
+	 * // send the double properties as float and the positions as 16 bit integers
+	 * vd.ghost_get_wire<wire_pos_quant<unsigned short>,wire_f32,0,1>();
+	 *
+	 * \endcode
+	 *
+	 * \tparam pos_codec position codec (wire_pos_raw, wire_pos_quant<qint>)
+	 * \tparam prp_codec property codec (wire_raw, wire_f32)
+	 * \tparam prp list of properties to get synchronize
+	 *
+	 * \param opt options WITH_POSITION, it send also the positional information of the particles
+	 *
+	 */
+	template<typename pos_codec, typename prp_codec, int ... prp> inline void ghost_get_wire(size_t opt = WITH_POSITION)
+	{
+#ifdef SE_CLASS3
+		se3.template ghost_get_pre<prp...>(opt);
+#endif
+
+		this->template ghost_get_wire_<pos_codec,prp_codec,prp...>(v_pos,v_prp,g_m,opt);
+
+#ifdef SE_CLASS3
+
+		// the check exchange must not change the size of the ghost particles of the user exchange
+		size_t obj_sz = this->getGhostObjectSize();
+
 		this->template ghost_get_<prop::max_prop_real>(v_pos,v_prp,g_m,opt | KEEP_PROPERTIES);
 
+		this->setGhostObjectSize(obj_sz);
+
 		se3.template ghost_get_post<prp...>(opt);
 #endif
 	}
@@ -2254,10 +3078,21 @@ public:
 	 */
 	void remove(openfpm::vector<size_t> & keys, size_t start = 0)
 	{
+		if (n_marked != 0)
+		{
+			rm_mark_fit(v_pos.size());
+			rm_mark.remove(keys, start);
+
+			n_marked = 0;
+			for (size_t i = 0 ; i < rm_mark.size() ; i++)
+			{n_marked += rm_mark.get(i);}
+		}
+
 		v_pos.remove(keys, start);
 		v_prp.remove(keys, start);
 
 		g_m -= keys.size();
+		n_reindex++;
 	}
 
 	/*! \brief Remove one element from the distributed vector
@@ -2267,10 +3102,202 @@ public:
 	 */
 	void remove(size_t key)
 	{
+		if (key < rm_mark.size())
+		{
+			n_marked -= rm_mark.get(key);
+			rm_mark.remove(key);
+		}
+
 		v_pos.remove(key);
 		v_prp.remove(key);
 
 		g_m--;
+		n_reindex++;
+	}
+
+	/*! \brief Remove a set of particles in O(keys.size()), swapping each removed particle with the last one
+	 *
+	 * Contrary to remove(keys) the order of the remaining particles is not preserved
+	 *
+	 * \warning keys must be sorted and refer to local (not ghost) particles
+	 * \warning it kill the ghost
+	 *
+	 * \param keys particles to remove
+	 *
+	 */
+	void removeUnordered(const openfpm::vector<size_t> & keys)
+	{
+		v_pos.resize(g_m);
+		v_prp.resize(g_m);
+
+		if (n_marked != 0)
+		{rm_mark_fit(g_m);}
+
+		// from the biggest key, so the last particle is never a particle still to remove
+		for (long int i = keys.size() - 1 ; i >= 0 ; i--)
+		{
+			size_t k = keys.get(i);
+			size_t last = g_m - 1;
+
+			if (n_marked != 0)
+			{
+				n_marked -= rm_mark.get(k);
+				rm_mark.get(k) = rm_mark.get(last);
+			}
+
+			if (k != last)
+			{
+				v_pos.get(k) = v_pos.get(last);
+				v_prp.get(k) = v_prp.get(last);
+			}
+
+			g_m--;
+		}
+
+		v_pos.resize(g_m);
+		v_prp.resize(g_m);
+
+		if (rm_mark.size() > g_m)
+		{rm_mark.resize(g_m);}
+
+		n_reindex++;
+	}
+
+	/*! \brief Mark a local particle for removal
+	 *
+	 * The particle is not removed immediately, all the marked particles are removed in a single pass
+	 * (preserving the order of the others) by the next map() or by removeMarked()
+	 *
+	 * \param key particle to mark
+	 *
+	 */
+	void markRemove(size_t key)
+	{
+#ifdef SE_CLASS1
+		if (key >= g_m)
+		{std::cerr << __FILE__ << ":" << __LINE__ << " error only local particles can be marked for removal, key: " << key << " local particles: " << g_m << std::endl;}
+#endif
+
+		rm_mark_fit(g_m);
+
+		if (rm_mark.get(key) == 0)
+		{
+			rm_mark.get(key) = 1;
+			n_marked++;
+		}
+	}
+
+	/*! \brief Mark a local particle for removal
+	 *
+	 * \param key particle to mark
+	 *
+	 */
+	inline void markRemove(vect_dist_key_dx key)
+	{
+		markRemove(key.getKey());
+	}
+
+	/*! \brief Return true if the particle is marked for removal
+	 *
+	 * \param key particle
+	 *
+	 * \return true if marked
+	 *
+	 */
+	inline bool isMarkedRemove(size_t key) const
+	{
+		return rm_marked(key);
+	}
+
+	/*! \brief Return the number of particles marked for removal
+	 *
+	 * \return the number of marked particles
+	 *
+	 */
+	inline size_t getNMarkedRemove() const
+	{
+		return n_marked;
+	}
+
+	/*! \brief Set the number of threads used by removeMarked
+	 *
+	 * \param n_thr number of threads
+	 *
+	 */
+	inline void setRemoveThreads(size_t n_thr)
+	{
+		n_thr_compact = (n_thr == 0)?1:n_thr;
+	}
+
+	/*! \brief Remove all the particles marked with markRemove
+	 *
+	 * Positions and all the properties are compacted in place and the order of the remaining particles
+	 * is preserved. Each thread compacts its chunk at the beginning of the chunk, then the chunks are
+	 * moved in order to their final position (a chunk never moves after the next one)
+	 *
+	 * \warning it kill the ghost
+	 *
+	 */
+	void removeMarked()
+	{
+		if (n_marked == 0)
+		{return;}
+
+		size_t n_thr = std::max((size_t)1,std::min(n_thr_compact,g_m / 4096));
+
+		// particles kept by each thread
+		openfpm::vector<size_t> cnt;
+		cnt.resize(n_thr+1);
+		cnt.get(0) = 0;
+
+		// compact each chunk at its beginning
+		run_threads(n_thr,[&](size_t t)
+		{
+			size_t start = t * g_m / n_thr;
+			size_t stop = (t+1) * g_m / n_thr;
+			size_t dst = start;
+
+			for (size_t i = start ; i < stop ; i++)
+			{
+				if (rm_marked(i) == true)
+				{continue;}
+
+				if (dst != i)
+				{
+					v_pos.get(dst) = v_pos.get(i);
+					v_prp.get(dst) = v_prp.get(i);
+				}
+				dst++;
+			}
+
+			cnt.get(t+1) = dst - start;
+		});
+
+		// move the chunks to their final position
+		for (size_t t = 0 ; t < n_thr ; t++)
+		{
+			size_t start = t * g_m / n_thr;
+			size_t dst = cnt.get(t);
+
+			if (dst != start)
+			{
+				for (size_t i = 0 ; i < cnt.get(t+1) ; i++)
+				{
+					v_pos.get(dst+i) = v_pos.get(start+i);
+					v_prp.get(dst+i) = v_prp.get(start+i);
+				}
+			}
+
+			cnt.get(t+1) += dst;
+		}
+
+		v_pos.resize(cnt.get(n_thr));
+		v_prp.resize(cnt.get(n_thr));
+
+		g_m = cnt.get(n_thr);
+		rm_mark.clear();
+		n_marked = 0;
+		n_reindex++;
 	}
 
 	/*! \brief Add the computation cost on the decomposition coming
@@ -2353,6 +3380,89 @@ public:
 		finalizeComputationCosts(md,ts);
 	}
 
+	/*! \brief Measure the communication and migration costs of the sub-sub-domains from the particles
+	 *
+	 * For each face of each sub-sub-domain it count the bytes of the particles inside the ghost
+	 * width of the face (the ghost traffic the face produce if it is cut), the size of a ghost
+	 * particle is the one of the last ghost_get. The migration cost is the size of the particles in the
+	 * sub-sub-domain. The next decomposition (or finalizeComputationCosts) use these costs instead of
+	 * the geometric model
+	 *
+	 * \warning it is a collective call
+	 *
+	 */
+	void measureCommunicationAndMigrationCosts()
+	{
+		CellDecomposer_sm<dim, St, shift<dim,St>> cdsm;
+
+		Decomposition & dec = getDecomposition();
+
+		cdsm.setDimensions(dec.getDomain(), dec.getDistGrid().getSize(), 0);
+
+		size_t n_ss = dec.getDistGrid().size();
+
+		// costs of the sub-sub-domains that contain particles
+		openfpm::vector<typename Decomposition::meas_cost_type> cost;
+		std::unordered_map<size_t,size_t> c_id;
+
+		size_t mig_sz = sizeof(prop) + sizeof(Point<dim,St>);
+		size_t gh_sz = (this->getGhostObjectSize() == 0)?mig_sz:this->getGhostObjectSize();
+
+		const Ghost<dim,St> & g = dec.getGhost();
+		const Box<dim,St> & dom = dec.getDomain();
+		auto cbox = cdsm.getCellBox();
+
+		auto it = getDomainIterator();
+
+		while (it.isNext())
+		{
+			Point<dim,St> p = getPos(it.get());
+			size_t c = cdsm.getCell(p);
+
+			if (c >= n_ss)
+			{
+				++it;
+				continue;
+			}
+
+			auto it_c = c_id.find(c);
+			if (it_c == c_id.end())
+			{
+				c_id[c] = cost.size();
+				cost.add();
+				cost.last().template get<0>() = c;
+				cost.last().template get<1>() = 0;
+
+				for (size_t f = 0 ; f < 2*dim ; f++)
+				{cost.last().template get<2>()[f] = 0;}
+
+				it_c = c_id.find(c);
+			}
+
+			size_t ic = it_c->second;
+
+			cost.template get<1>(ic) += mig_sz;
+
+			grid_key_dx<dim> k = cdsm.getCellGrid(p);
+
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				St lw = dom.getLow(d) + k.get(d)*cbox.getHigh(d);
+				St hg = lw + cbox.getHigh(d);
+
+				if (p.get(d) - lw < -g.getLow(d))
+				{cost.template get<2>(ic)[2*d] += gh_sz;}
+
+				if (hg - p.get(d) < g.getHigh(d))
+				{cost.template get<2>(ic)[2*d + 1] += gh_sz;}
+			}
+
+			++it;
+		}
+
+		dec.setMeasuredCosts(cost);
+	}
+
 	/*! \brief Save the distributed vector on HDF5 file
 	 *
 	 * \param filename file where to save
@@ -2459,7 +3569,17 @@ public:
 		v_pos.resize(rs);
 		v_prp.resize(rs);
 
+		// marks of the particles cut away
+		if (rm_mark.size() > rs)
+		{
+			for (size_t i = rs ; i < rm_mark.size() ; i++)
+			{n_marked -= rm_mark.get(i);}
+
+			rm_mark.resize(rs);
+		}
+
 		g_m = rs;
+		n_reindex++;
 	}
 
 	/*! \brief Output particle position and properties
@@ -2834,6 +3954,8 @@ public:
                 // swap the sorted with the non-sorted
                 v_pos.swap(v_pos_out);
                 v_prp.swap(v_prp_out);
+
+                n_reindex++;
         }
 
         /*! \brief This function compare if the host and device buffer position match up to some tolerance
@@ -17,8 +17,12 @@
 #endif
 
 #include "Vector/util/vector_dist_funcs.hpp"
+#include "Vector/util/vector_dist_ghost_delta.hpp"
+#include "Vector/util/vector_dist_wire_codec.hpp"
+#include "Vector/util/vector_dist_ghost_plan.hpp"
 #include "cuda/vector_dist_comm_util_funcs.cuh"
 #include "util/cuda/scan_ofp.cuh"
+#include "Debug/phase_profiler.hpp"
 
 /*! \brief compute the communication options from the ghost_get/put options
  *
@@ -134,6 +138,21 @@ class vector_dist_comm
 	//! The same as recv_sz_get but for map
 	openfpm::vector<size_t> recv_sz_map;
 
+	//! neighborhood processors we send to in the map (all of them, the messages can be empty)
+	openfpm::vector<size_t> prc_map_nn;
+
+	//! processors we send to in the map that are not neighborhood processors
+	openfpm::vector<size_t> prc_map_far;
+
+	//! the same as prc_recv_map but for the particles coming from non-neighborhood processors
+	openfpm::vector<size_t> prc_recv_map_far;
+
+	//! the same as recv_sz_map but for the particles coming from non-neighborhood processors
+	openfpm::vector<size_t> recv_sz_map_far;
+
+	//! for each processor its position in prc_map_nn (-1 if it is not a neighborhood processor)
+	openfpm::vector<long int> map_nn_id;
+
 	//! elements sent for each processors (ghost_get)
 	openfpm::vector<size_t> prc_sz_gg;
 
@@ -163,6 +182,56 @@ class vector_dist_comm
 	//! Sending buffer
 	openfpm::vector_fr<Memory> hsmem;
 
+	//! Number of particles that did not migrate in the last map, (in the local vector they come
+	//! before the received particles)
+	size_t n_stay_map = 0;
+
+	//! Number of map where the local processor sent only to its neighborhood processors
+	size_t n_map_local = 0;
+
+	//! size in byte of one ghost particle (properties and position) sent by the last ghost_get
+	size_t g_obj_sz = 0;
+
+	//! properties sent in the last delta ghost_get (GHOST_DELTA)
+	ghost_delta_state g_delta;
+
+	//! persistent plan for the properties of ghost_get with SKIP_LABELLING | NO_CHANGE_ELEMENTS
+	ghost_comm_plan g_plan_prp;
+
+	//! persistent plan for the positions of ghost_get with SKIP_LABELLING | NO_CHANGE_ELEMENTS
+	ghost_comm_plan g_plan_pos;
+
+	//! plan of the delta ghost_get (GHOST_DELTA) messages
+	ghost_comm_plan g_plan_delta;
+
+	//! maximum number of ghost particles in one message across all processors (-1 not computed for the current layout)
+	size_t g_plan_max_n = (size_t)-1;
+
+	/*! \brief Maximum number of ghost particles in one message across all processors for the current ghost layout
+	 *
+	 * \warning the first call after a labelling is collective (one reduction)
+	 *
+	 * \return the maximum number of particles
+	 *
+	 */
+	size_t ghost_plan_max_n()
+	{
+		if (g_plan_max_n == (size_t)-1)
+		{
+			g_plan_max_n = 0;
+			for (size_t i = 0 ; i < g_opart.size() ; i++)
+			{g_plan_max_n = std::max(g_plan_max_n,(size_t)g_opart.get(i).size());}
+
+			for (size_t i = 0 ; i < recv_sz_get.size() ; i++)
+			{g_plan_max_n = std::max(g_plan_max_n,(size_t)recv_sz_get.get(i));}
+
+			v_cl.max(g_plan_max_n);
+			v_cl.execute();
+		}
+
+		return g_plan_max_n;
+	}
+
 	//! process the particle with properties
 	template<typename prp_object, int ... prp>
 	struct proc_with_prp
@@ -171,9 +240,9 @@ class vector_dist_comm
 		template<typename T1, typename T2> inline static void proc(size_t lbl, size_t cnt, size_t id, T1 & v_prp, T2 & m_prp)
 		{
 			// source object type
-			typedef encapc<1, prop, typename openfpm::vector<prop>::layout_type> encap_src;
+			typedef encapc<1, prop, typename layout_base<prop>::type> encap_src;
 			// destination object type
-			typedef encapc<1, prp_object, typename openfpm::vector<prp_object>::layout_type> encap_dst;
+			typedef encapc<1, prp_object, typename layout_base<prp_object>::type> encap_dst;
 
 			// Copy only the selected properties
 			object_si_d<encap_src, encap_dst, OBJ_ENCAP, prp...>(v_prp.get(id), m_prp.get(lbl).get(cnt));
@@ -983,21 +1052,31 @@ class vector_dist_comm
 		}
 		else
 		{
-			// end vector point
-			long int id_end = v_pos.size();
+			if (opt & MAP_SFC_ORDER)
+			{
+				// The particles that stay must keep their relative order
+				process_map_particles_stable<proc_without_prp>(m_opart,p_map_req,m_pos,m_prp,v_pos,v_prp,cnt);
+			}
+			else
+			{
+				// end vector point
+				long int id_end = v_pos.size();
 
-			// end opart point
-			long int end = m_opart.size()-1;
+				// end opart point
+				long int end = m_opart.size()-1;
 
-			// Run through all the particles and fill the sending buffer
-			for (size_t i = 0; i < m_opart.size(); i++)
-			{
-				process_map_particle<proc_without_prp>(i,end,id_end,m_opart,p_map_req,m_pos,m_prp,v_pos,v_prp,cnt);
+				// Run through all the particles and fill the sending buffer
+				for (size_t i = 0; i < m_opart.size(); i++)
+				{
+					process_map_particle<proc_without_prp>(i,end,id_end,m_opart,p_map_req,m_pos,m_prp,v_pos,v_prp,cnt);
+				}
 			}
 
 			v_pos.resize(v_pos.size() - m_opart.size());
 			v_prp.resize(v_prp.size() - m_opart.size());
 		}
+
+		n_stay_map = v_pos.size();
 	}
 
 
@@ -1014,11 +1093,12 @@ class vector_dist_comm
 	 *
 	 */
 	template<typename prp_object,int ... prp>
-	void fill_send_map_buf_list(openfpm::vector<Point<dim, St>> & v_pos,
+	void fill_send_map_buf_list(openfpm::vector<Point<dim, St>,Memory,typename layout_base<Point<dim,St>>::type,layout_base> & v_pos,
 			                    openfpm::vector<prop,Memory,typename layout_base<prop>::type,layout_base> & v_prp,
 								openfpm::vector<size_t> & prc_sz_r,
-								openfpm::vector<openfpm::vector<Point<dim,St>>> & m_pos,
-								openfpm::vector<openfpm::vector<prp_object>> & m_prp)
+								openfpm::vector<send_pos_vector> & m_pos,
+								openfpm::vector<openfpm::vector<prp_object,Memory,typename layout_base<prp_object>::type,layout_base,openfpm::grow_policy_identity>> & m_prp,
+								size_t opt = NONE)
 	{
 		m_prp.resize(prc_sz_r.size());
 		m_pos.resize(prc_sz_r.size());
@@ -1032,20 +1112,30 @@ class vector_dist_comm
 			cnt.get(i) = 0;
 		}
 
-		// end vector point
-		long int id_end = v_pos.size();
+		if (opt & MAP_SFC_ORDER)
+		{
+			// The particles that stay must keep their relative order
+			process_map_particles_stable<proc_with_prp<prp_object,prp...>>(m_opart,p_map_req,m_pos,m_prp,v_pos,v_prp,cnt);
+		}
+		else
+		{
+			// end vector point
+			long int id_end = v_pos.size();
 
-		// end opart point
-		long int end = m_opart.size()-1;
+			// end opart point
+			long int end = m_opart.size()-1;
 
-		// Run through all the particles and fill the sending buffer
-		for (size_t i = 0; i < m_opart.size(); i++)
-		{
-			process_map_particle<proc_with_prp<prp_object,prp...>>(i,end,id_end,m_opart,p_map_req,m_pos,m_prp,v_pos,v_prp,cnt);
+			// Run through all the particles and fill the sending buffer
+			for (size_t i = 0; i < m_opart.size(); i++)
+			{
+				process_map_particle<proc_with_prp<prp_object,prp...>>(i,end,id_end,m_opart,p_map_req,m_pos,m_prp,v_pos,v_prp,cnt);
+			}
 		}
 
 		v_pos.resize(v_pos.size() - m_opart.size());
 		v_prp.resize(v_prp.size() - m_opart.size());
+
+		n_stay_map = v_pos.size();
 	}
 
 	/*! \brief Label particles for mappings
@@ -1161,6 +1251,14 @@ class vector_dist_comm
 			// resize the label buffer
 			prc_sz.template fill<0>(0);
 
+			// with the distributed directory, particles not in the local or neighborhood
+			// sub-domains are resolved later with a batched query (index in lbl_p and position)
+			bool dir_mode = dec.isDistributedDirectory();
+			openfpm::vector<size_t> far_lbl;
+			openfpm::vector<Point<dim,St>> far_pos;
+
+			prof_region prof_l(PROF_MAP,PROF_LABEL);
+
 			auto it = v_pos.getIterator();
 
 			// Label all the particles with the processor id where they should go
@@ -1169,13 +1267,36 @@ class vector_dist_comm
 				auto key = it.get();
 
 				// Apply the boundary conditions
-				dec.applyPointBC(v_pos.get(key));
+				prof_l.inner(PROF_BC,[&](){dec.applyPointBC(v_pos.get(key));});
 
 				size_t p_id = 0;
 
 				// Check if the particle is inside the domain
 				if (dec.getDomain().isInside(v_pos.get(key)) == true)
-				{p_id = dec.processorID(v_pos.get(key));}
+				{
+					if (dir_mode == true)
+					{
+						Point<dim,St> p = v_pos.get(key);
+						long int lp = dec.processorIDLocal(p);
+
+						if (lp == -1)
+						{
+							far_lbl.add(lbl_p.size());
+							far_pos.add(p);
+
+							lbl_p.add();
+							lbl_p.last().template get<0>() = key;
+							lbl_p.last().template get<2>() = -1;
+
+							++it;
+							continue;
+						}
+
+						p_id = lp;
+					}
+					else
+					{p_id = dec.processorID(v_pos.get(key));}
+				}
 				else
 				{p_id = obp::out(key, v_cl.getProcessUnitID());}
 
@@ -1201,6 +1322,38 @@ class vector_dist_comm
 
 				++it;
 			}
+
+			if (dir_mode == true)
+			{
+				openfpm::vector<size_t> far_prc;
+				dec.processorIDRemote(far_pos,far_prc);
+
+				bool stay = false;
+				for (size_t i = 0 ; i < far_lbl.size() ; i++)
+				{
+					lbl_p.template get<2>(far_lbl.get(i)) = far_prc.get(i);
+
+					if (far_prc.get(i) == v_cl.getProcessUnitID())
+					{stay = true;}
+					else
+					{prc_sz.template get<0>(far_prc.get(i))++;}
+				}
+
+				// round-off on the sub-domain borders, the particle is local
+				if (stay == true)
+				{
+					size_t k = 0;
+					for (size_t i = 0 ; i < lbl_p.size() ; i++)
+					{
+						if ((size_t)lbl_p.template get<2>(i) == v_cl.getProcessUnitID())
+						{continue;}
+
+						lbl_p.set(k,lbl_p.get(i));
+						k++;
+					}
+					lbl_p.resize(k);
+				}
+			}
 		}
 	}
 
@@ -1225,6 +1378,9 @@ class vector_dist_comm
 			                 size_t & g_m,
 			                 size_t opt)
 	{
+		// the ghost layout change
+		g_plan_max_n = (size_t)-1;
+
 		// Buffer that contain for each processor the id of the particle to send
 		prc_sz.clear();
 		g_opart.clear();
@@ -1449,12 +1605,34 @@ public:
 		SCOREP_USER_REGION("ghost_get",SCOREP_USER_REGION_TYPE_FUNCTION)
 #endif
 
+		g_obj_sz = sizeof(object<typename object_creator<typename prop::type, prp...>::type>) + ((opt & NO_POSITION)?0:sizeof(Point<dim,St>));
+
+		// the ghost layout changed, or we are sending everything, the delta history is not valid anymore
+		if (!(opt & SKIP_LABELLING) || !(opt & GHOST_DELTA))
+		{g_delta.invalidate();}
+
+		// the layout is fixed, use the persistent plan
+		if ((opt & SKIP_LABELLING) && (opt & NO_CHANGE_ELEMENTS) && !(opt & RUN_ON_DEVICE) && !(opt & GHOST_DELTA) &&
+			wire_codec_impl<std::is_same<layout_base<prop>,memory_traits_lin<prop>>::value>::supported == true)
+		{
+			if (ghost_get_plan_<prp...>(v_pos,v_prp,g_m,opt) == true)
+			{return;}
+		}
+
+		prof_region prof_t(PROF_GHOST_GET,PROF_TOTAL);
+
 		// Sending property object
 		typedef object<typename object_creator<typename prop::type, prp...>::type> prp_object;
 
 		// send vector for each processor
 		typedef openfpm::vector<prp_object,Memory,typename layout_base<prp_object>::type,layout_base,openfpm::grow_policy_identity> send_vector;
 
+		// communication statistics
+		size_t n_sent = 0;
+		size_t b_sent = 0;
+		size_t b_recv = 0;
+		size_t n_recv = 0;
+
 		if (!(opt & NO_POSITION))
 		{v_pos.resize(g_m);}
 
@@ -1465,12 +1643,18 @@ public:
 
 		// Label all the particles
 		if ((opt & SKIP_LABELLING) == false)
-		{labelParticlesGhost(v_pos,v_prp,prc_g_opart,prc_sz_gg,prc_offset,g_m,opt);}
+		{
+			prof_region prof_l(PROF_GHOST_GET,PROF_LABEL);
+			labelParticlesGhost(v_pos,v_prp,prc_g_opart,prc_sz_gg,prc_offset,g_m,opt);
+		}
 
 		{
 			// Send and receive ghost particle information
 			openfpm::vector<send_vector> g_send_prp;
+
+			prof_region prof_p(PROF_GHOST_GET,PROF_PACK);
 			fill_send_ghost_prp_buf<send_vector, prp_object, prp...>(v_prp,prc_sz_gg,g_send_prp,opt);
+			prof_p.stop();
 
 	#if defined(CUDA_GPU) && defined(__NVCC__)
 			cudaDeviceSynchronize();
@@ -1481,28 +1665,56 @@ public:
 
 			if (sizeof...(prp) != 0)
 			{
+				size_t prp_recv_start = v_prp.size();
+				prof_region prof_c(PROF_GHOST_GET,PROF_COMM);
+
 				size_t opt_ = compute_options(opt);
-				if (opt & SKIP_LABELLING)
+				bool delta_done = false;
+				if ((opt & SKIP_LABELLING) && (opt & GHOST_DELTA) && !(opt & RUN_ON_DEVICE))
+				{
+					delta_done = ghost_delta_impl<std::is_same<layout_base<prp_object>,memory_traits_lin<prp_object>>::value &&
+					                              ghost_delta_trivial<prop,prp...>::value>
+					             ::template run<prp_object,prp...>(v_cl,g_plan_delta,ghost_plan_max_n(),g_delta,g_send_prp,v_prp,g_m,prc_g_opart,prc_recv_get,recv_sz_get,b_sent,b_recv);
+				}
+
+				if (delta_done == false)
 				{
-					if (opt & RUN_ON_DEVICE)
+					if (opt & SKIP_LABELLING)
 					{
-						op_ssend_gg_recv_merge_run_device opm(g_m);
-						v_cl.template SSendRecvP_op<op_ssend_gg_recv_merge_run_device,send_vector,decltype(v_prp),layout_base,prp...>(g_send_prp,v_prp,prc_g_opart,opm,prc_recv_get,recv_sz_get,opt_);
+						if (opt & RUN_ON_DEVICE)
+						{
+							op_ssend_gg_recv_merge_run_device opm(g_m);
+							v_cl.template SSendRecvP_op<op_ssend_gg_recv_merge_run_device,send_vector,decltype(v_prp),layout_base,prp...>(g_send_prp,v_prp,prc_g_opart,opm,prc_recv_get,recv_sz_get,opt_);
+						}
+						else
+						{
+							op_ssend_gg_recv_merge opm(g_m);
+							v_cl.template SSendRecvP_op<op_ssend_gg_recv_merge,send_vector,decltype(v_prp),layout_base,prp...>(g_send_prp,v_prp,prc_g_opart,opm,prc_recv_get,recv_sz_get,opt_);
+						}
 					}
 					else
-					{
-						op_ssend_gg_recv_merge opm(g_m);
-						v_cl.template SSendRecvP_op<op_ssend_gg_recv_merge,send_vector,decltype(v_prp),layout_base,prp...>(g_send_prp,v_prp,prc_g_opart,opm,prc_recv_get,recv_sz_get,opt_);
-					}
+					{v_cl.template SSendRecvP<send_vector,decltype(v_prp),layout_base,prp...>(g_send_prp,v_prp,prc_g_opart,prc_recv_get,recv_sz_get,recv_sz_get_byte,opt_);}
 				}
-				else
-				{v_cl.template SSendRecvP<send_vector,decltype(v_prp),layout_base,prp...>(g_send_prp,v_prp,prc_g_opart,prc_recv_get,recv_sz_get,recv_sz_get_byte,opt_);}
+
+				prof_c.stop();
 
 				// fill g_opart_sz
 				g_opart_sz.resize(prc_g_opart.size());
 
 				for (size_t i = 0 ; i < prc_g_opart.size() ; i++)
+				{
 					g_opart_sz.get(i) = g_send_prp.get(i).size();
+					n_sent += g_send_prp.get(i).size();
+				}
+
+				n_recv = (opt & SKIP_LABELLING)?v_prp.size() - g_m:v_prp.size() - prp_recv_start;
+
+				// with delta the bytes has been counted on the real messages
+				if (delta_done == false)
+				{
+					b_sent += n_sent * sizeof(prp_object);
+					b_recv += n_recv * sizeof(prp_object);
+				}
 			}
 		}
 
@@ -1511,12 +1723,16 @@ public:
 			// Sending buffer for the ghost particles position
 			openfpm::vector<send_pos_vector> g_pos_send;
 
+			prof_region prof_p(PROF_GHOST_GET,PROF_PACK);
 			fill_send_ghost_pos_buf(v_pos,prc_sz_gg,g_pos_send,opt);
+			prof_p.stop();
 
 #if defined(CUDA_GPU) && defined(__NVCC__)
 			cudaDeviceSynchronize();
 #endif
 
+			prof_region prof_c(PROF_GHOST_GET,PROF_COMM);
+
 			size_t opt_ = compute_options(opt);
 			if (opt & SKIP_LABELLING)
 			{
@@ -1529,11 +1745,22 @@ public:
 				v_cl.template SSendRecv<send_pos_vector,decltype(v_pos),layout_base>(g_pos_send,v_pos,prc_g_opart,prc_recv_get,recv_sz_get,opt_);
 			}
 
+			prof_c.stop();
+
             // fill g_opart_sz
             g_opart_sz.resize(prc_g_opart.size());
 
+			size_t n_sent_pos = 0;
 			for (size_t i = 0 ; i < prc_g_opart.size() ; i++)
+			{
 				g_opart_sz.get(i) = g_pos_send.get(i).size();
+				n_sent_pos += g_pos_send.get(i).size();
+			}
+
+			n_sent = n_sent_pos;
+			n_recv = v_pos.size() - g_m;
+			b_sent += n_sent_pos * sizeof(Point<dim,St>);
+			b_recv += n_recv * sizeof(Point<dim,St>);
 		}
 
         // Important to ensure that the number of particles in v_prp must be equal to v_pos
@@ -1544,6 +1771,258 @@ public:
                 v_prp.resize(v_pos.size());
         }
 
+		openfpm_profiler().add_comm(PROF_GHOST_GET,b_sent,b_recv,prc_g_opart.size(),prc_recv_get.size(),n_sent,n_recv);
+
+		// local ghost copy (replicas of the local particles across the periodic boundaries)
+		prof_region prof_lc(PROF_GHOST_GET,PROF_LOCAL);
+		add_loc_particles_bc(v_pos,v_prp,g_m,opt);
+	}
+
+	/*! \brief ghost_get_ with a fixed ghost layout (SKIP_LABELLING | NO_CHANGE_ELEMENTS) using persistent communication plans
+	 *
+	 * If one message on any processor is too big for MPI nothing is exchanged and all the processors
+	 * return false, so that the caller can use the generic path. The decision is collective the
+	 * first time for each ghost layout
+	 *
+	 * \tparam prp list of properties to get synchronize
+	 *
+	 * \param v_pos vector of position to update
+	 * \param v_prp vector of properties to update
+	 * \param g_m marker between real and ghost particles
+	 * \param opt options
+	 *
+	 * \return false if the plan cannot be used
+	 *
+	 */
+	template<int ... prp>
+	inline bool ghost_get_plan_(openfpm::vector<Point<dim, St>,Memory,typename layout_base<Point<dim,St>>::type,layout_base> & v_pos,
+								openfpm::vector<prop,Memory,typename layout_base<prop>::type,layout_base> & v_prp,
+								size_t & g_m,
+								size_t opt)
+	{
+		typedef wire_codec_impl<std::is_same<layout_base<prop>,memory_traits_lin<prop>>::value> wci;
+
+		// the biggest message of the layout is the same for all the processors
+		size_t max_n = ghost_plan_max_n();
+
+		size_t el_sz = 0;
+		wire_size_prp<wire_raw,prop> ws(el_sz);
+		boost::mpl::for_each_ref<boost::mpl::vector_c<int,prp...>>(ws);
+
+		if ((sizeof...(prp) != 0 && max_n*el_sz > INT_MAX) ||
+			(!(opt & NO_POSITION) && wire_pos_raw::template size<dim,St>(max_n) > INT_MAX))
+		{return false;}
+
+		// the plans are prepared before any exchange, the sizes were checked collectively above so a
+		// failure is the same on all the processors
+		bool ok = true;
+
+		if (sizeof...(prp) != 0)
+		{
+			ok &= g_plan_prp.prepare(v_cl.getMPIComm(),
+					                 prc_g_opart,[&](size_t i){return g_opart.get(i).size()*el_sz;},
+					                 prc_recv_get,[&](size_t i){return recv_sz_get.get(i)*el_sz;});
+		}
+
+		if (!(opt & NO_POSITION))
+		{
+			ok &= g_plan_pos.prepare(v_cl.getMPIComm(),
+					                 prc_g_opart,[&](size_t i){return wire_pos_raw::template size<dim,St>(g_opart.get(i).size());},
+					                 prc_recv_get,[&](size_t i){return wire_pos_raw::template size<dim,St>(recv_sz_get.get(i));});
+		}
+
+		if (ok == false)
+		{return false;}
+
+		prof_region prof_t(PROF_GHOST_GET,PROF_TOTAL);
+
+		// communication statistics
+		size_t n_sent = 0;
+		size_t b_sent = 0;
+		size_t b_recv = 0;
+		size_t n_recv = 0;
+
+		for (size_t i = 0 ; i < g_opart.size() ; i++)
+		{n_sent += g_opart.get(i).size();}
+
+		if (sizeof...(prp) != 0)
+		{
+			prof_region prof_p(PROF_GHOST_GET,PROF_PACK);
+			wci::template encode_prp<wire_raw,prop,prp...>(v_prp,g_opart,g_plan_prp.getSendBuffers());
+			prof_p.stop();
+
+			prof_region prof_c(PROF_GHOST_GET,PROF_COMM);
+			g_plan_prp.exchange();
+			prof_c.stop();
+
+			prof_region prof_u(PROF_GHOST_GET,PROF_UNPACK);
+			n_recv = wci::template decode_prp<wire_raw,prop,prp...>(g_plan_prp.getRecvBuffer(),g_plan_prp.getRecvProcessors(),g_plan_prp.getRecvSizes(),
+			                                                        v_prp,g_m,prc_recv_get,recv_sz_get,true);
+			prof_u.stop();
+
+			b_sent += g_plan_prp.getSentBytes();
+			b_recv += g_plan_prp.getRecvBuffer().size();
+		}
+
+		if (!(opt & NO_POSITION))
+		{
+			prof_region prof_p(PROF_GHOST_GET,PROF_PACK);
+			wci::template encode_pos<wire_pos_raw,dim,St>(v_pos,g_opart,dec.getShiftVectors(),g_plan_pos.getSendBuffers());
+			prof_p.stop();
+
+			prof_region prof_c(PROF_GHOST_GET,PROF_COMM);
+			g_plan_pos.exchange();
+			prof_c.stop();
+
+			prof_region prof_u(PROF_GHOST_GET,PROF_UNPACK);
+			n_recv = wci::template decode_pos<wire_pos_raw,dim,St>(g_plan_pos.getRecvBuffer(),g_plan_pos.getRecvProcessors(),g_plan_pos.getRecvSizes(),
+			                                                       v_pos,g_m,prc_recv_get,recv_sz_get,true);
+			prof_u.stop();
+
+			b_sent += g_plan_pos.getSentBytes();
+			b_recv += g_plan_pos.getRecvBuffer().size();
+		}
+
+		openfpm_profiler().add_comm(PROF_GHOST_GET,b_sent,b_recv,prc_g_opart.size(),prc_recv_get.size(),n_sent,n_recv);
+
+		// local ghost copy (replicas of the local particles across the periodic boundaries)
+		prof_region prof_lc(PROF_GHOST_GET,PROF_LOCAL);
+		add_loc_particles_bc(v_pos,v_prp,g_m,opt);
+
+		return true;
+	}
+
+	/*! \brief Number of times the persistent ghost_get plans has been (re)built
+	 *
+	 * \return the counter (properties + positions)
+	 *
+	 */
+	size_t getGhostPlanNBuild() const
+	{
+		return g_plan_prp.getNBuild() + g_plan_pos.getNBuild();
+	}
+
+	/*! \brief Same as ghost_get_ but the messages are encoded with wire codecs
+	 *
+	 * The properties are encoded with prp_codec (for example wire_f32 send double as float),
+	 * the positions with pos_codec (for example wire_pos_quant<unsigned short> quantise the
+	 * positions relative to the bounding box of each message). Lossy codecs change the
+	 * ghost values (not the real particles). On device or for not linear layouts it
+	 * fall back to ghost_get_
+	 *
+	 * \tparam pos_codec position wire codec
+	 * \tparam prp_codec property wire codec
+	 * \tparam prp list of properties to get synchronize
+	 *
+	 * \param v_pos vector of position to update
+	 * \param v_prp vector of properties to update
+	 * \param g_m marker between real and ghost particles
+	 * \param opt options (the same of ghost_get_)
+	 *
+	 */
+	template<typename pos_codec, typename prp_codec, int ... prp>
+	inline void ghost_get_wire_(openfpm::vector<Point<dim, St>,Memory,typename layout_base<Point<dim,St>>::type,layout_base> & v_pos,
+								openfpm::vector<prop,Memory,typename layout_base<prop>::type,layout_base> & v_prp,
+								size_t & g_m,
+								size_t opt = WITH_POSITION)
+	{
+		typedef wire_codec_impl<std::is_same<layout_base<prop>,memory_traits_lin<prop>>::value> wci;
+
+		if ((opt & RUN_ON_DEVICE) || wci::supported == false)
+		{
+			ghost_get_<prp...>(v_pos,v_prp,g_m,opt);
+			return;
+		}
+
+		prof_region prof_t(PROF_GHOST_GET,PROF_TOTAL);
+
+		// communication statistics
+		size_t n_sent = 0;
+		size_t b_sent = 0;
+		size_t b_recv = 0;
+		size_t n_recv = 0;
+
+		if (!(opt & NO_POSITION))
+		{v_pos.resize(g_m);}
+
+		if (!(opt & SKIP_LABELLING))
+		{
+			v_prp.resize(g_m);
+
+			prof_region prof_l(PROF_GHOST_GET,PROF_LABEL);
+			labelParticlesGhost(v_pos,v_prp,prc_g_opart,prc_sz_gg,prc_offset,g_m,opt);
+		}
+
+		g_delta.invalidate();
+
+		// the ghost layout is known only if we skip the labelling
+		bool known = (opt & SKIP_LABELLING) != 0;
+
+		g_opart_sz.resize(prc_g_opart.size());
+		for (size_t i = 0 ; i < prc_g_opart.size() ; i++)
+		{
+			g_opart_sz.get(i) = g_opart.get(i).size();
+			n_sent += g_opart.get(i).size();
+		}
+
+		if (sizeof...(prp) != 0)
+		{
+			openfpm::vector<openfpm::vector<unsigned char>> w_send;
+			openfpm::vector<unsigned char> w_recv;
+			openfpm::vector<size_t> prc_recv;
+			openfpm::vector<size_t> sz_recv;
+
+			prof_region prof_p(PROF_GHOST_GET,PROF_PACK);
+			wci::template encode_prp<prp_codec,prop,prp...>(v_prp,g_opart,w_send);
+			prof_p.stop();
+
+			prof_region prof_c(PROF_GHOST_GET,PROF_COMM);
+			v_cl.SSendRecv(w_send,w_recv,prc_g_opart,prc_recv,sz_recv);
+			prof_c.stop();
+
+			for (size_t i = 0 ; i < w_send.size() ; i++)
+			{b_sent += w_send.get(i).size();}
+			b_recv += w_recv.size();
+
+			prof_region prof_u(PROF_GHOST_GET,PROF_UNPACK);
+			n_recv = wci::template decode_prp<prp_codec,prop,prp...>(w_recv,prc_recv,sz_recv,v_prp,g_m,prc_recv_get,recv_sz_get,known);
+			prof_u.stop();
+
+			known = true;
+		}
+
+		if (!(opt & NO_POSITION))
+		{
+			openfpm::vector<openfpm::vector<unsigned char>> w_send;
+			openfpm::vector<unsigned char> w_recv;
+			openfpm::vector<size_t> prc_recv;
+			openfpm::vector<size_t> sz_recv;
+
+			prof_region prof_p(PROF_GHOST_GET,PROF_PACK);
+			wci::template encode_pos<pos_codec,dim,St>(v_pos,g_opart,dec.getShiftVectors(),w_send);
+			prof_p.stop();
+
+			prof_region prof_c(PROF_GHOST_GET,PROF_COMM);
+			v_cl.SSendRecv(w_send,w_recv,prc_g_opart,prc_recv,sz_recv);
+			prof_c.stop();
+
+			for (size_t i = 0 ; i < w_send.size() ; i++)
+			{b_sent += w_send.get(i).size();}
+			b_recv += w_recv.size();
+
+			prof_region prof_u(PROF_GHOST_GET,PROF_UNPACK);
+			n_recv = wci::template decode_pos<pos_codec,dim,St>(w_recv,prc_recv,sz_recv,v_pos,g_m,prc_recv_get,recv_sz_get,known);
+			prof_u.stop();
+		}
+
+		// Important to ensure that the number of particles in v_prp must be equal to v_pos
+		if (!(opt & SKIP_LABELLING))
+		{v_prp.resize(v_pos.size());}
+
+		openfpm_profiler().add_comm(PROF_GHOST_GET,b_sent,b_recv,prc_g_opart.size(),prc_recv_get.size(),n_sent,n_recv);
+
+		// local ghost copy (replicas of the local particles across the periodic boundaries)
+		prof_region prof_lc(PROF_GHOST_GET,PROF_LOCAL);
 		add_loc_particles_bc(v_pos,v_prp,g_m,opt);
 	}
 
@@ -1564,7 +2043,9 @@ public:
 	 * \param opt options
 	 *
 	 */
-	template<unsigned int ... prp> void map_list_(openfpm::vector<Point<dim, St>> & v_pos, openfpm::vector<prop> & v_prp, size_t & g_m, size_t opt)
+	template<unsigned int ... prp> void map_list_(openfpm::vector<Point<dim, St>,Memory,typename layout_base<Point<dim,St>>::type,layout_base> & v_pos,
+			                                      openfpm::vector<prop,Memory,typename layout_base<prop>::type,layout_base> & v_prp,
+			                                      size_t & g_m, size_t opt)
 	{
 		if (opt & RUN_ON_DEVICE)
 		{
@@ -1574,6 +2055,8 @@ public:
 
 		typedef KillParticle obp;
 
+		prof_region prof_t(PROF_MAP,PROF_TOTAL);
+
 		// Processor communication size
 		openfpm::vector<aggregate<unsigned int,unsigned int>,Memory,typename layout_base<aggregate<unsigned int,unsigned int>>::type,layout_base> prc_sz(v_cl.getProcessingUnits());
 
@@ -1600,6 +2083,8 @@ public:
 			}
 		}
 
+		bool split = map_split_prc(prc_r,opt);
+
 		if (opt & MAP_LOCAL)
 		{
 			// if the map is local we indicate that we receive only from the neighborhood processors
@@ -1612,24 +2097,161 @@ public:
 		// Sending property object
 		typedef object<typename object_creator<typename prop::type, prp...>::type> prp_object;
 
+		// send vector of the properties for each processor
+		typedef openfpm::vector<prp_object,Memory,typename layout_base<prp_object>::type,layout_base,openfpm::grow_policy_identity> send_prp_vector;
+
 		//! position vector
-		openfpm::vector<openfpm::vector<Point<dim, St>>> m_pos;
+		openfpm::vector<send_pos_vector> m_pos;
 		//! properties vector
-		openfpm::vector<openfpm::vector<prp_object>> m_prp;
+		openfpm::vector<send_prp_vector> m_prp;
 
 		fill_send_map_buf_list<prp_object,prp...>(v_pos,v_prp,prc_sz_r, m_pos, m_prp);
 
-		v_cl.SSendRecv(m_pos,v_pos,prc_r,prc_recv_map,recv_sz_map,opt);
-		v_cl.template SSendRecvP<openfpm::vector<prp_object>,decltype(v_prp),layout_base,prp...>(m_prp,v_prp,prc_r,prc_recv_map,recv_sz_map,opt);
+		map_send_recv(m_pos,v_pos,prc_r,split,opt & MAP_LOCAL);
+		map_send_recvP<send_prp_vector,decltype(v_prp),prp...>(m_prp,v_prp,prc_r,split,opt & MAP_LOCAL);
 
 		// mark the ghost part
 
 		g_m = v_pos.size();
 	}
 
+	/*! \brief Fill the send buffers and exchange the particles leaving the processor with all the properties
+	 *
+	 * \param v_pos vector of particle positions
+	 * \param v_prp vector of particle properties
+	 * \param prc_sz_r number of particles to send for each processor
+	 * \param prc_r processors we send to
+	 * \param split true if the neighborhood and the far particles are sent separately (see map_split_prc)
+	 * \param opt map options
+	 * \param n_sent number of particles sent
+	 * \param n_recv number of particles received
+	 *
+	 * \return the number of bytes of the properties of one particle
+	 *
+	 */
+	template<int ... prp>
+	size_t map_exchange_(std::true_type,
+			             openfpm::vector<Point<dim, St>,Memory,typename layout_base<Point<dim,St>>::type,layout_base> & v_pos,
+			             openfpm::vector<prop,Memory,typename layout_base<prop>::type,layout_base> & v_prp,
+			             openfpm::vector<size_t> & prc_sz_r,
+			             openfpm::vector<size_t> & prc_r,
+			             bool split,
+			             size_t opt,
+			             size_t & n_sent,
+			             size_t & n_recv)
+	{
+		//! position vector
+		openfpm::vector<openfpm::vector<Point<dim, St>,Memory,typename layout_base<Point<dim,St>>::type,layout_base,openfpm::grow_policy_identity>> m_pos;
+		//! properties vector
+		openfpm::vector<openfpm::vector<prop,Memory,typename layout_base<prop>::type,layout_base,openfpm::grow_policy_identity>> m_prp;
+
+		prof_region prof_p(PROF_MAP,PROF_PACK);
+		fill_send_map_buf(v_pos,v_prp, prc_sz_r,prc_r, m_pos, m_prp,prc_sz,opt);
+		prof_p.stop();
+
+		n_sent = 0;
+		for (size_t i = 0 ; i < m_pos.size() ; i++)
+		{n_sent += m_pos.get(i).size();}
+
+		size_t n_before = v_pos.size();
+		prof_region prof_c(PROF_MAP,PROF_COMM);
+
+		size_t opt_ = 0;
+		if (opt & RUN_ON_DEVICE)
+		{
+#if defined(CUDA_GPU) && defined(__NVCC__)
+			// Before doing the communication on RUN_ON_DEVICE we have to be sure that the previous kernels complete
+			cudaDeviceSynchronize();
+			opt_ |= MPI_GPU_DIRECT;
+#else
+			std::cout << __FILE__ << ":" << __LINE__ << " error: to use the option RUN_ON_DEVICE you must compile with NVCC" << std::endl;
+#endif
+		}
+
+		opt_ |= (opt & MAP_LOCAL);
+
+		map_send_recv(m_pos,v_pos,prc_r,split,opt_);
+		map_send_recv(m_prp,v_prp,prc_r,split,opt_);
+
+		n_recv = v_pos.size() - n_before;
+
+		return sizeof(prop);
+	}
+
+	/*! \brief Fill the send buffers and exchange the particles leaving the processor with only the properties prp...
+	 *
+	 * On the receiving processor the properties not listed are value-initialized
+	 *
+	 * \tparam prp properties to communicate
+	 *
+	 * \param v_pos vector of particle positions
+	 * \param v_prp vector of particle properties
+	 * \param prc_sz_r number of particles to send for each processor
+	 * \param prc_r processors we send to
+	 * \param split true if the neighborhood and the far particles are sent separately (see map_split_prc)
+	 * \param opt map options
+	 * \param n_sent number of particles sent
+	 * \param n_recv number of particles received
+	 *
+	 * \return the number of bytes of the properties of one particle
+	 *
+	 */
+	template<int ... prp>
+	size_t map_exchange_(std::false_type,
+			             openfpm::vector<Point<dim, St>,Memory,typename layout_base<Point<dim,St>>::type,layout_base> & v_pos,
+			             openfpm::vector<prop,Memory,typename layout_base<prop>::type,layout_base> & v_prp,
+			             openfpm::vector<size_t> & prc_sz_r,
+			             openfpm::vector<size_t> & prc_r,
+			             bool split,
+			             size_t opt,
+			             size_t & n_sent,
+			             size_t & n_recv)
+	{
+		// Sending property object
+		typedef object<typename object_creator<typename prop::type, prp...>::type> prp_object;
+
+		// send vector of the properties for each processor
+		typedef openfpm::vector<prp_object,Memory,typename layout_base<prp_object>::type,layout_base,openfpm::grow_policy_identity> send_prp_vector;
+
+		//! position vector
+		openfpm::vector<send_pos_vector> m_pos;
+		//! properties vector
+		openfpm::vector<send_prp_vector> m_prp;
+
+		prof_region prof_p(PROF_MAP,PROF_PACK);
+		fill_send_map_buf_list<prp_object,prp...>(v_pos,v_prp,prc_sz_r, m_pos, m_prp,opt);
+		prof_p.stop();
+
+		n_sent = 0;
+		for (size_t i = 0 ; i < m_pos.size() ; i++)
+		{n_sent += m_pos.get(i).size();}
+
+		size_t n_before = v_pos.size();
+
+		prof_region prof_c(PROF_MAP,PROF_COMM);
+
+		size_t opt_ = opt & MAP_LOCAL;
+
+		map_send_recv(m_pos,v_pos,prc_r,split,opt_);
+		map_send_recvP<send_prp_vector,decltype(v_prp),prp...>(m_prp,v_prp,prc_r,split,opt_);
+
+		prof_c.stop();
+
+		n_recv = v_pos.size() - n_before;
+
+		// the properties not sent are value-initialized on the received particles
+		prof_region prof_u(PROF_MAP,PROF_UNPACK);
+		init_unlisted_prp<decltype(v_prp),prop,prp...> iup(v_prp,n_before,v_prp.size());
+		boost::mpl::for_each_ref<boost::mpl::range_c<int,0,prop::max_prop>>(iup);
+
+		return sizeof(prp_object);
+	}
+
 	/*! \brief It move all the particles that does not belong to the local processor to the respective processor
 	 *
 	 * \tparam out of bound policy it specify what to do when the particles are detected out of bound
+	 * \tparam prp properties to communicate (all if empty), the properties not listed are value-initialized
+	 *         on the received particles. A subset of properties is not supported with RUN_ON_DEVICE
 	 *
 	 * In general this function is called after moving the particles to move the
 	 * elements out the local processor. Or just after initialization if each processor
@@ -1640,7 +2262,7 @@ public:
 	 * \param g_m ghost marker
 	 *
 	 */
-	template<typename obp = KillParticle>
+	template<typename obp = KillParticle, int ... prp>
 	void map_(openfpm::vector<Point<dim, St>,Memory,typename layout_base<Point<dim,St>>::type,layout_base> & v_pos,
 			  openfpm::vector<prop,Memory,typename layout_base<prop>::type,layout_base> & v_prp, size_t & g_m,
 			  size_t opt)
@@ -1649,6 +2271,14 @@ public:
 		SCOREP_USER_REGION("map",SCOREP_USER_REGION_TYPE_FUNCTION)
 #endif
 
+		if (sizeof...(prp) != 0 && (opt & RUN_ON_DEVICE))
+		{
+			std::cout << "Error: " << __FILE__ << ":" << __LINE__ << " map with a subset of properties is unsupported on device" << std::endl;
+			return;
+		}
+
+		prof_region prof_t(PROF_MAP,PROF_TOTAL);
+
 		prc_sz.resize(v_cl.getProcessingUnits());
 
 		// map completely reset the ghost part
@@ -1663,42 +2293,236 @@ public:
 
 		// Calculate the sending buffer size for each processor, put this information in
 		// a contiguous buffer
+		prof_region prof_p(PROF_MAP,PROF_PACK);
 		calc_send_buffers(prc_sz,prc_sz_r,prc_r,opt);
+		prof_p.stop();
 
-		//! position vector
-		openfpm::vector<openfpm::vector<Point<dim, St>,Memory,typename layout_base<Point<dim,St>>::type,layout_base,openfpm::grow_policy_identity>> m_pos;
-		//! properties vector
-		openfpm::vector<openfpm::vector<prop,Memory,typename layout_base<prop>::type,layout_base,openfpm::grow_policy_identity>> m_prp;
+		bool split = map_split_prc(prc_r,opt);
 
-		fill_send_map_buf(v_pos,v_prp, prc_sz_r,prc_r, m_pos, m_prp,prc_sz,opt);
-
-		size_t opt_ = 0;
-		if (opt & RUN_ON_DEVICE)
+		if (opt & MAP_LOCAL)
 		{
-#if defined(CUDA_GPU) && defined(__NVCC__)
-			// Before doing the communication on RUN_ON_DEVICE we have to be sure that the previous kernels complete
-			cudaDeviceSynchronize();
-			opt_ |= MPI_GPU_DIRECT;
-#else
-			std::cout << __FILE__ << ":" << __LINE__ << " error: to use the option RUN_ON_DEVICE you must compile with NVCC" << std::endl;
-#endif
+			// if the map is local we indicate that we receive only from the neighborhood processors
+
+			prc_recv_map.clear();
+			for (size_t i = 0 ; i < dec.getNNProcessors() ; i++)
+			{prc_recv_map.add(dec.IDtoProc(i));}
 		}
 
-		v_cl.template SSendRecv<openfpm::vector<Point<dim, St>,Memory,typename layout_base<Point<dim,St>>::type,layout_base,openfpm::grow_policy_identity>,
-					   openfpm::vector<Point<dim, St>,Memory,typename layout_base<Point<dim,St>>::type,layout_base>,
-					   layout_base>
-					   (m_pos,v_pos,prc_r,prc_recv_map,recv_sz_map,opt_);
+		size_t n_sent = 0;
+		size_t n_recv = 0;
 
-		v_cl.template SSendRecv<openfpm::vector<prop,Memory,typename layout_base<prop>::type,layout_base,openfpm::grow_policy_identity>,
-					   openfpm::vector<prop,Memory,typename layout_base<prop>::type,layout_base>,
-					   layout_base>
-					   (m_prp,v_prp,prc_r,prc_recv_map,recv_sz_map,opt_);
+		size_t sz_prp = map_exchange_<prp...>(std::integral_constant<bool,sizeof...(prp) == 0>(),v_pos,v_prp,prc_sz_r,prc_r,split,opt,n_sent,n_recv);
+
+		size_t n_prc_recv = prc_recv_map.size() + ((split == true)?prc_recv_map_far.size():0);
+
+		openfpm_profiler().add_comm(PROF_MAP,n_sent*(sizeof(Point<dim,St>) + sz_prp),n_recv*(sizeof(Point<dim,St>) + sz_prp),
+				                    prc_r.size(),n_prc_recv,n_sent,n_recv);
 
 		// mark the ghost part
 
 		g_m = v_pos.size();
 	}
 
+	/*! \brief Split the processors we send to in the map in neighborhood and far processors
+	 *
+	 * The decision is local and cost no communication. The particles going to the neighborhood
+	 * processors are sent with known receivers (every neighborhood processor receive a message,
+	 * possibly empty), only the particles going to the far processors use the dynamic discovery
+	 * of the receivers (NBX). With MAP_LOCAL, MAP_NBX, RUN_ON_DEVICE or one processor the exchange
+	 * is not split
+	 *
+	 * \param prc_r processors we send to
+	 * \param opt map options
+	 *
+	 * \return true if the exchange is split
+	 *
+	 */
+	bool map_split_prc(const openfpm::vector<size_t> & prc_r, size_t opt)
+	{
+		if ((opt & MAP_LOCAL) || (opt & RUN_ON_DEVICE) || (opt & MAP_NBX) || v_cl.getProcessingUnits() == 1)
+		{return false;}
+
+		map_nn_id.resize(v_cl.getProcessingUnits());
+		for (size_t i = 0 ; i < map_nn_id.size() ; i++)
+		{map_nn_id.get(i) = -1;}
+
+		prc_map_nn.clear();
+		prc_recv_map.clear();
+		for (size_t i = 0 ; i < dec.getNNProcessors() ; i++)
+		{
+			map_nn_id.get(dec.IDtoProc(i)) = i;
+			prc_map_nn.add(dec.IDtoProc(i));
+			prc_recv_map.add(dec.IDtoProc(i));
+		}
+
+		prc_map_far.clear();
+		for (size_t i = 0 ; i < prc_r.size() ; i++)
+		{
+			if (map_nn_id.get(prc_r.get(i)) == -1)
+			{prc_map_far.add(prc_r.get(i));}
+		}
+
+		if (prc_map_far.size() == 0)
+		{n_map_local++;}
+
+		return true;
+	}
+
+	/*! \brief Move the map send buffers in one buffer for each neighborhood processor (in the order of prc_map_nn)
+	 *         and in the buffers for the far processors (in the order of prc_map_far)
+	 *
+	 * \param prc_r processors we send to
+	 * \param m send buffers (one for each processor in prc_r), they are left empty
+	 * \param m_nn buffers for the neighborhood processors
+	 * \param m_far buffers for the far processors
+	 *
+	 */
+	template<typename send_vector>
+	void map_split_buf(const openfpm::vector<size_t> & prc_r,
+			           openfpm::vector<send_vector> & m,
+			           openfpm::vector<send_vector> & m_nn,
+			           openfpm::vector<send_vector> & m_far)
+	{
+		m_nn.resize(prc_map_nn.size());
+
+		for (size_t i = 0 ; i < prc_r.size() ; i++)
+		{
+			long int id = map_nn_id.get(prc_r.get(i));
+
+			if (id == -1)
+			{
+				m_far.add();
+				m_far.last().swap(m.get(i));
+			}
+			else
+			{m_nn.get(id).swap(m.get(i));}
+		}
+	}
+
+	/*! \brief Exchange the map send buffers, the received elements are appended to v
+	 *
+	 * When split the neighborhood processors exchange with known receivers, and the far
+	 * processors with NBX. The received elements come first from the neighborhood processors
+	 * and than from the far processors, the same for every call with the same split
+	 *
+	 * \param m send buffers (one for each processor in prc_r)
+	 * \param v vector where to append the received elements
+	 * \param prc_r processors we send to
+	 * \param split true if the exchange is split (see map_split_prc)
+	 * \param opt_ communication options
+	 *
+	 */
+	template<typename send_vector, typename recv_vector>
+	void map_send_recv(openfpm::vector<send_vector> & m,
+			           recv_vector & v,
+			           openfpm::vector<size_t> & prc_r,
+			           bool split,
+			           size_t opt_)
+	{
+		if (split == false)
+		{
+			v_cl.template SSendRecv<send_vector,recv_vector,layout_base>(m,v,prc_r,prc_recv_map,recv_sz_map,opt_);
+			return;
+		}
+
+		openfpm::vector<send_vector> m_nn;
+		openfpm::vector<send_vector> m_far;
+		map_split_buf(prc_r,m,m_nn,m_far);
+
+		v_cl.template SSendRecv<send_vector,recv_vector,layout_base>(m_nn,v,prc_map_nn,prc_recv_map,recv_sz_map,opt_ | MAP_LOCAL);
+		v_cl.template SSendRecv<send_vector,recv_vector,layout_base>(m_far,v,prc_map_far,prc_recv_map_far,recv_sz_map_far,opt_);
+	}
+
+	/*! \brief The same as map_send_recv but the send buffers contain only the properties prp...
+	 *
+	 * \tparam prp properties in the send buffers
+	 *
+	 * \param m send buffers (one for each processor in prc_r)
+	 * \param v vector where to append the received properties
+	 * \param prc_r processors we send to
+	 * \param split true if the exchange is split (see map_split_prc)
+	 * \param opt_ communication options
+	 *
+	 */
+	template<typename send_vector, typename recv_vector, int ... prp>
+	void map_send_recvP(openfpm::vector<send_vector> & m,
+			            recv_vector & v,
+			            openfpm::vector<size_t> & prc_r,
+			            bool split,
+			            size_t opt_)
+	{
+		if (split == false)
+		{
+			v_cl.template SSendRecvP<send_vector,recv_vector,layout_base,prp...>(m,v,prc_r,prc_recv_map,recv_sz_map,opt_);
+			return;
+		}
+
+		openfpm::vector<send_vector> m_nn;
+		openfpm::vector<send_vector> m_far;
+		map_split_buf(prc_r,m,m_nn,m_far);
+
+		v_cl.template SSendRecvP<send_vector,recv_vector,layout_base,prp...>(m_nn,v,prc_map_nn,prc_recv_map,recv_sz_map,opt_ | MAP_LOCAL);
+		v_cl.template SSendRecvP<send_vector,recv_vector,layout_base,prp...>(m_far,v,prc_map_far,prc_recv_map_far,recv_sz_map_far,opt_);
+	}
+
+	/*! \brief Get how many map the local processor sent only to its neighborhood processors
+	 *
+	 * The counter is local, it does not depend on what the other processors sent
+	 *
+	 * \return the counter
+	 *
+	 */
+	inline size_t getMapNLocal() const
+	{
+		return n_map_local;
+	}
+
+	/*! \brief Get the size of one ghost particle sent by the last ghost_get
+	 *
+	 * \return the size in byte of the properties and the position (0 if ghost_get has never been called)
+	 *
+	 */
+	inline size_t getGhostObjectSize() const
+	{
+		return g_obj_sz;
+	}
+
+	/*! \brief Set the size of one ghost particle sent by the last ghost_get
+	 *
+	 * \param sz size in byte of the properties and the position
+	 *
+	 */
+	inline void setGhostObjectSize(size_t sz)
+	{
+		g_obj_sz = sz;
+	}
+
+	/*! \brief Get the number of particles that did not migrate in the last map
+	 *
+	 * After map the particles [0,n_stay) are the particles that were already local, the particles
+	 * [n_stay,g_m) are the particles received from the other processors
+	 *
+	 * \return the number of particles that stayed
+	 *
+	 */
+	inline size_t getMapNStay() const
+	{
+		return n_stay_map;
+	}
+
+	/*! \brief Get the particles that left in the last map
+	 *
+	 * For each particle the property 0 is the particle id before map (ordered), 2 the destination
+	 * processor (negative if removed)
+	 *
+	 * \return the list of the particles that left
+	 *
+	 */
+	inline const decltype(m_opart) & getMapOutParticles() const
+	{
+		return m_opart;
+	}
+
 	/*! \brief Get the decomposition
 	 *
 	 * \return
@@ -1770,8 +2594,24 @@ public:
 		// send vector for each processor
 		typedef openfpm::vector<prp_object,Memory,typename layout_base<prp_object>::type,layout_base> send_vector;
 
+		prof_region prof_t(PROF_GHOST_PUT,PROF_TOTAL);
+
 		openfpm::vector<send_vector> g_send_prp;
+
+		prof_region prof_p(PROF_GHOST_PUT,PROF_PACK);
 		fill_send_ghost_put_prp_buf<send_vector, prp_object, prp...>(v_prp,g_send_prp,g_m);
+		prof_p.stop();
+
+		size_t n_sent = 0;
+		for (size_t i = 0 ; i < g_send_prp.size() ; i++)
+		{n_sent += g_send_prp.get(i).size();}
+
+		// received elements are merged with op, the number of elements received is the number sent in ghost_get
+		size_t n_recv = 0;
+		for (size_t i = 0 ; i < g_opart.size() ; i++)
+		{n_recv += g_opart.get(i).size();}
+
+		prof_region prof_c(PROF_GHOST_PUT,PROF_COMM);
 
 		// Send and receive ghost particle information
 		if (opt & NO_CHANGE_ELEMENTS)
@@ -1787,8 +2627,15 @@ public:
 			v_cl.template SSendRecvP_op<op_ssend_recv_merge<op>,send_vector,decltype(v_prp),layout_base,prp...>(g_send_prp,v_prp,prc_recv_get,opm,prc_recv_put,recv_sz_put);
 		}
 
+		prof_c.stop();
+
+		openfpm_profiler().add_comm(PROF_GHOST_PUT,n_sent*sizeof(prp_object),n_recv*sizeof(prp_object),
+				                    prc_recv_get.size(),prc_g_opart.size(),n_sent,n_recv);
+
 		// process also the local replicated particles
 
+		prof_region prof_lc(PROF_GHOST_PUT,PROF_LOCAL);
+
 		size_t i2 = 0;
 
 
@@ -10,6 +10,8 @@
 
 #include "NN/CellList/CellListM.hpp"
 #include "NN/VerletList/VerletListM.hpp"
+#include "Vector/util/verlet_list_csr.hpp"
+#include "util/thread_pool.hpp"
 
 template<typename Vector, typename CL, typename T>
 VerletList<Vector::dims,typename Vector::stype,Mem_fast<>,shift<Vector::dims,typename Vector::stype>,typename Vector::internal_position_vector_type,CL>
@@ -148,4 +150,422 @@ createCellListSymM(openfpm::vector<Vector> & phases, T r_cut)
 	return NN;
 }
 
+/////// Fused multi-phase version
+
+/*! \brief Phase-pair Verlet-lists constructed with one traversal over all the phases
+ *
+ * For each pair of phases (i,j) the neighborhood of the domain particles of the phase i inside the phase j is
+ * stored in CSR format
+ *
+ * \see createVerletMultiPhase
+ *
+ * \tparam dim dimensionality
+ * \tparam St space type
+ *
+ */
+template<unsigned int dim, typename St>
+class VerletListMultiPhase
+{
+	//! number of phases
+	size_t n_phases;
+
+	//! option VL_NON_SYMMETRIC or VL_SYMMETRIC
+	size_t opt;
+
+	//! for each phase pair (i*n_phases+j) the offset of the neighborhood of each particle of the phase i
+	openfpm::vector<openfpm::vector<size_t>> offs;
+
+	//! for each phase pair (i*n_phases+j) the neighborhood of all the particles of the phase i
+	openfpm::vector<openfpm::vector<size_t>> nn;
+
+	//! for each cell of the fused cell-list the offset of its packed keys
+	openfpm::vector<size_t> cell_off;
+
+	//! packed keys (phase and index) of all the particles ordered by cell
+	openfpm::vector<size_t> cell_key;
+
+	//! offsets of the neighborhood cells
+	openfpm::vector<long int> stencil;
+
+	/*! \brief Return if the symmetric interaction between p and q is stored in the list of p
+	 *
+	 * Same ordering of the symmetric cell-list iterator: the positions are compared starting from the last
+	 * coordinate and equal positions are ordered by (packed) index. The rule depend only on the relative
+	 * position of the two particles, so an interaction between a domain and a ghost particle is stored only
+	 * on one of the two processors
+	 *
+	 * \param xp position of p
+	 * \param xq position of q
+	 * \param key_p packed key of p
+	 * \param key_q packed key of q
+	 *
+	 * \return true if the interaction is stored in the list of p
+	 *
+	 */
+	inline static bool sym_owner(const Point<dim,St> & xp, const Point<dim,St> & xq, size_t key_p, size_t key_q)
+	{
+		for (long int k = dim-1 ; k >= 0 ; k--)
+		{
+			if (xp.get(k) < xq.get(k))
+			{return true;}
+			else if (xp.get(k) > xq.get(k))
+			{return false;}
+		}
+
+		return key_p < key_q;
+	}
+
+	/*! \brief Traverse the neighborhood of the particle p of the phase i
+	 *
+	 * \param phases phases
+	 * \param i phase
+	 * \param p particle
+	 * \param c cell of the particle p
+	 * \param r_cut cut-off radius
+	 * \param sh shift of the phase in the packed key
+	 * \param w counters (one for each phase)
+	 * \param cnt true count, false fill
+	 *
+	 */
+	template<typename Vector> void traverse(openfpm::vector<Vector> & phases,
+			                                size_t i, size_t p, size_t c, St r_cut, size_t sh,
+											openfpm::vector<size_t> & w, bool cnt)
+	{
+		size_t mask = ((size_t)1 << sh) - 1;
+		size_t key_p = p | (i << sh);
+
+		for (size_t j = 0 ; j < n_phases ; j++)
+		{w.get(j) = (cnt == true)?0:offs.get(i*n_phases+j).get(p);}
+
+		Point<dim,St> xp = phases.get(i).getPos(p);
+
+		for (size_t s = 0 ; s < stencil.size() ; s++)
+		{
+			size_t cs = c + stencil.get(s);
+
+			for (size_t k = cell_off.get(cs) ; k < cell_off.get(cs+1) ; k++)
+			{
+				size_t key_q = cell_key.get(k);
+				size_t j = key_q >> sh;
+				size_t q = key_q & mask;
+
+				Point<dim,St> xq = phases.get(j).getPos(q);
+
+				// symmetric interactions are stored once
+				if (opt == VL_SYMMETRIC && (key_q == key_p || sym_owner(xp,xq,key_p,key_q) == false))
+				{continue;}
+
+				if (xp.distance2(xq) < r_cut*r_cut)
+				{
+					if (cnt == false)
+					{nn.get(i*n_phases+j).get(w.get(j)) = q;}
+					w.get(j)++;
+				}
+			}
+		}
+
+		if (cnt == true)
+		{
+			for (size_t j = 0 ; j < n_phases ; j++)
+			{offs.get(i*n_phases+j).get(p) = w.get(j);}
+		}
+	}
+
+public:
+
+	//! Iterator across the neighborhood of a particle
+	typedef typename vl_csr_full::NNIterator NNIterator;
+
+	//! Default constructor
+	VerletListMultiPhase()
+	:n_phases(0),opt(VL_NON_SYMMETRIC)
+	{}
+
+	/*! \brief Create the Verlet-lists of all the pairs of phases
+	 *
+	 * \see createVerletMultiPhase
+	 *
+	 * \tparam nbit number of bits used to store the phase
+	 *
+	 * \param phases phases
+	 * \param r_cut cut-off radius
+	 * \param opt VL_NON_SYMMETRIC or VL_SYMMETRIC
+	 * \param n_thr number of threads
+	 *
+	 */
+	template<unsigned int nbit, typename Vector> void create(openfpm::vector<Vector> & phases, St r_cut, size_t opt, size_t n_thr)
+	{
+		size_t sh = sizeof(size_t)*8 - nbit;
+		size_t np = phases.size();
+
+		this->n_phases = np;
+		this->opt = opt;
+
+		offs.clear();
+		nn.clear();
+
+		if (np == 0)
+		{return;}
+
+		if (np > ((size_t)1 << nbit))
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error " << np << " phases cannot be stored with " << nbit << " bits" << std::endl;
+			n_phases = 0;
+			return;
+		}
+
+		n_thr = (n_thr == 0)?1:n_thr;
+
+		// Fused cell-list, only its cell decomposition is used
+		size_t div[dim];
+		Box<dim,St> box_cl;
+		phases.get(0).getCellListParams(r_cut,div,box_cl);
+
+		CellList<dim,St,Mem_fast<>,shift<dim,St>> NN;
+		NN.Initialize(box_cl,div);
+
+		size_t n_cell = NN.getGrid().size();
+
+		// offsets of the 3^dim neighborhood cells
+		stencil.clear();
+		stencil.add(0);
+
+		long int str = 1;
+		for (size_t k = 0 ; k < dim ; k++)
+		{
+			size_t n_st = stencil.size();
+			for (size_t s = 0 ; s < n_st ; s++)
+			{
+				stencil.add(stencil.get(s) - str);
+				stencil.add(stencil.get(s) + str);
+			}
+
+			str *= NN.getGrid().size(k);
+		}
+
+		// particles (domain + ghost) and domain particles of all the phases in one sequence
+		openfpm::vector<size_t> p_off(np+1);
+		openfpm::vector<size_t> d_off(np+1);
+		p_off.get(0) = 0;
+		d_off.get(0) = 0;
+		for (size_t i = 0 ; i < np ; i++)
+		{
+			p_off.get(i+1) = p_off.get(i) + phases.get(i).size_local_with_ghost();
+			d_off.get(i+1) = d_off.get(i) + phases.get(i).size_local();
+		}
+
+		// calculate the cell of all the particles of all the phases, and count the particles
+		// of each thread in each cell
+		openfpm::vector<size_t> p_cell(p_off.get(np));
+		openfpm::vector<openfpm::vector<size_t>> t_cnt(n_thr);
+
+		size_t chunk = (p_off.get(np) + n_thr - 1) / n_thr;
+
+		run_threads(n_thr,[&](size_t t)
+		{
+			auto & tc = t_cnt.get(t);
+			tc.resize(n_cell);
+			for (size_t c = 0 ; c < n_cell ; c++)
+			{tc.get(c) = 0;}
+
+			size_t stop = std::min(p_off.get(np),(t+1)*chunk);
+
+			size_t i = 0;
+			for (size_t k = t*chunk ; k < stop ; k++)
+			{
+				while (k >= p_off.get(i+1))	{i++;}
+
+				Point<dim,St> xp = phases.get(i).getPos(k - p_off.get(i));
+				p_cell.get(k) = NN.getCell(xp);
+				tc.get(p_cell.get(k))++;
+			}
+		});
+
+		// prefix sum, inside a cell the threads write one after the other
+		cell_off.resize(n_cell+1);
+
+		size_t tot = 0;
+		for (size_t c = 0 ; c < n_cell ; c++)
+		{
+			cell_off.get(c) = tot;
+			for (size_t t = 0 ; t < n_thr ; t++)
+			{
+				size_t n = t_cnt.get(t).get(c);
+				t_cnt.get(t).get(c) = tot;
+				tot += n;
+			}
+		}
+		cell_off.get(n_cell) = tot;
+
+		// insert the packed keys
+		cell_key.resize(tot);
+
+		run_threads(n_thr,[&](size_t t)
+		{
+			auto & tc = t_cnt.get(t);
+
+			size_t stop = std::min(p_off.get(np),(t+1)*chunk);
+
+			size_t i = 0;
+			for (size_t k = t*chunk ; k < stop ; k++)
+			{
+				while (k >= p_off.get(i+1))	{i++;}
+
+				cell_key.get(tc.get(p_cell.get(k))++) = (k - p_off.get(i)) | (i << sh);
+			}
+		});
+
+		offs.resize(np*np);
+		nn.resize(np*np);
+
+		for (size_t i = 0 ; i < np ; i++)
+		{
+			for (size_t j = 0 ; j < np ; j++)
+			{
+				offs.get(i*np+j).resize(phases.get(i).size_local()+1);
+				for (size_t k = 0 ; k < offs.get(i*np+j).size() ; k++)
+				{offs.get(i*np+j).get(k) = 0;}
+			}
+		}
+
+		// the domain particles of all the phases are partitioned across threads
+		size_t n_dom = d_off.get(np);
+		chunk = (n_dom + n_thr - 1) / n_thr;
+
+		auto pass = [&](bool cnt)
+		{
+			run_threads(n_thr,[&](size_t t)
+			{
+				openfpm::vector<size_t> w(np);
+
+				size_t stop = std::min(n_dom,(t+1)*chunk);
+
+				size_t i = 0;
+				for (size_t k = t*chunk ; k < stop ; k++)
+				{
+					while (k >= d_off.get(i+1))	{i++;}
+
+					size_t p = k - d_off.get(i);
+					traverse(phases,i,p,p_cell.get(p_off.get(i) + p),r_cut,sh,w,cnt);
+				}
+			});
+		};
+
+		// count
+		pass(true);
+
+		// prefix sum
+		for (size_t ij = 0 ; ij < np*np ; ij++)
+		{
+			auto & o = offs.get(ij);
+
+			size_t tot = 0;
+			for (size_t k = 0 ; k < o.size() ; k++)
+			{
+				size_t c = o.get(k);
+				o.get(k) = tot;
+				tot += c;
+			}
+
+			nn.get(ij).resize(tot);
+		}
+
+		// fill
+		pass(false);
+
+		// the cells are needed only during the construction
+		cell_off.clear();
+		cell_key.clear();
+	}
+
+	/*! \brief Get the neighborhood iterator of the particle p of the phase i inside the phase j
+	 *
+	 * \param i phase of the particle p
+	 * \param j phase of the neighborhood
+	 * \param p particle
+	 *
+	 * \return the neighborhood iterator
+	 *
+	 */
+	inline NNIterator getNNIterator(size_t i, size_t j, size_t p) const
+	{
+		auto & o = offs.get(i*n_phases+j);
+		auto & n = nn.get(i*n_phases+j);
+
+		const size_t * base = (n.size() == 0)?NULL:&n.get(0);
+
+		return NNIterator(p,base + o.get(p),base + o.get(p+1));
+	}
+
+	/*! \brief Get the number of neighbors in the phase j of the particle p of the phase i
+	 *
+	 * \param i phase of the particle p
+	 * \param j phase of the neighborhood
+	 * \param p particle
+	 *
+	 * \return the number of neighbors
+	 *
+	 */
+	inline size_t getNNPart(size_t i, size_t j, size_t p) const
+	{
+		auto & o = offs.get(i*n_phases+j);
+
+		return o.get(p+1) - o.get(p);
+	}
+
+	/*! \brief Number of phases
+	 *
+	 * \return the number of phases
+	 *
+	 */
+	inline size_t getNPhases() const
+	{
+		return n_phases;
+	}
+
+	/*! \brief Return if the lists are symmetric
+	 *
+	 * \return VL_NON_SYMMETRIC or VL_SYMMETRIC
+	 *
+	 */
+	inline size_t getOpt() const
+	{
+		return opt;
+	}
+};
+
+/*! \brief Create with one traversal the Verlet-lists of all the pairs of phases
+ *
+ * One cell-list is constructed over all the particles (domain + ghost) of all the phases storing the phase and the
+ * index packed in one key (the phase in the nbit most significant bits), the cells of all the particles are calculated
+ * in one threaded pass. The domain particles of all the phases are then partitioned across threads, and each thread
+ * traverse the neighborhood of its particles once, counting (first pass) and filling (second pass after the prefix sum)
+ * the lists of all the phase pairs at the same time.
+ *
+ * With VL_SYMMETRIC every interaction is stored only once, with the same ordering of the symmetric cell-list
+ * (positions compared from the last coordinate, then the packed key). Because the rule depend only on the relative
+ * position, an interaction between a domain and a ghost particle is stored only on one processor and the
+ * contributions to the ghost particles must be merged with ghost_put
+ *
+ * \tparam nbit number of bits used to store the phase
+ *
+ * \param phases phases
+ * \param r_cut cut-off radius
+ * \param opt VL_NON_SYMMETRIC or VL_SYMMETRIC
+ * \param n_thr number of threads
+ *
+ * \return the phase-pair Verlet-lists
+ *
+ */
+template<unsigned int nbit, typename Vector, typename T>
+VerletListMultiPhase<Vector::dims,typename Vector::stype>
+createVerletMultiPhase(openfpm::vector<Vector> & phases, T r_cut, size_t opt = VL_NON_SYMMETRIC, size_t n_thr = 1)
+{
+	VerletListMultiPhase<Vector::dims,typename Vector::stype> ver;
+
+	ver.template create<nbit>(phases,r_cut,opt,n_thr);
+
+	return ver;
+}
+
 #endif /* SRC_VECTOR_VECTOR_DIST_MULTIPHASE_FUNCTIONS_HPP_ */
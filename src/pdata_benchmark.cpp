@@ -0,0 +1,604 @@
+/*
+ * pdata_benchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ *
+ * Benchmark runner producing machine readable results (JSON/CSV) that can be compared with a baseline
+ *
+ * Usage: mpirun -np N ./pdata_bench [options]
+ *
+ *  --list                 list the available tests
+ *  --test t1,t2,...       run only the selected tests (default all)
+ *  --sizes s1,s2,...      total number of particles to sweep (default 25000,50000,100000 per processor)
+ *  --samples n            number of samples for each measure (default N_STAT_TEST)
+ *  --weak                 the sizes are per processor (weak scaling), otherwise they are total (strong scaling)
+ *  --nn n                 average number of neighborhood particles, used to calculate the cut-off radius (default 30)
+ *  --ghost g1,g2,...      ghost widths, as multiple of the cut-off radius, for the communication tests (default 1)
+ *  --move m1,m2,...       movement amplitudes, as multiple of the cut-off radius, for the map tests (default 0.1,1)
+ *  --json file            write the results in JSON format
+ *  --csv file             write the results in CSV format (can be used as baseline)
+ *  --baseline file        compare with the baseline (CSV) and exit with 1 if there are regressions
+ *  --t-crit x             critical value of the Welch t statistic (default 3.0)
+ *  --min-rel x            minimum relative slow-down to consider a regression (default 0.05)
+ *
+ */
+
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include "config.h"
+#include "initialize/initialize_wrapper.hpp"
+#include "Vector/vector_dist.hpp"
+#include "Vector/performance/vector_dist_performance_util.hpp"
+#include "Vector/performance/benchmark_report.hpp"
+#include "Vector/performance/comm_scaling_benchmarks.hpp"
+
+//! dimensionality of the benchmarks
+constexpr unsigned int bdim = 3;
+
+//! distributed vector used in the benchmarks
+typedef vector_dist<bdim,float, aggregate<float[bdim]> > bench_vector;
+
+/*! \brief A benchmark
+ *
+ * It fill the measures for each quantity name it produce (run), or it add directly the records to
+ * the report (run_comm, communication benchmarks that create their own distributed structures)
+ *
+ */
+struct benchmark_test
+{
+	//! name of the test
+	const char * name;
+
+	//! description
+	const char * desc;
+
+	//! run the benchmark
+	void (* run)(bench_vector & vd, float r_cut, size_t n_samples, openfpm::vector<std::string> & names, openfpm::vector<openfpm::vector<double>> & measures);
+
+	//! run the communication benchmark
+	void (* run_comm)(const comm_bench_param & p, benchmark_report & rep);
+};
+
+/*! \brief Reduce one sample across processors (the slowest processor define the time)
+ *
+ * \param t time of this processor
+ *
+ * \return the maximum time across processors
+ *
+ */
+static double sample_max(double t)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	v_cl.max(t);
+	v_cl.execute();
+
+	return t;
+}
+
+static void bench_cell_list(bench_vector & vd, float r_cut, size_t n_samples, openfpm::vector<std::string> & names, openfpm::vector<openfpm::vector<double>> & measures)
+{
+	names.add("create");
+	names.add("forces");
+	measures.resize(2);
+
+	auto NN = vd.getCellList(r_cut);
+
+	for (size_t i = 0 ; i < n_samples ; i++)
+	{measures.get(0).add(sample_max(benchmark_get_celllist(NN,vd,r_cut)));}
+
+	for (size_t i = 0 ; i < n_samples ; i++)
+	{measures.get(1).add(sample_max(benchmark_calc_forces<bdim>(NN,vd,r_cut)));}
+}
+
+static void bench_verlet(bench_vector & vd, float r_cut, size_t n_samples, openfpm::vector<std::string> & names, openfpm::vector<openfpm::vector<double>> & measures)
+{
+	names.add("create");
+	names.add("forces");
+	measures.resize(2);
+
+	auto NN = vd.getVerlet(r_cut);
+
+	for (size_t i = 0 ; i < n_samples ; i++)
+	{measures.get(0).add(sample_max(benchmark_get_verlet_type(NN,vd,r_cut)));}
+
+	for (size_t i = 0 ; i < n_samples ; i++)
+	{measures.get(1).add(sample_max(benchmark_calc_forces_verlet<bdim>(NN,vd,r_cut)));}
+}
+
+static void bench_map(bench_vector & vd, float r_cut, size_t n_samples, openfpm::vector<std::string> & names, openfpm::vector<openfpm::vector<double>> & measures)
+{
+	names.add("map");
+	measures.resize(1);
+
+	for (size_t i = 0 ; i < n_samples ; i++)
+	{
+		move_particles<bdim>(vd,r_cut);
+
+		timer t;
+		t.start();
+		vd.map();
+		t.stop();
+
+		measures.get(0).add(sample_max(t.getwct()));
+	}
+}
+
+static void bench_ghost_get(bench_vector & vd, float r_cut, size_t n_samples, openfpm::vector<std::string> & names, openfpm::vector<openfpm::vector<double>> & measures)
+{
+	names.add("ghost_get");
+	names.add("ghost_get_skip_labelling");
+	measures.resize(2);
+
+	for (size_t i = 0 ; i < n_samples ; i++)
+	{
+		timer t;
+		t.start();
+		vd.ghost_get<0>();
+		t.stop();
+
+		measures.get(0).add(sample_max(t.getwct()));
+	}
+
+	for (size_t i = 0 ; i < n_samples ; i++)
+	{
+		timer t;
+		t.start();
+		vd.ghost_get<0>(SKIP_LABELLING);
+		t.stop();
+
+		measures.get(1).add(sample_max(t.getwct()));
+	}
+}
+
+static void bench_reorder(bench_vector & vd, float r_cut, size_t n_samples, openfpm::vector<std::string> & names, openfpm::vector<openfpm::vector<double>> & measures)
+{
+	names.add("reorder");
+	measures.resize(1);
+
+	for (size_t i = 0 ; i < n_samples ; i++)
+	{measures.get(0).add(sample_max(benchmark_reorder(vd,5)));}
+}
+
+static void bench_remove(bench_vector & vd, float r_cut, size_t n_samples, openfpm::vector<std::string> & names, openfpm::vector<openfpm::vector<double>> & measures)
+{
+	names.add("remove");
+	names.add("remove_unordered");
+	names.add("mark_remove_compact");
+	measures.resize(3);
+
+	// remove 1% of the local particles
+	openfpm::vector<size_t> keys;
+
+	for (size_t i = 0 ; i < vd.size_local() ; i += 100)
+	{keys.add(i + rand() % std::min((size_t)100,vd.size_local() - i));}
+
+	for (size_t i = 0 ; i < n_samples ; i++)
+	{
+		bench_vector vd2(vd);
+
+		timer t;
+		t.start();
+		vd2.remove(keys);
+		t.stop();
+
+		measures.get(0).add(sample_max(t.getwct()));
+	}
+
+	for (size_t i = 0 ; i < n_samples ; i++)
+	{
+		bench_vector vd2(vd);
+
+		timer t;
+		t.start();
+		vd2.removeUnordered(keys);
+		t.stop();
+
+		measures.get(1).add(sample_max(t.getwct()));
+	}
+
+	for (size_t i = 0 ; i < n_samples ; i++)
+	{
+		bench_vector vd2(vd);
+
+		timer t;
+		t.start();
+		for (size_t j = 0 ; j < keys.size() ; j++)
+		{vd2.markRemove(keys.get(j));}
+		vd2.removeMarked();
+		t.stop();
+
+		measures.get(2).add(sample_max(t.getwct()));
+	}
+}
+
+static void bench_add(bench_vector & vd, float r_cut, size_t n_samples, openfpm::vector<std::string> & names, openfpm::vector<openfpm::vector<double>> & measures)
+{
+	names.add("add");
+	names.add("add_bulk");
+	names.add("add_bulk_map");
+	measures.resize(3);
+
+	size_t n = vd.size_local();
+
+	for (size_t i = 0 ; i < n_samples ; i++)
+	{
+		bench_vector vd2(vd.getDecomposition(),0);
+
+		timer t;
+		t.start();
+		for (size_t j = 0 ; j < n ; j++)
+		{
+			vd2.add();
+
+			vd2.getLastPos()[0] = vd.getPos(j)[0];
+			vd2.getLastPos()[1] = vd.getPos(j)[1];
+			vd2.getLastPos()[2] = vd.getPos(j)[2];
+		}
+		t.stop();
+
+		measures.get(0).add(sample_max(t.getwct()));
+	}
+
+	for (size_t k = 0 ; k < 2 ; k++)
+	{
+		for (size_t i = 0 ; i < n_samples ; i++)
+		{
+			bench_vector vd2(vd.getDecomposition(),0);
+
+			timer t;
+			t.start();
+			vd2.addBulk(n,[&](size_t j, vect_dist_key_dx key)
+			{
+				vd2.getPos(key)[0] = vd.getPos(j)[0];
+				vd2.getPos(key)[1] = vd.getPos(j)[1];
+				vd2.getPos(key)[2] = vd.getPos(j)[2];
+			},1,k == 1);
+			t.stop();
+
+			measures.get(1+k).add(sample_max(t.getwct()));
+		}
+	}
+}
+
+/*! \brief Decomposition setup time varying the number of sub-domains per processor
+ *
+ * For each granularity it measure decompose() and the construction of the ghost boxes alone
+ * (duplicate with a different ghost), the problem size reported is the average number of
+ * sub-domains per processor after decompose
+ *
+ * \param p parameters
+ * \param rep report
+ *
+ */
+static void bench_dec_setup(const comm_bench_param & p, benchmark_report & rep)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	Box<bdim,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+	size_t bc[bdim] = {PERIODIC,PERIODIC,PERIODIC};
+	Ghost<bdim,float> g(p.r_cut());
+	Ghost<bdim,float> g2(2.0*p.r_cut());
+
+	size_t gran[] = {16,64,256,1024};
+
+	for (size_t k = 0 ; k < sizeof(gran) / sizeof(size_t) ; k++)
+	{
+		openfpm::vector<double> t_dec;
+		openfpm::vector<double> t_ghost;
+		size_t n_sub = 0;
+
+		for (size_t i = 0 ; i < p.n_samples ; i++)
+		{
+			CartDecomposition<bdim,float> dec(v_cl);
+			dec.setGoodParameters(box,bc,g,gran[k]);
+
+			timer t;
+			t.start();
+			dec.decompose();
+			t.stop();
+
+			t_dec.add(sample_max(t.getwct()));
+
+			timer t2;
+			t2.start();
+			auto dec2 = dec.duplicate(g2);
+			t2.stop();
+
+			t_ghost.add(sample_max(t2.getwct()));
+
+			n_sub = dec.getNSubDomain();
+		}
+
+		v_cl.sum(n_sub);
+		v_cl.execute();
+		n_sub /= v_cl.getProcessingUnits();
+
+		rep.add("dec_setup",comm_bench_tag("gran",gran[k]) + "/decompose",n_sub,v_cl.getProcessingUnits(),t_dec);
+		rep.add("dec_setup",comm_bench_tag("gran",gran[k]) + "/ghost_boxes",n_sub,v_cl.getProcessingUnits(),t_ghost);
+	}
+}
+
+//! all the available benchmarks
+static benchmark_test tests[] = {{"cell_list","Cell-list creation and force calculation",bench_cell_list},
+                                 {"verlet","Verlet-list creation and force calculation",bench_verlet},
+                                 {"map","map() after moving all the particles of r_cut in random direction",bench_map},
+                                 {"ghost_get","ghost_get with and without labelling",bench_ghost_get},
+                                 {"reorder","reorder along an Hilbert curve of order 5",bench_reorder},
+                                 {"add","insertion of the local particles with add and addBulk",bench_add},
+                                 {"remove","removal of 1% of the particles: remove, removeUnordered, markRemove + removeMarked",bench_remove},
+                                 {"vector_map","map() time breakdown and volume varying the movement amplitude",NULL,comm_bench_vector_map},
+                                 {"vector_ghost_get","ghost_get() time breakdown and volume varying the ghost width and options",NULL,comm_bench_vector_ghost_get},
+                                 {"vector_ghost_put","ghost_put() time breakdown and volume varying the ghost width",NULL,comm_bench_vector_ghost_put},
+                                 {"grid_ghost_get","grid ghost_get() time breakdown and volume varying the ghost width",NULL,comm_bench_grid_ghost_get},
+                                 {"grid_map","grid map() time breakdown and volume (redistribution on a new decomposition)",NULL,comm_bench_grid_map},
+                                 {"dec_setup","decomposition and ghost boxes setup time varying the sub-domains per processor",NULL,bench_dec_setup}};
+
+/*! \brief Split a comma separated list
+ *
+ * \param str string
+ * \param out output list
+ *
+ */
+static void split_list(const char * str, openfpm::vector<std::string> & out)
+{
+	std::stringstream ss(str);
+	std::string item;
+
+	while (std::getline(ss,item,','))
+	{
+		if (item.size() != 0)
+		{out.add(item);}
+	}
+}
+
+/*! \brief Split a comma separated list of numbers
+ *
+ * \param str string
+ * \param out output list
+ *
+ */
+static void split_list(const char * str, openfpm::vector<double> & out)
+{
+	openfpm::vector<std::string> s;
+	split_list(str,s);
+
+	for (size_t i = 0 ; i < s.size() ; i++)
+	{out.add(std::stod(s.get(i)));}
+}
+
+/*! \brief Check if a test has been selected
+ *
+ * \param sel selected tests (empty means all)
+ * \param name name of the test
+ *
+ * \return true if selected
+ *
+ */
+static bool is_selected(openfpm::vector<std::string> & sel, const char * name)
+{
+	if (sel.size() == 0)
+	{return true;}
+
+	for (size_t i = 0 ; i < sel.size() ; i++)
+	{
+		if (sel.get(i) == name)
+		{return true;}
+	}
+
+	return false;
+}
+
+int main(int argc, char* argv[])
+{
+	openfpm_init_wrapper(&argc,&argv);
+
+	Vcluster<> & v_cl = create_vcluster();
+
+	openfpm::vector<std::string> sel;
+	openfpm::vector<size_t> sizes;
+	size_t n_samples = N_STAT_TEST;
+	double n_nn = 30.0;
+	bool weak = false;
+	openfpm::vector<double> ghost;
+	openfpm::vector<double> move;
+	std::string json_file;
+	std::string csv_file;
+	std::string base_file;
+	double t_crit = 3.0;
+	double min_rel = 0.05;
+	size_t n_tests = sizeof(tests) / sizeof(benchmark_test);
+
+	for (int i = 1 ; i < argc ; i++)
+	{
+		bool has_arg = (i + 1 < argc);
+
+		if (strcmp(argv[i],"--list") == 0)
+		{
+			if (v_cl.getProcessUnitID() == 0)
+			{
+				for (size_t j = 0 ; j < n_tests ; j++)
+				{std::cout << tests[j].name << "\t" << tests[j].desc << std::endl;}
+			}
+
+			openfpm_finalize_wrapper();
+			return 0;
+		}
+		else if (strcmp(argv[i],"--test") == 0 && has_arg)
+		{split_list(argv[++i],sel);}
+		else if (strcmp(argv[i],"--sizes") == 0 && has_arg)
+		{
+			openfpm::vector<std::string> s;
+			split_list(argv[++i],s);
+
+			for (size_t j = 0 ; j < s.size() ; j++)
+			{sizes.add(std::stoul(s.get(j)));}
+		}
+		else if (strcmp(argv[i],"--samples") == 0 && has_arg)
+		{n_samples = std::stoul(argv[++i]);}
+		else if (strcmp(argv[i],"--weak") == 0)
+		{weak = true;}
+		else if (strcmp(argv[i],"--ghost") == 0 && has_arg)
+		{split_list(argv[++i],ghost);}
+		else if (strcmp(argv[i],"--move") == 0 && has_arg)
+		{split_list(argv[++i],move);}
+		else if (strcmp(argv[i],"--nn") == 0 && has_arg)
+		{n_nn = std::stod(argv[++i]);}
+		else if (strcmp(argv[i],"--json") == 0 && has_arg)
+		{json_file = argv[++i];}
+		else if (strcmp(argv[i],"--csv") == 0 && has_arg)
+		{csv_file = argv[++i];}
+		else if (strcmp(argv[i],"--baseline") == 0 && has_arg)
+		{base_file = argv[++i];}
+		else if (strcmp(argv[i],"--t-crit") == 0 && has_arg)
+		{t_crit = std::stod(argv[++i]);}
+		else if (strcmp(argv[i],"--min-rel") == 0 && has_arg)
+		{min_rel = std::stod(argv[++i]);}
+		else
+		{
+			if (v_cl.getProcessUnitID() == 0)
+			{std::cerr << __FILE__ << ":" << __LINE__ << " error unknown or incomplete option " << argv[i] << std::endl;}
+
+			openfpm_finalize_wrapper();
+			return 2;
+		}
+	}
+
+	for (size_t i = 0 ; i < sel.size() ; i++)
+	{
+		if (std::find_if(tests,tests+n_tests,[&](const benchmark_test & t){return sel.get(i) == t.name;}) == tests+n_tests)
+		{
+			if (v_cl.getProcessUnitID() == 0)
+			{std::cerr << __FILE__ << ":" << __LINE__ << " error unknown test " << sel.get(i) << ", use --list" << std::endl;}
+
+			openfpm_finalize_wrapper();
+			return 2;
+		}
+	}
+
+	if (sizes.size() == 0)
+	{
+		weak = true;
+		sizes.add(25000);
+		sizes.add(50000);
+		sizes.add(100000);
+	}
+
+	if (weak == true)
+	{
+		for (size_t i = 0 ; i < sizes.size() ; i++)
+		{sizes.get(i) *= v_cl.getProcessingUnits();}
+	}
+
+	if (ghost.size() == 0)
+	{ghost.add(1.0);}
+
+	if (move.size() == 0)
+	{
+		move.add(0.1);
+		move.add(1.0);
+	}
+
+	//! [benchmark report usage]
+
+	benchmark_report rep;
+
+	for (size_t t = 0 ; t < n_tests ; t++)
+	{
+		if (is_selected(sel,tests[t].name) == false)
+		{continue;}
+
+		for (size_t s = 0 ; s < sizes.size() ; s++)
+		{
+			size_t np = sizes.get(s);
+
+			if (v_cl.getProcessUnitID() == 0)
+			{std::cout << "Running " << tests[t].name << " size: " << np << std::endl;}
+
+			if (tests[t].run_comm != NULL)
+			{
+				comm_bench_param p;
+				p.np = np;
+				p.n_samples = n_samples;
+				p.n_nn = n_nn;
+				p.ghost = ghost;
+				p.move = move;
+
+				tests[t].run_comm(p,rep);
+				continue;
+			}
+
+			// cut-off radius such that on average every particle has n_nn neighborhood particles
+			float r_cut = pow(3.0 * n_nn / (4.0 * M_PI * np),1.0/3.0);
+
+			Box<bdim,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+			size_t bc[bdim] = {PERIODIC,PERIODIC,PERIODIC};
+
+			bench_vector vd(np,box,bc,Ghost<bdim,float>(r_cut));
+			vd_initialize<bdim>(vd,v_cl,np);
+			vd.ghost_get<0>();
+
+			openfpm::vector<std::string> names;
+			openfpm::vector<openfpm::vector<double>> measures;
+
+			tests[t].run(vd,r_cut,n_samples,names,measures);
+
+			for (size_t i = 0 ; i < names.size() ; i++)
+			{rep.add(tests[t].name,names.get(i),np,v_cl.getProcessingUnits(),measures.get(i));}
+		}
+	}
+
+	//! [benchmark report usage]
+
+	size_t n_reg = 0;
+
+	if (v_cl.getProcessUnitID() == 0)
+	{
+		if (json_file.size() != 0)
+		{rep.write(json_file);}
+
+		if (csv_file.size() != 0)
+		{rep.write(csv_file);}
+
+		if (json_file.size() == 0 && csv_file.size() == 0)
+		{rep.write_json(std::cout);}
+
+		if (base_file.size() != 0)
+		{
+			benchmark_report base;
+			openfpm::vector<benchmark_compare_result> res;
+
+			if (base.load_csv(base_file) == true)
+			{
+				n_reg = rep.compare(base,res,t_crit,min_rel);
+
+				for (size_t i = 0 ; i < res.size() ; i++)
+				{
+					benchmark_compare_result & c = res.get(i);
+
+					std::cout << ((c.regression == true)?"REGRESSION ":"ok         ") << c.rec.test << "/" << c.rec.name << " size: " << c.rec.size
+					          << " mean: " << c.rec.mean << " baseline: " << c.base_mean << " change: " << 100.0*c.rel << "%";
+
+					if (c.insufficient == true)
+					{std::cout << " insufficient samples" << std::endl;}
+					else
+					{std::cout << " t: " << c.t << std::endl;}
+				}
+
+				if (res.size() == 0)
+				{std::cerr << "Warning: " << __FILE__ << ":" << __LINE__ << " no result match the baseline " << base_file << std::endl;}
+			}
+			else
+			{n_reg = 1;}
+		}
+	}
+
+	v_cl.max(n_reg);
+	v_cl.execute();
+
+	openfpm_finalize_wrapper();
+
+	return (n_reg != 0)?1:0;
+}
@@ -0,0 +1,190 @@
+/*
+ * thread_pool.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_UTIL_THREAD_POOL_HPP_
+#define SRC_UTIL_THREAD_POOL_HPP_
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+
+/*! \brief Pool of persistent threads shared by the multi-threaded parts of the library
+ *
+ * The workers are created the first time they are needed and stay alive (waiting) between two
+ * runs, so a construction repeated at every time-step does not create threads. One run at time is
+ * executed, a run started from inside a job is executed serially
+ *
+ */
+class thread_pool
+{
+	//! workers (the caller is the thread 0)
+	std::vector<std::thread> thr;
+
+	//! serialize the runs
+	std::mutex run_mtx;
+
+	//! protect the job state
+	std::mutex mtx;
+
+	//! signal a new job
+	std::condition_variable cv_start;
+
+	//! signal the end of the job
+	std::condition_variable cv_done;
+
+	//! current job
+	std::function<void(size_t)> job;
+
+	//! threads running the current job (caller included)
+	size_t n_job = 0;
+
+	//! job counter
+	size_t gen = 0;
+
+	//! workers that completed the current job
+	size_t n_done = 0;
+
+	//! stop the workers
+	bool stop = false;
+
+	/*! \brief true if the calling thread is running a job
+	 *
+	 * \return the flag
+	 *
+	 */
+	static bool & in_job()
+	{
+		static thread_local bool flag = false;
+		return flag;
+	}
+
+	/*! \brief Worker loop
+	 *
+	 * \param t thread id
+	 * \param seen last job seen
+	 *
+	 */
+	void worker(size_t t, size_t seen)
+	{
+		in_job() = true;
+		std::unique_lock<std::mutex> lk(mtx);
+
+		while (true)
+		{
+			cv_start.wait(lk,[&](){return stop == true || gen != seen;});
+
+			if (stop == true)
+			{return;}
+
+			seen = gen;
+
+			if (t >= n_job)
+			{continue;}
+
+			lk.unlock();
+			job(t);
+			lk.lock();
+
+			if (++n_done == n_job - 1)
+			{cv_done.notify_one();}
+		}
+	}
+
+public:
+
+	//! Destructor, stop the workers
+	~thread_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lk(mtx);
+			stop = true;
+		}
+
+		cv_start.notify_all();
+
+		for (size_t i = 0 ; i < thr.size() ; i++)
+		{thr[i].join();}
+	}
+
+	/*! \brief Run f(t) for t in [0,n) on n threads (the caller run f(0))
+	 *
+	 * \param n number of threads
+	 * \param f function to run
+	 *
+	 */
+	void run(size_t n, const std::function<void(size_t)> & f)
+	{
+		if (n <= 1)
+		{
+			f(0);
+			return;
+		}
+
+		if (in_job() == true)
+		{
+			for (size_t t = 0 ; t < n ; t++)
+			{f(t);}
+
+			return;
+		}
+
+		std::lock_guard<std::mutex> rl(run_mtx);
+
+		{
+			std::lock_guard<std::mutex> lk(mtx);
+
+			while (thr.size() + 1 < n)
+			{thr.push_back(std::thread(&thread_pool::worker,this,thr.size()+1,gen));}
+
+			job = f;
+			n_job = n;
+			n_done = 0;
+			gen++;
+		}
+
+		cv_start.notify_all();
+
+		in_job() = true;
+		f(0);
+		in_job() = false;
+
+		std::unique_lock<std::mutex> lk(mtx);
+		cv_done.wait(lk,[&](){return n_done == n_job - 1;});
+	}
+};
+
+/*! \brief Get the thread pool shared by the multi-threaded parts of the library
+ *
+ * \return the thread pool
+ *
+ */
+inline thread_pool & thread_pool_shared()
+{
+	static thread_pool pool;
+	return pool;
+}
+
+/*! \brief Run the function f(t) on n_thr threads of the shared pool
+ *
+ * \param n_thr number of threads
+ * \param f function to run
+ *
+ */
+template<typename F> void run_threads(size_t n_thr, F f)
+{
+	if (n_thr <= 1)
+	{
+		f(0);
+		return;
+	}
+
+	thread_pool_shared().run(n_thr,std::function<void(size_t)>(f));
+}
+
+#endif /* SRC_UTIL_THREAD_POOL_HPP_ */